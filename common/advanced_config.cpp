@@ -142,6 +142,31 @@ static const wxChar DebugZoneFiller[] = wxT( "DebugZoneFiller" );
 
 static const wxChar SkipBoundingBoxFpLoad[] = wxT( "SkipBoundingBoxFpLoad" );
 
+/**
+ * Number of parsed footprints a footprint library cache keeps in memory.  0 for no limit.
+ */
+static const wxChar FootprintCacheSize[] = wxT( "FootprintCacheSize" );
+
+/**
+ * Re-test only the items changed since the last complete DRC run, keeping the other markers.
+ */
+static const wxChar IncrementalDRC[] = wxT( "IncrementalDRC" );
+
+/**
+ * Screen size (in pixels) below which cached items are drawn with less detail.  0 disables it.
+ */
+static const wxChar CoarseItemPixels[] = wxT( "CoarseItemPixels" );
+
+/**
+ * Number of cached vertices moved after each update to compact the vertex buffer.  0 disables it.
+ */
+static const wxChar CacheCompactVertices[] = wxT( "CacheCompactVertices" );
+
+/**
+ * Number of threads rasterizing the Cairo canvas.  0 uses all the cores.
+ */
+static const wxChar CairoRasterThreads[] = wxT( "CairoRasterThreads" );
+
 } // namespace KEYS
 
 
@@ -240,6 +265,11 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_DebugZoneFiller           = false;
 
     m_SkipBoundingBoxOnFpLoad   = false;
+    m_FootprintCacheSize        = 1000;
+    m_IncrementalDRC            = false;
+    m_CoarseItemPixels          = 16;
+    m_CacheCompactVertices      = 65536;
+    m_CairoRasterThreads        = 0;
 
     loadFromConfigFile();
 }
@@ -321,6 +351,21 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::SkipBoundingBoxFpLoad, 
                                                 &m_SkipBoundingBoxOnFpLoad, false ) );
 
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::FootprintCacheSize,
+                                               &m_FootprintCacheSize, 1000, 0, 1000000 ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalDRC,
+                                                &m_IncrementalDRC, false ) );
+
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::CoarseItemPixels,
+                                               &m_CoarseItemPixels, 16, 0, 1000 ) );
+
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::CacheCompactVertices,
+                                               &m_CacheCompactVertices, 65536, 0, 16777216 ) );
+
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::CairoRasterThreads,
+                                               &m_CairoRasterThreads, 0, 0, 256 ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( PARAM_CFG* param : configParams )
@@ -549,8 +549,71 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, EDA_DATA_TYPE aType )
 }
 
 
+/**
+ * The number of decimals of a millimeter in internal units, or -1 if IU_PER_MM is not
+ * a power of ten.
+ */
+static constexpr int iuDecimals()
+{
+    int    decimals = 0;
+    double scale = 1.0;
+
+    while( scale < IU_PER_MM && decimals < 9 )
+    {
+        scale *= 10.0;
+        ++decimals;
+    }
+
+    return scale == IU_PER_MM ? decimals : -1;
+}
+
+
+/**
+ * Writes \a aValue divided by 10^aDecimals as a decimal number, without trailing zeros.
+ */
+static std::string formatDecimal( int aValue, int aDecimals )
+{
+    char               digits[24];
+    char*              end = digits + sizeof( digits );
+    char*              cp = end;
+    unsigned long long magnitude = aValue < 0 ? -(long long) aValue : aValue;
+
+    while( aDecimals > 0 && magnitude % 10 == 0 )
+    {
+        magnitude /= 10;
+        --aDecimals;
+    }
+
+    // Right to left: the decimals, the point, then the integer part, at least one digit
+    for( int ii = 0; ii < aDecimals; ++ii, magnitude /= 10 )
+        *--cp = '0' + magnitude % 10;
+
+    if( aDecimals > 0 )
+        *--cp = '.';
+
+    do
+    {
+        *--cp = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while( magnitude );
+
+    if( aValue < 0 )
+        *--cp = '-';
+
+    return std::string( cp, end );
+}
+
+
 std::string FormatInternalUnits( int aValue )
 {
+    // A millimeter being a power of ten of internal units, the value in mm has at most 10
+    // significant digits, which "%.10g" and "%.10f" below print exactly.  Writing them
+    // directly gives the same text for a fraction of the cost.
+    constexpr int decimals = iuDecimals();
+
+    if( decimals >= 0 )
+        return formatDecimal( aValue, decimals );
+
     char    buf[50];
     double  engUnits = aValue;
     int     len;
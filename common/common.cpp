@@ -40,8 +40,10 @@
 #include <boost/functional/hash.hpp>
 
 
-// Create only once, as seeding is *very* expensive
+// Create only once, as seeding is *very* expensive.  Items are created on several threads
+// when loading libraries and boards, so the generator is only used through newRandomUuid().
 static boost::uuids::random_generator randomGenerator;
+static std::mutex                     randomGeneratorLock;
 
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
@@ -51,6 +53,14 @@ static boost::uuids::nil_generator nilGenerator;
 KIID niluuid( 0 );
 
 
+static boost::uuids::uuid newRandomUuid()
+{
+    std::lock_guard<std::mutex> lock( randomGeneratorLock );
+
+    return randomGenerator();
+}
+
+
 // For static initialization
 KIID& NilUuid()
 {
@@ -60,7 +70,7 @@ KIID& NilUuid()
 
 
 KIID::KIID() :
-        m_uuid( randomGenerator() ),
+        m_uuid( newRandomUuid() ),
         m_cached_timestamp( 0 )
 {
 }
@@ -104,7 +114,7 @@ KIID::KIID( const wxString& aString ) :
         {
             // Failed to parse string representation; best we can do is assign a new
             // random one.
-            m_uuid = randomGenerator();
+            m_uuid = newRandomUuid();
         }
     }
 }
@@ -178,7 +188,7 @@ void KIID::ConvertTimestampToUuid()
         return;
 
     m_cached_timestamp = 0;
-    m_uuid = randomGenerator();
+    m_uuid = newRandomUuid();
 }
 
 
@@ -46,9 +46,8 @@
 
 #include <widgets/infobar.h>
 
-#ifdef PROFILE
 #include <profile.h>
-#endif /* PROFILE */
+#include <trace_helpers.h>
 
 
 EDA_DRAW_PANEL_GAL::EDA_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWindowId,
@@ -189,6 +188,13 @@ void EDA_DRAW_PANEL_GAL::DoRePaint()
     m_drawing = true;
     KIGFX::RENDER_SETTINGS* settings = static_cast<KIGFX::RENDER_SETTINGS*>( m_painter->GetSettings() );
 
+    KIGFX::FRAME_STATS frameStats;
+    PROF_COUNTER       frameTimer;
+    bool               traceFrame = wxLog::IsAllowedTraceMask( traceGalFrameStats );
+
+    if( traceFrame )
+        m_gal->SetFrameStats( &frameStats );
+
     try
     {
         m_view->UpdateItems();
@@ -245,6 +251,25 @@ void EDA_DRAW_PANEL_GAL::DoRePaint()
         }
     }
 
+    if( traceFrame )
+    {
+        m_gal->SetFrameStats( nullptr );
+
+        wxLogTrace( traceGalFrameStats,
+                    "Frame: %.2f ms, update %.2f ms (%d items, prepare %.2f ms), upload %.2f ms "
+                    "(%d bytes moved, %.0f%% fragmented), query %.2f ms, "
+                    "draw %.2f ms (%d items, %d vertices), flush %.2f ms, composite %.2f ms, "
+                    "present %.2f ms",
+                    frameTimer.msecs(), frameStats.m_updateTime,
+                    (int) frameStats.m_updatedItemCount, frameStats.m_prepareTime,
+                    frameStats.m_uploadTime,
+                    (int) frameStats.m_cacheMovedBytes, frameStats.m_cacheFragmentation * 100.0,
+                    frameStats.GetQueryTime(), frameStats.GetDrawTime(),
+                    (int) frameStats.GetItemCount(), (int) frameStats.m_vertexCount,
+                    frameStats.m_flushTime,
+                    frameStats.m_compositeTime, frameStats.m_presentTime );
+    }
+
 #ifdef PROFILE
     totalRealTime.Stop();
     wxLogTrace( "GAL_PROFILE", "EDA_DRAW_PANEL_GAL::DoRePaint(): %.1f ms", totalRealTime.msecs() );
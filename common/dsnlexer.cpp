@@ -28,6 +28,13 @@
 #include <cstdio>
 #include <cstdlib>         // bsearch()
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <dsnlexer.h>
 
@@ -36,6 +43,258 @@
 
 //-----<DSNLEXER>-------------------------------------------------------------
 
+/**
+ * A minimal perfect hash of a keyword table.
+ *
+ * The keywords are spread over buckets by one hash of their text, and each bucket gets the
+ * displacement which sends all of its keywords to free slots of the table.  A lookup then
+ * costs one hash and one compare against the only keyword which could match, and needs no
+ * nul terminated copy of the token.
+ */
+class KEYWORD_INDEX
+{
+public:
+    KEYWORD_INDEX( const KEYWORD* aKeywords, unsigned aCount ) :
+            m_keywords( aKeywords ),
+            m_count( aCount )
+    {
+        std::vector<unsigned> unique = uniqueKeywords();
+        unsigned              size = 4;
+
+        while( size < 2 * aCount )
+            size *= 2;
+
+        // A larger table leaves more free slots for the crowded buckets
+        for( int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt, size *= 2 )
+        {
+            if( build( unique, size ) )
+                return;
+        }
+
+        wxFAIL_MSG( "No perfect hash found for the keyword table" );
+
+        // Find() searches the whole table
+        m_slots.clear();
+    }
+
+    /**
+     * Return the token of the keyword [aStart, aEnd), or DSN_SYMBOL if it is not a keyword.
+     */
+    int Find( const char* aStart, const char* aEnd ) const
+    {
+        size_t length = aEnd - aStart;
+
+        if( m_slots.empty() )
+        {
+            for( unsigned ii = 0; ii < m_count; ++ii )
+            {
+                if( strlen( m_keywords[ii].name ) == length
+                        && memcmp( m_keywords[ii].name, aStart, length ) == 0 )
+                {
+                    return m_keywords[ii].token;
+                }
+            }
+
+            return DSN_SYMBOL;
+        }
+
+        uint64_t    h = hash( aStart, aEnd );
+        uint32_t    d = m_displacements[h & m_mask];
+
+        if( d == 0 )
+            return DSN_SYMBOL;
+
+        const SLOT& slot = m_slots[mix( h, d ) & m_mask];
+
+        if( length && slot.m_length == length
+                && memcmp( m_keywords[slot.m_keyword].name, aStart, length ) == 0 )
+        {
+            return m_keywords[slot.m_keyword].token;
+        }
+
+        return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
+    }
+
+    /**
+     * Return the index of aKeywords, built on first use and then shared by all of the lexers
+     * using the same keyword table.
+     */
+    static const KEYWORD_INDEX* Get( const KEYWORD* aKeywords, unsigned aCount )
+    {
+        static std::mutex                                                   lock;
+        static std::map<const KEYWORD*, std::unique_ptr<KEYWORD_INDEX>>     indexes;
+
+        std::lock_guard<std::mutex> guard( lock );
+        std::unique_ptr<KEYWORD_INDEX>& index = indexes[aKeywords];
+
+        if( !index )
+            index.reset( new KEYWORD_INDEX( aKeywords, aCount ) );
+
+        return index.get();
+    }
+
+private:
+    ///> Displacements tried for a bucket before building a larger table
+    static const uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+    ///> Table sizes tried, each twice the previous one
+    static const int MAX_ATTEMPTS = 4;
+
+    /**
+     * Return the indexes of the keywords, without the repeated ones, which could never be
+     * placed in distinct slots.
+     */
+    std::vector<unsigned> uniqueKeywords() const
+    {
+        std::vector<unsigned> sorted( m_count );
+
+        for( unsigned ii = 0; ii < m_count; ++ii )
+            sorted[ii] = ii;
+
+        std::stable_sort( sorted.begin(), sorted.end(),
+                          [&]( unsigned a, unsigned b )
+                          {
+                              return strcmp( m_keywords[a].name, m_keywords[b].name ) < 0;
+                          } );
+
+        std::vector<unsigned> unique;
+
+        for( unsigned kw : sorted )
+        {
+            if( !unique.empty()
+                    && strcmp( m_keywords[unique.back()].name, m_keywords[kw].name ) == 0 )
+            {
+                wxFAIL_MSG( wxString::Format( "Keyword \"%s\" is repeated in the keyword table",
+                                              m_keywords[kw].name ) );
+                continue;
+            }
+
+            unique.push_back( kw );
+        }
+
+        return unique;
+    }
+
+    /**
+     * Place \a aKeywords in a table of \a aSize slots.
+     *
+     * @return false if a bucket found no displacement sending its keywords to free slots.
+     */
+    bool build( const std::vector<unsigned>& aKeywords, unsigned aSize )
+    {
+        m_mask = aSize - 1;
+        m_displacements.assign( aSize, 0 );
+        m_slots.assign( aSize, SLOT() );
+
+        std::vector<uint64_t>              hashes( m_count );
+        std::vector<std::vector<unsigned>> buckets( aSize );
+
+        for( unsigned kw : aKeywords )
+        {
+            const char* name = m_keywords[kw].name;
+
+            hashes[kw] = hash( name, name + strlen( name ) );
+            buckets[hashes[kw] & m_mask].push_back( kw );
+        }
+
+        std::vector<unsigned> order( aSize );
+
+        for( unsigned ii = 0; ii < aSize; ++ii )
+            order[ii] = ii;
+
+        // The crowded buckets are the hard ones to place, so they go first
+        std::stable_sort( order.begin(), order.end(),
+                          [&]( unsigned a, unsigned b )
+                          {
+                              return buckets[a].size() > buckets[b].size();
+                          } );
+
+        std::vector<unsigned> placed;
+
+        for( unsigned b : order )
+        {
+            if( buckets[b].empty() )
+                break;
+
+            uint32_t d;
+
+            for( d = 1; d <= MAX_DISPLACEMENT; ++d )
+            {
+                placed.clear();
+
+                for( unsigned kw : buckets[b] )
+                {
+                    unsigned slot = mix( hashes[kw], d ) & m_mask;
+
+                    if( m_slots[slot].m_length
+                            || std::find( placed.begin(), placed.end(), slot ) != placed.end() )
+                    {
+                        break;
+                    }
+
+                    placed.push_back( slot );
+                }
+
+                if( placed.size() == buckets[b].size() )
+                    break;
+            }
+
+            if( d > MAX_DISPLACEMENT )
+                return false;
+
+            for( size_t ii = 0; ii < placed.size(); ++ii )
+            {
+                unsigned kw = buckets[b][ii];
+
+                m_slots[placed[ii]].m_keyword = kw;
+                m_slots[placed[ii]].m_length = strlen( m_keywords[kw].name );
+            }
+
+            m_displacements[b] = d;
+        }
+
+        return true;
+    }
+
+    ///> FNV-1a
+    static uint64_t hash( const char* aStart, const char* aEnd )
+    {
+        uint64_t h = 0xcbf29ce484222325ULL;
+
+        for( const char* cp = aStart; cp < aEnd; ++cp )
+        {
+            h ^= (unsigned char) *cp;
+            h *= 0x100000001b3ULL;
+        }
+
+        return h;
+    }
+
+    static uint64_t mix( uint64_t aHash, uint32_t aDisplacement )
+    {
+        uint64_t h = aHash ^ ( aDisplacement * 0x9e3779b97f4a7c15ULL );
+
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    struct SLOT
+    {
+        unsigned m_keyword = 0;
+        size_t   m_length = 0;         ///< 0 for a free slot
+    };
+
+    const KEYWORD*        m_keywords;
+    unsigned              m_count;
+    unsigned              m_mask;
+    std::vector<uint32_t> m_displacements;     ///< per bucket, 0 for an empty bucket
+    std::vector<SLOT>     m_slots;
+};
+
+
 void DSNLEXER::init()
 {
     curTok  = DSN_NONE;
@@ -49,22 +308,7 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
-#if 1
-    if( keywordCount > 11 )
-    {
-        // resize the hashtable bucket count
-        keyword_hash.reserve( keywordCount );
-    }
-
-    // fill the specialized "C string" hashtable from keywords[]
-    const KEYWORD*  it  = keywords;
-    const KEYWORD*  end = it + keywordCount;
-
-    for( ; it < end; ++it )
-    {
-        keyword_hash[it->name] = it->token;
-    }
-#endif
+    keywordIndex = KEYWORD_INDEX::Get( keywords, keywordCount );
 }
 
 
@@ -75,6 +319,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mappedReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -91,6 +336,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mappedReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -108,6 +354,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mappedReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -125,6 +372,7 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mappedReader( NULL ),
     keywords( empty_keywords ),
     keywordCount( 0 )
 {
@@ -188,6 +436,7 @@ void DSNLEXER::PushReader( LINE_READER* aLineReader )
 {
     readerStack.push_back( aLineReader );
     reader = aLineReader;
+    mappedReader = dynamic_cast<MAPPED_FILE_LINE_READER*>( reader );
     start  = (const char*) (*reader);
 
     // force a new readLine() as first thing.
@@ -208,6 +457,7 @@ LINE_READER* DSNLEXER::PopReader()
         if( readerStack.size() )
         {
             reader = readerStack.back();
+            mappedReader = dynamic_cast<MAPPED_FILE_LINE_READER*>( reader );
             start  = reader->Line();
 
             // force a new readLine() as first thing.
@@ -217,6 +467,7 @@ LINE_READER* DSNLEXER::PopReader()
         else
         {
             reader = 0;
+            mappedReader = 0;
             start  = dummy;
             limit  = dummy;
         }
@@ -227,12 +478,13 @@ LINE_READER* DSNLEXER::PopReader()
 
 int DSNLEXER::findToken( const std::string& tok )
 {
-    KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
+    return keywordIndex->Find( tok.data(), tok.data() + tok.size() );
+}
 
-    if( it != keyword_hash.end() )
-        return it->second;
 
-    return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
+int DSNLEXER::findToken( const char* aStart, const char* aEnd )
+{
+    return keywordIndex->Find( aStart, aEnd );
 }
 
 
@@ -625,7 +877,7 @@ L_read:
                     case 'x':   // 1 or 2 byte hex escape sequence
                         for( i=0; i<2; ++i )
                         {
-                            if( !isxdigit( head[i] ) )
+                            if( head + i >= limit || !isxdigit( head[i] ) )
                                 break;
                             tbuf[i] = head[i];
                         }
@@ -641,7 +893,7 @@ L_read:
                         --head;
                         for( i=0; i<3; ++i )
                         {
-                            if( head[i] < '0' || head[i] > '7' )
+                            if( head + i >= limit || head[i] < '0' || head[i] > '7' )
                                 break;
                             tbuf[i] = head[i];
                         }
@@ -665,7 +917,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run up to the next escape or delimiter in one go
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -746,13 +1006,13 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    curText.assign( cur, head );
+
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
@@ -764,7 +1024,7 @@ L_read:
         goto exit;
     }
 
-    curTok = findToken( curText );
+    curTok = findToken( cur, head );
 
 exit:   // single point of exit, no returns elsewhere please.
 
@@ -776,6 +1036,90 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+const char* DSNLEXER::SkipListInPlace( const char* aLeft, int aLeftLine, int& aEndLine )
+{
+    wxASSERT( mappedReader && !specctraMode );
+
+    const char* end = mappedReader->Data() + mappedReader->Size();
+    const char* cp = aLeft;
+    int         line = aLeftLine;
+    int         depth = 0;
+
+    while( cp < end )
+    {
+        switch( *cp++ )
+        {
+        case '(':
+            ++depth;
+            break;
+
+        case ')':
+            if( --depth > 0 )
+                break;
+
+            aEndLine = line;
+
+            // Continue lexing on the line of the closing paren, as if it was just returned
+            {
+                const char* lineStart = cp - 1;
+
+                while( lineStart > mappedReader->Data() && lineStart[-1] != '\n' )
+                    --lineStart;
+
+                mappedReader->Seek( lineStart, line );
+                readLine();
+            }
+
+            next = cp;
+            curOffset = cp - 1 - start;
+            curText = ')';
+            prevTok = curTok;
+            curTok = DSN_RIGHT;
+            return cp;
+
+        case '"':
+            // a quoted string, which may hold parens and escaped quotes
+            while( cp < end && *cp != '"' )
+            {
+                if( *cp == '\\' && cp + 1 < end && cp[1] != '\n' )
+                    ++cp;
+                else if( *cp == '\n' )
+                    ++line;
+
+                ++cp;
+            }
+
+            ++cp;
+            break;
+
+        case '\n':
+            ++line;
+
+            // lines starting with # are comments, they are skipped like NextTok() does
+            {
+                const char* first = cp;
+
+                while( first < end && isSpace( *first ) && *first != '\n' )
+                    ++first;
+
+                if( first < end && *first == '#' )
+                {
+                    const char* nl = (const char*) memchr( first, '\n', end - first );
+                    cp = nl ? nl : end;
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    THROW_PARSE_ERROR( _( "Unterminated list" ), CurSource(), CurLine(), aLeftLine,
+                       curOffset + 1 );
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines()
 {
     wxArrayString*  ret = 0;
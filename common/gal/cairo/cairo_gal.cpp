@@ -29,15 +29,20 @@
 #include <wx/image.h>
 #include <wx/log.h>
 
+#include <advanced_config.h>
 #include <gal/cairo/cairo_gal.h>
 #include <gal/cairo/cairo_compositor.h>
 #include <gal/definitions.h>
 #include <geometry/shape_poly_set.h>
 #include <math/util.h>      // for KiROUND
 #include <bitmap_base.h>
+#include <profile.h>
 
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <limits>
+#include <thread>
 
 #include <pixman.h>
 
@@ -72,6 +77,9 @@ CAIRO_GAL_BASE::CAIRO_GAL_BASE( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
     // Avoid unitialized variables:
     cairo_matrix_init_identity( &currentXform );
     cairo_matrix_init_identity( &currentWorld2Screen );
+
+    tileContext = nullptr;
+    SetRasterThreadCount( ADVANCED_CFG::GetCfg().m_CairoRasterThreads );
 }
 
 
@@ -79,6 +87,10 @@ CAIRO_GAL_BASE::~CAIRO_GAL_BASE()
 {
     ClearCache();
 
+    // The kept paths are not drawn anymore
+    if( tileContext )
+        cairo_destroy( tileContext );
+
     if( surface )
         cairo_surface_destroy( surface );
 
@@ -243,8 +255,7 @@ void CAIRO_GAL_BASE::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& a
 
         cairo_move_to( currentContext, p0.x, p0.y );
         cairo_line_to( currentContext, p1.x, p1.y );
-        cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        cairo_stroke( currentContext );
+        drawPath( fillColor, true );
     }
     else
     {
@@ -456,6 +467,9 @@ void CAIRO_GAL_BASE::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aCo
 
 void CAIRO_GAL_BASE::DrawBitmap( const BITMAP_BASE& aBitmap )
 {
+    // The image is painted at once, over the paths drawn before it
+    flushTiles();
+
     cairo_save( currentContext );
 
     // We have to calculate the pixel size in users units to draw the image.
@@ -524,6 +538,9 @@ void CAIRO_GAL_BASE::DrawBitmap( const BITMAP_BASE& aBitmap )
 
 void CAIRO_GAL_BASE::ResizeScreen( int aWidth, int aHeight )
 {
+    // The kept paths are drawn before their target is reallocated
+    flushTiles();
+
     screenSize = VECTOR2I( aWidth, aHeight );
 }
 
@@ -531,14 +548,14 @@ void CAIRO_GAL_BASE::ResizeScreen( int aWidth, int aHeight )
 void CAIRO_GAL_BASE::Flush()
 {
     storePath();
+    flushTiles();
 }
 
 
 void CAIRO_GAL_BASE::ClearScreen()
 {
-    cairo_set_source_rgb( currentContext, m_clearColor.r, m_clearColor.g, m_clearColor.b );
     cairo_rectangle( currentContext, 0.0, 0.0, screenSize.x, screenSize.y );
-    cairo_fill( currentContext );
+    drawPath( COLOR4D( m_clearColor.r, m_clearColor.g, m_clearColor.b, 1.0 ), false );
 }
 
 
@@ -816,15 +833,13 @@ void CAIRO_GAL_BASE::DrawGroup( int aGroupNumber )
 
 
         case CMD_STROKE_PATH:
-            cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_stroke( currentContext );
+            drawPath( strokeColor, true );
             break;
 
         case CMD_FILL_PATH:
-            cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_fill( currentContext );
+            drawPath( COLOR4D( fillColor.r, fillColor.g, fillColor.b, strokeColor.a ), false );
             break;
 
             /*
@@ -973,12 +988,11 @@ void CAIRO_GAL_BASE::drawAxes( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
     auto p1 = roundp( xform( aEndPoint ) );
     auto org = roundp( xform( VECTOR2D( 0.0, 0.0 ) ) );     // Axis origin = 0,0 coord
 
-    cairo_set_source_rgba( currentContext, axesColor.r, axesColor.g, axesColor.b, axesColor.a );
     cairo_move_to( currentContext, p0.x, org.y);
     cairo_line_to( currentContext, p1.x, org.y );
     cairo_move_to( currentContext, org.x, p0.y );
     cairo_line_to( currentContext, org.x, p1.y );
-    cairo_stroke( currentContext );
+    drawPath( axesColor, true );
 }
 
 
@@ -988,10 +1002,9 @@ void CAIRO_GAL_BASE::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D&
     auto p0 = roundp( xform( aStartPoint ) );
     auto p1 = roundp( xform( aEndPoint ) );
 
-    cairo_set_source_rgba( currentContext, gridColor.r, gridColor.g, gridColor.b, gridColor.a );
     cairo_move_to( currentContext, p0.x, p0.y );
     cairo_line_to( currentContext, p1.x, p1.y );
-    cairo_stroke( currentContext );
+    drawPath( gridColor, true );
 }
 
 
@@ -1006,12 +1019,11 @@ void CAIRO_GAL_BASE::drawGridCross( const VECTOR2D& aPoint )
     auto p2 = roundp( xform( aPoint ) ) - VECTOR2D( 0, size ) + offset;
     auto p3 = roundp( xform( aPoint ) ) + VECTOR2D( 0, size ) + offset;
 
-    cairo_set_source_rgba( currentContext, gridColor.r, gridColor.g, gridColor.b, gridColor.a );
     cairo_move_to( currentContext, p0.x, p0.y );
     cairo_line_to( currentContext, p1.x, p1.y );
     cairo_move_to( currentContext, p2.x, p2.y );
     cairo_line_to( currentContext, p3.x, p3.y );
-    cairo_stroke( currentContext );
+    drawPath( gridColor, true );
 }
 
 
@@ -1020,33 +1032,20 @@ void CAIRO_GAL_BASE::drawGridPoint( const VECTOR2D& aPoint, double aSize )
     auto p = roundp( xform( aPoint ) );
     auto s = std::max( 1.0, xform( aSize / 2.0 ) );
 
-    cairo_set_source_rgba( currentContext, gridColor.r, gridColor.g, gridColor.b, gridColor.a );
     cairo_move_to( currentContext, p.x, p.y );
     cairo_arc( currentContext, p.x, p.y, s, 0.0, 2.0 * M_PI );
     cairo_close_path( currentContext );
 
-    cairo_fill( currentContext );
+    drawPath( gridColor, false );
 }
 
 void CAIRO_GAL_BASE::flushPath()
 {
    if( isFillEnabled )
-   {
-       cairo_set_source_rgba( currentContext,
-               fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-       if( isStrokeEnabled )
-           cairo_fill_preserve( currentContext );
-       else
-           cairo_fill( currentContext );
-   }
+       drawPath( fillColor, false, isStrokeEnabled );
 
    if( isStrokeEnabled )
-   {
-       cairo_set_source_rgba( currentContext,
-               strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-       cairo_stroke( currentContext );
-   }
+       drawPath( strokeColor, true );
 }
 
 
@@ -1059,17 +1058,10 @@ void CAIRO_GAL_BASE::storePath()
         if( !isGrouping )
         {
             if( isFillEnabled )
-            {
-                cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-                cairo_fill_preserve( currentContext );
-            }
+                drawPath( fillColor, false, true );
 
             if( isStrokeEnabled )
-            {
-                cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g,
-                                      strokeColor.b, strokeColor.a );
-                cairo_stroke_preserve( currentContext );
-            }
+                drawPath( strokeColor, true, true );
         }
         else
         {
@@ -1098,6 +1090,198 @@ void CAIRO_GAL_BASE::storePath()
 }
 
 
+void CAIRO_GAL_BASE::SetRasterThreadCount( int aCount )
+{
+    if( aCount <= 0 )
+        rasterThreadCount = std::max( 1u, std::thread::hardware_concurrency() );
+    else
+        rasterThreadCount = aCount;
+}
+
+
+void CAIRO_GAL_BASE::drawPath( const COLOR4D& aColor, bool aStroke, bool aPreserve )
+{
+    // Only image surfaces are split in bands, and only when there are threads to draw them
+    if( rasterThreadCount <= 1
+            || cairo_surface_get_type( cairo_get_target( currentContext ) )
+                    != CAIRO_SURFACE_TYPE_IMAGE )
+    {
+        cairo_set_source_rgba( currentContext, aColor.r, aColor.g, aColor.b, aColor.a );
+
+        if( aStroke )
+            aPreserve ? cairo_stroke_preserve( currentContext ) : cairo_stroke( currentContext );
+        else
+            aPreserve ? cairo_fill_preserve( currentContext ) : cairo_fill( currentContext );
+
+        return;
+    }
+
+    // The kept paths are drawn to a single target, in the order they came
+    if( tileContext != currentContext )
+    {
+        flushTiles();
+        tileContext = cairo_reference( currentContext );
+    }
+
+    TILE_PATH tilePath;
+
+    tilePath.path.reset( cairo_copy_path( currentContext ), cairo_path_destroy );
+
+    if( tilePath.path->status == CAIRO_STATUS_SUCCESS && tilePath.path->num_data > 0 )
+    {
+        cairo_get_matrix( currentContext, &tilePath.matrix );
+        tilePath.color = aColor;
+        tilePath.op = cairo_get_operator( currentContext );
+        tilePath.fillRule = cairo_get_fill_rule( currentContext );
+        tilePath.stroke = aStroke;
+        tilePath.lineWidth = cairo_get_line_width( currentContext );
+        tilePath.lineCap = cairo_get_line_cap( currentContext );
+        tilePath.lineJoin = cairo_get_line_join( currentContext );
+
+        // Rows covered by the path, with its stroke and antialiasing
+        double x1, y1, x2, y2;
+        cairo_path_extents( currentContext, &x1, &y1, &x2, &y2 );
+
+        if( aStroke )
+        {
+            double margin = tilePath.lineWidth / 2.0;
+
+            if( tilePath.lineJoin == CAIRO_LINE_JOIN_MITER )
+                margin *= cairo_get_miter_limit( currentContext );
+
+            x1 -= margin;
+            y1 -= margin;
+            x2 += margin;
+            y2 += margin;
+        }
+
+        double xs[4] = { x1, x2, x1, x2 };
+        double ys[4] = { y1, y1, y2, y2 };
+
+        tilePath.top = std::numeric_limits<double>::max();
+        tilePath.bottom = std::numeric_limits<double>::lowest();
+
+        for( int i = 0; i < 4; ++i )
+        {
+            cairo_user_to_device( currentContext, &xs[i], &ys[i] );
+            tilePath.top = std::min( tilePath.top, ys[i] - 1.0 );
+            tilePath.bottom = std::max( tilePath.bottom, ys[i] + 1.0 );
+        }
+
+        tilePaths.push_back( tilePath );
+    }
+
+    if( !aPreserve )
+        cairo_new_path( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::flushTiles()
+{
+    if( !tileContext )
+        return;
+
+    cairo_surface_t*  target = cairo_get_target( tileContext );
+    cairo_antialias_t antialias = cairo_get_antialias( tileContext );
+    int               height = cairo_image_surface_get_height( target );
+
+    // A few bands for each thread, as the paths are rarely spread evenly over the rows
+    size_t parallelThreadCount = std::min<size_t>( rasterThreadCount, tilePaths.size() / 16 );
+    size_t bandCount = std::min<size_t>( parallelThreadCount * 4, height / 16 );
+
+    if( parallelThreadCount <= 1 || bandCount <= 1 )
+    {
+        // A context of its own keeps the state of the GAL context
+        cairo_t* bandContext = cairo_create( target );
+        cairo_set_antialias( bandContext, antialias );
+        drawTilePaths( bandContext, 0, height );
+        cairo_destroy( bandContext );
+    }
+    else
+    {
+        unsigned char* data = cairo_image_surface_get_data( target );
+        cairo_format_t format = cairo_image_surface_get_format( target );
+        int            width = cairo_image_surface_get_width( target );
+        int            stride = cairo_image_surface_get_stride( target );
+
+        cairo_surface_flush( target );
+
+        std::atomic<size_t> nextBand( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto raster_lambda = [&]() -> size_t
+        {
+            for( size_t i = nextBand++; i < bandCount; i = nextBand++ )
+            {
+                int top = height * i / bandCount;
+                int bottom = height * ( i + 1 ) / bandCount;
+
+                // Each band is a surface of its own over the rows of the target
+                cairo_surface_t* bandSurface = cairo_image_surface_create_for_data(
+                        data + top * stride, format, width, bottom - top, stride );
+                cairo_t* bandContext = cairo_create( bandSurface );
+
+                cairo_set_antialias( bandContext, antialias );
+                drawTilePaths( bandContext, top, bottom );
+
+                cairo_destroy( bandContext );
+                cairo_surface_destroy( bandSurface );
+            }
+
+            return 1;
+        };
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, raster_lambda );
+
+        // Finalize the threads
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+
+        cairo_surface_mark_dirty( target );
+    }
+
+    tilePaths.clear();
+    cairo_destroy( tileContext );
+    tileContext = nullptr;
+}
+
+
+void CAIRO_GAL_BASE::drawTilePaths( cairo_t* aContext, int aTop, int aBottom ) const
+{
+    for( const TILE_PATH& tilePath : tilePaths )
+    {
+        if( tilePath.bottom < aTop || tilePath.top > aBottom )
+            continue;
+
+        // The band starts at the row aTop of the target
+        cairo_matrix_t matrix = tilePath.matrix;
+        matrix.y0 -= aTop;
+
+        cairo_set_matrix( aContext, &matrix );
+        cairo_set_operator( aContext, tilePath.op );
+        cairo_set_fill_rule( aContext, tilePath.fillRule );
+        cairo_set_source_rgba( aContext, tilePath.color.r, tilePath.color.g, tilePath.color.b,
+                               tilePath.color.a );
+
+        cairo_new_path( aContext );
+        cairo_append_path( aContext, tilePath.path.get() );
+
+        if( tilePath.stroke )
+        {
+            cairo_set_line_width( aContext, tilePath.lineWidth );
+            cairo_set_line_cap( aContext, tilePath.lineCap );
+            cairo_set_line_join( aContext, tilePath.lineJoin );
+            cairo_stroke( aContext );
+        }
+        else
+        {
+            cairo_fill( aContext );
+        }
+    }
+}
+
+
 void CAIRO_GAL_BASE::blitCursor( wxMemoryDC& clientDC )
 {
     if( !IsCursorEnabled() )
@@ -1271,12 +1455,20 @@ void CAIRO_GAL::beginDrawing()
 
 void CAIRO_GAL::endDrawing()
 {
+    PROF_COUNTER timer;
+
     CAIRO_GAL_BASE::endDrawing();
 
+    if( frameStats )
+        frameStats->m_flushTime += timer.msecs( true );
+
     // Merge buffers on the screen
     compositor->DrawBuffer( mainBuffer );
     compositor->DrawBuffer( overlayBuffer );
 
+    if( frameStats )
+        frameStats->m_compositeTime += timer.msecs( true );
+
     // Now translate the raw context data from the format stored
     // by cairo into a format understood by wxImage.
 
@@ -1304,6 +1496,9 @@ void CAIRO_GAL::endDrawing()
     clientDC.Blit( 0, 0, screenSize.x, screenSize.y, &mdc, 0, 0, wxCOPY );
 
     deinitSurface();
+
+    if( frameStats )
+        frameStats->m_presentTime += timer.msecs( true );
 }
 
 
@@ -1395,6 +1590,9 @@ RENDER_TARGET CAIRO_GAL::GetTarget() const
 
 void CAIRO_GAL::ClearTarget( RENDER_TARGET aTarget )
 {
+    // The buffers are cleared directly, after the paths kept for them are drawn
+    flushTiles();
+
     // Save the current state
     unsigned int currentBuffer = compositor->GetBuffer();
 
@@ -1444,6 +1642,8 @@ void CAIRO_GAL::deinitSurface()
     if( !isInitialized )
         return;
 
+    flushTiles();
+
     cairo_destroy( context );
     context = nullptr;
     cairo_surface_destroy( surface );
@@ -43,6 +43,8 @@ GAL::GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
     // Set the default values for the internal variables
     SetIsFill( false );
     SetIsStroke( true );
+    isCoarseGeometry = false;
+    frameStats = nullptr;
     SetFillColor( COLOR4D( 0.0, 0.0, 0.0, 0.0 ) );
     SetStrokeColor( COLOR4D( 1.0, 1.0, 1.0, 1.0 ) );
     SetLookAtPoint( VECTOR2D( 0, 0 ) );
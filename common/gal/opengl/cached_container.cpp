@@ -48,10 +48,12 @@
 using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
-    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 )
+    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 ),
+    m_movedBytes( 0 )
 {
     // In the beginning there is only free space
     m_freeChunks.insert( std::make_pair( aSize, 0 ) );
+    m_freeChunkOffsets.insert( std::make_pair( 0, aSize ) );
 }
 
 
@@ -65,6 +67,10 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
 
     // Get the previously set offset if the item was stored previously
     m_chunkOffset = itemSize > 0 ? aItem->GetOffset() : -1;
+
+    // The item is stored again in FinishItem(), once its chunk does not move anymore
+    if( itemSize > 0 )
+        m_items.erase( m_chunkOffset );
 }
 
 
@@ -82,13 +88,14 @@ void CACHED_CONTAINER::FinishItem()
 
         // Add the not used memory back to the pool
         addFreeChunk( itemOffset + itemSize, m_chunkSize - itemSize );
-        // mergeFreeChunks();   // veery slow and buggy
-
-        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
     }
 
     if( itemSize > 0 )
-        m_items.insert( m_item );
+    {
+        // The item may fill its chunk exactly, so this is not only done for the one above
+        m_maxIndex = std::max( m_item->GetOffset() + itemSize, m_maxIndex );
+        m_items.insert( std::make_pair( m_item->GetOffset(), m_item ) );
+    }
 
     m_item = NULL;
     m_chunkSize = 0;
@@ -144,7 +151,6 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
 void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 {
     assert( aItem != NULL );
-    assert( m_items.find( aItem ) != m_items.end() || aItem->GetSize() == 0 );
 
     int size = aItem->GetSize();
 
@@ -153,13 +159,15 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 
     int offset = aItem->GetOffset();
 
+    assert( m_items.count( offset ) && m_items.at( offset ) == aItem );
+
     // Insert a free memory chunk entry in the place where item was stored
     addFreeChunk( offset, size );
 
     // Indicate that the item is not stored in the container anymore
     aItem->setSize( 0 );
 
-    m_items.erase( aItem );
+    m_items.erase( offset );
 
 #if CACHED_CONTAINER_TEST > 0
     test();
@@ -191,13 +199,92 @@ void CACHED_CONTAINER::Clear()
     // Set the size of all the stored VERTEX_ITEMs to 0, so it is clear that they are not held
     // in the container anymore
     for( ITEMS::iterator it = m_items.begin(); it != m_items.end(); ++it )
-        ( *it )->setSize( 0 );
+        it->second->setSize( 0 );
 
     m_items.clear();
 
     // Now there is only free space left
     m_freeChunks.clear();
     m_freeChunks.insert( std::make_pair( m_freeSpace, 0 ) );
+    m_freeChunkOffsets.clear();
+    m_freeChunkOffsets.insert( std::make_pair( 0, m_freeSpace ) );
+}
+
+
+unsigned int CACHED_CONTAINER::Compact( unsigned int aMaxSize )
+{
+    assert( m_item == NULL );
+
+    if( !IsMapped() || m_failed )
+        return 0;
+
+    unsigned int moved = 0;
+
+    while( !m_items.empty() )
+    {
+        // Move the last item to the first free chunk that fits it, if there is one before it
+        ITEMS::iterator last = std::prev( m_items.end() );
+        VERTEX_ITEM* item = last->second;
+        unsigned int itemOffset = last->first;
+        unsigned int itemSize = item->GetSize();
+
+        if( moved > 0 && moved + itemSize > aMaxSize )
+            break;
+
+        FREE_CHUNK_MAP::iterator chunk = m_freeChunks.lower_bound( CHUNK( itemSize, 0 ) );
+
+        while( chunk != m_freeChunks.end() && getChunkOffset( *chunk ) > itemOffset )
+            ++chunk;
+
+        if( chunk == m_freeChunks.end() )
+            break;
+
+        unsigned int chunkSize   = getChunkSize( *chunk );
+        unsigned int chunkOffset = getChunkOffset( *chunk );
+
+        removeFreeChunk( chunkOffset, chunkSize );
+
+        if( chunkSize > itemSize )
+            addFreeChunk( chunkOffset + itemSize, chunkSize - itemSize );
+
+        memcpy( &m_vertices[chunkOffset], &m_vertices[itemOffset], itemSize * VERTEX_SIZE );
+
+        item->setOffset( chunkOffset );
+        m_items.erase( last );
+        m_items.insert( std::make_pair( chunkOffset, item ) );
+
+        // The item leaves a free chunk merged with the free space at the end
+        addFreeChunk( itemOffset, itemSize );
+
+        moved += itemSize;
+    }
+
+    if( moved > 0 )
+    {
+        m_movedBytes += moved * VERTEX_SIZE;
+        m_dirty = true;
+
+        // The vertices after the last item are not used anymore
+        if( m_items.empty() )
+            m_maxIndex = 0;
+        else
+            m_maxIndex = m_items.rbegin()->first + m_items.rbegin()->second->GetSize();
+    }
+
+#if CACHED_CONTAINER_TEST > 0
+    test();
+#endif
+
+    return moved;
+}
+
+
+double CACHED_CONTAINER::GetFragmentation() const
+{
+    if( m_freeSpace == 0 || m_freeChunks.empty() )
+        return 0.0;
+
+    return 1.0 - (double) getChunkSize( *m_freeChunks.rbegin() ) / m_freeSpace;
 }
 
 
@@ -208,16 +295,32 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 
     unsigned int itemSize = m_item->GetSize();
 
-    // Find a free space chunk >= aSize
-    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
+    // Find a free space chunk >= aSize, preferably of the next power of 2, so an item growing
+    // a few vertices at a time does not have to be moved again at each allocation
+    unsigned int sizeClass = 1;
+
+    while( sizeClass < aSize && sizeClass < ( 1u << 31 ) )
+        sizeClass <<= 1;
+
+    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( CHUNK( sizeClass, 0 ) );
+
+    if( newChunk == m_freeChunks.end() )
+        newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
 
     // Is there enough space to store vertices?
     if( newChunk == m_freeChunks.end() )
     {
         bool result;
 
+        // Moving the items is enough if a quarter of the container stays free after that,
+        // otherwise it would have to be done again for the next allocations
+        if( usedSpace() + aSize <= m_currentSize - m_currentSize / 4 )
+        {
+            // Yes: no growing
+            result = defragmentResize( m_currentSize );
+        }
         // Would it be enough to double the current space?
-        if( aSize < m_freeSpace + m_currentSize )
+        else if( aSize < m_freeSpace + m_currentSize )
         {
             // Yes: exponential growing
             result = defragmentResize( m_currentSize * 2 );
@@ -231,7 +334,9 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
         if( !result )
             return false;
 
-        newChunk = m_freeChunks.lower_bound( aSize );
+        m_movedBytes += usedSpace() * VERTEX_SIZE;
+
+        newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
         assert( newChunk != m_freeChunks.end() );
     }
 
@@ -242,20 +347,21 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     assert( newChunkSize >= aSize );
     assert( newChunkOffset < m_currentSize );
 
+    // Remove the new allocated chunk from the free space pool, before the previous chunk is
+    // added and possibly merged with it
+    removeFreeChunk( newChunkOffset, newChunkSize );
+
     // Check if the item was previously stored in the container
     if( itemSize > 0 )
     {
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[newChunkOffset], &m_vertices[m_chunkOffset], itemSize * VERTEX_SIZE );
+        m_movedBytes += itemSize * VERTEX_SIZE;
 
         // Free the space used by the previous chunk
         addFreeChunk( m_chunkOffset, m_chunkSize );
     }
 
-    // Remove the new allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
-    m_freeSpace -= newChunkSize;
-
     m_chunkSize = newChunkSize;
     m_chunkOffset = newChunkOffset;
 
@@ -271,8 +377,9 @@ void CACHED_CONTAINER::defragment( VERTEX* aTarget )
     ITEMS::iterator it, it_end;
     int newOffset = 0;
 
-    for( VERTEX_ITEM* item : m_items )
+    for( const std::pair<const unsigned int, VERTEX_ITEM*>& entry : m_items )
     {
+        VERTEX_ITEM* item = entry.second;
         int itemOffset    = item->GetOffset();
         int itemSize      = item->GetSize();
 
@@ -299,55 +406,26 @@ void CACHED_CONTAINER::defragment( VERTEX* aTarget )
 }
 
 
-void CACHED_CONTAINER::mergeFreeChunks()
+void CACHED_CONTAINER::resetChunks()
 {
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
-        return;
+    // The items kept their order, so they are stored again from the first one
+    ITEMS items;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
+    for( const std::pair<const unsigned int, VERTEX_ITEM*>& entry : m_items )
+        items.emplace_hint( items.end(), entry.second->GetOffset(), entry.second );
 
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
-
-    FREE_CHUNK_MAP::const_iterator it, it_end;
-
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
-    {
-        freeChunks.emplace_back( it->second, it->first );
-    }
+    m_items.swap( items );
 
+    // Now there is only one big chunk of free memory
     m_freeChunks.clear();
-    freeChunks.sort();
-
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int offset = freeChunks.front().first;
-    unsigned int size   = freeChunks.front().second;
-    freeChunks.pop_front();
+    m_freeChunkOffsets.clear();
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
+    if( m_freeSpace > 0 )
     {
-        if( itf->first == offset + size )
-        {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
-        }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
-            // and let's check the next chunk
-            offset = itf->first;
-            size   = itf->second;
-
-        }
+        m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+        m_freeChunkOffsets.insert( std::make_pair( m_currentSize - m_freeSpace, m_freeSpace ) );
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
-
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
@@ -359,11 +437,49 @@ void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
     assert( aOffset + aSize <= m_currentSize );
     assert( aSize > 0 );
 
-    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
+    unsigned int offset = aOffset;
+    unsigned int size   = aSize;
+
+    // Merge with the free chunk that follows
+    FREE_CHUNK_OFFSETS::iterator next = m_freeChunkOffsets.lower_bound( aOffset );
+
+    if( next != m_freeChunkOffsets.end() && next->first == aOffset + aSize )
+    {
+        size += next->second;
+        m_freeChunks.erase( std::make_pair( next->second, next->first ) );
+        next = m_freeChunkOffsets.erase( next );
+    }
+
+    // and with the one that precedes
+    if( next != m_freeChunkOffsets.begin() )
+    {
+        FREE_CHUNK_OFFSETS::iterator prev = std::prev( next );
+
+        if( prev->first + prev->second == aOffset )
+        {
+            offset = prev->first;
+            size += prev->second;
+            m_freeChunks.erase( std::make_pair( prev->second, prev->first ) );
+            m_freeChunkOffsets.erase( prev );
+        }
+    }
+
+    m_freeChunks.insert( std::make_pair( size, offset ) );
+    m_freeChunkOffsets.insert( std::make_pair( offset, size ) );
     m_freeSpace += aSize;
 }
 
 
+void CACHED_CONTAINER::removeFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    assert( m_freeChunks.count( std::make_pair( aSize, aOffset ) ) );
+
+    m_freeChunks.erase( std::make_pair( aSize, aOffset ) );
+    m_freeChunkOffsets.erase( aOffset );
+    m_freeSpace -= aSize;
+}
+
+
 void CACHED_CONTAINER::showFreeChunks()
 {
 }
@@ -390,7 +506,13 @@ void CACHED_CONTAINER::test()
     unsigned int used_space = 0;
     ITEMS::iterator itr;
     for( itr = m_items.begin(); itr != m_items.end(); ++itr )
-        used_space += ( *itr )->GetSize();
+    {
+        assert( itr->first == itr->second->GetOffset() );
+        used_space += itr->second->GetSize();
+    }
+
+    // Both maps store the same free chunks
+    assert( m_freeChunks.size() == m_freeChunkOffsets.size() );
 
     // If we have a chunk assigned, then there must be an item edited
     assert( m_chunkSize == 0 || m_item );
@@ -140,7 +140,7 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
     // Defragmentation
     for( it = m_items.begin(), it_end = m_items.end(); it != it_end; ++it )
     {
-        VERTEX_ITEM* item = *it;
+        VERTEX_ITEM* item = it->second;
         int itemOffset    = item->GetOffset();
         int itemSize      = item->GetSize();
 
@@ -192,8 +192,7 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
     m_currentSize = aNewSize;
 
     // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    resetChunks();
 
     return true;
 }
@@ -258,8 +257,7 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
     m_currentSize = aNewSize;
 
     // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    resetChunks();
 
     return true;
 }
@@ -47,9 +47,9 @@
 #include <wx/frame.h>
 
 #include <macros.h>
+#include <profile.h>
 
 #ifdef __WXDEBUG__
-#include <profile.h>
 #include <wx/log.h>
 #endif /* __WXDEBUG__ */
 
@@ -561,6 +561,8 @@ void OPENGL_GAL::endDrawing()
     PROF_COUNTER totalRealTime( "OPENGL_GAL::endDrawing()", true );
 #endif /* __WXDEBUG__ */
 
+    PROF_COUNTER timer;
+
     // Cached & non-cached containers are rendered to the same buffer
     compositor->SetBuffer( mainBuffer );
     nonCachedManager->EndDrawing();
@@ -571,6 +573,9 @@ void OPENGL_GAL::endDrawing()
         compositor->SetBuffer( overlayBuffer );
     overlayManager->EndDrawing();
 
+    if( frameStats )
+        frameStats->m_flushTime += timer.msecs( true );
+
     // Be sure that the framebuffer is not colorized (happens on specific GPU&drivers combinations)
     glColor4d( 1.0, 1.0, 1.0, 1.0 );
 
@@ -583,8 +588,14 @@ void OPENGL_GAL::endDrawing()
     compositor->Present();
     blitCursor();
 
+    if( frameStats )
+        frameStats->m_compositeTime += timer.msecs( true );
+
     SwapBuffers();
 
+    if( frameStats )
+        frameStats->m_presentTime += timer.msecs( true );
+
 #ifdef __WXDEBUG__
     totalRealTime.Stop();
     wxLogTrace( "GAL_PROFILE", wxT( "OPENGL_GAL::endDrawing(): %.1f ms" ), totalRealTime.msecs() );
@@ -629,6 +640,10 @@ void OPENGL_GAL::beginUpdate()
         init();
 
     cachedManager->Map();
+
+    // The bytes moved are counted from here to the end of the update
+    if( frameStats )
+        frameStats->m_cacheMovedBytes -= cachedManager->GetMovedBytes();
 }
 
 
@@ -637,7 +652,21 @@ void OPENGL_GAL::endUpdate()
     if( !isInitialized )
         return;
 
+    // Gather some of the free space left by the changed items, a bit at each update
+    cachedManager->Compact( ADVANCED_CFG::GetCfg().m_CacheCompactVertices );
+
+    if( frameStats )
+    {
+        frameStats->m_cacheMovedBytes += cachedManager->GetMovedBytes();
+        frameStats->m_cacheFragmentation = cachedManager->GetFragmentation();
+    }
+
+    PROF_COUNTER timer;
+
     cachedManager->Unmap();
+
+    if( frameStats )
+        frameStats->m_uploadTime += timer.msecs();
 }
 
 
@@ -1571,13 +1600,50 @@ void OPENGL_GAL::EndGroup()
 {
     cachedManager->FinishItem();
     isGrouping = false;
+    isCoarseGeometry = false;
 }
 
 
 void OPENGL_GAL::DrawGroup( int aGroupNumber )
 {
     if( groups[aGroupNumber] )
+    {
         cachedManager->DrawItem( *groups[aGroupNumber] );
+
+        if( frameStats )
+            frameStats->m_vertexCount += groups[aGroupNumber]->GetSize();
+    }
+}
+
+
+bool OPENGL_GAL::BeginCoarseGroup( int aGroupNumber )
+{
+    if( groups.find( aGroupNumber ) == groups.end() )
+        return false;
+
+    isGrouping = true;
+    isCoarseGeometry = true;
+
+    // Replaces the previous coarse variant, if any
+    coarseGroups[aGroupNumber] = std::make_shared<VERTEX_ITEM>( *cachedManager );
+
+    return true;
+}
+
+
+bool OPENGL_GAL::DrawCoarseGroup( int aGroupNumber )
+{
+    auto it = coarseGroups.find( aGroupNumber );
+
+    if( it == coarseGroups.end() )
+        return false;
+
+    cachedManager->DrawItem( *it->second );
+
+    if( frameStats )
+        frameStats->m_vertexCount += it->second->GetSize();
+
+    return true;
 }
 
 
@@ -1585,6 +1651,11 @@ void OPENGL_GAL::ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor )
 {
     if( groups[aGroupNumber] )
         cachedManager->ChangeItemColor( *groups[aGroupNumber], aNewColor );
+
+    auto it = coarseGroups.find( aGroupNumber );
+
+    if( it != coarseGroups.end() )
+        cachedManager->ChangeItemColor( *it->second, aNewColor );
 }
 
 
@@ -1592,6 +1663,11 @@ void OPENGL_GAL::ChangeGroupDepth( int aGroupNumber, int aDepth )
 {
     if( groups[aGroupNumber] )
         cachedManager->ChangeItemDepth( *groups[aGroupNumber], aDepth );
+
+    auto it = coarseGroups.find( aGroupNumber );
+
+    if( it != coarseGroups.end() )
+        cachedManager->ChangeItemDepth( *it->second, aDepth );
 }
 
 
@@ -1599,6 +1675,7 @@ void OPENGL_GAL::DeleteGroup( int aGroupNumber )
 {
     // Frees memory in the container as well
     groups.erase( aGroupNumber );
+    coarseGroups.erase( aGroupNumber );
 }
 
 
@@ -1606,6 +1683,7 @@ void OPENGL_GAL::ClearCache()
 {
     bitmapCache = std::make_unique<GL_BITMAP_CACHE>( );
 
+    coarseGroups.clear();
     groups.clear();
 
     if( isInitialized )
@@ -230,6 +230,31 @@ void VERTEX_MANAGER::Clear() const
 }
 
 
+void VERTEX_MANAGER::Compact( unsigned int aMaxSize ) const
+{
+    if( m_container->IsCached() && aMaxSize > 0 )
+        static_cast<CACHED_CONTAINER*>( m_container.get() )->Compact( aMaxSize );
+}
+
+
+size_t VERTEX_MANAGER::GetMovedBytes() const
+{
+    if( !m_container->IsCached() )
+        return 0;
+
+    return static_cast<CACHED_CONTAINER*>( m_container.get() )->GetMovedBytes();
+}
+
+
+double VERTEX_MANAGER::GetFragmentation() const
+{
+    if( !m_container->IsCached() )
+        return 0.0;
+
+    return static_cast<CACHED_CONTAINER*>( m_container.get() )->GetFragmentation();
+}
+
+
 void VERTEX_MANAGER::BeginDrawing() const
 {
     m_gpu->BeginDrawing();
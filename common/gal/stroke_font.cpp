@@ -311,6 +311,22 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         break;
     }
 
+    // A text only a few pixels high is drawn as a bar covering its glyphs
+    if( m_gal->IsCoarseGeometry() )
+    {
+        float  lineWidth = m_gal->GetLineWidth();
+        double barWidth = std::abs( baseGlyphSize.y ) * 0.6;
+        double length = std::max( textSize.x - lineWidth - barWidth, 0.0 );
+        double start = ( textSize.x - lineWidth - length ) / 2.0;
+
+        m_gal->SetLineWidth( barWidth );
+        m_gal->DrawLine( VECTOR2D( start, -baseGlyphSize.y / 2.0 ),
+                         VECTOR2D( start + length, -baseGlyphSize.y / 2.0 ) );
+        m_gal->SetLineWidth( lineWidth );
+        m_gal->Restore();
+        return;
+    }
+
     if( m_gal->IsTextMirrored() )
     {
         // In case of mirrored text invert the X scale of points and their X direction
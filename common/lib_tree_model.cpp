@@ -22,7 +22,9 @@
 #include <lib_tree_model.h>
 
 #include <algorithm>
+#include <iterator>
 #include <eda_pattern_match.h>
+#include <wx/tokenzr.h>
 #include <lib_tree_item.h>
 #include <utility>
 #include <pgm_base.h>
@@ -50,6 +52,51 @@ static int matchPosScore(int aPosition, int aMaximum)
 }
 
 
+// Lowercases the name and search text of a node for matching, if not done yet.
+static void normalize( LIB_TREE_NODE& aNode )
+{
+    if( !aNode.m_Normalized )
+    {
+        aNode.m_MatchName = aNode.m_MatchName.Lower();
+        aNode.m_SearchText = aNode.m_SearchText.Lower();
+        aNode.m_Normalized = true;
+    }
+}
+
+
+// Appends the trigrams of a string, each one packing three characters of 21 bits.
+static void addTrigrams( const wxString& aText, std::vector<unsigned long long>& aTrigrams )
+{
+    const unsigned long long mask = ( 1ULL << 63 ) - 1;
+    unsigned long long       trigram = 0;
+    size_t                   count = 0;
+
+    for( wxString::const_iterator it = aText.begin(); it != aText.end(); ++it )
+    {
+        trigram = ( ( trigram << 21 ) | ( (wxUniChar) *it ).GetValue() ) & mask;
+
+        if( ++count >= 3 )
+            aTrigrams.push_back( trigram );
+    }
+}
+
+
+// Whether no matcher of EDA_COMBINED_MATCHER can find a term but as a plain substring.  The
+// characters below are the regular expression, wildcard and relational operators.
+static bool isPlainTerm( const wxString& aTerm )
+{
+    static const wxString operators = wxT( ".*+?^${}()|[]\\<=>" );
+
+    for( wxString::const_iterator it = aTerm.begin(); it != aTerm.end(); ++it )
+    {
+        if( operators.Find( *it ) != wxNOT_FOUND )
+            return false;
+    }
+
+    return true;
+}
+
+
 void LIB_TREE_NODE::ResetScore()
 {
     for( auto& child: m_Children )
@@ -211,12 +258,7 @@ void LIB_TREE_NODE_LIB_ID::UpdateScore( EDA_COMBINED_MATCHER& aMatcher )
     if( m_Score <= 0 )
         return; // Leaf nodes without scores are out of the game.
 
-    if( !m_Normalized )
-    {
-        m_MatchName = m_MatchName.Lower();
-        m_SearchText = m_SearchText.Lower();
-        m_Normalized = true;
-    }
+    normalize( *this );
 
     // Keywords and description we only count if the match string is at
     // least two characters long. That avoids spurious, low quality
@@ -337,3 +379,217 @@ void LIB_TREE_NODE_ROOT::UpdateScore( EDA_COMBINED_MATCHER& aMatcher )
         child->UpdateScore( aMatcher );
 }
 
+
+
+void LIB_TREE_NODE_ROOT::updateSearchIndex()
+{
+    std::vector<LIB_TREE_NODE*> items;
+    bool                        upToDate = true;
+
+    // SortNodes() reorders the tree between searches, so the items are looked up by address.
+    // New and updated nodes are not normalized yet, even if they reuse the address of a
+    // deleted node.
+    for( std::unique_ptr<LIB_TREE_NODE>& lib : m_Children )
+    {
+        for( std::unique_ptr<LIB_TREE_NODE>& item : lib->m_Children )
+        {
+            items.push_back( item.get() );
+            upToDate = upToDate && item->m_Normalized && m_searchIndex.count( item.get() );
+        }
+    }
+
+    if( upToDate && items.size() == m_searchItems.size() )
+        return;
+
+    m_searchItems.swap( items );
+    m_searchIndex.clear();
+    m_trigrams.clear();
+    m_lastSearch.clear();
+    m_lastMatches.clear();
+
+    std::vector<unsigned long long> trigrams;
+
+    for( unsigned ii = 0; ii < m_searchItems.size(); ++ii )
+    {
+        LIB_TREE_NODE* item = m_searchItems[ii];
+
+        m_searchIndex[item] = ii;
+        normalize( *item );
+
+        trigrams.clear();
+        addTrigrams( item->m_MatchName, trigrams );
+        addTrigrams( item->m_SearchText, trigrams );
+
+        for( unsigned long long trigram : trigrams )
+        {
+            std::vector<unsigned>& postings = m_trigrams[trigram];
+
+            // Items are indexed in order, so the postings stay sorted
+            if( postings.empty() || postings.back() != ii )
+                postings.push_back( ii );
+        }
+    }
+}
+
+
+std::vector<unsigned> LIB_TREE_NODE_ROOT::findCandidates( wxString const& aTerm ) const
+{
+    std::vector<unsigned long long> trigrams;
+    std::vector<unsigned>           candidates;
+
+    addTrigrams( aTerm, trigrams );
+
+    // The items containing all the trigrams of the term, starting from the rarest one
+    std::vector<const std::vector<unsigned>*> postings;
+
+    for( unsigned long long trigram : trigrams )
+    {
+        auto it = m_trigrams.find( trigram );
+
+        if( it == m_trigrams.end() )
+        {
+            postings.clear();
+            break;
+        }
+
+        postings.push_back( &it->second );
+    }
+
+    if( !postings.empty() )
+    {
+        std::sort( postings.begin(), postings.end(),
+                   []( const std::vector<unsigned>* a, const std::vector<unsigned>* b )
+                   {
+                       return a->size() < b->size();
+                   } );
+
+        candidates = *postings[0];
+
+        for( size_t ii = 1; ii < postings.size() && !candidates.empty(); ++ii )
+        {
+            std::vector<unsigned> both;
+
+            std::set_intersection( candidates.begin(), candidates.end(), postings[ii]->begin(),
+                                   postings[ii]->end(), std::back_inserter( both ) );
+            candidates.swap( both );
+        }
+    }
+
+    // All the items of a library match its name
+    std::vector<unsigned> libItems;
+
+    for( const std::unique_ptr<LIB_TREE_NODE>& lib : m_Children )
+    {
+        if( lib->m_MatchName.Find( aTerm ) != wxNOT_FOUND )
+        {
+            for( const std::unique_ptr<LIB_TREE_NODE>& item : lib->m_Children )
+                libItems.push_back( m_searchIndex.at( item.get() ) );
+        }
+    }
+
+    if( !libItems.empty() )
+    {
+        std::sort( libItems.begin(), libItems.end() );
+
+        std::vector<unsigned> either;
+
+        std::set_union( candidates.begin(), candidates.end(), libItems.begin(), libItems.end(),
+                        std::back_inserter( either ) );
+        candidates.swap( either );
+    }
+
+    return candidates;
+}
+
+
+void LIB_TREE_NODE_ROOT::UpdateSearchScore( wxString const& aSearch )
+{
+    updateSearchIndex();
+
+    wxString              search = aSearch.Lower();
+    std::vector<wxString> terms;
+    bool                  plain = true;
+    wxStringTokenizer     tokenizer( search );
+
+    while( tokenizer.HasMoreTokens() )
+    {
+        terms.push_back( tokenizer.GetNextToken() );
+        plain = plain && isPlainTerm( terms.back() );
+    }
+
+    if( terms.empty() )
+    {
+        m_lastSearch.clear();
+        m_lastMatches.clear();
+        return;
+    }
+
+    std::vector<unsigned> candidates;
+    bool                  narrowed = false;
+
+    if( plain && !m_lastSearch.IsEmpty() && search.StartsWith( m_lastSearch ) )
+    {
+        // Each term contains one of the last search string, so it matches only items which
+        // the last search string matched too
+        candidates = m_lastMatches;
+        narrowed = true;
+    }
+
+    for( const wxString& term : terms )
+    {
+        // Shorter terms have no trigram, the matchers will have to look at every item
+        if( term.length() < 3 || !isPlainTerm( term ) )
+            continue;
+
+        std::vector<unsigned> termCandidates = findCandidates( term );
+
+        if( narrowed )
+        {
+            std::vector<unsigned> both;
+
+            std::set_intersection( candidates.begin(), candidates.end(), termCandidates.begin(),
+                                   termCandidates.end(), std::back_inserter( both ) );
+            candidates.swap( both );
+        }
+        else
+        {
+            candidates.swap( termCandidates );
+            narrowed = true;
+        }
+    }
+
+    if( narrowed )
+    {
+        std::vector<bool> keep( m_searchItems.size(), false );
+
+        for( unsigned ii : candidates )
+            keep[ii] = true;
+
+        for( unsigned ii = 0; ii < m_searchItems.size(); ++ii )
+        {
+            if( !keep[ii] )
+                m_searchItems[ii]->m_Score = 0;
+        }
+    }
+
+    for( const wxString& term : terms )
+    {
+        EDA_COMBINED_MATCHER matcher( term );
+
+        UpdateScore( matcher );
+    }
+
+    m_lastSearch.clear();
+    m_lastMatches.clear();
+
+    if( plain )
+    {
+        m_lastSearch = search;
+
+        for( unsigned ii = 0; ii < m_searchItems.size(); ++ii )
+        {
+            if( m_searchItems[ii]->m_Score > 0 )
+                m_lastMatches.push_back( ii );
+        }
+    }
+}
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <wx/string.h>
 #include <lib_tree_item.h>
 
@@ -51,6 +52,7 @@ class EDA_COMBINED_MATCHER;
  * Quick summary of methods used to drive this class:
  *
  * - `UpdateScore()` - accumulate scores recursively given a new search token
+ * - `UpdateSearchScore()` - accumulate the scores of a whole search string on the root
  * - `ResetScore()` - reset scores recursively for a new search string
  * - `AssignIntrinsicRanks()` - calculate and cache the initial sort order
  * - `SortNodes()` - recursively sort the tree by score
@@ -282,6 +284,46 @@ public:
     LIB_TREE_NODE_LIB& AddLib( wxString const& aName, wxString const& aDesc );
 
     virtual void UpdateScore( EDA_COMBINED_MATCHER& aMatcher ) override;
+
+    /**
+     * Update the scores for a search string, calling UpdateScore() for each of its terms.
+     * ResetScore() must be called first.
+     *
+     * The items which cannot match are found first with a trigram index of their names and
+     * search texts, and their score is zeroed so that the matchers do not run on them.  The
+     * index is built by the first search after the tree changed.  When the search string
+     * extends the previous one, only the items the previous one matched are looked at.
+     *
+     * Terms with regular expression, wildcard or relational operators cannot be looked up in
+     * the index, they are matched against all the items left by the other terms.
+     *
+     * @param aSearch   the search string, whitespace separated terms
+     */
+    void UpdateSearchScore( wxString const& aSearch );
+
+private:
+    /**
+     * Index the items of the tree, unless the index is up to date.  Any item added, deleted
+     * or updated since the last search makes the index out of date.
+     */
+    void updateSearchIndex();
+
+    /**
+     * Return the indexes of the items which may contain the plain term \a aTerm, in their
+     * name, search text or library name.
+     */
+    std::vector<unsigned> findCandidates( wxString const& aTerm ) const;
+
+    std::vector<LIB_TREE_NODE*>  m_searchItems;   ///< indexed items, in the order indexed
+
+    ///> Index in m_searchItems of each indexed item
+    std::unordered_map<LIB_TREE_NODE*, unsigned> m_searchIndex;
+
+    ///> Sorted indexes in m_searchItems of the items containing each trigram
+    std::unordered_map<unsigned long long, std::vector<unsigned>> m_trigrams;
+
+    wxString              m_lastSearch;           ///< last search string, if it can be narrowed
+    std::vector<unsigned> m_lastMatches;          ///< indexes of the items it matched
 };
 
 
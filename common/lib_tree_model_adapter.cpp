@@ -211,16 +211,7 @@ void LIB_TREE_MODEL_ADAPTER::UpdateSearchString( wxString const& aSearch )
                 child->m_Score *= 2;
         }
 
-        wxStringTokenizer tokenizer( aSearch );
-
-        while( tokenizer.HasMoreTokens() )
-        {
-            const wxString term = tokenizer.GetNextToken().Lower();
-            EDA_COMBINED_MATCHER matcher( term );
-
-            m_tree.UpdateScore( matcher );
-        }
-
+        m_tree.UpdateSearchScore( aSearch );
         m_tree.SortNodes();
         AfterReset();
         Thaw();
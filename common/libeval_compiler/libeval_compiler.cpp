@@ -172,6 +172,62 @@ UCODE::~UCODE()
 }
 
 
+void UCODE::FoldConstants()
+{
+    std::vector<UOP*> folded;
+
+    for( UOP* op : m_ucode )
+    {
+        int arity = op->GetArity();
+
+        // The operands of an operator are the ops immediately before it when they're literals
+        bool constOperands = arity > 0 && (int) folded.size() >= arity
+                             && std::all_of( folded.end() - arity, folded.end(),
+                                             []( const UOP* aOp )
+                                             {
+                                                 return aOp->IsConstant();
+                                             } );
+
+        if( !constOperands )
+        {
+            folded.push_back( op );
+            continue;
+        }
+
+        // Run the same code as at evaluation time so that the result can't differ
+        CONTEXT ctx;
+
+        for( auto it = folded.end() - arity; it != folded.end(); ++it )
+            ( *it )->Exec( &ctx );
+
+        op->Exec( &ctx );
+
+        VALUE* value = ctx.Pop();
+
+        // An error is reported again at evaluation time, when it can be shown to the user
+        if( ctx.IsErrorPending() || ctx.SP() != 0 )
+        {
+            folded.push_back( op );
+            continue;
+        }
+
+        std::unique_ptr<VALUE> result = std::make_unique<VALUE>();
+        result->Set( *value );
+
+        for( int ii = 0; ii < arity; ++ii )
+        {
+            delete folded.back();
+            folded.pop_back();
+        }
+
+        delete op;
+        folded.push_back( new UOP( TR_UOP_PUSH_VALUE, std::move( result ) ) );
+    }
+
+    m_ucode = std::move( folded );
+}
+
+
 wxString UCODE::Dump() const
 {
     wxString rv;
@@ -1052,6 +1108,8 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
         stack.pop_back();
     }
 
+    aCode->FoldConstants();
+
     libeval_dbg(2,"dump: \n%s\n", aCode->Dump().c_str() );
 
     return true;
@@ -1166,6 +1224,9 @@ VALUE* UCODE::Run( CONTEXT* ctx )
 {
     static VALUE g_false( 0 );
 
+    ctx->ResetValues();
+    ctx->ClearError();
+
     try
     {
         for( UOP* op : m_ucode )
@@ -23,7 +23,9 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
@@ -32,6 +34,16 @@
 #include <wx/file.h>
 #include <wx/translation.h>
 
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN 1
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -229,6 +241,164 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+                                                  unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ),
+    m_data( nullptr ),
+    m_size( 0 ),
+    m_ndx( 0 ),
+    m_mapping( nullptr ),
+    m_ownsData( true )
+{
+    m_source = aFileName;
+
+    wxString msg = wxString::Format( _( "Unable to open filename \"%s\" for reading" ),
+                                     aFileName.GetData() );
+
+#if defined( _WIN32 )
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if( file == INVALID_HANDLE_VALUE )
+        THROW_IO_ERROR( msg );
+
+    LARGE_INTEGER size;
+
+    if( !GetFileSizeEx( file, &size ) )
+    {
+        CloseHandle( file );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_size = (size_t) size.QuadPart;
+
+    // Empty files cannot be mapped, and need not be
+    if( m_size )
+    {
+        HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+        if( mapping )
+            m_data = (const char*) MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+        if( !m_data )
+        {
+            if( mapping )
+                CloseHandle( mapping );
+
+            CloseHandle( file );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_mapping = mapping;
+    }
+
+    // The mapping keeps the file open
+    CloseHandle( file );
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        THROW_IO_ERROR( msg );
+
+    struct stat st;
+
+    if( fstat( fd, &st ) != 0 )
+    {
+        close( fd );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_size = (size_t) st.st_size;
+
+    // Empty files cannot be mapped, and need not be
+    if( m_size )
+    {
+        void* data = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+        if( data == MAP_FAILED )
+        {
+            close( fd );
+            THROW_IO_ERROR( msg );
+        }
+
+        // The file is read front to back
+        madvise( data, m_size, MADV_SEQUENTIAL );
+
+        m_data = (const char*) data;
+    }
+
+    // The mapping keeps the file open
+    close( fd );
+#endif
+}
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const MAPPED_FILE_LINE_READER& aFile,
+                                                  const char* aStart, const char* aEnd,
+                                                  unsigned aLineNumber ) :
+    LINE_READER( aFile.m_maxLineLength ),
+    m_data( aStart ),
+    m_size( aEnd - aStart ),
+    m_ndx( 0 ),
+    m_mapping( nullptr ),
+    m_ownsData( false )
+{
+    m_source  = aFile.m_source;
+    m_lineNum = aLineNumber - 1;
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+    if( !m_data || !m_ownsData )
+        return;
+
+#if defined( _WIN32 )
+    UnmapViewOfFile( m_data );
+    CloseHandle( (HANDLE) m_mapping );
+#else
+    munmap( (void*) m_data, m_size );
+#endif
+}
+
+
+const char* MAPPED_FILE_LINE_READER::NextLineInPlace( unsigned& aLength )
+{
+    const char* line = m_data + m_ndx;
+    size_t      left = m_size - m_ndx;
+    const char* nl = left ? (const char*) memchr( line, '\n', left ) : nullptr;
+    size_t      length = nl ? nl - line + 1 : left;     // include the newline, so +1
+
+    if( length > m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_ndx += length;
+    aLength = length;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return length ? line : NULL;
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine()
+{
+    const char* line = NextLineInPlace( m_length );
+
+    if( m_length + 1 > m_capacity )     // +1 for terminating nul
+        expandCapacity( m_length + 1 );
+
+    if( line )
+        memcpy( m_line, line, m_length );
+
+    m_line[m_length] = 0;
+
+    return m_length ? m_line : NULL;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -393,18 +563,6 @@ int OUTPUTFORMATTER::vprint( const char* fmt,  va_list ap )
 }
 
 
-int OUTPUTFORMATTER::sprint( const char* fmt, ... )
-{
-    va_list     args;
-
-    va_start( args, fmt );
-    int ret = vprint( fmt, args);
-    va_end( args );
-
-    return ret;
-}
-
-
 int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 {
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
@@ -413,19 +571,33 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 
     va_start( args, fmt );
 
+    static const char spaces[] = "                                ";
+
     int result = 0;
     int total  = 0;
 
-    for( int i=0; i<nestLevel;  ++i )
+    // no error checking needed, an exception indicates an error.
+    for( int indent = nestLevel * NESTWIDTH; indent > 0; indent -= result )
     {
-        // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        result = std::min<int>( indent, sizeof( spaces ) - 1 );
+        write( spaces, result );
 
         total += result;
     }
 
-    // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    // Most of the Print() calls of the file formats close lists or end lines, and need
+    // no formatting at all
+    if( !strchr( fmt, '%' ) )
+    {
+        result = strlen( fmt );
+
+        if( result > 0 )
+            write( fmt, result );
+    }
+    else
+    {
+        result = vprint( fmt, args );
+    }
 
     va_end( args );
 
@@ -517,6 +689,11 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName, const wxC
 
     if( !m_fp )
         THROW_IO_ERROR( strerror( errno ) );
+
+    // Boards with filled zones are written in many small pieces; a large buffer saves
+    // most of the trips to the system
+    m_writeBuffer.resize( FILEFMTBUFZ );
+    setvbuf( m_fp, m_writeBuffer.data(), _IOFBF, m_writeBuffer.size() );
 }
 
 
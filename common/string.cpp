@@ -26,6 +26,11 @@
  * @brief Some useful functions to handle strings.
  */
 
+#include <climits>
+#include <cstdint>
+#include <locale>
+#include <sstream>
+
 #include <macros.h>
 #include <richio.h>                        // StrPrintf
 #include <kicad_string.h>
@@ -380,6 +385,196 @@ char* StrPurge( char* text )
 }
 
 
+/**
+ * The digits of a decimal number, as an integer and a power of ten.
+ */
+struct PARSED_DECIMAL
+{
+    bool     negative = false;
+    uint64_t mantissa = 0;         ///< the first 19 significant digits
+    int      exponent = 0;
+    bool     inexact = false;      ///< true if non-zero digits were dropped from the mantissa
+};
+
+
+static const char* parseDecimal( const char* aText, PARSED_DECIMAL& aDecimal )
+{
+    const char* cp = aText;
+    bool        sawDigit = false;
+    int         digits = 0;
+
+    while( *cp == ' ' || ( *cp >= '\t' && *cp <= '\r' ) )
+        ++cp;
+
+    if( *cp == '-' || *cp == '+' )
+        aDecimal.negative = *cp++ == '-';
+
+    for( ; *cp >= '0' && *cp <= '9'; ++cp )
+    {
+        sawDigit = true;
+
+        if( digits < 19 )
+        {
+            aDecimal.mantissa = aDecimal.mantissa * 10 + ( *cp - '0' );
+            digits += aDecimal.mantissa != 0;
+        }
+        else
+        {
+            aDecimal.exponent++;
+            aDecimal.inexact |= *cp != '0';
+        }
+    }
+
+    if( *cp == '.' )
+    {
+        for( ++cp; *cp >= '0' && *cp <= '9'; ++cp )
+        {
+            sawDigit = true;
+
+            if( digits < 19 )
+            {
+                aDecimal.mantissa = aDecimal.mantissa * 10 + ( *cp - '0' );
+                aDecimal.exponent--;
+                digits += aDecimal.mantissa != 0;
+            }
+            else
+            {
+                aDecimal.inexact |= *cp != '0';
+            }
+        }
+    }
+
+    if( !sawDigit )
+        return aText;
+
+    if( *cp == 'e' || *cp == 'E' )
+    {
+        const char* ep = cp + 1;
+        bool        negative = false;
+        int         exponent = 0;
+
+        if( *ep == '-' || *ep == '+' )
+            negative = *ep++ == '-';
+
+        // Without digits the 'e' is not part of the number
+        if( *ep >= '0' && *ep <= '9' )
+        {
+            for( ; *ep >= '0' && *ep <= '9'; ++ep )
+            {
+                if( exponent < 100000 )
+                    exponent = exponent * 10 + ( *ep - '0' );
+            }
+
+            aDecimal.exponent += negative ? -exponent : exponent;
+            cp = ep;
+        }
+    }
+
+    return cp;
+}
+
+
+const char* DecimalToDouble( const char* aText, double& aValue )
+{
+    static const double powersOf10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    PARSED_DECIMAL decimal;
+    const char*    end = parseDecimal( aText, decimal );
+
+    if( end == aText )
+    {
+        aValue = 0.0;
+        return aText;
+    }
+
+    // Both the mantissa and the power of ten are exact doubles, so one multiplication or
+    // division gives the correctly rounded value, which is what strtod() gives too.
+    if( !decimal.inexact && decimal.mantissa <= ( UINT64_C( 1 ) << 53 )
+            && decimal.exponent >= -22 && decimal.exponent <= 22 )
+    {
+        double value = (double) decimal.mantissa;
+
+        if( decimal.exponent < 0 )
+            value /= powersOf10[-decimal.exponent];
+        else
+            value *= powersOf10[decimal.exponent];
+
+        aValue = decimal.negative ? -value : value;
+        return end;
+    }
+
+    if( decimal.mantissa == 0 )
+    {
+        aValue = decimal.negative ? -0.0 : 0.0;
+        return end;
+    }
+
+    // Numbers with more digits or a large exponent are rare enough to go the slow way
+    std::istringstream stream( std::string( aText, end ) );
+
+    stream.imbue( std::locale::classic() );
+    stream >> aValue;
+
+    return stream.fail() ? nullptr : end;
+}
+
+
+const char* DecimalToScaledInt( const char* aText, int aScale, long long& aValue )
+{
+    PARSED_DECIMAL decimal;
+    const char*    end = parseDecimal( aText, decimal );
+    int            exponent = decimal.exponent + aScale;
+    uint64_t       magnitude = decimal.mantissa;
+
+    if( end == aText )
+    {
+        aValue = 0;
+        return aText;
+    }
+
+    if( exponent >= 0 )
+    {
+        for( ; exponent > 0 && magnitude; --exponent )
+        {
+            if( magnitude > (uint64_t) LLONG_MAX / 10 )
+            {
+                magnitude = (uint64_t) LLONG_MAX + 1;
+                break;
+            }
+
+            magnitude *= 10;
+        }
+    }
+    else if( exponent >= -19 )
+    {
+        uint64_t divisor = 1;
+
+        for( ; exponent < 0; ++exponent )
+            divisor *= 10;
+
+        uint64_t remainder = magnitude % divisor;
+
+        magnitude /= divisor;
+
+        // Compare the remainder to half of the divisor without overflowing
+        if( remainder >= divisor - remainder )
+            magnitude++;
+    }
+    else
+    {
+        magnitude = 0;      // less than 10^19 / 10^20
+    }
+
+    if( decimal.negative )
+        aValue = magnitude > (uint64_t) LLONG_MAX ? LLONG_MIN : -(long long) magnitude;
+    else
+        aValue = magnitude > (uint64_t) LLONG_MAX ? LLONG_MAX : (long long) magnitude;
+
+    return end;
+}
+
+
 char* GetLine( FILE* File, char* Line, int* LineNum, int SizeLine )
 {
     do {
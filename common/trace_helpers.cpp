@@ -49,6 +49,7 @@ const wxChar* const traceSymbolResolver = wxT( "KICAD_SYM_RESOLVE" );
 const wxChar* const traceDisplayLocation = wxT( "KICAD_DISPLAY_LOCATION" );
 const wxChar* const traceSchSheetPaths = wxT( "KICAD_SCH_SHEET_PATHS" );
 const wxChar* const traceEnvVars = wxT( "KICAD_ENV_VARS" );
+const wxChar* const traceGalFrameStats = wxT( "KICAD_GAL_FRAME_STATS" );
 
 
 wxString dump( const wxArrayString& aArray )
@@ -24,6 +24,10 @@
  */
 
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 #include <eda_item.h>
 #include <layers_id_colors_and_visibility.h>
 
@@ -33,13 +37,12 @@
 #include <view/view_rtree.h>
 #include <view/view_overlay.h>
 
+#include <advanced_config.h>
 #include <gal/definitions.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <painter.h>
 
-#ifdef __WXDEBUG__
 #include <profile.h>
-#endif /* __WXDEBUG__  */
 
 namespace KIGFX {
 
@@ -53,6 +56,7 @@ public:
         m_flags( KIGFX::VISIBLE ),
         m_requiredUpdate( KIGFX::NONE ),
         m_drawPriority( 0 ),
+        m_cachedSize( 0.0 ),
         m_groups( nullptr ),
         m_groupsSize( 0 ) {}
 
@@ -90,6 +94,7 @@ private:
     int     m_flags;            ///< Visibility flags
     int     m_requiredUpdate;   ///< Flag required for updating
     int     m_drawPriority;     ///< Order to draw this item in a layer, lowest first
+    double  m_cachedSize;       ///< Larger side of the bounding box, when it was last cached
 
     ///> Helper for storing cached items group ids
     typedef std::pair<int, int> GroupPair;
@@ -275,7 +280,9 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_dynamic( aIsDynamic ),
     m_useDrawPriority( false ),
     m_nextDrawPriority( 0 ),
-    m_reverseDrawOrder( false )
+    m_reverseDrawOrder( false ),
+    m_prepareThreadCount( 0 ),
+    m_coarseItemPixels( ADVANCED_CFG::GetCfg().m_CoarseItemPixels )
 {
     // Set m_boundary to define the max area size. The default area size
     // is defined here as the max value of a int.
@@ -936,10 +943,12 @@ void VIEW::UpdateAllLayersOrder()
 
 struct VIEW::drawItem
 {
-    drawItem( VIEW* aView, int aLayer, bool aUseDrawPriority, bool aReverseDrawOrder ) :
+    drawItem( VIEW* aView, int aLayer, bool aUseDrawPriority, bool aReverseDrawOrder,
+              bool aDeferDraw = false ) :
         view( aView ), layer( aLayer ),
         useDrawPriority( aUseDrawPriority ),
-        reverseDrawOrder( aReverseDrawOrder )
+        reverseDrawOrder( aReverseDrawOrder ),
+        deferDraw( aUseDrawPriority || aDeferDraw )
     {
     }
 
@@ -953,7 +962,7 @@ struct VIEW::drawItem
         if( !drawCondition )
             return true;
 
-        if( useDrawPriority )
+        if( deferDraw )
             drawItems.push_back( aItem );
         else
             view->draw( aItem, layer );
@@ -963,12 +972,13 @@ struct VIEW::drawItem
 
     void deferredDraw()
     {
-        if( reverseDrawOrder )
+        // Without draw priorities, the items were only deferred to time the query apart
+        if( useDrawPriority && reverseDrawOrder )
             std::sort( drawItems.begin(), drawItems.end(),
                        []( VIEW_ITEM* a, VIEW_ITEM* b ) -> bool {
                            return b->viewPrivData()->m_drawPriority < a->viewPrivData()->m_drawPriority;
                        });
-        else
+        else if( useDrawPriority )
             std::sort( drawItems.begin(), drawItems.end(),
                        []( VIEW_ITEM* a, VIEW_ITEM* b ) -> bool {
                            return a->viewPrivData()->m_drawPriority < b->viewPrivData()->m_drawPriority;
@@ -980,25 +990,40 @@ struct VIEW::drawItem
 
     VIEW* view;
     int layer, layers[VIEW_MAX_LAYERS];
-    bool useDrawPriority, reverseDrawOrder;
+    bool useDrawPriority, reverseDrawOrder, deferDraw;
     std::vector<VIEW_ITEM*> drawItems;
 };
 
 
 void VIEW::redrawRect( const BOX2I& aRect )
 {
+    FRAME_STATS* stats = m_gal->GetFrameStats();
+
     for( VIEW_LAYER* l : m_orderedLayers )
     {
         if( l->visible && IsTargetDirty( l->target ) && areRequiredLayersEnabled( l->id ) )
         {
-            drawItem drawFunc( this, l->id, m_useDrawPriority, m_reverseDrawOrder );
+            // When timed, all the items are looked up before drawing any of them
+            drawItem drawFunc( this, l->id, m_useDrawPriority, m_reverseDrawOrder,
+                               stats != nullptr );
 
             m_gal->SetTarget( l->target );
             m_gal->SetLayerDepth( l->renderingOrder );
+
+            PROF_COUNTER timer;
+
             l->items->Query( aRect, drawFunc );
 
-            if( m_useDrawPriority )
+            double queryTime = timer.msecs( true );
+
+            if( drawFunc.deferDraw )
                 drawFunc.deferredDraw();
+
+            if( stats )
+            {
+                stats->m_layers.push_back( { l->id, queryTime, timer.msecs( true ),
+                                             drawFunc.drawItems.size() } );
+            }
         }
     }
 }
@@ -1014,12 +1039,26 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
     if( IsCached( aLayer ) && !aImmediate )
     {
         // Draw using cached information or create one
-        int group = viewData->getGroup( aLayer );
+        int    group = viewData->getGroup( aLayer );
+        double coarseSize = m_coarseItemPixels / m_gal->GetWorldScale();
 
-        if( group >= 0 )
-            m_gal->DrawGroup( group );
-        else
+        if( group < 0 )
+        {
             Update( aItem );
+        }
+        else if( viewData->m_cachedSize > 0.0 && viewData->m_cachedSize < coarseSize )
+        {
+            // Items a few pixels large are drawn from a coarse variant, built by the next update
+            if( !m_gal->DrawCoarseGroup( group ) )
+            {
+                m_gal->DrawGroup( group );
+                Update( aItem, COARSE_GEOMETRY );
+            }
+        }
+        else
+        {
+            m_gal->DrawGroup( group );
+        }
     }
     else
     {
@@ -1209,6 +1248,13 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         }
     }
 
+    if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT ) )
+    {
+        const BOX2I bbox = aItem->ViewBBox();
+
+        aItem->viewPrivData()->m_cachedSize = std::max( bbox.GetWidth(), bbox.GetHeight() );
+    }
+
     int layers[VIEW_MAX_LAYERS], layers_count;
     aItem->ViewGetLayers( layers, layers_count );
 
@@ -1219,10 +1265,19 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
 
         if( IsCached( layerId ) )
         {
+            // A new geometry drops the coarse variant, which is built again when drawn
             if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT ) )
+            {
                 updateItemGeometry( aItem, layerId );
-            else if( aUpdateFlags & COLOR )
-                updateItemColor( aItem, layerId );
+            }
+            else
+            {
+                if( aUpdateFlags & COARSE_GEOMETRY )
+                    updateItemCoarseGeometry( aItem, layerId );
+
+                if( aUpdateFlags & COLOR )
+                    updateItemColor( aItem, layerId );
+            }
         }
 
         // Mark those layers as dirty, so the VIEW will be refreshed
@@ -1297,6 +1352,63 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
 }
 
 
+void VIEW::updateItemCoarseGeometry( VIEW_ITEM* aItem, int aLayer )
+{
+    auto viewData = aItem->viewPrivData();
+    wxCHECK( (unsigned) aLayer < m_layers.size(), /*void*/ );
+    wxCHECK( IsCached( aLayer ), /*void*/ );
+
+    if( !viewData )
+        return;
+
+    VIEW_LAYER& l = m_layers.at( aLayer );
+
+    m_gal->SetTarget( l.target );
+    m_gal->SetLayerDepth( l.renderingOrder );
+
+    if( !m_gal->BeginCoarseGroup( viewData->getGroup( aLayer ) ) )
+        return;
+
+    if( !m_painter->Draw( static_cast<EDA_ITEM*>( aItem ), aLayer ) )
+        aItem->ViewDraw( aLayer, this ); // Alternative drawing method
+
+    m_gal->EndGroup();
+}
+
+
+void VIEW::prepareItemGeometry( const std::vector<VIEW_ITEM*>& aItems )
+{
+    size_t threadCount = m_prepareThreadCount > 0 ? m_prepareThreadCount
+                                                  : std::thread::hardware_concurrency();
+
+    // Redrawing a few items while editing is not worth the threads
+    size_t parallelThreadCount = std::min<size_t>( threadCount, ( aItems.size() + 255 ) / 256 );
+
+    std::atomic<size_t> nextItem( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto prepare_lambda = [&nextItem, &aItems, this]() -> size_t
+    {
+        for( size_t i = nextItem++; i < aItems.size(); i = nextItem++ )
+            m_painter->PrepareDraw( aItems[i] );
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        prepare_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, prepare_lambda );
+
+        // Finalize the threads
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+}
+
+
 void VIEW::updateBbox( VIEW_ITEM* aItem )
 {
     int layers[VIEW_MAX_LAYERS], layers_count;
@@ -1396,6 +1508,28 @@ void VIEW::UpdateItems()
     if( m_gal->IsVisible() )
     {
         GAL_UPDATE_CONTEXT ctx( m_gal );
+        PROF_COUNTER       updateTimer;
+        FRAME_STATS*       stats = m_gal->GetFrameStats();
+
+        std::vector<VIEW_ITEM*> redrawnItems;
+
+        for( VIEW_ITEM* item : *m_allItems )
+        {
+            auto viewData = item->viewPrivData();
+
+            if( viewData && ( viewData->m_requiredUpdate
+                              & ( INITIAL_ADD | LAYERS | GEOMETRY | REPAINT ) ) )
+            {
+                redrawnItems.push_back( item );
+            }
+        }
+
+        PROF_COUNTER prepareTimer;
+
+        prepareItemGeometry( redrawnItems );
+
+        if( stats )
+            stats->m_prepareTime += prepareTimer.msecs();
 
         for( VIEW_ITEM* item : *m_allItems )
         {
@@ -1408,8 +1542,15 @@ void VIEW::UpdateItems()
             {
                 invalidateItem( item, viewData->m_requiredUpdate );
                 viewData->m_requiredUpdate = NONE;
+
+                if( stats )
+                    stats->m_updatedItemCount++;
             }
         }
+
+        // The cache is sent to the GPU afterwards, when the update context is destroyed
+        if( stats )
+            stats->m_updateTime += updateTimer.msecs();
     }
 }
 
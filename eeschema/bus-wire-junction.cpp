@@ -68,23 +68,49 @@ std::vector<wxPoint> SCH_EDIT_FRAME::GetSchematicConnections()
 
 bool SCH_EDIT_FRAME::TestDanglingEnds()
 {
-    std::vector<DANGLING_END_ITEM> endPoints;
-    bool hasStateChanged = false;
+    std::function<void( SCH_ITEM* )> changeHandler =
+            [&]( SCH_ITEM* aChangedItem )
+            {
+                GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
+            };
 
-    for( auto item : GetScreen()->Items() )
-        item->GetEndPoints( endPoints );
+    return GetScreen()->TestDanglingEnds( nullptr, &changeHandler );
+}
 
-    for( auto item : GetScreen()->Items() )
+
+bool SCH_EDIT_FRAME::TestDanglingEnds( const PICKED_ITEMS_LIST& aChange )
+{
+    std::vector<SCH_ITEM*> touchedItems;
+
+    for( unsigned ii = 0; ii < aChange.GetCount(); ++ii )
     {
-        if( item->UpdateDanglingState( endPoints ) )
+        if( aChange.GetScreenForItem( ii ) != GetScreen() )
+            continue;
+
+        // Changed items are swapped with their copy, which may be the one on the screen
+        for( EDA_ITEM* item : { aChange.GetPickedItem( ii ), aChange.GetPickedItemLink( ii ) } )
         {
-            GetCanvas()->GetView()->Update( item, KIGFX::REPAINT );
-            hasStateChanged = true;
+            if( SCH_ITEM* schItem = dynamic_cast<SCH_ITEM*>( item ) )
+                touchedItems.push_back( schItem );
         }
-        item->GetEndPoints( endPoints );
     }
 
-    return hasStateChanged;
+    std::function<void( SCH_ITEM* )> changeHandler =
+            [&]( SCH_ITEM* aChangedItem )
+            {
+                GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
+            };
+
+    return GetScreen()->TestDanglingEnds( touchedItems, &changeHandler );
+}
+
+
+bool SCH_EDIT_FRAME::TestDanglingEndsOfLastChange()
+{
+    if( m_undoList.m_CommandsList.empty() )
+        return TestDanglingEnds();
+
+    return TestDanglingEnds( *m_undoList.m_CommandsList.back() );
 }
 
 
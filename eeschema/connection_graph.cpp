@@ -24,6 +24,7 @@
 #include <future>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <profile.h>
 #include <common.h>
 #include <erc.h>
@@ -57,6 +58,29 @@ static const wxChar ConnProfileMask[] = wxT( "CONN_PROFILE" );
 static const wxChar ConnTrace[] = wxT( "CONN" );
 
 
+/**
+ * Returns the net name a driver item gives on a sheet
+ */
+static wxString getDriverName( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet )
+{
+    switch( aItem->Type() )
+    {
+    case SCH_PIN_T:
+        return static_cast<SCH_PIN*>( aItem )->GetDefaultNetName( aSheet );
+
+    case SCH_LABEL_T:
+    case SCH_GLOBAL_LABEL_T:
+    case SCH_HIER_LABEL_T:
+    case SCH_SHEET_PIN_T:
+        return EscapeString( static_cast<SCH_TEXT*>( aItem )->GetShownText(), CTX_NETNAME );
+
+    default:
+        wxFAIL_MSG( "Unhandled item type in GetNameForDriver" );
+        return wxEmptyString;
+    }
+}
+
+
 bool CONNECTION_SUBGRAPH::ResolveDrivers( bool aCreateMarkers )
 {
     PRIORITY               highest_priority = PRIORITY::INVALID;
@@ -270,29 +294,7 @@ const wxString& CONNECTION_SUBGRAPH::GetNameForDriver( SCH_ITEM* aItem )
     if( m_driver_name_cache.count( aItem ) )
         return m_driver_name_cache.at( aItem );
 
-    switch( aItem->Type() )
-    {
-    case SCH_PIN_T:
-    {
-        SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
-        m_driver_name_cache[aItem] = pin->GetDefaultNetName( m_sheet );
-        break;
-    }
-
-    case SCH_LABEL_T:
-    case SCH_GLOBAL_LABEL_T:
-    case SCH_HIER_LABEL_T:
-    case SCH_SHEET_PIN_T:
-    {
-        m_driver_name_cache[aItem] = EscapeString( static_cast<SCH_TEXT*>( aItem )->GetShownText(),
-                                                   CTX_NETNAME );
-        break;
-    }
-
-    default:
-        wxFAIL_MSG( "Unhandled item type in GetNameForDriver" );
-        break;
-    }
+    m_driver_name_cache[aItem] = getDriverName( aItem, m_sheet );
 
     return m_driver_name_cache.at( aItem );
 }
@@ -392,6 +394,18 @@ bool CONNECTION_GRAPH::m_allowRealTime = true;
 
 
 void CONNECTION_GRAPH::Reset()
+{
+    resetGraph();
+
+    m_sheet_items.clear();
+    m_net_name_to_code_map.clear();
+    m_bus_name_to_code_map.clear();
+    m_last_net_code = 1;
+    m_last_bus_code = 1;
+}
+
+
+void CONNECTION_GRAPH::resetGraph()
 {
     for( auto& subgraph : m_subgraphs )
         delete subgraph;
@@ -402,15 +416,12 @@ void CONNECTION_GRAPH::Reset()
     m_sheet_to_subgraphs_map.clear();
     m_invisible_power_pins.clear();
     m_bus_alias_cache.clear();
-    m_net_name_to_code_map.clear();
-    m_bus_name_to_code_map.clear();
     m_net_code_to_subgraphs_map.clear();
     m_net_name_to_subgraphs_map.clear();
     m_item_to_subgraph_map.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
-    m_last_net_code = 1;
-    m_last_bus_code = 1;
+    m_link_key_map.clear();
     m_last_subgraph_code = 1;
 }
 
@@ -419,37 +430,135 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 {
     PROF_COUNTER recalc_time( "CONNECTION_GRAPH::Recalculate" );
 
+    // Bus aliases can give new members to buses on any sheet
+    wxString bus_aliases = busAliasSignature();
+    bool     incremental = !aUnconditional && !m_sheet_items.empty()
+                                && bus_aliases == m_bus_alias_signature;
+
     if( aUnconditional )
         Reset();
+    else if( !incremental )
+        resetGraph();
+
+    // The items are listed again, but only the full recalculations reset their connections
+    m_items.clear();
+    m_invisible_power_pins.clear();
+    m_bus_alias_signature = bus_aliases;
 
     PROF_COUNTER update_items( "updateItemConnectivity" );
 
     m_sheetList = aSheetList;
 
+    // Items are added with dirty connectivity, and saving them for undo makes them dirty.
+    // Removed items are found by the count and the addresses of the items of the screen.
+    // Screens may be shared by several sheets, so all of them are checked before any update.
+    std::unordered_map<SCH_SCREEN*, SHEET_ITEMS> screens;
+    std::unordered_set<SCH_SCREEN*>              changed_screens;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        SCH_SCREEN* screen = sheet.LastScreen();
+
+        if( screens.count( screen ) )
+            continue;
+
+        SHEET_ITEMS& screen_items = screens[ screen ];
+
+        screen_items.m_screen = screen;
+        screen_items.m_screenItemCount = 0;
+        screen_items.m_screenItemSum = 0;
+
+        for( SCH_ITEM* item : screen->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            if( item->IsConnectivityDirty() )
+                changed_screens.insert( screen );
+
+            screen_items.m_screenItemCount++;
+            screen_items.m_screenItemSum += reinterpret_cast<uintptr_t>( item );
+        }
+    }
+
+    std::unordered_map<SCH_SHEET_PATH, SHEET_ITEMS> sheet_items;
+    std::unordered_set<SCH_SHEET_PATH>              dirty_sheets;
+
     for( const SCH_SHEET_PATH& sheet : aSheetList )
     {
+        SCH_SCREEN*        screen = sheet.LastScreen();
+        const SHEET_ITEMS& screen_items = screens.at( screen );
+        auto               cached = m_sheet_items.find( sheet );
+        wxString           path_name = sheet.PathHumanReadable();
+
+        if( cached != m_sheet_items.end()
+                && cached->second.m_screen == screen
+                && cached->second.m_screenItemCount == screen_items.m_screenItemCount
+                && cached->second.m_screenItemSum == screen_items.m_screenItemSum
+                && !changed_screens.count( screen ) )
+        {
+            // Local net names start with the sheet path, which a renamed sheet changes
+            bool renamed = cached->second.m_pathName != path_name;
+
+            if( renamed )
+                dirty_sheets.insert( sheet );
+
+            reuseItemConnectivity( sheet, cached->second, !incremental || renamed );
+            sheet_items[ sheet ] = std::move( cached->second );
+            sheet_items[ sheet ].m_pathName = path_name;
+            continue;
+        }
+
         std::vector<SCH_ITEM*> items;
 
-        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        for( SCH_ITEM* item : screen->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
+            if( item->IsConnectable() )
                 items.push_back( item );
         }
 
+        size_t first_item = m_items.size();
+        size_t first_pin = m_invisible_power_pins.size();
+
         m_items.reserve( m_items.size() + items.size() );
 
         updateItemConnectivity( sheet, items );
 
         // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet );
+        screen->TestDanglingEnds( &sheet );
+
+        SHEET_ITEMS& found = sheet_items[ sheet ];
+
+        found = screen_items;
+        found.m_pathName = path_name;
+        found.m_items.assign( m_items.begin() + first_item, m_items.end() );
+
+        for( size_t ii = first_pin; ii < m_invisible_power_pins.size(); ii++ )
+            found.m_invisible_power_pins.push_back( m_invisible_power_pins[ii].second );
+
+        dirty_sheets.insert( sheet );
+    }
+
+    // Sheets which are no longer in the schematic are dropped, along with their subgraphs
+    for( const auto& cached : m_sheet_items )
+    {
+        if( !sheet_items.count( cached.first ) )
+            dirty_sheets.insert( cached.first );
     }
 
+    m_sheet_items.swap( sheet_items );
+
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         update_items.Show();
 
     PROF_COUNTER build_graph( "buildConnectionGraph" );
 
-    buildConnectionGraph();
+    if( incremental )
+        updateConnectionGraph( dirty_sheets );
+    else
+        buildConnectionGraph();
+
+    pruneCodeMaps();
 
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         build_graph.Show();
@@ -472,6 +581,127 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 }
 
 
+/**
+ * Sets the bus or net type of the connection of wires, buses and bus entries, so that the
+ * propagation code uses it.
+ */
+static void setConnectionType( SCH_ITEM* aItem, SCH_CONNECTION* aConnection )
+{
+    switch( aItem->Type() )
+    {
+    case SCH_LINE_T:
+        aConnection->SetType( aItem->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
+                                                               CONNECTION_TYPE::NET );
+        break;
+
+    case SCH_BUS_BUS_ENTRY_T:
+        aConnection->SetType( CONNECTION_TYPE::BUS );
+        break;
+
+    case SCH_PIN_T:
+    case SCH_BUS_WIRE_ENTRY_T:
+        aConnection->SetType( CONNECTION_TYPE::NET );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/**
+ * Resets the connection of an item for buildConnectionGraph(), keeping the connections
+ * between items found by updateItemConnectivity()
+ */
+static void resetConnection( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet,
+                             CONNECTION_GRAPH* aGraph )
+{
+    SCH_CONNECTION* connection = aItem->InitializeConnection( aSheet, aGraph );
+
+    // Component pins are initialized as in updateItemConnectivity(), and their default
+    // net name is cached beforehand because calling the first time is not thread-safe
+    if( aItem->Type() == SCH_PIN_T )
+        static_cast<SCH_PIN*>( aItem )->GetDefaultNetName( aSheet );
+    else
+        setConnectionType( aItem, connection );
+}
+
+
+/**
+ * Adds the link keys of the names of a connection and of its bus members
+ *
+ * @param aSheet is the sheet where items with the same names are linked, or nullptr
+ */
+static void addNameKeys( const SCH_CONNECTION& aConnection, const SCH_SHEET_PATH* aSheet,
+                         std::vector<wxString>& aKeys )
+{
+    aKeys.push_back( wxT( "F\t" ) + aConnection.Name() );
+
+    // Weakly driven bus vectors are renamed when another one has the same prefix
+    if( aConnection.Type() == CONNECTION_TYPE::BUS )
+        aKeys.push_back( wxT( "F\t" ) + aConnection.Name().BeforeFirst( '[' ) + wxT( "[]" ) );
+
+    if( aSheet )
+    {
+        aKeys.push_back( wxT( "S\t" ) + aSheet->PathAsString() + wxT( "\t" )
+                         + aConnection.Name( true ) );
+    }
+
+    for( const std::shared_ptr<SCH_CONNECTION>& member : aConnection.Members() )
+        addNameKeys( *member, aSheet, aKeys );
+}
+
+
+/**
+ * Removes subgraphs from the vectors of a map, and the entries left empty
+ */
+template <typename MAP, typename PREDICATE>
+static void eraseSubgraphs( MAP& aMap, PREDICATE aRemoved )
+{
+    for( auto it = aMap.begin(); it != aMap.end(); )
+    {
+        it->second.erase( std::remove_if( it->second.begin(), it->second.end(), aRemoved ),
+                          it->second.end() );
+
+        if( it->second.empty() )
+            it = aMap.erase( it );
+        else
+            ++it;
+    }
+}
+
+
+/**
+ * Puts back the subgraphs of a map which were set aside, before those of the same entries
+ */
+template <typename MAP>
+static void mergeSubgraphs( MAP& aMap, const MAP& aKept )
+{
+    for( const auto& entry : aKept )
+    {
+        auto& subgraphs = aMap[ entry.first ];
+        subgraphs.insert( subgraphs.begin(), entry.second.begin(), entry.second.end() );
+    }
+}
+
+
+void CONNECTION_GRAPH::reuseItemConnectivity( const SCH_SHEET_PATH& aSheet,
+                                              const SHEET_ITEMS& aItems,
+                                              bool aResetConnections )
+{
+    if( aResetConnections )
+    {
+        for( SCH_ITEM* item : aItems.m_items )
+            resetConnection( item, aSheet, this );
+    }
+
+    m_items.insert( m_items.end(), aItems.m_items.begin(), aItems.m_items.end() );
+
+    for( SCH_PIN* pin : aItems.m_invisible_power_pins )
+        m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+}
+
+
 void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                                                const std::vector<SCH_ITEM*>& aItemList )
 {
@@ -532,26 +762,17 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
             auto conn = item->InitializeConnection( aSheet, this );
 
             // Set bus/net property here so that the propagation code uses it
+            setConnectionType( item, conn );
+
             switch( item->Type() )
             {
-            case SCH_LINE_T:
-                conn->SetType( item->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
-                                                               CONNECTION_TYPE::NET );
-                break;
-
             case SCH_BUS_BUS_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::BUS );
                 // clean previous (old) links:
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
                 break;
 
-            case SCH_PIN_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                break;
-
             case SCH_BUS_WIRE_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::NET );
                 // clean previous (old) link:
                 static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
                 break;
@@ -802,7 +1023,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                       return candidate->m_dirty;
                   } );
 
-    auto update_lambda = [&nextSubgraph, &dirty_graphs]() -> size_t
+    auto update_lambda = [&nextSubgraph, &dirty_graphs, this]() -> size_t
     {
         for( size_t subgraphId = nextSubgraph++; subgraphId < dirty_graphs.size(); subgraphId = nextSubgraph++ )
         {
@@ -837,6 +1058,8 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                 default:
                     break;
                 }
+
+                addLinkKeys( item, subgraph->m_sheet, subgraph->m_link_keys );
             }
 
             if( !subgraph->ResolveDrivers() )
@@ -973,6 +1196,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         {
             subgraph = invisible_pin_subgraphs.at( code );
             subgraph->AddItem( pin );
+            addLinkKeys( pin, sheet, subgraph->m_link_keys );
         }
         else
         {
@@ -983,6 +1207,7 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
             subgraph->AddItem( pin );
             subgraph->ResolveDrivers();
+            addLinkKeys( pin, sheet, subgraph->m_link_keys );
 
             auto key = std::make_pair( subgraph->GetNetName(), code );
             m_net_code_to_subgraphs_map[ key ].push_back( subgraph );
@@ -1485,6 +1710,9 @@ void CONNECTION_GRAPH::buildConnectionGraph()
             subgraph->m_dirty = false;
         }
 
+        // The final names of the net and its members may be those of other subgraphs
+        addNameKeys( *subgraph->m_driver_connection, nullptr, subgraph->m_link_keys );
+
         if( subgraph->m_driver_connection->IsBus() )
         {
             // No other processing to do on buses
@@ -1533,6 +1761,352 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
         m_net_name_to_subgraphs_map[subgraph->m_driver_connection->Name()].push_back( subgraph );
     }
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        std::vector<wxString>& keys = subgraph->m_link_keys;
+
+        std::sort( keys.begin(), keys.end() );
+        keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+
+        for( const wxString& key : keys )
+            m_link_key_map[ key ].push_back( subgraph );
+    }
+}
+
+
+void CONNECTION_GRAPH::updateConnectionGraph(
+        const std::unordered_set<SCH_SHEET_PATH>& aDirtySheets )
+{
+    std::unordered_set<CONNECTION_SUBGRAPH*> subgraphs;
+    std::vector<wxString>                    keys;
+
+    // The old subgraphs of the dirty sheets, and the subgraphs their new items can join
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        if( aDirtySheets.count( subgraph->m_sheet ) )
+            subgraphs.insert( subgraph );
+    }
+
+    for( const SCH_SHEET_PATH& sheet : aDirtySheets )
+    {
+        auto it = m_sheet_items.find( sheet );
+
+        if( it == m_sheet_items.end() )
+            continue;
+
+        for( SCH_ITEM* item : it->second.m_items )
+            addLinkKeys( item, sheet, keys );
+
+        for( SCH_PIN* pin : it->second.m_invisible_power_pins )
+            addLinkKeys( pin, sheet, keys );
+    }
+
+    findLinkedSubgraphs( keys, subgraphs );
+
+    wxLogTrace( ConnTrace, "Updating %zu of %zu subgraphs", subgraphs.size(), m_subgraphs.size() );
+
+    // The items of the dirty sheets may have been deleted, but not those of the other sheets
+    const std::unordered_set<SCH_SHEET_PATH>  no_sheets;
+    const std::unordered_set<SCH_SHEET_PATH>* dirty_sheets = &aDirtySheets;
+
+    while( !subgraphs.empty() )
+    {
+        removeSubgraphs( subgraphs, *dirty_sheets );
+        dirty_sheets = &no_sheets;
+
+        // The kept subgraphs are set aside, so that the new ones are only linked together
+        std::vector<CONNECTION_SUBGRAPH*>         kept_subgraphs;
+        std::vector<CONNECTION_SUBGRAPH*>         kept_driver_subgraphs;
+        decltype( m_sheet_to_subgraphs_map )      kept_sheet_to_subgraphs;
+        decltype( m_global_label_cache )          kept_global_labels;
+        decltype( m_local_label_cache )           kept_local_labels;
+        decltype( m_net_name_to_subgraphs_map )   kept_net_name_to_subgraphs;
+        NET_MAP                                   kept_net_code_to_subgraphs;
+
+        kept_subgraphs.swap( m_subgraphs );
+        kept_driver_subgraphs.swap( m_driver_subgraphs );
+        kept_sheet_to_subgraphs.swap( m_sheet_to_subgraphs_map );
+        kept_global_labels.swap( m_global_label_cache );
+        kept_local_labels.swap( m_local_label_cache );
+        kept_net_name_to_subgraphs.swap( m_net_name_to_subgraphs_map );
+        kept_net_code_to_subgraphs.swap( m_net_code_to_subgraphs_map );
+
+        // Only the items without a subgraph are put in new ones
+        buildConnectionGraph();
+
+        std::unordered_set<CONNECTION_SUBGRAPH*> built( m_subgraphs.begin(), m_subgraphs.end() );
+
+        m_subgraphs.insert( m_subgraphs.begin(), kept_subgraphs.begin(), kept_subgraphs.end() );
+        m_driver_subgraphs.insert( m_driver_subgraphs.begin(), kept_driver_subgraphs.begin(),
+                                   kept_driver_subgraphs.end() );
+        mergeSubgraphs( m_sheet_to_subgraphs_map, kept_sheet_to_subgraphs );
+        mergeSubgraphs( m_global_label_cache, kept_global_labels );
+        mergeSubgraphs( m_local_label_cache, kept_local_labels );
+        mergeSubgraphs( m_net_name_to_subgraphs_map, kept_net_name_to_subgraphs );
+        mergeSubgraphs( m_net_code_to_subgraphs_map, kept_net_code_to_subgraphs );
+
+        // A net may have been given the name of a kept subgraph, as a weak driver renamed
+        // with a suffix for instance.  Both are then built again, with what they link to.
+        std::unordered_set<wxString> built_keys;
+
+        for( CONNECTION_SUBGRAPH* subgraph : built )
+            built_keys.insert( subgraph->m_link_keys.begin(), subgraph->m_link_keys.end() );
+
+        keys.clear();
+        subgraphs.clear();
+
+        for( const wxString& key : built_keys )
+        {
+            for( CONNECTION_SUBGRAPH* linked : m_link_key_map.at( key ) )
+            {
+                if( !built.count( linked ) )
+                {
+                    keys.push_back( key );
+                    break;
+                }
+            }
+        }
+
+        findLinkedSubgraphs( keys, subgraphs );
+
+        if( !subgraphs.empty() )
+        {
+            wxLogTrace( ConnTrace, "Updating %zu more subgraphs linked by name",
+                        subgraphs.size() );
+        }
+    }
+}
+
+
+void CONNECTION_GRAPH::removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs,
+                                        const std::unordered_set<SCH_SHEET_PATH>& aDirtySheets )
+{
+    auto removed =
+            [&]( const CONNECTION_SUBGRAPH* aSubgraph ) -> bool
+            {
+                return aSubgraphs.count( const_cast<CONNECTION_SUBGRAPH*>( aSubgraph ) ) > 0;
+            };
+
+    std::unordered_set<wxString> keys;
+
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        keys.insert( subgraph->m_link_keys.begin(), subgraph->m_link_keys.end() );
+
+        if( aDirtySheets.count( subgraph->m_sheet ) )
+            continue;
+
+        // Absorbed items are in two subgraphs, but are only reset once
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            SCH_CONNECTION* connection = item->Connection( &subgraph->m_sheet );
+
+            if( connection && connection->SubgraphCode() != 0 )
+                resetConnection( item, subgraph->m_sheet, this );
+        }
+    }
+
+    for( const wxString& key : keys )
+    {
+        auto it = m_link_key_map.find( key );
+
+        if( it == m_link_key_map.end() )
+            continue;
+
+        it->second.erase( std::remove_if( it->second.begin(), it->second.end(), removed ),
+                          it->second.end() );
+
+        if( it->second.empty() )
+            m_link_key_map.erase( it );
+    }
+
+    m_driver_subgraphs.erase( std::remove_if( m_driver_subgraphs.begin(),
+                                              m_driver_subgraphs.end(), removed ),
+                              m_driver_subgraphs.end() );
+
+    eraseSubgraphs( m_sheet_to_subgraphs_map, removed );
+    eraseSubgraphs( m_global_label_cache, removed );
+    eraseSubgraphs( m_local_label_cache, removed );
+    eraseSubgraphs( m_net_name_to_subgraphs_map, removed );
+    eraseSubgraphs( m_net_code_to_subgraphs_map, removed );
+
+    for( auto it = m_item_to_subgraph_map.begin(); it != m_item_to_subgraph_map.end(); )
+    {
+        if( removed( it->second ) )
+            it = m_item_to_subgraph_map.erase( it );
+        else
+            ++it;
+    }
+
+    m_subgraphs.erase( std::remove_if( m_subgraphs.begin(), m_subgraphs.end(), removed ),
+                       m_subgraphs.end() );
+
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+        delete subgraph;
+}
+
+
+void CONNECTION_GRAPH::findLinkedSubgraphs( std::vector<wxString> aKeys,
+                                            std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs )
+{
+    std::vector<CONNECTION_SUBGRAPH*> search_list( aSubgraphs.begin(), aSubgraphs.end() );
+    std::unordered_set<wxString>      visited_keys;
+
+    auto add =
+            [&]( CONNECTION_SUBGRAPH* aSubgraph )
+            {
+                if( aSubgraph && aSubgraphs.insert( aSubgraph ).second )
+                    search_list.push_back( aSubgraph );
+            };
+
+    while( !aKeys.empty() || !search_list.empty() )
+    {
+        if( !aKeys.empty() )
+        {
+            wxString key = aKeys.back();
+            aKeys.pop_back();
+
+            auto it = m_link_key_map.find( key );
+
+            if( visited_keys.insert( key ).second && it != m_link_key_map.end() )
+            {
+                for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                    add( subgraph );
+            }
+
+            continue;
+        }
+
+        CONNECTION_SUBGRAPH* subgraph = search_list.back();
+        search_list.pop_back();
+
+        aKeys.insert( aKeys.end(), subgraph->m_link_keys.begin(), subgraph->m_link_keys.end() );
+
+        add( subgraph->m_absorbed_by );
+        add( subgraph->m_hier_parent );
+
+        for( const auto& kv : subgraph->m_bus_neighbors )
+        {
+            for( CONNECTION_SUBGRAPH* neighbor : kv.second )
+                add( neighbor );
+        }
+
+        for( const auto& kv : subgraph->m_bus_parents )
+        {
+            for( CONNECTION_SUBGRAPH* parent : kv.second )
+                add( parent );
+        }
+    }
+}
+
+
+void CONNECTION_GRAPH::addLinkKeys( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet,
+                                    std::vector<wxString>& aKeys )
+{
+    wxString name;
+
+    switch( aItem->Type() )
+    {
+    case SCH_PIN_T:
+    {
+        SCH_PIN* pin = static_cast<SCH_PIN*>( aItem );
+
+        // Symbol pins are weak drivers, only linked to the subgraphs named after them
+        if( !pin->IsPowerConnection() )
+        {
+            aKeys.push_back( wxT( "F\t" ) + pin->GetDefaultNetName( aSheet ) );
+            return;
+        }
+
+        name = pin->GetDefaultNetName( aSheet );
+        break;
+    }
+
+    case SCH_SHEET_PIN_T:
+    {
+        SCH_SHEET_PIN* pin = static_cast<SCH_SHEET_PIN*>( aItem );
+        SCH_SHEET_PATH path = aSheet;
+
+        path.push_back( pin->GetParent() );
+        name = getDriverName( aItem, aSheet );
+
+        aKeys.push_back( wxT( "H\t" ) + path.PathAsString() + wxT( "\t" ) + name );
+        aKeys.push_back( wxT( "H\t" ) + path.PathAsString() + wxT( "\t" ) + pin->GetText() );
+        break;
+    }
+
+    case SCH_HIER_LABEL_T:
+    {
+        SCH_HIERLABEL* label = static_cast<SCH_HIERLABEL*>( aItem );
+
+        name = getDriverName( aItem, aSheet );
+
+        aKeys.push_back( wxT( "H\t" ) + aSheet.PathAsString() + wxT( "\t" ) + name );
+        aKeys.push_back( wxT( "H\t" ) + aSheet.PathAsString() + wxT( "\t" ) + label->GetText() );
+        break;
+    }
+
+    case SCH_LABEL_T:
+    case SCH_GLOBAL_LABEL_T:
+        name = getDriverName( aItem, aSheet );
+        break;
+
+    default:
+        return;
+    }
+
+    // The connection this item gives when it drives a subgraph
+    SCH_CONNECTION connection( aItem, aSheet );
+
+    connection.SetGraph( this );
+    connection.ConfigureFromLabel( name );
+    connection.SetDriver( aItem );
+
+    addNameKeys( connection, &aSheet, aKeys );
+
+    // Secondary drivers of a subgraph are compared by their own name
+    aKeys.push_back( wxT( "S\t" ) + aSheet.PathAsString() + wxT( "\t" ) + name );
+}
+
+
+void CONNECTION_GRAPH::pruneCodeMaps()
+{
+    // Every name given to a net or a bus is a link key of some subgraph
+    for( std::map<wxString, int>* codes : { &m_net_name_to_code_map, &m_bus_name_to_code_map } )
+    {
+        for( auto it = codes->begin(); it != codes->end(); )
+        {
+            if( m_link_key_map.count( wxT( "F\t" ) + it->first ) )
+                ++it;
+            else
+                it = codes->erase( it );
+        }
+    }
+}
+
+
+wxString CONNECTION_GRAPH::busAliasSignature() const
+{
+    wxString signature;
+
+    if( !m_schematic )
+        return signature;
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic->GetSheets() )
+    {
+        for( const std::shared_ptr<BUS_ALIAS>& alias : sheet.LastScreen()->GetBusAliases() )
+        {
+            signature << alias->GetName() << wxT( "{" );
+
+            for( const wxString& member : alias->Members() )
+                signature << member << wxT( " " );
+
+            signature << wxT( "}" );
+        }
+    }
+
+    return signature;
 }
 
 
@@ -21,6 +21,7 @@
 #ifndef _CONNECTION_GRAPH_H
 #define _CONNECTION_GRAPH_H
 
+#include <cstdint>
 #include <mutex>
 #include <vector>
 
@@ -41,6 +42,7 @@ class SCHEMATIC;
 class SCH_EDIT_FRAME;
 class SCH_HIERLABEL;
 class SCH_PIN;
+class SCH_SCREEN;
 class SCH_SHEET_PIN;
 
 
@@ -217,6 +219,12 @@ public:
 
     /// A cache of escaped netnames from schematic items
     std::unordered_map<SCH_ITEM*, wxString> m_driver_name_cache;
+
+    /**
+     * The names and hierarchical links through which this subgraph can be connected to
+     * others, used to find the subgraphs that a conditional recalculation must build again.
+     */
+    std::vector<wxString> m_link_keys;
 };
 
 /// Associates a net code with the final name of a net
@@ -253,6 +261,13 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * Unless the update is unconditional, the graphical connectivity of the items (where they
+     * touch) is only updated on the sheets whose screen has items added, removed or with dirty
+     * connectivity, and nets keep their net code as long as they keep their name.  Items
+     * changed in place must be marked dirty.  Only the subgraphs of those sheets are built
+     * again, along with the subgraphs they can be linked to through a net name, a bus member
+     * or a hierarchical pin; the others are kept as they are.
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
@@ -315,6 +330,20 @@ private:
     // All connectable items in the schematic
     std::vector<SCH_ITEM*> m_items;
 
+    /// The connectable items found on a sheet by updateItemConnectivity()
+    struct SHEET_ITEMS
+    {
+        SCH_SCREEN*            m_screen;
+        size_t                 m_screenItemCount;   ///< connectable items of the screen
+        uintptr_t              m_screenItemSum;     ///< sum of their addresses
+        wxString               m_pathName;          ///< the path the nets were named with
+        std::vector<SCH_ITEM*> m_items;
+        std::vector<SCH_PIN*>  m_invisible_power_pins;
+    };
+
+    // The item connectivity of each sheet, reused for the sheets which did not change
+    std::unordered_map<SCH_SHEET_PATH, SHEET_ITEMS> m_sheet_items;
+
     // The owner of all CONNECTION_SUBGRAPH objects
     std::vector<CONNECTION_SUBGRAPH*> m_subgraphs;
 
@@ -329,6 +358,9 @@ private:
 
     std::unordered_map< wxString, std::shared_ptr<BUS_ALIAS> > m_bus_alias_cache;
 
+    // The bus aliases the subgraphs were built with, as returned by busAliasSignature()
+    wxString m_bus_alias_signature;
+
     std::map<wxString, int> m_net_name_to_code_map;
 
     std::map<wxString, int> m_bus_name_to_code_map;
@@ -345,6 +377,9 @@ private:
 
     NET_MAP m_net_code_to_subgraphs_map;
 
+    // The subgraphs by CONNECTION_SUBGRAPH::m_link_keys
+    std::unordered_map<wxString, std::vector<CONNECTION_SUBGRAPH*>> m_link_key_map;
+
     int m_last_net_code;
 
     int m_last_bus_code;
@@ -353,6 +388,24 @@ private:
 
     SCHEMATIC* m_schematic;     ///< The schematic this graph represents
 
+    /**
+     * Deletes the subgraphs and everything derived from them, but keeps the item connectivity
+     * of the sheets and the net codes for the next conditional recalculation.
+     */
+    void resetGraph();
+
+    /**
+     * Prepares the items of an unchanged sheet for buildConnectionGraph(), keeping the
+     * connections between them found by a previous updateItemConnectivity()
+     *
+     * @param aSheet is the path to the sheet of the items
+     * @param aItems is what updateItemConnectivity() found on the sheet
+     * @param aResetConnections is false to also keep the connections of the items, when
+     *                          their subgraphs are kept
+     */
+    void reuseItemConnectivity( const SCH_SHEET_PATH& aSheet, const SHEET_ITEMS& aItems,
+                                bool aResetConnections );
+
     /**
      * Updates the graphical connectivity between items (i.e. where they touch)
      * The items passed in must be on the same sheet.
@@ -398,6 +451,57 @@ private:
      */
     void buildConnectionGraph();
 
+    /**
+     * Builds the subgraphs of the given sheets again, and those of the other sheets which
+     * are linked to them, keeping all the other subgraphs
+     *
+     * @param aDirtySheets are the sheets whose items were updated, renamed or removed
+     */
+    void updateConnectionGraph( const std::unordered_set<SCH_SHEET_PATH>& aDirtySheets );
+
+    /**
+     * Deletes subgraphs, resetting the connections of their items so that the next
+     * buildConnectionGraph() puts them in new subgraphs
+     *
+     * @param aSubgraphs are the subgraphs to delete
+     * @param aDirtySheets are sheets whose items may no longer exist and are not reset
+     */
+    void removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs,
+                          const std::unordered_set<SCH_SHEET_PATH>& aDirtySheets );
+
+    /**
+     * Adds to a list of subgraphs the subgraphs sharing one of the given link keys, and
+     * recursively those linked to them
+     *
+     * @param aKeys are link keys, see addLinkKeys()
+     * @param aSubgraphs is the list of subgraphs to complete
+     */
+    void findLinkedSubgraphs( std::vector<wxString> aKeys,
+                              std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs );
+
+    /**
+     * Adds the link keys of a driver item: the net names it can give to a subgraph, the names
+     * linking it to other subgraphs on its sheet, and the hierarchical links of sheet pins and
+     * hierarchical labels
+     *
+     * @param aItem is an item of the subgraph
+     * @param aSheet is the sheet of the subgraph
+     * @param aKeys is the list to add the keys to
+     */
+    void addLinkKeys( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet,
+                      std::vector<wxString>& aKeys );
+
+    /**
+     * Drops the net and bus codes of the names which are no longer used by any subgraph
+     */
+    void pruneCodeMaps();
+
+    /**
+     * Returns the names and members of the bus aliases of the schematic, to find out when
+     * they changed
+     */
+    wxString busAliasSignature() const;
+
     /**
      * Helper to assign a new net code to a connection
      *
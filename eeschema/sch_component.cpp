@@ -277,6 +277,9 @@ void SCH_COMPONENT::UpdatePins()
     m_pins.clear();
     m_pinMap.clear();
 
+    // The connection graph must drop the old pins
+    SetConnectivityDirty();
+
     if( !m_part )
         return;
 
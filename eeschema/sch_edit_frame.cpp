@@ -712,8 +712,10 @@ void SCH_EDIT_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
+    // Edits save their items for undo and undo/redo restores them, both marking the items
+    // dirty, so the sheets without dirty items keep their item connectivity
     if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity && CONNECTION_GRAPH::m_allowRealTime )
-        RecalculateConnections( NO_CLEANUP );
+        RecalculateConnections( NO_CLEANUP, true );
 
     GetCanvas()->GetView()->UpdateAllItemsConditionally( KIGFX::REPAINT,
             []( KIGFX::VIEW_ITEM* aItem )
@@ -1202,7 +1204,8 @@ void SCH_EDIT_FRAME::UpdateTitle()
 }
 
 
-void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
+void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags,
+                                             bool aReuseUnchangedSheets )
 {
     SCHEMATIC_SETTINGS& settings = Schematic().Settings();
     SCH_SHEET_LIST list = Schematic().GetSheets();
@@ -1225,7 +1228,7 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     if( settings.m_IntersheetsRefShow == true )
         RecomputeIntersheetsRefs();
 
-    Schematic().ConnectionGraph()->Recalculate( list, true );
+    Schematic().ConnectionGraph()->Recalculate( list, !aReuseUnchangedSheets );
 }
 
 int SCH_EDIT_FRAME::RecomputeIntersheetsRefs()
@@ -316,6 +316,25 @@ public:
      */
     bool TestDanglingEnds();
 
+    /**
+     * Test for unused connection points only the objects which a change may have connected
+     * or disconnected, see SCH_SCREEN::TestDanglingEnds().
+     *
+     * @param aChange is the undo or redo command of the change, whose items and copies on the
+     *                current screen are the touched items.
+     * @return True if any connection state changes were made.
+     */
+    bool TestDanglingEnds( const PICKED_ITEMS_LIST& aChange );
+
+    /**
+     * Test for unused connection points only the objects which the last change may have
+     * connected or disconnected.  The tools call it once their change, and the cleanup
+     * following it, are in the command on top of the undo list.
+     *
+     * @return True if any connection state changes were made.
+     */
+    bool TestDanglingEndsOfLastChange();
+
     /**
      * Send a message to Pcbnew via a socket connection.
      *
@@ -902,8 +921,14 @@ public:
 
     /**
      * Generates the connection data for the entire schematic hierarchy.
+     *
+     * @param aReuseUnchangedSheets is true to keep where the items touch on the sheets not
+     *                              changed since the last calculation.  The nets are still
+     *                              built again for the whole hierarchy, see
+     *                              CONNECTION_GRAPH::Recalculate().
      */
-    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags );
+    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags,
+                                 bool aReuseUnchangedSheets = false );
 
     /**
      * Allows Eeschema to install its preferences panels into the preferences dialog.
@@ -750,6 +750,10 @@ void SCH_LINE::SwapData( SCH_ITEM* aItem )
     std::swap( m_startIsDangling, item->m_startIsDangling );
     std::swap( m_endIsDangling, item->m_endIsDangling );
     std::swap( m_stroke, item->m_stroke );
+
+    // Both lines have moved, as far as the connection graph is concerned
+    SetConnectivityDirty();
+    item->SetConnectivityDirty();
 }
 
 
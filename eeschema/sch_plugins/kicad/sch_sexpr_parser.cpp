@@ -32,6 +32,7 @@
 #include <wx/tokenzr.h>
 
 #include <common.h>
+#include <kicad_string.h>
 #include <lib_id.h>
 
 #include <class_libentry.h>
@@ -125,7 +126,6 @@ LIB_PART* SCH_SEXPR_PARSER::ParseSymbol( LIB_PART_MAP& aSymbolLibMap, int aFileV
                  wxT( "Cannot parse " ) + GetTokenString( CurTok() ) + wxT( " as a symbol." ) );
 
     T token;
-    long tmp;
     wxString name;
     wxString error;
     LIB_ITEM* item;
@@ -136,27 +136,8 @@ LIB_PART* SCH_SEXPR_PARSER::ParseSymbol( LIB_PART_MAP& aSymbolLibMap, int aFileV
 
     m_fieldId = MANDATORY_FIELDS;
 
-    token = NextTok();
-
-    if( !IsSymbol( token ) )
-    {
-        error.Printf( _( "Invalid symbol name in\nfile: \"%s\"\nline: %d\noffset: %d" ),
-                      CurSource().c_str(), CurLineNumber(), CurOffset() );
-        THROW_IO_ERROR( error );
-    }
+    LIB_ID id = parseSymbolName();
 
-    name = FromUTF8();
-
-    LIB_ID id;
-
-    if( id.Parse( name, LIB_ID::ID_SCH ) >= 0 )
-    {
-        error.Printf( _( "Invalid library identifier in\nfile: \"%s\"\nline: %d\noffset: %d" ),
-                      CurSource().c_str(), CurLineNumber(), CurOffset() );
-        THROW_IO_ERROR( error );
-    }
-
-    m_symbolName = id.GetLibItemName().wx_str();
     symbol->SetName( m_symbolName );
     symbol->SetLibId( id );
 
@@ -232,59 +213,7 @@ LIB_PART* SCH_SEXPR_PARSER::ParseSymbol( LIB_PART_MAP& aSymbolLibMap, int aFileV
 
         case T_symbol:
         {
-            token = NextTok();
-
-            if( !IsSymbol( token ) )
-            {
-                error.Printf(
-                    _( "Invalid symbol unit name in\nfile: \"%s\"\nline: %d\noffset: %d" ),
-                    CurSource().c_str(), CurLineNumber(), CurOffset() );
-                THROW_IO_ERROR( error );
-            }
-
-            name = FromUTF8();
-
-            if( !name.StartsWith( m_symbolName ) )
-            {
-                error.Printf(
-                    _( "Invalid symbol unit name prefix %s in\nfile: \"%s\"\n"
-                       "line: %d\noffset: %d" ),
-                    name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
-                THROW_IO_ERROR( error );
-            }
-
-            name = name.Right( name.Length() - m_symbolName.Length() - 1 );
-
-            wxStringTokenizer tokenizer( name, "_" );
-
-            if( tokenizer.CountTokens() != 2 )
-            {
-                error.Printf(
-                    _( "Invalid symbol unit name suffix %s in\nfile: \"%s\"\n"
-                       "line: %d\noffset: %d" ),
-                    name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
-                THROW_IO_ERROR( error );
-            }
-
-            if( !tokenizer.GetNextToken().ToLong( &tmp ) )
-            {
-                error.Printf(
-                    _( "Invalid symbol unit number %s in\nfile: \"%s\"\nline: %d\noffset: %d" ),
-                    name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
-                THROW_IO_ERROR( error );
-            }
-
-            m_unit = static_cast<int>( tmp );
-
-            if( !tokenizer.GetNextToken().ToLong( &tmp ) )
-            {
-                error.Printf(
-                    _( "Invalid symbol convert number %s in\nfile: \"%s\"\nline: %d\noffset: %d" ),
-                    name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
-                THROW_IO_ERROR( error );
-            }
-
-            m_convert = static_cast<int>( tmp );
+            parseUnitName();
 
             if( m_convert > 1 )
                 symbol->SetConversion( true, false );
@@ -353,6 +282,252 @@ LIB_PART* SCH_SEXPR_PARSER::ParseSymbol( LIB_PART_MAP& aSymbolLibMap, int aFileV
 }
 
 
+LIB_ID SCH_SEXPR_PARSER::parseSymbolName()
+{
+    wxString error;
+    T        token = NextTok();
+
+    if( !IsSymbol( token ) )
+    {
+        error.Printf( _( "Invalid symbol name in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    wxString name = FromUTF8();
+    LIB_ID   id;
+
+    if( id.Parse( name, LIB_ID::ID_SCH ) >= 0 )
+    {
+        error.Printf( _( "Invalid library identifier in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    m_symbolName = id.GetLibItemName().wx_str();
+
+    return id;
+}
+
+
+void SCH_SEXPR_PARSER::parseUnitName()
+{
+    wxString error;
+    long     tmp;
+    T        token = NextTok();
+
+    if( !IsSymbol( token ) )
+    {
+        error.Printf( _( "Invalid symbol unit name in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    wxString name = FromUTF8();
+
+    if( !name.StartsWith( m_symbolName ) )
+    {
+        error.Printf( _( "Invalid symbol unit name prefix %s in\nfile: \"%s\"\n"
+                         "line: %d\noffset: %d" ),
+                      name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    name = name.Right( name.Length() - m_symbolName.Length() - 1 );
+
+    wxStringTokenizer tokenizer( name, "_" );
+
+    if( tokenizer.CountTokens() != 2 )
+    {
+        error.Printf( _( "Invalid symbol unit name suffix %s in\nfile: \"%s\"\n"
+                         "line: %d\noffset: %d" ),
+                      name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    if( !tokenizer.GetNextToken().ToLong( &tmp ) )
+    {
+        error.Printf( _( "Invalid symbol unit number %s in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    m_unit = static_cast<int>( tmp );
+
+    if( !tokenizer.GetNextToken().ToLong( &tmp ) )
+    {
+        error.Printf( _( "Invalid symbol convert number %s in\nfile: \"%s\"\nline: %d\n"
+                         "offset: %d" ),
+                      name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
+        THROW_IO_ERROR( error );
+    }
+
+    m_convert = static_cast<int>( tmp );
+}
+
+
+void SCH_SEXPR_PARSER::ParseLibIndex( LIB_PART_MAP& aSymbolLibMap,
+                                      LIB_SYMBOL_LOCATIONS& aLocations )
+{
+    wxCHECK_RET( mappedReader, "Symbol libraries can only be indexed when mapped in memory." );
+
+    T token;
+
+    NeedLEFT();
+    NextTok();
+    parseHeader( T_kicad_symbol_lib, SEXPR_SYMBOL_LIB_FILE_VERSION );
+
+    for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
+    {
+        if( token != T_LEFT )
+            Expecting( T_LEFT );
+
+        LIB_SYMBOL_LOCATION location;
+
+        location.m_start = CurPtr() - mappedReader->Data();
+        location.m_line = CurLineNumber();
+
+        token = NextTok();
+
+        if( token != T_symbol )
+            Expecting( "symbol" );
+
+        LIB_PART* symbol = parseSymbolSummary( aSymbolLibMap );
+
+        // Just after the closing parenthesis of the symbol
+        location.m_end = CurPtr() + 1 - mappedReader->Data();
+
+        aLocations[symbol->GetName()] = location;
+        aSymbolLibMap[symbol->GetName()] = symbol;
+    }
+}
+
+
+LIB_PART* SCH_SEXPR_PARSER::parseSymbolSummary( LIB_PART_MAP& aSymbolLibMap )
+{
+    wxCHECK_MSG( CurTok() == T_symbol, nullptr,
+                 wxT( "Cannot parse " ) + GetTokenString( CurTok() ) + wxT( " as a symbol." ) );
+
+    T                         token;
+    wxString                  error;
+    std::unique_ptr<LIB_PART> symbol( new LIB_PART( wxEmptyString ) );
+
+    symbol->SetUnitCount( 1 );
+
+    LIB_ID id = parseSymbolName();
+
+    symbol->SetName( m_symbolName );
+    symbol->SetLibId( id );
+
+    for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
+    {
+        if( token != T_LEFT )
+            Expecting( T_LEFT );
+
+        const char* left = CurPtr();
+        int         leftLine = CurLineNumber();
+        int         endLine;
+
+        token = NextTok();
+
+        switch( token )
+        {
+        case T_power:
+            symbol->SetPower();
+            NeedRIGHT();
+            break;
+
+        case T_extends:
+        {
+            token = NextTok();
+
+            if( !IsSymbol( token ) )
+            {
+                error.Printf(
+                    _( "Invalid symbol extends name in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                    CurSource().c_str(), CurLineNumber(), CurOffset() );
+                THROW_IO_ERROR( error );
+            }
+
+            wxString name = FromUTF8();
+            auto     it = aSymbolLibMap.find( name );
+
+            if( it == aSymbolLibMap.end() )
+            {
+                error.Printf(
+                    _( "No parent for extended symbol %s in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                    name.c_str(), CurSource().c_str(), CurLineNumber(), CurOffset() );
+                THROW_IO_ERROR( error );
+            }
+
+            symbol->SetParent( it->second );
+            NeedRIGHT();
+            break;
+        }
+
+        case T_property:
+        {
+            // Only the fields searched by the symbol chooser, the rest of the list is skipped
+            NeedSYMBOL();
+            wxString name = FromUTF8();
+            NeedSYMBOL();
+            wxString value = FromUTF8();
+            int      id = MANDATORY_FIELDS;
+
+            if( NextTok() == T_LEFT && NextTok() == T_id )
+                id = parseInt( "field ID" );
+
+            if( id == FOOTPRINT )
+            {
+                symbol->GetFootprintField().SetText( value );
+            }
+            else if( name == "ki_keywords" )
+            {
+                symbol->SetKeyWords( value );
+            }
+            else if( name == "ki_description" )
+            {
+                symbol->SetDescription( value );
+            }
+            else if( name == "ki_fp_filters" )
+            {
+                wxArrayString     filters;
+                wxStringTokenizer tokenizer( value );
+
+                while( tokenizer.HasMoreTokens() )
+                    filters.Add( tokenizer.GetNextToken() );
+
+                symbol->SetFootprintFilters( filters );
+            }
+
+            SkipListInPlace( left, leftLine, endLine );
+            break;
+        }
+
+        case T_symbol:
+            parseUnitName();
+
+            if( m_unit > symbol->GetUnitCount() )
+                symbol->SetUnitCount( m_unit, false );
+
+            m_unit = 1;
+            m_convert = 1;
+            SkipListInPlace( left, leftLine, endLine );
+            break;
+
+        default:
+            // Pin name and number options, and draw items which are not in a unit
+            SkipListInPlace( left, leftLine, endLine );
+            break;
+        }
+    }
+
+    m_symbolName.clear();
+
+    return symbol.release();
+}
+
+
 LIB_ITEM* SCH_SEXPR_PARSER::ParseDrawItem()
 {
     switch( CurTok() )
@@ -395,13 +570,10 @@ LIB_ITEM* SCH_SEXPR_PARSER::ParseDrawItem()
 
 double SCH_SEXPR_PARSER::parseDouble()
 {
-    char* tmp;
-
-    errno = 0;
-
-    double fval = strtod( CurText(), &tmp );
+    double      fval;
+    const char* tmp = DecimalToDouble( CurText(), fval );
 
-    if( errno )
+    if( !tmp )
     {
         wxString error;
         error.Printf( _( "Invalid floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -423,6 +595,32 @@ double SCH_SEXPR_PARSER::parseDouble()
 }
 
 
+int SCH_SEXPR_PARSER::parseInternalUnits()
+{
+    // Schematic internal units are 100nm, so the mm of the file convert to them by a power
+    // of ten.
+    static_assert( IU_PER_MM == 1e4, "SCH_SEXPR_PARSER expects 100nm internal units" );
+
+    long long value;
+
+    if( DecimalToScaledInt( CurText(), 4, value ) == CurText() )
+    {
+        wxString error;
+        error.Printf( _( "Missing floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      CurSource().c_str(), CurLineNumber(), CurOffset() );
+
+        THROW_IO_ERROR( error );
+    }
+
+    // Schematic internal units are represented as integers.  Any values that are
+    // larger or smaller than the schematic units represent undefined behavior for
+    // the system.  Limit values to the largest that can be displayed on the screen.
+    long long int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
+
+    return (int) Clamp<long long>( -int_limit, value, int_limit );
+}
+
+
 void SCH_SEXPR_PARSER::parseStroke( STROKE_PARAMS& aStroke )
 {
     wxCHECK_RET( CurTok() == T_stroke,
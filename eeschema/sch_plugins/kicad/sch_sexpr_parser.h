@@ -73,6 +73,21 @@ public:
 };
 
 
+/**
+ * The position of a symbol in a library file, see SCH_SEXPR_PARSER::ParseLibIndex().
+ */
+struct LIB_SYMBOL_LOCATION
+{
+    size_t m_start;         ///< Offset of the opening parenthesis of the symbol
+    size_t m_end;           ///< Offset just after its closing parenthesis
+    int    m_line;          ///< Line number of m_start
+};
+
+
+/// Locations of the symbols of a library file by symbol name
+typedef std::map<wxString, LIB_SYMBOL_LOCATION> LIB_SYMBOL_LOCATIONS;
+
+
 /**
  * Object to parser s-expression symbol library and schematic file formats.
  */
@@ -86,6 +101,15 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
 
     void parseHeader( TSCHEMATIC_T::T aHeaderType, int aFileVersion );
 
+    /// Parse the name of the symbol into m_symbolName and return its library identifier
+    LIB_ID parseSymbolName();
+
+    /// Parse the name of a unit of the current symbol into m_unit and m_convert
+    void parseUnitName();
+
+    /// Parse what ParseLibIndex() keeps of a symbol, skipping its graphic items
+    LIB_PART* parseSymbolSummary( LIB_PART_MAP& aSymbolLibMap );
+
     inline long parseHex()
     {
         NextTok();
@@ -105,7 +129,8 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
 
     /**
      * Parse the current token as an ASCII numeric string with possible leading
-     * whitespace into a double precision floating point number.
+     * whitespace into a double precision floating point number, in the C locale whatever
+     * the current locale is.
      *
      * @throw IO_ERROR if an error occurs attempting to convert the current token.
      * @return The result of the parsed token.
@@ -123,25 +148,20 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
         return parseDouble( GetTokenText( aToken ) );
     }
 
-    inline int parseInternalUnits()
-    {
-        auto retval = parseDouble() * IU_PER_MM;
-
-        // Schematic internal units are represented as integers.  Any values that are
-        // larger or smaller than the schematic units represent undefined behavior for
-        // the system.  Limit values to the largest that can be displayed on the screen.
-        double int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
-
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
-    }
+    /**
+     * Parse the current token, a length in mm, straight into internal units.  The value is
+     * never converted to floating point, so it is rounded exactly, and the result does not
+     * depend on the locale.
+     *
+     * @throw IO_ERROR if the current token is not a number.
+     * @return The length in internal units.
+     */
+    int parseInternalUnits();
 
     inline int parseInternalUnits( const char* aExpected )
     {
-        auto retval = parseDouble( aExpected ) * IU_PER_MM;
-
-        double int_limit = std::numeric_limits<int>::max() * 0.7071;
-
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
+        NeedNUMBER( aExpected );
+        return parseInternalUnits();
     }
 
     inline int parseInternalUnits( TSCHEMATIC_T::T aToken )
@@ -205,6 +225,18 @@ public:
 
     void ParseLib( LIB_PART_MAP& aSymbolLibMap );
 
+    /**
+     * Parse the summary of each symbol of a library into \a aSymbolLibMap, and its position in
+     * the file into \a aLocations.
+     *
+     * The summaries only hold what the symbol chooser shows and searches: the name, parent,
+     * unit count, power flag, description, keywords, footprint and footprint filters.  The
+     * graphic items are skipped without being tokenized, and a symbol is parsed from its
+     * location with ParseSymbol() when it is needed.  The library must be read from a
+     * #MAPPED_FILE_LINE_READER.
+     */
+    void ParseLibIndex( LIB_PART_MAP& aSymbolLibMap, LIB_SYMBOL_LOCATIONS& aLocations );
+
     LIB_PART* ParseSymbol( LIB_PART_MAP& aSymbolLibMap,
                            int aFileVersion = SEXPR_SYMBOL_LIB_FILE_VERSION );
 
@@ -234,6 +266,9 @@ public:
      * Return whether a version number, if any was parsed, was too recent
      */
     bool IsTooRecent() const;
+
+    /// The file version of the last parsed header
+    int GetRequiredVersion() const { return m_requiredVersion; }
 };
 
 #endif    // __SCH_SEXPR_PARSER_H__
@@ -291,6 +291,14 @@ class SCH_SEXPR_PLUGIN_CACHE
     wxFileName      m_libFileName;  // Absolute path and file name is required here.
     wxDateTime      m_fileModTime;
     LIB_PART_MAP    m_symbols;      // Map of names of #LIB_PART pointers.
+
+    // The symbols of m_symbols only holding the summary read by Load(), and where to parse
+    // them from in the file it read.
+    LIB_SYMBOL_LOCATIONS m_unparsed;
+    wxString        m_indexedFileName;
+    size_t          m_indexedSize;
+    int             m_indexedVersion;
+
     bool            m_isWritable;
     bool            m_isModified;
     int             m_versionMajor;
@@ -301,6 +309,12 @@ class SCH_SEXPR_PLUGIN_CACHE
                                    const char** aOutput );
     LIB_PART*       removeSymbol( LIB_PART* aAlias );
 
+    /// Parse the symbol \a aName, and its parent first, in place of their summaries
+    void            parseSymbol( const MAPPED_FILE_LINE_READER& aFile, const wxString& aName );
+
+    /// Parse the symbols \a aNames which are only summaries
+    void            parseSymbols( const std::vector<wxString>& aNames );
+
     static void     saveSymbolDrawItem( LIB_ITEM* aItem, OUTPUTFORMATTER& aFormatter,
                                         int aNestLevel );
     static void     saveArc( LIB_ARC* aArc, OUTPUTFORMATTER& aFormatter, int aNestLevel = 0 );
@@ -334,8 +348,23 @@ public:
     /// Save the entire library to file m_libFileName;
     void Save();
 
+    /**
+     * Read the summary of each symbol of the library file, and where it is in the file.  The
+     * symbols are parsed in full by GetSymbol() or ParseAllSymbols().
+     */
     void Load();
 
+    /**
+     * Return the symbol \a aName, parsing it in full if needed.  Parsing a symbol keeps its
+     * address.
+     *
+     * @return the symbol or NULL if the library has no symbol \a aName.
+     */
+    LIB_PART* GetSymbol( const wxString& aName );
+
+    /// Parse in full the symbols which are only summaries
+    void ParseAllSymbols();
+
     void AddSymbol( const LIB_PART* aPart );
 
     void DeleteSymbol( const wxString& aName );
@@ -391,8 +420,7 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
 {
     wxASSERT( !aFileName || aSchematic != nullptr );
 
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-    SCH_SHEET*  sheet;
+    SCH_SHEET* sheet;
 
     wxFileName fn = aFileName;
 
@@ -527,7 +555,7 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 
 void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
-    FILE_LINE_READER reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     SCH_SEXPR_PARSER parser( &reader );
 
@@ -539,7 +567,6 @@ void SCH_SEXPR_PLUGIN::LoadContent( LINE_READER& aReader, SCH_SHEET* aSheet, int
 {
     wxCHECK( aSheet, /* void */ );
 
-    LOCALE_IO toggle;
     SCH_SEXPR_PARSER parser( &aReader );
 
     parser.ParseSchematic( aSheet, true, aFileVersion );
@@ -1288,7 +1315,9 @@ SCH_SEXPR_PLUGIN_CACHE::SCH_SEXPR_PLUGIN_CACHE( const wxString& aFullPathAndFile
     m_fileName( aFullPathAndFileName ),
     m_libFileName( aFullPathAndFileName ),
     m_isWritable( true ),
-    m_isModified( false )
+    m_isModified( false ),
+    m_indexedSize( 0 ),
+    m_indexedVersion( SEXPR_SYMBOL_LIB_FILE_VERSION )
 {
     m_versionMajor = -1;
     m_versionMinor = -1;
@@ -1426,6 +1455,9 @@ LIB_PART* SCH_SEXPR_PLUGIN_CACHE::removeSymbol( LIB_PART* aPart )
 
 void SCH_SEXPR_PLUGIN_CACHE::AddSymbol( const LIB_PART* aPart )
 {
+    // Removing a root symbol moves its graphic items to the symbols derived from it
+    ParseAllSymbols();
+
     // aPart is cloned in PART_LIB::AddPart().  The cache takes ownership of aPart.
     wxString name = aPart->GetName();
     LIB_PART_MAP::iterator it = m_symbols.find( name );
@@ -1456,13 +1488,17 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
     wxLogTrace( traceSchLegacyPlugin, "Loading sexpr symbol library file \"%s\"",
                 m_libFileName.GetFullPath() );
 
-    FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+    MAPPED_FILE_LINE_READER reader( m_libFileName.GetFullPath() );
 
     SCH_SEXPR_PARSER parser( &reader );
 
-    parser.ParseLib( m_symbols );
+    parser.ParseLibIndex( m_symbols, m_unparsed );
     ++m_modHash;
 
+    m_indexedFileName = m_libFileName.GetFullPath();
+    m_indexedSize = reader.Size();
+    m_indexedVersion = parser.GetRequiredVersion();
+
     // Remember the file modification time of library file when the
     // cache snapshot was made, so that in a networked environment we will
     // reload the cache as needed.
@@ -1470,11 +1506,97 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
 }
 
 
+LIB_PART* SCH_SEXPR_PLUGIN_CACHE::GetSymbol( const wxString& aName )
+{
+    LIB_PART_MAP::iterator it = m_symbols.find( aName );
+
+    if( it == m_symbols.end() )
+        return nullptr;
+
+    if( m_unparsed.count( aName ) )
+        parseSymbols( { aName } );
+
+    return it->second;
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::ParseAllSymbols()
+{
+    std::vector<wxString> names;
+
+    for( const std::pair<const wxString, LIB_SYMBOL_LOCATION>& entry : m_unparsed )
+        names.push_back( entry.first );
+
+    parseSymbols( names );
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::parseSymbols( const std::vector<wxString>& aNames )
+{
+    std::unique_ptr<MAPPED_FILE_LINE_READER> file;
+
+    for( const wxString& name : aNames )
+    {
+        if( !m_unparsed.count( name ) )
+            continue;
+
+        if( !file )
+        {
+            file.reset( new MAPPED_FILE_LINE_READER( m_indexedFileName ) );
+
+            // The locations are only good in the file they were read from
+            if( file->Size() != m_indexedSize )
+            {
+                THROW_IO_ERROR( wxString::Format( _( "Library file \"%s\" changed since it "
+                                                     "was read." ),
+                                                  m_indexedFileName ) );
+            }
+        }
+
+        parseSymbol( *file, name );
+    }
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::parseSymbol( const MAPPED_FILE_LINE_READER& aFile,
+                                          const wxString& aName )
+{
+    LIB_SYMBOL_LOCATIONS::iterator location = m_unparsed.find( aName );
+    LIB_PART_MAP::iterator         it = m_symbols.find( aName );
+
+    if( location == m_unparsed.end() || it == m_symbols.end() )
+        return;
+
+    LIB_PART* summary = it->second;
+
+    // A derived symbol is drawn with the graphic items of its parent
+    if( PART_SPTR parent = summary->GetParent().lock() )
+        parseSymbol( aFile, parent->GetName() );
+
+    MAPPED_FILE_LINE_READER reader( aFile, aFile.Data() + location->second.m_start,
+                                    aFile.Data() + location->second.m_end,
+                                    location->second.m_line );
+    SCH_SEXPR_PARSER        parser( &reader );
+
+    parser.NeedLEFT();
+    parser.NextTok();
+
+    std::unique_ptr<LIB_PART> part( parser.ParseSymbol( m_symbols, m_indexedVersion ) );
+
+    // Copied over the summary, whose address the callers of the plugin may hold
+    *summary = *part;
+    m_unparsed.erase( location );
+}
+
+
 void SCH_SEXPR_PLUGIN_CACHE::Save()
 {
     if( !m_isModified )
         return;
 
+    // Before the file is overwritten
+    ParseAllSymbols();
+
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
     // Write through symlinks, don't replace them.
@@ -1981,6 +2103,8 @@ void SCH_SEXPR_PLUGIN_CACHE::saveText( LIB_TEXT* aText,
 
 void SCH_SEXPR_PLUGIN_CACHE::DeleteSymbol( const wxString& aSymbolName )
 {
+    ParseAllSymbols();
+
     LIB_PART_MAP::iterator it = m_symbols.find( aSymbolName );
 
     if( it == m_symbols.end() )
@@ -2064,8 +2188,6 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( wxArrayString&    aSymbolNameList,
                                            const wxString&   aLibraryPath,
                                            const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     bool powerSymbolsOnly = ( aProperties &&
@@ -2086,14 +2208,17 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( std::vector<LIB_PART*>& aSymbolList,
                                            const wxString&   aLibraryPath,
                                            const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
+    bool summariesOnly = ( aProperties &&
+                           aProperties->find( SYMBOL_LIB_TABLE::PropSummariesOnly ) != aProperties->end() );
     cacheLib( aLibraryPath );
 
+    if( !summariesOnly )
+        m_cache->ParseAllSymbols();
+
     const LIB_PART_MAP& symbols = m_cache->m_symbols;
 
     for( LIB_PART_MAP::const_iterator it = symbols.begin();  it != symbols.end();  ++it )
@@ -2107,18 +2232,11 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( std::vector<LIB_PART*>& aSymbolList,
 LIB_PART* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxString& aSymbolName,
                                         const PROPERTIES* aProperties )
 {
-    LOCALE_IO toggle;     // toggles on, then off, the C locale.
-
     m_props = aProperties;
 
     cacheLib( aLibraryPath );
 
-    LIB_PART_MAP::const_iterator it = m_cache->m_symbols.find( aSymbolName );
-
-    if( it == m_cache->m_symbols.end() )
-        return nullptr;
-
-    return it->second;
+    return m_cache->GetSymbol( aSymbolName );
 }
 
 
@@ -2242,7 +2360,6 @@ bool SCH_SEXPR_PLUGIN::IsSymbolLibWritable( const wxString& aLibraryPath )
 
 LIB_PART* SCH_SEXPR_PLUGIN::ParsePart( LINE_READER& aReader, int aFileVersion )
 {
-    LOCALE_IO toggle;     // toggles on, then off, the C locale.
     LIB_PART_MAP map;
     SCH_SEXPR_PARSER parser( &aReader );
 
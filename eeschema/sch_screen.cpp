@@ -50,7 +50,9 @@
 #include <sch_junction.h>
 #include <sch_line.h>
 #include <sch_marker.h>
+#include <sch_pin.h>
 #include <sch_sheet.h>
+#include <sch_sheet_pin.h>
 #include <sch_text.h>
 #include <schematic.h>
 #include <symbol_lib_table.h>
@@ -59,6 +61,7 @@
 #include <thread>
 #include <algorithm>
 #include <future>
+#include <unordered_set>
 
 // TODO(JE) Debugging only
 #include <profile.h>
@@ -205,6 +208,8 @@ void SCH_SCREEN::Clear( bool aFree )
         m_rtree.clear();
     }
 
+    m_danglingEnds.clear();
+
     // Clear the project settings
     m_virtualPageNumber = m_pageCount = 1;
 
@@ -999,18 +1004,274 @@ void SCH_SCREEN::GetSheets( std::vector<SCH_ITEM*>* aItems )
 }
 
 
-bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath )
+/**
+ * The end points of the items of a screen, hashed by grid cell.
+ *
+ * An item can only be connected to the end points at its own connection points, and to the
+ * wires and buses running through them, so it is enough to test it against the items having
+ * end points or segments in the same cells.
+ */
+class DANGLING_END_GRID
 {
-    std::vector< DANGLING_END_ITEM > endPoints;
-    bool hasStateChanged = false;
+public:
+    DANGLING_END_GRID( const std::vector<SCH_ITEM*>& aItems )
+    {
+        for( size_t ii = 0; ii < aItems.size(); ++ii )
+        {
+            m_firstEndPoint.push_back( m_endPoints.size() );
+            aItems[ii]->GetEndPoints( m_endPoints );
+
+            ForEachCell( m_endPoints.begin() + m_firstEndPoint.back(), m_endPoints.end(),
+                         [&]( long long aCell )
+                         {
+                             std::vector<size_t>& cellItems = m_cells[aCell];
+
+                             if( cellItems.empty() || cellItems.back() != ii )
+                                 cellItems.push_back( ii );
+                         } );
+        }
+
+        m_firstEndPoint.push_back( m_endPoints.size() );
+    }
+
+    /// The end points of the item of index \a aItem
+    std::vector<DANGLING_END_ITEM> GetEndPoints( size_t aItem ) const
+    {
+        return std::vector<DANGLING_END_ITEM>( m_endPoints.begin() + m_firstEndPoint[aItem],
+                                               m_endPoints.begin() + m_firstEndPoint[aItem + 1] );
+    }
+
+    /**
+     * Fill \a aList with the end points of the items which have end points or segments in the
+     * cells of \a aPoints.  The end points of each item stay together and in their order, as
+     * UpdateDanglingState() expects the two ends of wires and buses to follow each other.
+     */
+    void GetEndPointsAt( const std::vector<wxPoint>& aPoints,
+                         std::vector<DANGLING_END_ITEM>& aList ) const
+    {
+        std::vector<size_t> items;
+
+        for( const wxPoint& point : aPoints )
+        {
+            auto it = m_cells.find( CellAt( point ) );
+
+            if( it != m_cells.end() )
+                items.insert( items.end(), it->second.begin(), it->second.end() );
+        }
+
+        std::sort( items.begin(), items.end() );
+        items.erase( std::unique( items.begin(), items.end() ), items.end() );
+
+        aList.clear();
+
+        for( size_t item : items )
+        {
+            aList.insert( aList.end(), m_endPoints.begin() + m_firstEndPoint[item],
+                          m_endPoints.begin() + m_firstEndPoint[item + 1] );
+        }
+    }
+
+    /**
+     * Call \a aFunction with the cell of each end point in a range, and with all the cells
+     * crossed by the wires and buses, whose two ends follow each other.
+     */
+    template <typename ITER, typename FUNC>
+    static void ForEachCell( ITER aFirst, ITER aLast, FUNC aFunction )
+    {
+        for( ITER it = aFirst; it != aLast; ++it )
+        {
+            ITER next = it + 1;
+
+            if( ( it->GetType() == WIRE_START_END || it->GetType() == BUS_START_END )
+                    && next != aLast )
+            {
+                // Labels are connected to wires within 1 unit of them, see SCH_TEXT
+                wxPoint start = it->GetPosition();
+                wxPoint end = next->GetPosition();
+                int     x0 = cellCoord( std::min( start.x, end.x ) - 1 );
+                int     x1 = cellCoord( std::max( start.x, end.x ) + 1 );
+                int     y0 = cellCoord( std::min( start.y, end.y ) - 1 );
+                int     y1 = cellCoord( std::max( start.y, end.y ) + 1 );
+
+                for( int x = x0; x <= x1; ++x )
+                {
+                    for( int y = y0; y <= y1; ++y )
+                        aFunction( cellKey( x, y ) );
+                }
+
+                it = next;
+            }
+            else
+            {
+                aFunction( CellAt( it->GetPosition() ) );
+            }
+        }
+    }
+
+    static long long CellAt( const wxPoint& aPoint )
+    {
+        return cellKey( cellCoord( aPoint.x ), cellCoord( aPoint.y ) );
+    }
+
+private:
+    static int cellCoord( int aCoord )
+    {
+        static const int cellSize = Mils2iu( 500 );
+
+        // Rounded down, also for negative coordinates
+        return aCoord >= 0 ? aCoord / cellSize : -( ( -( aCoord + 1 ) ) / cellSize ) - 1;
+    }
+
+    static long long cellKey( int aX, int aY )
+    {
+        return (long long) ( ( (unsigned long long) (unsigned) aX << 32 ) | (unsigned) aY );
+    }
+
+    std::vector<DANGLING_END_ITEM>                     m_endPoints;
+    std::vector<size_t>                                m_firstEndPoint;  ///< by item, and end
+    std::unordered_map<long long, std::vector<size_t>> m_cells;          ///< items by cell
+};
+
+
+/**
+ * The positions at which UpdateDanglingState() looks for the end points of other items.
+ */
+static std::vector<wxPoint> getDanglingTestPoints( SCH_ITEM* aItem )
+{
+    std::vector<wxPoint> points;
+
+    switch( aItem->Type() )
+    {
+    case SCH_COMPONENT_T:
+        // All the pins are updated, not only those of the current unit and body style
+        for( std::unique_ptr<SCH_PIN>& pin : static_cast<SCH_COMPONENT*>( aItem )->GetRawPins() )
+            points.push_back( pin->GetPosition() );
+
+        break;
+
+    case SCH_SHEET_T:
+        for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+            points.push_back( pin->GetTextPos() );
+
+        break;
+
+    default:
+        points = aItem->GetConnectionPoints();
+        break;
+    }
+
+    return points;
+}
+
+
+bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath,
+                                   std::function<void( SCH_ITEM* )>* aChangedHandler )
+{
+    std::vector<SCH_ITEM*> items;
 
     for( SCH_ITEM* item : Items() )
-        item->GetEndPoints( endPoints );
+        items.push_back( item );
+
+    DANGLING_END_GRID              grid( items );
+    std::vector<DANGLING_END_ITEM> endPoints;
+    bool                           hasStateChanged = false;
+
+    m_danglingEnds.clear();
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        grid.GetEndPointsAt( getDanglingTestPoints( items[ii] ), endPoints );
+
+        if( items[ii]->UpdateDanglingState( endPoints, aPath ) )
+        {
+            if( aChangedHandler )
+                ( *aChangedHandler )( items[ii] );
+
+            hasStateChanged = true;
+        }
+
+        m_danglingEnds[ items[ii] ] = grid.GetEndPoints( ii );
+    }
+
+    return hasStateChanged;
+}
+
+
+bool SCH_SCREEN::TestDanglingEnds( const std::vector<SCH_ITEM*>& aTouchedItems,
+                                   std::function<void( SCH_ITEM* )>* aChangedHandler )
+{
+    // Without a first test, there is nothing to compare with
+    if( m_danglingEnds.empty() )
+        return TestDanglingEnds( nullptr, aChangedHandler );
+
+    std::vector<SCH_ITEM*>                      items;
+    std::unordered_map<const SCH_ITEM*, size_t> indexes;
 
     for( SCH_ITEM* item : Items() )
     {
-        if( item->UpdateDanglingState( endPoints, aPath ) )
+        indexes[item] = items.size();
+        items.push_back( item );
+    }
+
+    DANGLING_END_GRID             grid( items );
+    std::vector<bool>             touched( items.size(), false );
+    std::unordered_set<long long> cells;    // where end points appeared or disappeared
+
+    auto addCell = [&]( long long aCell )
+                   {
+                       cells.insert( aCell );
+                   };
+
+    for( SCH_ITEM* item : aTouchedItems )
+    {
+        auto cached = m_danglingEnds.find( item );
+
+        if( cached != m_danglingEnds.end() )
+        {
+            DANGLING_END_GRID::ForEachCell( cached->second.begin(), cached->second.end(),
+                                            addCell );
+            m_danglingEnds.erase( cached );
+        }
+
+        auto index = indexes.find( item );
+
+        if( index != indexes.end() )
+        {
+            std::vector<DANGLING_END_ITEM> itemEndPoints = grid.GetEndPoints( index->second );
+
+            DANGLING_END_GRID::ForEachCell( itemEndPoints.begin(), itemEndPoints.end(),
+                                            addCell );
+            touched[index->second] = true;
+            m_danglingEnds[item] = std::move( itemEndPoints );
+        }
+    }
+
+    std::vector<DANGLING_END_ITEM> endPoints;
+    bool                           hasStateChanged = false;
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        std::vector<wxPoint> points = getDanglingTestPoints( items[ii] );
+
+        if( !touched[ii] && std::none_of( points.begin(), points.end(),
+                                          [&]( const wxPoint& aPoint )
+                                          {
+                                              return cells.count(
+                                                      DANGLING_END_GRID::CellAt( aPoint ) );
+                                          } ) )
+        {
+            continue;
+        }
+
+        grid.GetEndPointsAt( points, endPoints );
+
+        if( items[ii]->UpdateDanglingState( endPoints ) )
+        {
+            if( aChangedHandler )
+                ( *aChangedHandler )( items[ii] );
+
             hasStateChanged = true;
+        }
     }
 
     return hasStateChanged;
@@ -25,8 +25,10 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <functional>
 #include <memory>
 #include <stddef.h>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <wx/arrstr.h>
@@ -113,6 +115,9 @@ private:
     wxPoint     m_aux_origin;        // Origin used for drill & place files by PCBNew
     EE_RTREE    m_rtree;
 
+    /// The end points of each item at the last dangling end test
+    std::unordered_map<const SCH_ITEM*, std::vector<DANGLING_END_ITEM>> m_danglingEnds;
+
     int         m_modification_sync; // inequality with PART_LIBS::GetModificationHash() will
                                      //   trigger ResolveAll().
 
@@ -318,10 +323,31 @@ public:
 
     /**
      * Test all of the connectable objects in the schematic for unused connection points.
+     *
+     * The end points are hashed by position, so that each item is only tested against the
+     * end points at its own connection points and the wires and buses running through them.
+     *
      * @param aPath is a sheet path to pass to UpdateDanglingState if desired
+     * @param aChangedHandler is called for each item whose dangling state changed
+     * @return True if any connection state changes were made.
+     */
+    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr,
+                           std::function<void( SCH_ITEM* )>* aChangedHandler = nullptr );
+
+    /**
+     * Test for unused connection points only the items which \a aTouchedItems may have
+     * connected or disconnected since the last test: the touched items themselves, and the
+     * items at their end points now or at the last test.
+     *
+     * Every item added, removed or changed since the last test must be in \a aTouchedItems.
+     * The removed ones are not dereferenced.
+     *
+     * @param aTouchedItems are the items added, removed or changed since the last test.
+     * @param aChangedHandler is called for each item whose dangling state changed
      * @return True if any connection state changes were made.
      */
-    bool TestDanglingEnds( const SCH_SHEET_PATH* aPath = nullptr );
+    bool TestDanglingEnds( const std::vector<SCH_ITEM*>& aTouchedItems,
+                           std::function<void( SCH_ITEM* )>* aChangedHandler = nullptr );
 
     /**
      * Return all wires and junctions connected to \a aSegment which are not connected any
@@ -338,6 +338,9 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                 break;
             }
 
+            // The connection graph reuses the connectivity of screens without dirty items
+            item->SetConnectivityDirty();
+
             if( item != &Schematic().Root() )
                 AddToScreen( item, (SCH_SCREEN*) aList->GetScreenForItem( (unsigned) ii ) );
         }
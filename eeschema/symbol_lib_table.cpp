@@ -42,6 +42,7 @@ static const wxString global_tbl_name( "sym-lib-table" );
 
 const char* SYMBOL_LIB_TABLE::PropPowerSymsOnly = "pwr_sym_only";
 const char* SYMBOL_LIB_TABLE::PropNonPowerSymsOnly = "non_pwr_sym_only";
+const char* SYMBOL_LIB_TABLE::PropSummariesOnly = "summaries_only";
 int SYMBOL_LIB_TABLE::m_modifyHash = 1;     // starts at 1 and goes up
 
 
@@ -317,7 +318,8 @@ SYMBOL_LIB_TABLE_ROW* SYMBOL_LIB_TABLE::FindRow( const wxString& aNickname )
 
 
 void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_PART*>& aSymbolList,
-                                      const wxString& aNickname, bool aPowerSymbolsOnly )
+                                      const wxString& aNickname, bool aPowerSymbolsOnly,
+                                      bool aSummariesOnly )
 {
     SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname );
     wxCHECK( row && row->plugin, /* void */  );
@@ -327,11 +329,14 @@ void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_PART*>& aSymbolList,
     if( aPowerSymbolsOnly )
         row->SetOptions( row->GetOptions() + " " + PropPowerSymsOnly );
 
+    if( aSummariesOnly )
+        row->SetOptions( row->GetOptions() + " " + PropSummariesOnly );
+
     row->SetLoaded( false );
     row->plugin->EnumerateSymbolLib( aSymbolList, row->GetFullURI( true ), row->GetProperties() );
     row->SetLoaded( true );
 
-    if( aPowerSymbolsOnly )
+    if( aPowerSymbolsOnly || aSummariesOnly )
         row->SetOptions( options );
 
     // The library cannot know its own name, because it might have been renamed or moved.
@@ -119,6 +119,7 @@ public:
 
     static const char* PropPowerSymsOnly;
     static const char* PropNonPowerSymsOnly;
+    static const char* PropSummariesOnly;
 
     virtual void Parse( LIB_TABLE_LEXER* aLexer ) override;
 
@@ -165,8 +166,18 @@ public:
     void EnumerateSymbolLib( const wxString& aNickname, wxArrayString& aAliasNames,
                              bool aPowerSymbolsOnly = false );
 
+    /**
+     * Load the symbols of the library given by @a aNickname.
+     *
+     * @param aPowerSymbolsOnly is a flag to load only power symbols.
+     * @param aSummariesOnly allows the plugin to only read what the symbol chooser shows of
+     *                       each symbol: its name, description, keywords, unit count and
+     *                       footprint.  Each symbol is read in full by LoadSymbol().
+     *
+     * @throw IO_ERROR if the library cannot be found or loaded.
+     */
     void LoadSymbolLib( std::vector<LIB_PART*>& aAliasList, const wxString& aNickname,
-                        bool aPowerSymbolsOnly = false );
+                        bool aPowerSymbolsOnly = false, bool aSummariesOnly = false );
 
     /**
      * Load a #LIB_PART having @a aName from the library given by @a aNickname.
@@ -98,7 +98,8 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 
     try
     {
-        m_libs->LoadSymbolLib( symbols, aLibNickname, onlyPowerSymbols );
+        // The tree only needs the summaries, the symbols are loaded when previewed or placed
+        m_libs->LoadSymbolLib( symbols, aLibNickname, onlyPowerSymbols, true );
     }
     catch( const IO_ERROR& ioe )
     {
@@ -595,7 +595,7 @@ int SCH_EDIT_TOOL::Rotate( const TOOL_EVENT& aEvent )
             m_toolMgr->RunAction( EE_ACTIONS::clearSelection, true );
 
         if( connections )
-            m_frame->TestDanglingEnds();
+            m_frame->TestDanglingEndsOfLastChange();
 
         m_frame->OnModify();
     }
@@ -782,7 +782,7 @@ int SCH_EDIT_TOOL::Mirror( const TOOL_EVENT& aEvent )
             m_toolMgr->RunAction( EE_ACTIONS::clearSelection, true );
 
         if( connections )
-            m_frame->TestDanglingEnds();
+            m_frame->TestDanglingEndsOfLastChange();
 
         m_frame->OnModify();
     }
@@ -976,7 +976,7 @@ int SCH_EDIT_TOOL::RepeatDrawItem( const TOOL_EVENT& aEvent )
 
         m_toolMgr->RunAction( EE_ACTIONS::addNeededJunctions, true, &selection );
         m_frame->SchematicCleanUp();
-        m_frame->TestDanglingEnds();
+        m_frame->TestDanglingEndsOfLastChange();
     }
 
     // newItem newItem, now that it has been moved, thus saving new position.
@@ -1086,7 +1086,7 @@ int SCH_EDIT_TOOL::DoDelete( const TOOL_EVENT& aEvent )
             m_frame->DeleteJunction( junction, appendToUndo );
     }
 
-    m_frame->TestDanglingEnds();
+    m_frame->TestDanglingEndsOfLastChange();
 
     m_frame->GetCanvas()->Refresh();
     m_frame->OnModify();
@@ -1668,7 +1668,7 @@ int SCH_EDIT_TOOL::ChangeTextType( const TOOL_EVENT& aEvent )
                 }
             }
             else
-                m_frame->TestDanglingEnds();
+                m_frame->TestDanglingEndsOfLastChange();
 
             m_frame->OnModify();
         }
@@ -1690,7 +1690,7 @@ int SCH_EDIT_TOOL::BreakWire( const TOOL_EVENT& aEvent )
         if( m_frame->GetScreen()->IsJunctionNeeded( cursorPos, true ) )
             m_frame->AddJunction( m_frame->GetScreen(), cursorPos, true, false );
 
-        m_frame->TestDanglingEnds();
+        m_frame->TestDanglingEndsOfLastChange();
 
         m_frame->OnModify();
         m_frame->GetCanvas()->Refresh();
@@ -1180,7 +1180,7 @@ int SCH_EDITOR_CONTROL::Undo( const TOOL_EVENT& aEvent )
     selTool->RebuildSelection();
 
     m_frame->SetSheetNumberAndCount();
-    m_frame->TestDanglingEnds();
+    m_frame->TestDanglingEnds( *List );
 
     m_frame->OnPageSettingsChange();
     m_frame->SyncView();
@@ -1213,7 +1213,7 @@ int SCH_EDITOR_CONTROL::Redo( const TOOL_EVENT& aEvent )
     selTool->RebuildSelection();
 
     m_frame->SetSheetNumberAndCount();
-    m_frame->TestDanglingEnds();
+    m_frame->TestDanglingEnds( *List );
 
     m_frame->OnPageSettingsChange();
     m_frame->SyncView();
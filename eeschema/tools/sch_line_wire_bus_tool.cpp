@@ -921,7 +921,7 @@ void SCH_LINE_WIRE_BUS_TOOL::finishSegments()
     if( m_busUnfold.in_progress )
         m_busUnfold = {};
 
-    m_frame->TestDanglingEnds();
+    m_frame->TestDanglingEndsOfLastChange();
     m_toolMgr->PostEvent( EVENTS::SelectedItemsModified );
 
     m_frame->OnModify();
@@ -489,7 +489,7 @@ int SCH_MOVE_TOOL::Main( const TOOL_EVENT& aEvent )
         m_selectionTool->RemoveItemsFromSel( &m_dragAdditions, QUIET_MODE );
 
         m_frame->SchematicCleanUp();
-        m_frame->TestDanglingEnds();
+        m_frame->TestDanglingEndsOfLastChange();
 
         m_frame->OnModify();
     }
@@ -856,7 +856,7 @@ int SCH_MOVE_TOOL::AlignElements( const TOOL_EVENT& aEvent )
     m_toolMgr->RunAction( EE_ACTIONS::addNeededJunctions, true, &selection );
 
     m_frame->SchematicCleanUp();
-    m_frame->TestDanglingEnds();
+    m_frame->TestDanglingEndsOfLastChange();
 
     m_frame->OnModify();
     return 0;
@@ -147,6 +147,38 @@ public:
      */
     bool m_SkipBoundingBoxOnFpLoad;
 
+    /**
+     * The most footprints a KiCad footprint library cache keeps parsed in memory.  The least
+     * recently used ones are dropped past it, and parsed again if asked for.  0 is no limit.
+     */
+    int m_FootprintCacheSize;
+
+    /**
+     * When true, re-running DRC only re-checks items changed since the last full run
+     * (and their neighbours) using the locally-scoped test providers.
+     */
+    bool m_IncrementalDRC;
+
+    /**
+     * Cached items smaller than this on screen are drawn by the OpenGL canvas from a coarse
+     * variant, with fewer arc segments and texts drawn as bars.  Units are pixels; 0 disables
+     * the coarse variants.
+     */
+    int m_CoarseItemPixels;
+
+    /**
+     * Number of cached vertices the OpenGL canvas may move after each update to gather the
+     * free space of its vertex buffer, instead of defragmenting all of it when it runs out of
+     * large enough chunks.  0 disables the compaction.
+     */
+    int m_CacheCompactVertices;
+
+    /**
+     * Number of threads rasterizing the Cairo canvas, each in its own bands of the view.
+     * 0 uses all the cores, 1 draws everything on the GUI thread.
+     */
+    int m_CairoRasterThreads;
+
 private:
     ADVANCED_CFG();
 
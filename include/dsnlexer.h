@@ -50,6 +50,9 @@ struct KEYWORD
 //#define TOKDEF(x)    { #x, T_##x }
 
 
+class KEYWORD_INDEX;
+
+
 /**
  * Enum DSN_SYNTAX_T
  * lists all the DSN lexer's tokens that are supported in lexing.  It is up
@@ -90,6 +93,8 @@ protected:
 
     READER_STACK        readerStack;            ///< all the LINE_READERs by pointer.
     LINE_READER*        reader;                 ///< no ownership. ownership is via readerStack, maybe, if iOwnReaders
+    MAPPED_FILE_LINE_READER* mappedReader;      ///< reader, if its lines are lexed in place
+    std::string         inPlaceLine;            ///< copy of an in place line, for CurLine()
 
     bool                specctraMode;           ///< if true, then:
                                                 ///< 1) stringDelimiter can be changed
@@ -110,13 +115,28 @@ protected:
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_INDEX* keywordIndex;          ///< perfect hash of keywords, shared by lexers
 
     void init();
 
     int readLine()
     {
-        if( reader )
+        if( mappedReader )
+        {
+            // Lex straight from the mapped file, without copying the line
+            unsigned len;
+
+            start = mappedReader->NextLineInPlace( len );
+
+            if( !start )
+                start = dummy;
+
+            next  = start;
+            limit = next + len;
+
+            return len;
+        }
+        else if( reader )
         {
             reader->ReadLine();
 
@@ -144,6 +164,12 @@ protected:
      */
     int findToken( const std::string& aToken );
 
+    /**
+     * Function findToken
+     * looks up the keyword in the text range [aStart, aEnd).
+     */
+    int findToken( const char* aStart, const char* aEnd );
+
     bool isStringTerminator( char cc )
     {
         if( !space_in_quoted_tokens && cc==' ' )
@@ -525,6 +551,13 @@ public:
      */
     const char* CurLine()
     {
+        if( mappedReader )
+        {
+            // The line is not nul terminated in the mapped file
+            inPlaceLine.assign( start, limit );
+            return inPlaceLine.c_str();
+        }
+
         return (const char*)(*reader);
     }
 
@@ -548,6 +581,31 @@ public:
     {
         return curOffset + 1;
     }
+
+    /**
+     * Function CurPtr
+     * returns the position of the current token in the file, if its lines are lexed in place
+     * from a MAPPED_FILE_LINE_READER.
+     * @return const char* - the current token within the mapped file, or NULL.
+     */
+    const char* CurPtr() const
+    {
+        return mappedReader ? start + curOffset : NULL;
+    }
+
+    /**
+     * Function SkipListInPlace
+     * skips the list opened by the DSN_LEFT at @a aLeft without tokenizing it, so that the
+     * next NextTok() returns the token after the list.  Only possible when the lines are
+     * lexed in place, and not in specctra mode.
+     *
+     * @param aLeft is the position of the DSN_LEFT, see CurPtr().
+     * @param aLeftLine is the line number of the DSN_LEFT.
+     * @param aEndLine is set to the line number of the DSN_RIGHT closing the list.
+     * @return const char* - the position just after the DSN_RIGHT closing the list.
+     * @throw IO_ERROR if the list is not closed before the end of the file.
+     */
+    const char* SkipListInPlace( const char* aLeft, int aLeftLine, int& aEndLine );
 };
 
 #endif  // DSNLEXER_H_
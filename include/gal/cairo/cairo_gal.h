@@ -31,6 +31,7 @@
 
 #include <map>
 #include <iterator>
+#include <vector>
 
 #include <cairo.h>
 
@@ -208,6 +209,15 @@ public:
     ///> @copydoc GAL::DrawGrid()
     void DrawGrid() override;
 
+    /**
+     * Sets the number of threads rasterizing the paths drawn to image surfaces, each in its
+     * own bands of the surface.
+     *
+     * @param aCount is the number of threads, 0 for all the cores, 1 to rasterize the paths
+     * as they are drawn.
+     */
+    void SetRasterThreadCount( int aCount );
+
 
 protected:
     // Geometric transforms according to the currentWorld2Screen transform matrix:
@@ -308,9 +318,52 @@ protected:
 
     std::vector<cairo_matrix_t> xformStack;
 
+    /// A path kept to be rasterized in the bands of the target
+    struct TILE_PATH
+    {
+        std::shared_ptr<cairo_path_t> path;         ///< Path in user coordinates
+        cairo_matrix_t      matrix;                 ///< User to device transformation
+        COLOR4D             color;                  ///< Color to fill or stroke with
+        cairo_operator_t    op;                     ///< Compositing operator
+        cairo_fill_rule_t   fillRule;
+        bool                stroke;                 ///< Stroked if true, filled otherwise
+        double              lineWidth;
+        cairo_line_cap_t    lineCap;
+        cairo_line_join_t   lineJoin;
+        double              top;                    ///< First device row covered
+        double              bottom;                 ///< Last device row covered
+    };
+
+    unsigned int            rasterThreadCount;      ///< Threads rasterizing the kept paths
+    cairo_t*                tileContext;            ///< Context the kept paths are drawn to
+    std::vector<TILE_PATH>  tilePaths;              ///< Paths to rasterize in the bands
+
     void flushPath();
     void storePath();                           ///< Store the actual path
 
+    /**
+     * Fills or strokes the current path with a color.  When several threads rasterize the
+     * image surfaces, the path is kept until flushTiles() instead of being rasterized at once.
+     *
+     * @param aColor is the color to fill or stroke with.
+     * @param aStroke strokes the path if true, fills it otherwise.
+     * @param aPreserve keeps the current path, which is cleared otherwise.
+     */
+    void drawPath( const COLOR4D& aColor, bool aStroke, bool aPreserve = false );
+
+    /**
+     * Rasterizes the kept paths.  The target is split in bands of rows, each one drawn by one
+     * of the threads with its own context and only the paths crossing it.
+     */
+    void flushTiles();
+
+    /**
+     * Rasterizes the kept paths that cross the rows of a band.
+     *
+     * @param aContext is the context of the band, its first row being aTop.
+     */
+    void drawTilePaths( cairo_t* aContext, int aTop, int aBottom ) const;
+
     /**
      * @brief Blits cursor into the current screen.
      */
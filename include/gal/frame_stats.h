@@ -0,0 +1,114 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef FRAME_STATS_H__
+#define FRAME_STATS_H__
+
+#include <cstddef>
+#include <vector>
+
+namespace KIGFX
+{
+/**
+ * Costs of drawing frames, collected by the VIEW and the GAL while they are set with
+ * GAL::SetFrameStats().  They add up until cleared, so that the caller chooses what a frame is.
+ *
+ * Times are in milliseconds.  GPU work is only accounted for when the driver blocks on it.
+ */
+struct FRAME_STATS
+{
+    /// Costs of drawing one layer
+    struct LAYER
+    {
+        int    m_layer;
+        double m_queryTime;         ///< Looking up the items of the view area in the R-tree
+        double m_drawTime;          ///< Drawing these items, or their cached groups
+        size_t m_itemCount;         ///< Items drawn
+    };
+
+    FRAME_STATS()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        m_updateTime = 0.0;
+        m_prepareTime = 0.0;
+        m_updatedItemCount = 0;
+        m_uploadTime = 0.0;
+        m_flushTime = 0.0;
+        m_compositeTime = 0.0;
+        m_presentTime = 0.0;
+        m_vertexCount = 0;
+        m_cacheMovedBytes = 0;
+        m_cacheFragmentation = 0.0;
+        m_layers.clear();
+    }
+
+    double GetQueryTime() const
+    {
+        double time = 0.0;
+
+        for( const LAYER& layer : m_layers )
+            time += layer.m_queryTime;
+
+        return time;
+    }
+
+    double GetDrawTime() const
+    {
+        double time = 0.0;
+
+        for( const LAYER& layer : m_layers )
+            time += layer.m_drawTime;
+
+        return time;
+    }
+
+    size_t GetItemCount() const
+    {
+        size_t count = 0;
+
+        for( const LAYER& layer : m_layers )
+            count += layer.m_itemCount;
+
+        return count;
+    }
+
+    double             m_updateTime;        ///< Caching again the changed items
+    double             m_prepareTime;       ///< Part of it building the item caches in parallel
+    size_t             m_updatedItemCount;  ///< Items cached again
+    double             m_uploadTime;        ///< Sending the changed cache to the GPU
+    double             m_flushTime;         ///< Rendering what was drawn into the targets
+    double             m_compositeTime;     ///< Blending the targets together
+    double             m_presentTime;       ///< Showing the result on screen
+    size_t             m_vertexCount;       ///< Cached vertices drawn (OpenGL only)
+    size_t             m_cacheMovedBytes;   ///< Cached vertex data moved (OpenGL only)
+    double             m_cacheFragmentation; ///< Of the free cache space after the last update
+    std::vector<LAYER> m_layers;            ///< Layers in the order they were drawn
+};
+
+} // namespace KIGFX
+
+#endif /* FRAME_STATS_H__ */
@@ -35,6 +35,7 @@
 
 #include <gal/color4d.h>
 #include <gal/definitions.h>
+#include <gal/frame_stats.h>
 #include <gal/stroke_font.h>
 #include <gal/gal_display_options.h>
 #include <newstroke_font.h>
@@ -527,6 +528,32 @@ public:
      */
     virtual void DrawGroup( int aGroupNumber ) {};
 
+    /**
+     * @brief Begin the coarse variant of an existing group, drawn instead of it when its items
+     * are only a few pixels large.
+     *
+     * Arcs and texts are drawn with less detail until the group is ended with EndGroup().
+     *
+     * @param aGroupNumber is the number of the group to simplify.
+     * @return false if coarse groups are not supported or the group does not exist.
+     */
+    virtual bool BeginCoarseGroup( int aGroupNumber ) { return false; };
+
+    /**
+     * @brief Draw the coarse variant of a stored group.
+     *
+     * @param aGroupNumber is the group number.
+     * @return false if the coarse variant has not been built yet, nothing is drawn then.
+     */
+    virtual bool DrawCoarseGroup( int aGroupNumber )
+    {
+        DrawGroup( aGroupNumber );
+        return true;
+    };
+
+    /// @brief Are the items drawn with less detail (see BeginCoarseGroup())?
+    bool IsCoarseGeometry() const { return isCoarseGeometry; }
+
     /**
      * @brief Changes the color used to draw the group.
      *
@@ -555,6 +582,16 @@ public:
      */
     virtual void ClearCache() {};
 
+    /**
+     * @brief Collect the costs of the next frames.
+     *
+     * @param aStats receives the costs until it is cleared by the caller, nullptr to stop.
+     */
+    void SetFrameStats( FRAME_STATS* aStats ) { frameStats = aStats; }
+
+    /// @brief Return where the costs of the frames are collected, nullptr if they are not.
+    FRAME_STATS* GetFrameStats() const { return frameStats; }
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -1038,6 +1075,9 @@ protected:
 
     bool               isFillEnabled;          ///< Is filling of graphic objects enabled ?
     bool               isStrokeEnabled;        ///< Are the outlines stroked ?
+    bool               isCoarseGeometry;       ///< Is a coarse group drawn?
+
+    FRAME_STATS*       frameStats;             ///< Costs of the frames, if collected
 
     COLOR4D            fillColor;              ///< The fill color
     COLOR4D            strokeColor;            ///< The color of the outlines
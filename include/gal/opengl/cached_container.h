@@ -66,6 +66,33 @@ public:
     ///> @copydoc VERTEX_CONTAINER::Clear()
     virtual void Clear() override;
 
+    /**
+     * Moves the items stored at the end of the container to the free chunks before them, so
+     * that the free space gathers at the end instead of being split between the items.  It
+     * may be called after each update to compact the container a bit at a time, rather than
+     * defragmenting all of it when an allocation does not fit.
+     *
+     * @param aMaxSize is the number of vertices that may be moved, the first item is moved
+     * regardless of its size.
+     * @return the number of vertices moved.
+     */
+    unsigned int Compact( unsigned int aMaxSize );
+
+    /**
+     * Returns the number of bytes moved to make room for the items or to compact the container,
+     * since it was created.
+     */
+    size_t GetMovedBytes() const
+    {
+        return m_movedBytes;
+    }
+
+    /**
+     * Returns the fragmentation of the free space: 0 when it is a single chunk, approaching 1
+     * as it is split into smaller chunks.
+     */
+    double GetFragmentation() const;
+
     /**
      * Returns handle to the vertex buffer. It might be negative if the buffer is not initialized.
      */
@@ -83,17 +110,23 @@ public:
     virtual void Unmap() override = 0;
 
 protected:
-    ///> Maps size of free memory chunks to their offsets
+    ///> Size & offset of free memory chunks, sorted by size and then by offset
     typedef std::pair<unsigned int, unsigned int> CHUNK;
-    typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
+    typedef std::set<CHUNK> FREE_CHUNK_MAP;
 
-    /// List of all the stored items
-    typedef std::set<VERTEX_ITEM*> ITEMS;
+    ///> Maps offsets of free memory chunks to their size
+    typedef std::map<unsigned int, unsigned int> FREE_CHUNK_OFFSETS;
+
+    /// Maps offsets of the stored items to the items
+    typedef std::map<unsigned int, VERTEX_ITEM*> ITEMS;
 
     ///> Stores size & offset of free chunks.
     FREE_CHUNK_MAP  m_freeChunks;
 
-    ///> Stored VERTEX_ITEMs
+    ///> Stores the same free chunks, to find the neighbours of a chunk
+    FREE_CHUNK_OFFSETS m_freeChunkOffsets;
+
+    ///> Stored VERTEX_ITEMs, except the currently modified one
     ITEMS m_items;
 
     ///> Currently modified item
@@ -106,6 +139,9 @@ protected:
     ///> Maximal vertex index number stored in the container
     unsigned int m_maxIndex;
 
+    ///> Bytes moved to make room for the items or to compact the container
+    size_t m_movedBytes;
+
     /**
      * Resizes the chunk that stores the current item to the given size. The current item has
      * its offset adjusted after the call, and the new chunk parameters are stored
@@ -133,10 +169,11 @@ protected:
     void defragment( VERTEX* aTarget );
 
     /**
-     * Looks for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * Updates the items and the free chunks after the items were moved to the beginning of the
+     * container in the order of their offsets, leaving a single free chunk at the end.  To be
+     * called once m_freeSpace and m_currentSize are set for the new container.
      */
-    void mergeFreeChunks();
+    void resetChunks();
 
     /**
      * Returns the size of a chunk.
@@ -159,10 +196,15 @@ protected:
     }
 
     /**
-     * Adds a chunk marked as a free space.
+     * Adds a chunk marked as a free space, merged with the free chunks next to it.
      */
     void addFreeChunk( unsigned int aOffset, unsigned int aSize );
 
+    /**
+     * Removes a chunk from the free space.
+     */
+    void removeFreeChunk( unsigned int aOffset, unsigned int aSize );
+
 private:
     /// Debug & test functions
     void showFreeChunks();
@@ -210,6 +210,12 @@ public:
     /// @copydoc GAL::DrawGroup()
     void DrawGroup( int aGroupNumber ) override;
 
+    /// @copydoc GAL::BeginCoarseGroup()
+    bool BeginCoarseGroup( int aGroupNumber ) override;
+
+    /// @copydoc GAL::DrawCoarseGroup()
+    bool DrawCoarseGroup( int aGroupNumber ) override;
+
     /// @copydoc GAL::ChangeGroupColor()
     void ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor ) override;
 
@@ -286,6 +292,7 @@ private:
 
     static const int    CIRCLE_POINTS   = 64;   ///< The number of points for circle approximation
     static const int    CURVE_POINTS    = 32;   ///< The number of points for curve approximation
+    static const int    COARSE_CIRCLE_POINTS = 16;  ///< The number of points for coarse circles
 
     static wxGLContext*     glMainContext;      ///< Parent OpenGL context
     wxGLContext*            glPrivContext;      ///< Canvas-specific OpenGL context
@@ -298,6 +305,7 @@ private:
     // Vertex buffer objects related fields
     typedef std::unordered_map< unsigned int, std::shared_ptr<VERTEX_ITEM> > GROUPS_MAP;
     GROUPS_MAP              groups;                 ///< Stores informations about VBO objects (groups)
+    GROUPS_MAP              coarseGroups;           ///< Coarse variants of the groups, by group number
     unsigned int            groupCounter;           ///< Counter used for generating keys for groups
     VERTEX_MANAGER*         currentManager;         ///< Currently used VERTEX_MANAGER (for storing VERTEX_ITEMs)
     VERTEX_MANAGER*         cachedManager;          ///< Container for storing cached VERTEX_ITEMs
@@ -475,7 +483,8 @@ private:
     double calcAngleStep( double aRadius ) const
     {
         // Bigger arcs need smaller alpha increment to make them look smooth
-        return std::min( 1e6 / aRadius, 2.0 * M_PI / CIRCLE_POINTS );
+        return std::min( 1e6 / aRadius,
+                         2.0 * M_PI / ( isCoarseGeometry ? COARSE_CIRCLE_POINTS : CIRCLE_POINTS ) );
     }
 
     double getWorldPixelSize() const;
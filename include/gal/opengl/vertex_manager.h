@@ -329,6 +329,24 @@ public:
      */
     void Clear() const;
 
+    /**
+     * Function Compact()
+     * moves the last stored items to the free spaces before them, so the free space of a cached
+     * container does not get split into chunks too small to be reused.
+     * @param aMaxSize is the number of vertices that may be moved.
+     */
+    void Compact( unsigned int aMaxSize ) const;
+
+    /**
+     * Returns the number of bytes moved in a cached container since it was created.
+     */
+    size_t GetMovedBytes() const;
+
+    /**
+     * Returns the fragmentation of the free space of a cached container, between 0 and 1.
+     */
+    double GetFragmentation() const;
+
     /**
      * Function BeginDrawing()
      * prepares buffers and items to start drawing.
@@ -108,6 +108,29 @@ std::string EscapedUTF8( wxString aString );
  */
 wxString EscapedHTML( const wxString& aString );
 
+/**
+ * Convert the decimal number at the start of \a aText to a double, like strtod() does in
+ * the C locale.  Unlike strtod(), the result does not depend on the current locale, and no
+ * memory is allocated for the usual numbers of the file formats, so that files can be read
+ * from several threads without LOCALE_IO.
+ *
+ * @param aText is the text to convert, leading whitespace is skipped.
+ * @param aValue is set to the number.
+ * @return the first character after the number, \a aText if there is no number, or nullptr
+ *         if the number is out of the range of a double.
+ */
+const char* DecimalToDouble( const char* aText, double& aValue );
+
+/**
+ * Convert the decimal number at the start of \a aText multiplied by 10^\a aScale to the
+ * nearest integer, halves rounding away from zero.  The number is never converted to a
+ * floating point value, so the result is exact: "1.0000005" with a scale of 6 gives 1000001.
+ * Results out of the range of a long long saturate.
+ *
+ * @return the first character after the number, or \a aText if there is no number.
+ */
+const char* DecimalToScaledInt( const char* aText, int aScale, long long& aValue );
+
 /**
  * Read one line line from \a aFile.
  *
@@ -25,7 +25,7 @@
 #include <functional>
 #include <map>
 #include <string>
-#include <stack>
+#include <vector>
 
 #include <base_units.h>
 
@@ -240,6 +240,25 @@ public:
             m_valueStr = val.m_valueStr;
     }
 
+    ///> As above, but takes the string over rather than copying it.
+    void Set( VALUE&& val )
+    {
+        m_type = val.m_type;
+        m_valueDbl = val.m_valueDbl;
+
+        if( m_type == VT_STRING )
+            m_valueStr.swap( val.m_valueStr );
+    }
+
+    ///> Return to the default-constructed state, keeping any string buffer for reuse.
+    void Reset()
+    {
+        m_type = VT_UNDEFINED;
+        m_valueDbl = 0;
+        m_valueStr.clear();
+        m_stringIsWildcard = false;
+    }
+
 private:
     VAR_TYPE_T  m_type;
     double      m_valueDbl;
@@ -261,22 +280,48 @@ public:
 class CONTEXT
 {
 public:
+    CONTEXT() :
+        m_nextValue( 0 )
+    {}
+
     virtual ~CONTEXT()
     {
         for( VALUE* value : m_ownedValues )
             delete value;
     }
 
+    /**
+     * Return a value owned by the context.  Values are recycled by ResetValues(), so a
+     * context reused for many evaluations stops allocating once it has warmed up.
+     */
     VALUE* AllocValue()
     {
+        if( m_nextValue < m_ownedValues.size() )
+        {
+            VALUE* value = m_ownedValues[ m_nextValue++ ];
+            value->Reset();
+            return value;
+        }
+
         VALUE* value = new VALUE();
         m_ownedValues.push_back( value );
+        m_nextValue++;
         return value;
     }
 
+    /**
+     * Clear the stack and make all the values handed out by AllocValue() available again.
+     * Any previously returned values are invalidated.
+     */
+    void ResetValues()
+    {
+        m_stack.clear();
+        m_nextValue = 0;
+    }
+
     void Push( VALUE* v )
     {
-        m_stack.push( v );
+        m_stack.push_back( v );
     }
 
     VALUE* Pop()
@@ -287,8 +332,8 @@ public:
             return AllocValue();
         }
 
-        VALUE* value = m_stack.top();
-        m_stack.pop();
+        VALUE* value = m_stack.back();
+        m_stack.pop_back();
         return value;
     }
 
@@ -306,9 +351,17 @@ public:
     bool IsErrorPending() const { return m_errorStatus.pendingError; }
     const ERROR_STATUS& GetError() const { return m_errorStatus; }
 
+    ///> Forget the error of a previous evaluation, for a context which is reused.
+    void ClearError()
+    {
+        m_errorStatus.pendingError = false;
+        m_errorStatus.message.clear();
+    }
+
 private:
     std::vector<VALUE*> m_ownedValues;
-    std::stack<VALUE*>  m_stack;
+    size_t              m_nextValue;
+    std::vector<VALUE*> m_stack;
     ERROR_STATUS        m_errorStatus;
 
     std::function<void( const wxString& aMessage, int aOffset )> m_errorCallback;
@@ -325,9 +378,19 @@ public:
         m_ucode.push_back(uop);
     }
 
+    /**
+     * Evaluate the code.  The context's values and error are reset first, so the result of a
+     * previous Run() with the same context is no longer valid.
+     */
     VALUE* Run( CONTEXT* ctx );
     wxString Dump() const;
 
+    /**
+     * Replace operations whose operands are all constants with their result (for instance
+     * "1mm + 0.5mm" or "'a' == 'a'").
+     */
+    void FoldConstants();
+
     virtual std::unique_ptr<VAR_REF> CreateVarRef( const wxString& var, const wxString& field )
     {
         return nullptr;
@@ -374,6 +437,20 @@ public:
 
     wxString Format() const;
 
+    ///> @return true if the operation pushes a literal.
+    bool IsConstant() const { return m_op == TR_UOP_PUSH_VALUE && m_value; }
+
+    ///> @return the number of operands popped by a unary or binary operator, 0 otherwise.
+    int GetArity() const
+    {
+        if( m_op & TR_OP_BINARY_MASK )
+            return 2;
+        else if( m_op & TR_OP_UNARY_MASK )
+            return 1;
+        else
+            return 0;
+    }
+
 private:
     int                      m_op;
 
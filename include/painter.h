@@ -103,6 +103,15 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function PrepareDraw
+     * Builds the data cached by an item that Draw() would otherwise build, such as polygon
+     * triangulations.  It may be called from several threads at once for different items, so
+     * it must neither draw nor change the GAL state, and must only change the item itself.
+     * @param aItem is an item which is going to be drawn.
+     */
+    virtual void PrepareDraw( const VIEW_ITEM* aItem ) {}
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
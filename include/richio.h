@@ -248,6 +248,78 @@ public:
 };
 
 
+/**
+ * MAPPED_FILE_LINE_READER
+ * is a LINE_READER that maps a whole file into memory instead of reading it through a
+ * FILE.  Besides the usual ReadLine(), it can hand out the lines in place in the mapped
+ * file, which saves copying them when the caller does not need them nul terminated (e.g.
+ * DSNLEXER).
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    const char* m_data;     ///< the mapped file, not nul terminated
+    size_t      m_size;     ///< size of the mapped file
+    size_t      m_ndx;      ///< offset of the next line within m_data
+    void*       m_mapping;  ///< platform specific mapping handle
+    bool        m_ownsData; ///< false for a section of another reader's mapping
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * maps @a aFileName into memory.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aMaxLineLength is the maximum allowed line length.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or mapped.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * reads the section [@a aStart, @a aEnd) of the file mapped by @a aFile, which must
+     * outlive this reader.  Several sections of a file can so be read at the same time.
+     *
+     * @param aLineNumber is the line number of @a aStart in the file, for error reporting.
+     */
+    MAPPED_FILE_LINE_READER( const MAPPED_FILE_LINE_READER& aFile, const char* aStart,
+                             const char* aEnd, unsigned aLineNumber );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function NextLineInPlace
+     * advances to the next line like ReadLine(), but without copying it to the line buffer,
+     * which keeps its previous contents.
+     *
+     * @param aLength is set to the number of bytes in the line, including the newline.
+     * @return const char* - The beginning of the line within the mapped file (not nul
+     *  terminated), or NULL if EOF.
+     * @throw IO_ERROR when a line is too long.
+     */
+    const char* NextLineInPlace( unsigned& aLength );
+
+    /**
+     * Function Seek
+     * continues reading at @a aLine, the beginning of line number @a aLineNumber.
+     */
+    void Seek( const char* aLine, unsigned aLineNumber )
+    {
+        m_ndx = aLine - m_data;
+        m_lineNum = aLineNumber - 1;
+    }
+
+    const char* Data() const { return m_data; }
+
+    size_t Size() const { return m_size; }
+};
+
+
 /**
  * STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -308,6 +380,7 @@ public:
 
 
 #define OUTPUTFMTBUFZ    500        ///< default buffer size for any OUTPUT_FORMATTER
+#define FILEFMTBUFZ      ( 1 << 20 ) ///< write-behind buffer size of FILE_OUTPUTFORMATTER
 
 /**
  * OUTPUTFORMATTER
@@ -330,7 +403,6 @@ class OUTPUTFORMATTER
     std::vector<char>   m_buffer;
     char                quoteChar[2];
 
-    int sprint( const char* fmt, ... );
     int vprint( const char* fmt,  va_list ap );
 
 
@@ -397,6 +469,20 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... );
 
+    /**
+     * Function Write
+     * writes text to the output stream as is, for instance what was formatted beforehand
+     * into a STRING_FORMATTER.
+     *
+     * @param aText is the text to output.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Write( const std::string& aText )
+    {
+        if( !aText.empty() )
+            write( aText.data(), (int) aText.size() );
+    }
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -514,8 +600,9 @@ protected:
     void write( const char* aOutBuf, int aCount ) override;
     //-----</OUTPUTFORMATTER>-----------------------------------------------
 
-    FILE*       m_fp;               ///< takes ownership
-    wxString    m_filename;
+    FILE*             m_fp;               ///< takes ownership
+    wxString          m_filename;
+    std::vector<char> m_writeBuffer;      ///< the stdio buffer of m_fp, see FILEFMTBUFZ
 };
 
 
@@ -182,6 +182,13 @@ extern const wxChar* const traceSchSheetPaths;
  */
 extern const wxChar* const traceEnvVars;
 
+/**
+ * Flag to enable debug output of the costs of each frame drawn by the GAL canvases.
+ *
+ * Use "KICAD_GAL_FRAME_STATS" to enable.
+ */
+extern const wxChar* const traceGalFrameStats;
+
 ///@}
 
 /**
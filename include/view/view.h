@@ -691,6 +691,23 @@ public:
      */
     void SetPrintMode( int aPrintMode ) { m_printMode = aPrintMode; }
 
+    /**
+     * Sets the number of threads preparing the items of large updates (see
+     * PAINTER::PrepareDraw()).
+     *
+     * @param aCount is the number of threads, 0 for all the cores, 1 to prepare the items on
+     * the calling thread.
+     */
+    void SetPrepareThreadCount( int aCount ) { m_prepareThreadCount = aCount; }
+
+    /**
+     * Sets the screen size below which cached items are drawn from their coarse variant (see
+     * GAL::BeginCoarseGroup()).  The default is the CoarseItemPixels advanced setting.
+     *
+     * @param aPixels is the size in pixels, 0 to always draw the full groups.
+     */
+    void SetCoarseItemPixels( int aPixels ) { m_coarseItemPixels = aPixels; }
+
     static constexpr int VIEW_MAX_LAYERS = 512;      ///< maximum number of layers that may be shown
 
 protected:
@@ -779,6 +796,17 @@ protected:
     /// Updates all informations needed to draw an item
     void updateItemGeometry( VIEW_ITEM* aItem, int aLayer );
 
+    /// Builds the variant of an item drawn when it is small on screen
+    void updateItemCoarseGeometry( VIEW_ITEM* aItem, int aLayer );
+
+    /**
+     * Lets the painter build the item caches its Draw() needs (see PAINTER::PrepareDraw()),
+     * using several threads for large updates.  Only these caches are built in parallel: the
+     * vertices are still generated and cached item by item afterwards, from the calling
+     * thread.
+     */
+    void prepareItemGeometry( const std::vector<VIEW_ITEM*>& aItems );
+
     /// Updates bounding box of an item
     void updateBbox( VIEW_ITEM* aItem );
 
@@ -860,6 +888,12 @@ protected:
     /// m_printMode > 0 is a printing mode (currently means "we are in printing mode")
     int m_printMode;
 
+    /// Number of threads preparing the items of large updates, 0 for all the cores
+    int m_prepareThreadCount;
+
+    /// Screen size (in pixels) below which cached items are drawn coarse, 0 to disable it
+    int m_coarseItemPixels;
+
     VIEW( const VIEW& ) = delete;
 };
 } // namespace KIGFX
@@ -60,6 +60,7 @@ enum VIEW_UPDATE_FLAGS {
     LAYERS      = 0x08,     /// Layers have changed
     INITIAL_ADD = 0x10,     /// Item is being added to the view
     REPAINT     = 0x20,     /// Item needs to be redrawn
+    COARSE_GEOMETRY = 0x40, /// Item is small on screen and needs a coarse variant
     ALL         = 0xef      /// All except INITIAL_ADD
 };
 
@@ -113,7 +113,8 @@ public:
               m_arcs( aShape.m_arcs ),
               m_closed( aShape.m_closed ),
               m_width( aShape.m_width ),
-              m_bbox( aShape.m_bbox )
+              m_bbox( aShape.m_bbox ),
+              m_geometryStamp( aShape.m_geometryStamp )
     {}
 
     SHAPE_LINE_CHAIN( const std::vector<int>& aV);
@@ -175,6 +176,7 @@ public:
         m_arcs.clear();
         m_shapes.clear();
         m_closed = false;
+        geometryChanged();
     }
 
     /**
@@ -187,6 +189,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        geometryChanged();
     }
 
     /**
@@ -296,6 +299,7 @@ public:
             aIndex -= PointCount();
 
         m_points[aIndex] = aPos;
+        geometryChanged();
 
         if( m_shapes[aIndex] != SHAPE_IS_PT )
             convertArc( m_shapes[aIndex] );
@@ -432,6 +436,7 @@ public:
             m_points.push_back( aP );
             m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
             m_bbox.Merge( aP );
+            geometryChanged();
         }
     }
 
@@ -669,6 +674,8 @@ public:
 
         for( auto& arc : m_arcs )
             arc.Move( aVector );
+
+        geometryChanged();
     }
 
     /**
@@ -724,8 +731,23 @@ public:
     virtual size_t GetPointCount() const override { return PointCount(); }
     virtual size_t GetSegmentCount() const override { return SegmentCount(); }
 
+    /**
+     * Returns a non-zero number identifying the current geometry (points, arcs and closed
+     * state) of the chain, for caches derived from it.  Copies of the chain share its stamp
+     * until one of them is changed; a changed chain never gets a stamp it had before.
+     */
+    uint64_t GeometryStamp() const { return m_geometryStamp; }
+
 private:
 
+    ///> Must be called by every method changing the points, arcs or closed state
+    void geometryChanged()
+    {
+        m_geometryStamp = nextGeometryStamp();
+    }
+
+    static uint64_t nextGeometryStamp();
+
     constexpr static ssize_t SHAPE_IS_PT = -1;
 
     /// array of vertices
@@ -752,6 +774,9 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// see GeometryStamp()
+    uint64_t m_geometryStamp = nextGeometryStamp();
 };
 
 
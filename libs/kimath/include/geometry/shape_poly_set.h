@@ -26,6 +26,7 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <atomic>
 #include <cstdio>
 #include <deque>                        // for deque
 #include <vector>                       // for vector
@@ -291,7 +292,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             const T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].CPoint(
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CPoint(
                         m_currentVertex );
             }
 
@@ -414,7 +415,8 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CSegment(
+                        m_currentSegment );
             }
 
             T operator*()
@@ -637,6 +639,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            exposePolygon( aIndex );
             return m_polys[aIndex][0];
         }
 
@@ -659,12 +662,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            exposePolygon( aOutline );
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            exposePolygon( aIndex );
             return m_polys[aIndex];
         }
 
@@ -1118,6 +1123,23 @@ class SHAPE_POLY_SET : public SHAPE
 
         const BOX2I BBoxFromCaches() const;
 
+        /**
+         * Sets the number of edges from which Contains(), Collide() and the SquaredDistance()
+         * family stop walking every edge and use a spatial index of the edges instead.
+         *
+         * The index is built on demand, once a set has been queried a few times without being
+         * edited in between, and it is dropped by any editing action, including handing out a
+         * reference from Outline(), Hole() or Polygon().  As such a reference may still be held
+         * and edited later, queries check the geometry stamps of the contours of the polygons
+         * handed out (see SHAPE_LINE_CHAIN::GeometryStamp()) before trusting the index.
+         *
+         * @param aEdgeCount is the minimum number of edges in the set, or INT_MAX to never
+         *                   index.
+         */
+        static void SetEdgeIndexThreshold( int aEdgeCount );
+
+        static int GetEdgeIndexThreshold();
+
         /**
          * Returns true if a given subpolygon contains the point aP
          *
@@ -1331,6 +1353,10 @@ class SHAPE_POLY_SET : public SHAPE
         bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                              bool aUseBBoxCaches = false ) const;
 
+        ///> Returns false if aP is too far outside the cached bbox of the aSubpolyIndex-th
+        ///> outline to be inside the polygon (see BuildBBoxCaches())
+        bool outlineCacheContains( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy ) const;
+
         /**
          * Operations ChamferPolygon and FilletPolygon are computed under the private chamferFillet
          * method; this enum is defined to make the necessary distinction when calling this method
@@ -1362,6 +1388,58 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns true if the polygon set has any holes that touch share a vertex.
         bool hasTouchingHoles( const POLYGON& aPoly ) const;
 
+        class EDGE_INDEX;
+
+        /**
+         * Returns the spatial index of the edges of the set, building it if the set has been
+         * queried often enough since the last edit, or nullptr if queries should walk the
+         * edges.  Safe to call from several threads.
+         */
+        const EDGE_INDEX* edgeIndex() const;
+
+        ///> Drops the edge index.  Must be called by every method editing m_polys.
+        void invalidateEdgeIndex()
+        {
+            if( m_edgeIndex.load( std::memory_order_relaxed ) )
+            {
+                m_edgeIndex.store( nullptr, std::memory_order_relaxed );
+                m_edgeIndexOwner.reset();
+            }
+
+            m_edgeIndexQueries.store( 0, std::memory_order_relaxed );
+            m_edgeIndexStale.store( false, std::memory_order_relaxed );
+        }
+
+        /**
+         * Called when a non-const reference into the aIndex-th polygon is handed out.  It may be
+         * edited through the reference, so the edge index is dropped, and as the reference may
+         * be kept, later indexes are checked against the polygon before use.
+         */
+        void exposePolygon( int aIndex )
+        {
+            invalidateEdgeIndex();
+
+            if( aIndex >= (int) m_polygonExposed.size() )
+                m_polygonExposed.resize( aIndex + 1, false );
+
+            if( !m_polygonExposed[aIndex] )
+            {
+                m_polygonExposed[aIndex] = true;
+                m_exposedPolygons.push_back( aIndex );
+            }
+        }
+
+        ///> Forgets the polygons handed out so far.  Called when m_polys is rebuilt, as no
+        ///> reference into the old polygons can still be used.
+        void forgetExposedPolygons()
+        {
+            m_exposedPolygons.clear();
+            m_polygonExposed.clear();
+        }
+
+        ///> Shares the edge index of aOther, which has the same geometry as this set.
+        void shareEdgeIndex( const SHAPE_POLY_SET& aOther );
+
         typedef std::vector<POLYGON> POLYSET;
 
         POLYSET m_polys;
@@ -1389,6 +1467,19 @@ class SHAPE_POLY_SET : public SHAPE
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> Lazily built edge index; m_edgeIndex is published once m_edgeIndexOwner is set
+        mutable std::shared_ptr<const EDGE_INDEX> m_edgeIndexOwner;
+        mutable std::atomic<const EDGE_INDEX*>    m_edgeIndex{ nullptr };
+        mutable std::atomic<unsigned>             m_edgeIndexQueries{ 0 };
+
+        ///> Set once a query finds the index out of date with the contours
+        mutable std::atomic<bool>                 m_edgeIndexStale{ false };
+
+        ///> Polygons Outline(), Hole() or Polygon() have handed out a reference into, which
+        ///> may still be held (see exposePolygon())
+        std::vector<int>                          m_exposedPolygons;
+        std::vector<bool>                         m_polygonExposed;
+
 };
 
 #endif
@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <limits.h>          // for INT_MAX
 #include <math.h>            // for hypot
+#include <atomic>            // for atomic
 #include <string>            // for basic_string
 
 #include <clipper.hpp>
@@ -82,6 +83,7 @@ void SHAPE_LINE_CHAIN::convertArc( ssize_t aArcIndex )
     }
 
     m_arcs.erase( m_arcs.begin() + aArcIndex );
+    geometryChanged();
 }
 
 
@@ -149,6 +151,8 @@ void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 
     for( auto& arc : m_arcs )
         arc.Rotate( aAngle, aCenter );
+
+    geometryChanged();
 }
 
 
@@ -251,6 +255,8 @@ void SHAPE_LINE_CHAIN::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
     for( auto& arc : m_arcs )
         arc.Mirror( aX, aY, aRef );
+
+    geometryChanged();
 }
 
 
@@ -281,6 +287,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
         m_shapes.erase( m_shapes.begin() + aStartIndex + 1, m_shapes.begin() + aEndIndex + 1 );
     }
 
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -306,6 +313,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
     m_arcs.insert( m_arcs.end(), aLine.m_arcs.begin(), aLine.m_arcs.end() );
 
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -337,6 +345,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 
     m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -392,6 +401,7 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
         m_shapes.insert( m_shapes.begin() + ii + 1, ssize_t( SHAPE_IS_PT ) );
+        geometryChanged();
 
         return ii + 1;
     }
@@ -470,6 +480,7 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
         m_bbox.Merge( p );
     }
 
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -486,6 +497,7 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
     m_arcs.push_back( aArc );
 
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -498,6 +510,7 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
     m_points.insert( m_points.begin() + aVertex, aP );
     m_shapes.insert( m_shapes.begin() + aVertex, ssize_t( SHAPE_IS_PT ) );
 
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -528,6 +541,7 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
     /// Step 3: Add the vector of indices to the shape vector
     std::vector<size_t> new_points( chain.PointCount(), arc_pos );
     m_shapes.insert( m_shapes.begin() + aVertex, new_points.begin(), new_points.end() );
+    geometryChanged();
     assert( m_shapes.size() == m_points.size() );
 }
 
@@ -817,6 +831,8 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     std::vector<VECTOR2I> pts_unique;
     std::vector<ssize_t> shapes_unique;
 
+    geometryChanged();
+
     if( PointCount() < 2 )
     {
         return *this;
@@ -1014,11 +1030,21 @@ SHAPE* SHAPE_LINE_CHAIN::Clone() const
     return new SHAPE_LINE_CHAIN( *this );
 }
 
+
+uint64_t SHAPE_LINE_CHAIN::nextGeometryStamp()
+{
+    static std::atomic<uint64_t> s_nextStamp( 1 );
+
+    return s_nextStamp.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
 bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
 {
     size_t n_pts;
     size_t n_arcs;
 
+    geometryChanged();
     m_points.clear();
     aStream >> n_pts;
 
@@ -85,6 +85,8 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
         m_hash = MD5_HASH();
         m_triangulatedPolys.clear();
     }
+
+    shareEdgeIndex( aOther );
 }
 
 
@@ -156,7 +158,7 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
         for( unsigned int polygonIdx = 0; polygonIdx < selectedPolygon; polygonIdx++ )
         {
-            currentPolygon = Polygon( polygonIdx );
+            currentPolygon = CPolygon( polygonIdx );
 
             for( unsigned int contourIdx = 0; contourIdx < currentPolygon.size(); contourIdx++ )
             {
@@ -164,7 +166,7 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
             }
         }
 
-        currentPolygon = Polygon( selectedPolygon );
+        currentPolygon = CPolygon( selectedPolygon );
 
         for( unsigned int contourIdx = 0; contourIdx < selectedContour; contourIdx++ )
         {
@@ -184,6 +186,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -196,6 +200,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -213,6 +219,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -236,6 +244,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    invalidateEdgeIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -289,7 +299,7 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
     for( int index = aFirstPolygon; index < aLastPolygon; index++ )
     {
-        newPolySet.m_polys.push_back( Polygon( index ) );
+        newPolySet.m_polys.push_back( CPolygon( index ) );
     }
 
     return newPolySet;
@@ -421,6 +431,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -435,6 +447,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -624,6 +638,9 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    invalidateEdgeIndex();
+    forgetExposedPolygons();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -853,6 +870,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1040,6 +1059,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1064,7 +1085,9 @@ int SHAPE_POLY_SET::NormalizeAreaOutlines()
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
     // calculations, but it is not mandatory. It is used mainly
     // because there is usually only very few vertices in area outlines
-    SHAPE_POLY_SET::POLYGON& outline = Polygon( 0 );
+    invalidateEdgeIndex();
+
+    SHAPE_POLY_SET::POLYGON& outline = m_polys[0];
     SHAPE_POLY_SET holesBuffer;
 
     // Move holes stored in outline to holesBuffer:
@@ -1117,6 +1140,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateEdgeIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1268,12 +1293,17 @@ bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateEdgeIndex();
+    forgetExposedPolygons();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateEdgeIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1337,12 +1367,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateEdgeIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateEdgeIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1421,14 +1455,623 @@ bool SHAPE_POLY_SET::CollideEdge( const VECTOR2I& aPoint,
 }
 
 
+/// Number of edges from which a set gets an edge index.  See SetEdgeIndexThreshold().
+static int s_edgeIndexThreshold = 64;
+
+/// Number of queries a set has to answer between two edits before its edge index is built.
+/// Building the index costs about as much as a dozen queries walking all of the edges.
+static const unsigned EDGE_INDEX_MIN_QUERIES = 16;
+
+
+/**
+ * A uniform grid over the edges of a SHAPE_POLY_SET.  Each cell lists the edges passing
+ * through it, so point-in-polygon tests only look at the edges crossing the row of the point
+ * and nearest edge searches only at the cells around the query.
+ *
+ * The edges are stored as indices into the contours of the set, which is passed to each
+ * query, along with the geometry stamps of the contours so that an index can be checked
+ * against the set.  The index is never modified once built, so it can be queried from
+ * several threads and shared between copies of a set.
+ */
+class SHAPE_POLY_SET::EDGE_INDEX
+{
+public:
+    EDGE_INDEX( const SHAPE_POLY_SET& aSet );
+
+    ///> Returns true if the given polygons of aSet are still the ones the index was built from
+    bool IsUpToDate( const SHAPE_POLY_SET& aSet, const std::vector<int>& aPolygons ) const;
+
+    /**
+     * Returns true if querying the polygon through the index is faster than walking its
+     * edges.  A point-in-polygon test visits every edge of the row, whichever polygon it
+     * belongs to, so that is not the case for small polygons of a big set.
+     *
+     * @param aPolygon is the index of the polygon, or -1 for the whole set.
+     */
+    bool IsWorthwhile( int aPolygon ) const
+    {
+        return aPolygon < 0 || m_polygonEdgeCount[aPolygon] > m_edgesPerRow;
+    }
+
+    ///> Same as aSet.Contains(), restricted to aPolygon unless it is -1
+    bool Contains( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP, int aPolygon,
+                   int aAccuracy, bool aUseBBoxCaches ) const;
+
+    ///> Same as aSet.SquaredDistanceToPolygon(), over the whole set if aPolygon is -1
+    SEG::ecoord SquaredDistance( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP, int aPolygon,
+                                 VECTOR2I* aNearest ) const;
+
+    SEG::ecoord SquaredDistance( const SHAPE_POLY_SET& aSet, const SEG& aSeg, int aPolygon,
+                                 VECTOR2I* aNearest ) const;
+
+private:
+    struct CONTOUR
+    {
+        int      m_polygon;
+        int      m_index;       ///< 0 for the outline, hole index + 1 for holes
+        bool     m_hasInside;   ///< closed and with at least 3 points, see PointInside()
+        uint64_t m_stamp;       ///< SHAPE_LINE_CHAIN::GeometryStamp() of the contour
+    };
+
+    struct EDGE
+    {
+        int m_contour;
+        int m_segment;          ///< index of the segment in the contour
+    };
+
+    SEG segment( const SHAPE_POLY_SET& aSet, const EDGE& aEdge ) const
+    {
+        const CONTOUR& contour = m_contours[aEdge.m_contour];
+
+        return aSet.m_polys[contour.m_polygon][contour.m_index].CSegment( aEdge.m_segment );
+    }
+
+    int colOf( int64_t aX ) const
+    {
+        return Clamp<int64_t>( 0, ( aX - m_originX ) / m_cellSize, m_cols - 1 );
+    }
+
+    int rowOf( int64_t aY ) const
+    {
+        return Clamp<int64_t>( 0, ( aY - m_originY ) / m_cellSize, m_rows - 1 );
+    }
+
+    ///> Calls aFunc with the index of each cell aSeg passes through
+    template <typename FUNC>
+    void forEachCell( const SEG& aSeg, FUNC aFunc ) const;
+
+    ///> Returns the edge of aPolygon (or of any polygon if -1) minimizing aDist, or -1
+    template <typename DIST>
+    int nearestEdge( const SHAPE_POLY_SET& aSet, const BOX2I& aQuery, int aPolygon, DIST aDist,
+                     SEG::ecoord& aDistSq ) const;
+
+    std::vector<CONTOUR> m_contours;        ///< polygon by polygon, outline first
+    std::vector<int>     m_polygonContours; ///< offsets of each polygon in m_contours, plus end
+    std::vector<EDGE>    m_edges;
+    std::vector<int>     m_polygonEdgeCount;
+
+    std::vector<int>     m_cellStart;       ///< offsets of each cell in m_cellEdges, plus end
+    std::vector<int>     m_cellEdges;
+
+    int64_t              m_originX = 0;
+    int64_t              m_originY = 0;
+    int64_t              m_cellSize = 1;
+    int                  m_cols = 1;
+    int                  m_rows = 1;
+    int                  m_edgesPerRow = 0;
+};
+
+
+SHAPE_POLY_SET::EDGE_INDEX::EDGE_INDEX( const SHAPE_POLY_SET& aSet )
+{
+    m_polygonEdgeCount.resize( aSet.OutlineCount(), 0 );
+
+    int64_t minX = std::numeric_limits<int64_t>::max();
+    int64_t minY = minX;
+    int64_t maxX = std::numeric_limits<int64_t>::min();
+    int64_t maxY = maxX;
+
+    for( int polygonIdx = 0; polygonIdx < aSet.OutlineCount(); polygonIdx++ )
+    {
+        const POLYGON& polygon = aSet.CPolygon( polygonIdx );
+
+        m_polygonContours.push_back( m_contours.size() );
+
+        for( size_t contourIdx = 0; contourIdx < polygon.size(); contourIdx++ )
+        {
+            const SHAPE_LINE_CHAIN& chain = polygon[contourIdx];
+
+            m_contours.push_back( { polygonIdx, (int) contourIdx,
+                                    chain.IsClosed() && chain.PointCount() >= 3,
+                                    chain.GeometryStamp() } );
+
+            for( int ii = 0; ii < chain.SegmentCount(); ii++ )
+            {
+                const SEG seg = chain.CSegment( ii );
+
+                m_edges.push_back( { (int) m_contours.size() - 1, ii } );
+                m_polygonEdgeCount[polygonIdx]++;
+
+                minX = std::min<int64_t>( minX, std::min( seg.A.x, seg.B.x ) );
+                minY = std::min<int64_t>( minY, std::min( seg.A.y, seg.B.y ) );
+                maxX = std::max<int64_t>( maxX, std::max( seg.A.x, seg.B.x ) );
+                maxY = std::max<int64_t>( maxY, std::max( seg.A.y, seg.B.y ) );
+            }
+        }
+    }
+
+    m_polygonContours.push_back( m_contours.size() );
+
+    if( m_edges.empty() )
+    {
+        m_cellStart.assign( 2, 0 );
+        return;
+    }
+
+    // Aim at about two edges per square cell, but never more cells than edges along one
+    // side of a very thin set.
+    int64_t targetCells = std::max<int64_t>( 1, m_edges.size() / 2 );
+    int64_t width = maxX - minX;
+    int64_t height = maxY - minY;
+    double  area = double( std::max<int64_t>( width, 1 ) ) * std::max<int64_t>( height, 1 );
+
+    m_originX = minX;
+    m_originY = minY;
+    m_cellSize = std::max<int64_t>( std::ceil( std::sqrt( area / targetCells ) ),
+                                    std::max( width, height ) / targetCells + 1 );
+    m_cols = width / m_cellSize + 1;
+    m_rows = height / m_cellSize + 1;
+
+    m_cellStart.assign( (size_t) m_cols * m_rows + 1, 0 );
+
+    for( const EDGE& edge : m_edges )
+    {
+        forEachCell( segment( aSet, edge ),
+                     [&]( int aCell )
+                     {
+                         m_cellStart[aCell + 1]++;
+                     } );
+    }
+
+    for( size_t ii = 1; ii < m_cellStart.size(); ii++ )
+        m_cellStart[ii] += m_cellStart[ii - 1];
+
+    std::vector<int> next( m_cellStart.begin(), m_cellStart.end() - 1 );
+
+    m_cellEdges.resize( m_cellStart.back() );
+
+    for( size_t ii = 0; ii < m_edges.size(); ii++ )
+    {
+        forEachCell( segment( aSet, m_edges[ii] ),
+                     [&]( int aCell )
+                     {
+                         m_cellEdges[next[aCell]++] = ii;
+                     } );
+    }
+
+    m_edgesPerRow = m_cellEdges.size() / m_rows;
+}
+
+
+bool SHAPE_POLY_SET::EDGE_INDEX::IsUpToDate( const SHAPE_POLY_SET& aSet,
+                                             const std::vector<int>& aPolygons ) const
+{
+    // Polygons are only added or removed by the set itself, which drops the index
+    if( aSet.OutlineCount() + 1 != (int) m_polygonContours.size() )
+        return false;
+
+    for( int polygonIdx : aPolygons )
+    {
+        if( polygonIdx >= aSet.OutlineCount() )
+            continue;
+
+        const POLYGON& polygon = aSet.CPolygon( polygonIdx );
+        int            first = m_polygonContours[polygonIdx];
+
+        if( (int) polygon.size() != m_polygonContours[polygonIdx + 1] - first )
+            return false;
+
+        for( size_t ii = 0; ii < polygon.size(); ii++ )
+        {
+            if( m_contours[first + ii].m_stamp != polygon[ii].GeometryStamp() )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+template <typename FUNC>
+void SHAPE_POLY_SET::EDGE_INDEX::forEachCell( const SEG& aSeg, FUNC aFunc ) const
+{
+    VECTOR2I a = aSeg.A;
+    VECTOR2I b = aSeg.B;
+
+    if( a.y > b.y )
+        std::swap( a, b );
+
+    int lastRow = rowOf( b.y );
+
+    for( int row = rowOf( a.y ); row <= lastRow; row++ )
+    {
+        // Extent of the segment within the band of the row.  Widened by a couple of nm so
+        // that the rounding of the crossing points in Contains() always lands in a listed cell.
+        double top = std::max<double>( a.y, m_originY + row * m_cellSize );
+        double bottom = std::min<double>( b.y, m_originY + ( row + 1 ) * m_cellSize );
+        double left = std::min( a.x, b.x );
+        double right = std::max( a.x, b.x );
+
+        if( a.y != b.y )
+        {
+            double xTop = a.x + double( b.x - a.x ) * ( top - a.y ) / ( b.y - a.y );
+            double xBottom = a.x + double( b.x - a.x ) * ( bottom - a.y ) / ( b.y - a.y );
+
+            left = std::min( xTop, xBottom );
+            right = std::max( xTop, xBottom );
+        }
+
+        int lastCol = colOf( std::ceil( right ) + 2 );
+
+        for( int col = colOf( std::floor( left ) - 2 ); col <= lastCol; col++ )
+            aFunc( row * m_cols + col );
+    }
+}
+
+
+bool SHAPE_POLY_SET::EDGE_INDEX::Contains( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP,
+                                           int aPolygon, int aAccuracy,
+                                           bool aUseBBoxCaches ) const
+{
+    // Same ray casting as SHAPE_LINE_CHAIN_BASE::PointInside(), over the edges of the row of
+    // aP right of it.  An edge spanning several cells is counted in the cell holding its
+    // crossing point only.
+    std::vector<int> crossed;
+    int              row = rowOf( aP.y );
+
+    for( int col = colOf( aP.x ); col < m_cols; col++ )
+    {
+        int cell = row * m_cols + col;
+
+        for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+        {
+            const EDGE&    edge = m_edges[m_cellEdges[ii]];
+            const CONTOUR& contour = m_contours[edge.m_contour];
+
+            if( !contour.m_hasInside || ( aPolygon >= 0 && contour.m_polygon != aPolygon ) )
+                continue;
+
+            const SEG       seg = segment( aSet, edge );
+            const VECTOR2I& p1 = seg.A;
+            const VECTOR2I& p2 = seg.B;
+            const VECTOR2I  diff = p2 - p1;
+
+            if( diff.y == 0 || ( p1.y > aP.y ) == ( p2.y > aP.y ) )
+                continue;
+
+            const int d = rescale( diff.x, ( aP.y - p1.y ), diff.y );
+
+            if( aP.x - p1.x < d && colOf( (int64_t) p1.x + d ) == col )
+                crossed.push_back( edge.m_contour );
+        }
+    }
+
+    // Contours crossed an odd number of times contain aP
+    std::sort( crossed.begin(), crossed.end() );
+
+    std::vector<int> insideOutline;
+    std::vector<int> insideHole;
+
+    for( size_t ii = 0; ii < crossed.size(); )
+    {
+        size_t next = ii + 1;
+
+        while( next < crossed.size() && crossed[next] == crossed[ii] )
+            next++;
+
+        if( ( next - ii ) % 2 )
+        {
+            const CONTOUR& contour = m_contours[crossed[ii]];
+
+            if( contour.m_index > 0 )
+                insideHole.push_back( contour.m_polygon );
+            else
+                insideOutline.push_back( contour.m_polygon );
+        }
+
+        ii = next;
+    }
+
+    // As in PointInside(), points close enough to an outline count as inside it.  Holes are
+    // always tested with an accuracy of 1 by containsSingle().
+    if( aAccuracy > 1 )
+    {
+        BOX2I box( aP, VECTOR2I( 0, 0 ) );
+        box.Inflate( aAccuracy + 2 );
+
+        int lastRow = rowOf( box.GetBottom() );
+        int lastCol = colOf( box.GetRight() );
+
+        for( int r = rowOf( box.GetY() ); r <= lastRow; r++ )
+        {
+            for( int c = colOf( box.GetX() ); c <= lastCol; c++ )
+            {
+                int cell = r * m_cols + c;
+
+                for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+                {
+                    const EDGE&    edge = m_edges[m_cellEdges[ii]];
+                    const CONTOUR& contour = m_contours[edge.m_contour];
+
+                    if( contour.m_index > 0 || !contour.m_hasInside
+                            || ( aPolygon >= 0 && contour.m_polygon != aPolygon ) )
+                    {
+                        continue;
+                    }
+
+                    const SEG seg = segment( aSet, edge );
+
+                    if( seg.A == aP || seg.B == aP || seg.Distance( aP ) <= aAccuracy + 1 )
+                    {
+                        insideOutline.push_back( contour.m_polygon );
+                    }
+                }
+            }
+        }
+
+        std::sort( insideOutline.begin(), insideOutline.end() );
+    }
+
+    for( int polygon : insideOutline )
+    {
+        if( aUseBBoxCaches && !aSet.outlineCacheContains( aP, polygon, aAccuracy ) )
+            continue;
+
+        if( !std::binary_search( insideHole.begin(), insideHole.end(), polygon ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+template <typename DIST>
+int SHAPE_POLY_SET::EDGE_INDEX::nearestEdge( const SHAPE_POLY_SET& aSet, const BOX2I& aQuery,
+                                             int aPolygon, DIST aDist,
+                                             SEG::ecoord& aDistSq ) const
+{
+    int64_t queryLeft = aQuery.GetX();
+    int64_t queryTop = aQuery.GetY();
+    int64_t queryRight = aQuery.GetRight();
+    int64_t queryBottom = aQuery.GetBottom();
+
+    int firstCol = colOf( queryLeft );
+    int lastCol = colOf( queryRight );
+    int firstRow = rowOf( queryTop );
+    int lastRow = rowOf( queryBottom );
+
+    // Cells already searched; none yet
+    int doneFirstCol = 0, doneLastCol = -1, doneFirstRow = 0, doneLastRow = -1;
+
+    int best = -1;
+    aDistSq = VECTOR2I::ECOORD_MAX;
+
+    // Search the cells under the query, then grow the searched area one ring of cells at a
+    // time until no unsearched cell can hold anything closer than the best edge so far.
+    while( true )
+    {
+        for( int row = firstRow; row <= lastRow; row++ )
+        {
+            bool doneRow = row >= doneFirstRow && row <= doneLastRow;
+
+            for( int col = firstCol; col <= lastCol; col++ )
+            {
+                if( doneRow && col == doneFirstCol )
+                {
+                    col = doneLastCol;
+                    continue;
+                }
+
+                int cell = row * m_cols + col;
+
+                for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+                {
+                    int         edgeIdx = m_cellEdges[ii];
+                    const EDGE& edge = m_edges[edgeIdx];
+
+                    if( aPolygon >= 0 && m_contours[edge.m_contour].m_polygon != aPolygon )
+                        continue;
+
+                    SEG::ecoord distSq = aDist( segment( aSet, edge ) );
+
+                    if( distSq < aDistSq )
+                    {
+                        aDistSq = distSq;
+                        best = edgeIdx;
+                    }
+                }
+            }
+        }
+
+        if( best >= 0 && aDistSq == 0 )
+            break;
+
+        // Distance from the query to the nearest unsearched cell.  Nothing lies beyond the
+        // border of the grid.
+        int64_t gap = std::numeric_limits<int64_t>::max();
+
+        if( firstCol > 0 )
+            gap = std::min( gap, queryLeft - ( m_originX + firstCol * m_cellSize ) );
+
+        if( lastCol < m_cols - 1 )
+            gap = std::min( gap, m_originX + ( lastCol + 1 ) * m_cellSize - queryRight );
+
+        if( firstRow > 0 )
+            gap = std::min( gap, queryTop - ( m_originY + firstRow * m_cellSize ) );
+
+        if( lastRow < m_rows - 1 )
+            gap = std::min( gap, m_originY + ( lastRow + 1 ) * m_cellSize - queryBottom );
+
+        if( gap == std::numeric_limits<int64_t>::max() )
+            break;
+
+        // Allow for the rounding of the distances to the edges
+        if( best >= 0 && gap > 2 && aDistSq <= SEG::ecoord( gap - 2 ) * ( gap - 2 ) )
+            break;
+
+        doneFirstCol = firstCol;
+        doneLastCol = lastCol;
+        doneFirstRow = firstRow;
+        doneLastRow = lastRow;
+
+        firstCol = std::max( firstCol - 1, 0 );
+        lastCol = std::min( lastCol + 1, m_cols - 1 );
+        firstRow = std::max( firstRow - 1, 0 );
+        lastRow = std::min( lastRow + 1, m_rows - 1 );
+    }
+
+    return best;
+}
+
+
+SEG::ecoord SHAPE_POLY_SET::EDGE_INDEX::SquaredDistance( const SHAPE_POLY_SET& aSet,
+                                                         const VECTOR2I& aP, int aPolygon,
+                                                         VECTOR2I* aNearest ) const
+{
+    if( Contains( aSet, aP, aPolygon, 1, false ) )
+    {
+        if( aNearest )
+            *aNearest = aP;
+
+        return 0;
+    }
+
+    SEG::ecoord distSq;
+    int         edge = nearestEdge( aSet, BOX2I( aP, VECTOR2I( 0, 0 ) ), aPolygon,
+                                    [&]( const SEG& aSeg )
+                                    {
+                                        return aSeg.SquaredDistance( aP );
+                                    },
+                                    distSq );
+
+    if( edge >= 0 && aNearest )
+        *aNearest = segment( aSet, m_edges[edge] ).NearestPoint( aP );
+
+    return distSq;
+}
+
+
+SEG::ecoord SHAPE_POLY_SET::EDGE_INDEX::SquaredDistance( const SHAPE_POLY_SET& aSet,
+                                                         const SEG& aSeg, int aPolygon,
+                                                         VECTOR2I* aNearest ) const
+{
+    if( Contains( aSet, aSeg.A, aPolygon, 1, false ) )
+    {
+        if( aNearest )
+            *aNearest = ( aSeg.A + aSeg.B ) / 2;
+
+        return 0;
+    }
+
+    SEG::ecoord distSq;
+    int         edge = nearestEdge( aSet, BOX2I( aSeg.A, aSeg.B - aSeg.A ).Normalize(), aPolygon,
+                                    [&]( const SEG& aEdge )
+                                    {
+                                        return aEdge.SquaredDistance( aSeg );
+                                    },
+                                    distSq );
+
+    if( edge >= 0 && aNearest )
+        *aNearest = segment( aSet, m_edges[edge] ).NearestPoint( aSeg );
+
+    return distSq < 0 ? 0 : distSq;
+}
+
+
+void SHAPE_POLY_SET::SetEdgeIndexThreshold( int aEdgeCount )
+{
+    s_edgeIndexThreshold = aEdgeCount;
+}
+
+
+int SHAPE_POLY_SET::GetEdgeIndexThreshold()
+{
+    return s_edgeIndexThreshold;
+}
+
+
+const SHAPE_POLY_SET::EDGE_INDEX* SHAPE_POLY_SET::edgeIndex() const
+{
+    if( const EDGE_INDEX* index = m_edgeIndex.load( std::memory_order_acquire ) )
+    {
+        // The polygons handed out by Outline(), Hole() or Polygon() may have been edited
+        // through a reference kept since the index was built.  A stale index is only dropped
+        // by the next edit; until then the queries walk the edges.
+        if( m_exposedPolygons.empty() )
+            return index;
+
+        if( m_edgeIndexStale.load( std::memory_order_relaxed ) )
+            return nullptr;
+
+        if( index->IsUpToDate( *this, m_exposedPolygons ) )
+            return index;
+
+        m_edgeIndexStale.store( true, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    // Only the query reaching the count builds the index.  The other ones, and all of the
+    // queries on sets too small to be indexed, walk the edges.  Past the count the counter is
+    // only read, so that threads querying a small shared set don't fight over it.
+    if( m_edgeIndexQueries.load( std::memory_order_relaxed ) >= EDGE_INDEX_MIN_QUERIES )
+        return nullptr;
+
+    if( m_edgeIndexQueries.fetch_add( 1, std::memory_order_relaxed ) + 1
+            != EDGE_INDEX_MIN_QUERIES )
+    {
+        return nullptr;
+    }
+
+    int edgeCount = 0;
+
+    for( const POLYGON& poly : m_polys )
+    {
+        for( const SHAPE_LINE_CHAIN& path : poly )
+            edgeCount += path.SegmentCount();
+    }
+
+    if( edgeCount < s_edgeIndexThreshold )
+        return nullptr;
+
+    m_edgeIndexOwner = std::make_shared<EDGE_INDEX>( *this );
+    m_edgeIndex.store( m_edgeIndexOwner.get(), std::memory_order_release );
+
+    return m_edgeIndexOwner.get();
+}
+
+
+void SHAPE_POLY_SET::shareEdgeIndex( const SHAPE_POLY_SET& aOther )
+{
+    const EDGE_INDEX* index = aOther.m_edgeIndex.load( std::memory_order_acquire );
+
+    // This set may not check the index before use, so it must match the contours it got
+    if( index && ( aOther.m_exposedPolygons.empty()
+                   || index->IsUpToDate( *this, aOther.m_exposedPolygons ) ) )
+    {
+        m_edgeIndexOwner = aOther.m_edgeIndexOwner;
+        m_edgeIndex.store( index, std::memory_order_release );
+    }
+}
+
+
 void SHAPE_POLY_SET::BuildBBoxCaches()
 {
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        Outline( polygonIdx ).GenerateBBoxCache();
+        m_polys[polygonIdx][0].GenerateBBoxCache();
 
         for( int holeIdx = 0; holeIdx < HoleCount( polygonIdx ); holeIdx++ )
-            Hole( polygonIdx, holeIdx ).GenerateBBoxCache();
+            m_polys[polygonIdx][holeIdx + 1].GenerateBBoxCache();
     }
 }
 
@@ -1443,6 +2086,9 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, int aAccur
     if( aSubpolyIndex >= 0 )
         return containsSingle( aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
 
+    if( const EDGE_INDEX* index = edgeIndex() )
+        return index->Contains( *this, aP, -1, aAccuracy, aUseBBoxCaches );
+
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
@@ -1468,6 +2114,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1485,6 +2133,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1492,6 +2142,16 @@ void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                                      bool aUseBBoxCaches ) const
 {
+    // The caller has built the bbox caches (see BuildBBoxCaches()), which rule out most
+    // polygons without looking at any edge
+    if( aUseBBoxCaches && !outlineCacheContains( aP, aSubpolyIndex, aAccuracy ) )
+        return false;
+
+    const EDGE_INDEX* index = edgeIndex();
+
+    if( index && index->IsWorthwhile( aSubpolyIndex ) )
+        return index->Contains( *this, aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
+
     // Check that the point is inside the outline
     if( m_polys[aSubpolyIndex][0].PointInside( aP, aAccuracy ) )
     {
@@ -1513,8 +2173,21 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 }
 
 
+bool SHAPE_POLY_SET::outlineCacheContains( const VECTOR2I& aP, int aSubpolyIndex,
+                                           int aAccuracy ) const
+{
+    // PointInside() counts points closer than aAccuracy + 1 to an edge as inside
+    BOX2I bbox = m_polys[aSubpolyIndex][0].BBoxFromCache();
+    bbox.Inflate( std::max( aAccuracy, 0 ) + 1 );
+
+    return bbox.Contains( aP );
+}
+
+
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1530,6 +2203,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1542,6 +2217,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1584,6 +2261,11 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::FilletPolygon( unsigned int aRadius, int
 SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex,
                                                       VECTOR2I* aNearest ) const
 {
+    const EDGE_INDEX* index = edgeIndex();
+
+    if( index && index->IsWorthwhile( aPolygonIndex ) )
+        return index->SquaredDistance( *this, aPoint, aPolygonIndex, aNearest );
+
     // We calculate the min dist between the segment and each outline segment.  However, if the
     // segment to test is inside the outline, and does not cross any edge, it can be seen outside
     // the polygon.  Therefore test if a segment end is inside (testing only one end is enough).
@@ -1620,6 +2302,11 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPoly
 SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int aPolygonIndex,
                                                       VECTOR2I* aNearest ) const
 {
+    const EDGE_INDEX* index = edgeIndex();
+
+    if( index && index->IsWorthwhile( aPolygonIndex ) )
+        return index->SquaredDistance( *this, aSegment, aPolygonIndex, aNearest );
+
     // We calculate the min dist between the segment and each outline segment.  However, if the
     // segment to test is inside the outline, and does not cross any edge, it can be seen outside
     // the polygon.  Therefore test if a segment end is inside (testing only one end is enough).
@@ -1655,6 +2342,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int a
 
 SEG::ecoord SHAPE_POLY_SET::SquaredDistance( VECTOR2I aPoint, VECTOR2I* aNearest ) const
 {
+    if( const EDGE_INDEX* index = edgeIndex() )
+        return index->SquaredDistance( *this, aPoint, -1, aNearest );
+
     SEG::ecoord currentDistance_sq;
     SEG::ecoord minDistance_sq = VECTOR2I::ECOORD_MAX;
     VECTOR2I nearest;
@@ -1680,6 +2370,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistance( VECTOR2I aPoint, VECTOR2I* aNearest
 
 SEG::ecoord SHAPE_POLY_SET::SquaredDistance( const SEG& aSegment, VECTOR2I* aNearest ) const
 {
+    if( const EDGE_INDEX* index = edgeIndex() )
+        return index->SquaredDistance( *this, aSegment, -1, aNearest );
+
     SEG::ecoord currentDistance_sq;
     SEG::ecoord minDistance_sq = VECTOR2I::ECOORD_MAX;
     VECTOR2I nearest;
@@ -1744,7 +2437,7 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
     // Null segments create serious issues in calculations. Remove them:
     RemoveNullSegments();
 
-    SHAPE_POLY_SET::POLYGON currentPoly = Polygon( aIndex );
+    SHAPE_POLY_SET::POLYGON currentPoly = CPolygon( aIndex );
     SHAPE_POLY_SET::POLYGON newPoly;
 
     // If the chamfering distance is zero, then the polygon remain intact.
@@ -1902,6 +2595,8 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
 SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
 {
     static_cast<SHAPE&>(*this) = aOther;
+    invalidateEdgeIndex();
+    forgetExposedPolygons();
     m_polys = aOther.m_polys;
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
@@ -1916,6 +2611,8 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
         m_triangulationValid = true;
     }
 
+    shareEdgeIndex( aOther );
+
     return *this;
 }
 
@@ -2057,7 +2754,7 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
         // If the tesselation fails, we re-fracture the polygon, which will
         // first simplify the system before fracturing and removing the holes
         // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        if( !tess.TesselatePolygon( tmpSet.CPolygon( 0 ).front() ) )
         {
             tmpSet.Fracture( PM_FAST );
             m_triangulationValid = false;
@@ -163,6 +163,8 @@ void ZONE_CONTAINER::InitDataFromSrcInCopyCtor( const ZONE_CONTAINER& aZone )
         m_insulatedIslands[layer] = aZone.m_insulatedIslands.at( layer );
     }
 
+    m_fillFingerprints        = aZone.m_fillFingerprints;
+
     m_borderStyle             = aZone.m_borderStyle;
     m_borderHatchPitch        = aZone.m_borderHatchPitch;
     m_borderHatchLines        = aZone.m_borderHatchLines;
@@ -260,6 +262,7 @@ void ZONE_CONTAINER::SetLayerSet( LSET aLayerSet )
         m_FilledPolysList.clear();
         m_RawPolysList.clear();
         m_filledPolysHash.clear();
+        m_fillFingerprints.clear();
         m_insulatedIslands.clear();
 
         for( PCB_LAYER_ID layer : aLayerSet.Seq() )
@@ -502,7 +505,7 @@ bool ZONE_CONTAINER::HitTestCutout( const VECTOR2I& aRefPos, int* aOutlineIdx, i
     {
         for( int j = 0; j < m_Poly->HoleCount( i ); j++ )
         {
-            if( m_Poly->Hole( i, j ).PointInside( aRefPos ) )
+            if( m_Poly->CHole( i, j ).PointInside( aRefPos ) )
             {
                 if( aOutlineIdx )
                     *aOutlineIdx = i;
@@ -788,7 +791,7 @@ void ZONE_CONTAINER::RemoveCutout( int aOutlineIdx, int aHoleIdx )
     if( m_Poly->OutlineCount() < aOutlineIdx || m_Poly->HoleCount( aOutlineIdx ) < aHoleIdx )
         return;
 
-    SHAPE_POLY_SET cutPoly( m_Poly->Hole( aOutlineIdx, aHoleIdx ) );
+    SHAPE_POLY_SET cutPoly( m_Poly->CHole( aOutlineIdx, aHoleIdx ) );
 
     // Add the cutout back to the zone
     m_Poly->BooleanAdd( cutPoly, SHAPE_POLY_SET::PM_FAST );
@@ -1242,16 +1245,16 @@ double ZONE_CONTAINER::CalculateFilledArea()
 
     // Iterate over each outline polygon in the zone and then iterate over
     // each hole it has to compute the total area.
-    for( std::pair<const PCB_LAYER_ID, SHAPE_POLY_SET>& pair : m_FilledPolysList )
+    for( const std::pair<const PCB_LAYER_ID, SHAPE_POLY_SET>& pair : m_FilledPolysList )
     {
-        SHAPE_POLY_SET& poly = pair.second;
+        const SHAPE_POLY_SET& poly = pair.second;
 
         for( int i = 0; i < poly.OutlineCount(); i++ )
         {
-            m_area += poly.Outline( i ).Area();
+            m_area += poly.COutline( i ).Area();
 
             for( int j = 0; j < poly.HoleCount( i ); j++ )
-                m_area -= poly.Hole( i, j ).Area();
+                m_area -= poly.CHole( i, j ).Area();
         }
     }
 
@@ -821,6 +821,22 @@ public:
         m_filledPolysHash[aLayer] = m_FilledPolysList.at( aLayer ).GetHash();
     }
 
+    /**
+     * @return the fingerprint of the fill inputs (the zone itself, nearby items, rules and
+     *         board outline) recorded by the zone filler when aLayer was last filled, or 0
+     *         if there is none.
+     */
+    size_t GetFillFingerprint( PCB_LAYER_ID aLayer ) const
+    {
+        auto it = m_fillFingerprints.find( aLayer );
+        return it == m_fillFingerprints.end() ? 0 : it->second;
+    }
+
+    void SetFillFingerprint( PCB_LAYER_ID aLayer, size_t aFingerprint )
+    {
+        m_fillFingerprints[aLayer] = aFingerprint;
+    }
+
 
 
 #if defined(DEBUG)
@@ -930,6 +946,9 @@ protected:
     /// A hash value used in zone filling calculations to see if the filled areas are up to date
     std::map<PCB_LAYER_ID, MD5_HASH>       m_filledPolysHash;
 
+    /// Fingerprints of the fill inputs, used by the zone filler to skip unchanged layers
+    std::map<PCB_LAYER_ID, size_t>         m_fillFingerprints;
+
     ZONE_BORDER_DISPLAY_STYLE m_borderStyle;       // border display style, see enum above
     int                       m_borderHatchPitch;  // for DIAGONAL_EDGE, distance between 2 lines
     std::vector<SEG>          m_borderHatchLines;  // hatch lines
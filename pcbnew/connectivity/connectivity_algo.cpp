@@ -28,17 +28,53 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
+#include <hash_eda.h>
 
 #include <thread>
 #include <mutex>
 #include <algorithm>
 #include <future>
+#include <numeric>
 
 #ifdef PROFILE
 #include <profile.h>
 #endif
 
 
+static constexpr KICAD_T s_clusterTypes[] =
+{ PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_AREA_T, PCB_MODULE_T, EOT };
+
+
+/**
+ * Hashes everything the CN_ZONE_LAYER items of a zone are built from: the outlines of its
+ * fills, and the net and thickness which decide what they connect to.
+ */
+static size_t zoneFillKey( const ZONE_CONTAINER* aZone )
+{
+    size_t key = hash_val( aZone->GetNetCode(), aZone->GetFilledPolysUseThickness(),
+                           aZone->GetMinThickness() );
+
+    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+    {
+        const SHAPE_POLY_SET& fill = aZone->GetFilledPolysList( layer );
+
+        hash_combine( key, (int) layer, fill.OutlineCount() );
+
+        for( int ii = 0; ii < fill.OutlineCount(); ++ii )
+        {
+            const SHAPE_LINE_CHAIN& outline = fill.COutline( ii );
+
+            hash_combine( key, outline.PointCount() );
+
+            for( int jj = 0; jj < outline.PointCount(); ++jj )
+                hash_combine( key, outline.CPoint( jj ).x, outline.CPoint( jj ).y );
+        }
+    }
+
+    return key;
+}
+
+
 bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 {
     markItemNetAsDirty( aItem );
@@ -95,10 +131,20 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 
 void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
 {
+    auto markAddedNet =
+            [this]( const BOARD_ITEM* aConnectedItem )
+            {
+                auto it = m_itemMap.find( aConnectedItem );
+
+                if( it != m_itemMap.end() )
+                    MarkNetAsDirty( it->second.m_net );
+            };
+
     if( aItem->IsConnected() )
     {
         auto citem = static_cast<const BOARD_CONNECTED_ITEM*>( aItem );
         MarkNetAsDirty( citem->GetNetCode() );
+        markAddedNet( citem );
     }
     else
     {
@@ -107,7 +153,10 @@ void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
             auto mod = static_cast <const MODULE*>( aItem );
 
             for( auto pad : mod->Pads() )
+            {
                 MarkNetAsDirty( pad->GetNetCode() );
+                markAddedNet( pad );
+            }
         }
     }
 }
@@ -182,6 +231,8 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
             return false;
 
         m_itemMap[zone] = ITEM_MAP_ENTRY();
+        m_itemMap[zone].m_fillKey = zoneFillKey( zone );
+        m_itemMap[zone].m_net = zone->GetNetCode();
 
         for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
             for( auto zitem : m_itemList.Add( zone, layer ) )
@@ -198,6 +249,27 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
 }
 
 
+bool CN_CONNECTIVITY_ALGO::Update( BOARD_ITEM* aItem )
+{
+    // New zone items have to be searched for connections over the whole fill, and drag all
+    // of the items of the zone's net into the next cluster search.  Zone edits and refills
+    // which leave the copper as it was don't need that.
+    if( aItem->Type() == PCB_ZONE_AREA_T )
+    {
+        auto it = m_itemMap.find( aItem );
+
+        if( it != m_itemMap.end()
+                && it->second.m_fillKey == zoneFillKey( static_cast<ZONE_CONTAINER*>( aItem ) ) )
+        {
+            return true;
+        }
+    }
+
+    Remove( aItem );
+    return Add( aItem );
+}
+
+
 void CN_CONNECTIVITY_ALGO::searchConnections()
 {
 #ifdef PROFILE
@@ -228,18 +300,28 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
+        // Zone layers are the slowest items to search; starting with them keeps a big fill
+        // from being left to a single thread at the end
+        std::stable_partition( dirtyItems.begin(), dirtyItems.end(),
+                [] ( CN_ITEM* aItem ) { return aItem->Parent()->Type() == PCB_ZONE_AREA_T; } );
+
         size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
                 ( dirtyItems.size() + 7 ) / 8 );
 
         std::atomic<size_t> nextItem( 0 );
         std::vector<std::future<size_t>> returns( parallelThreadCount );
 
+        // The threads only read the items, and collect the connections they find in their own
+        // buffer.  They are added to the items afterwards.
+        std::vector<CN_VISITOR::CONNECTIONS> found( std::max<size_t>( parallelThreadCount, 1 ) );
+
         auto conn_lambda = [&nextItem, &dirtyItems]
-                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter) -> size_t
+                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter,
+                              CN_VISITOR::CONNECTIONS* aConnections ) -> size_t
         {
             for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
             {
-                CN_VISITOR visitor( dirtyItems[i] );
+                CN_VISITOR visitor( dirtyItems[i], *aConnections );
                 aItemList->FindNearby( dirtyItems[i], visitor );
 
                 if( aReporter )
@@ -250,12 +332,12 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         };
 
         if( parallelThreadCount <= 1 )
-            conn_lambda( &m_itemList, m_progressReporter );
+            conn_lambda( &m_itemList, m_progressReporter, &found[0] );
         else
         {
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
                 returns[ii] = std::async( std::launch::async, conn_lambda,
-                        &m_itemList, m_progressReporter );
+                        &m_itemList, m_progressReporter, &found[ii] );
 
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
             {
@@ -271,6 +353,31 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
             }
         }
 
+        // Sorting makes the merge independent of which thread found which connection
+        CN_VISITOR::CONNECTIONS connections;
+
+        for( CN_VISITOR::CONNECTIONS& threadConnections : found )
+            connections.insert( connections.end(), threadConnections.begin(),
+                                threadConnections.end() );
+
+        std::sort( connections.begin(), connections.end() );
+        connections.erase( std::unique( connections.begin(), connections.end() ),
+                           connections.end() );
+
+        CN_ITEM::CONNECTED_ITEMS newItems;
+
+        for( auto it = connections.begin(); it != connections.end(); )
+        {
+            CN_ITEM* item = it->first;
+
+            newItems.clear();
+
+            for( ; it != connections.end() && it->first == item; ++it )
+                newItems.push_back( it->second );
+
+            item->Connect( newItems );
+        }
+
         if( m_progressReporter )
             m_progressReporter->KeepRefreshing();
     }
@@ -285,32 +392,41 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode )
 {
-    constexpr KICAD_T types[] =
-    { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_AREA_T, PCB_MODULE_T, EOT };
     constexpr KICAD_T no_zones[] =
     { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_MODULE_T, EOT };
 
     if( aMode == CSM_PROPAGATE )
         return SearchClusters( aMode, no_zones, -1 );
     else
-        return SearchClusters( aMode, types, -1 );
+        return SearchClusters( aMode, s_clusterTypes, -1 );
 }
 
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
         const KICAD_T aTypes[], int aSingleNet )
 {
-    bool withinAnyNet = ( aMode != CSM_PROPAGATE );
+    if( aSingleNet < 0 )
+        return searchClusters( aMode, aTypes, nullptr );
 
-    std::deque<CN_ITEM*> Q;
-    std::set<CN_ITEM*> item_set;
+    std::vector<bool> nets( aSingleNet + 1, false );
+    nets[aSingleNet] = true;
 
-    CLUSTERS clusters;
+    return searchClusters( aMode, aTypes, &nets );
+}
+
+
+const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::searchClusters( CLUSTER_SEARCH_MODE aMode,
+        const KICAD_T aTypes[], const std::vector<bool>* aNets )
+{
+    bool withinAnyNet = ( aMode != CSM_PROPAGATE );
+
+    std::vector<CN_ITEM*> items;
+    CLUSTERS              clusters;
 
     if( m_itemList.IsDirty() )
         searchConnections();
 
-    auto addToSearchList = [&item_set, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
+    auto addToSearchList = [&items, withinAnyNet, aNets, aTypes] ( CN_ITEM *aItem )
     {
         if( withinAnyNet && aItem->Net() <= 0 )
             return;
@@ -318,8 +434,11 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
         if( !aItem->Valid() )
             return;
 
-        if( aSingleNet >=0 && aItem->Net() != aSingleNet )
+        if( aNets && ( aItem->Net() < 0 || aItem->Net() >= (int) aNets->size()
+                                        || !( *aNets )[aItem->Net()] ) )
+        {
             return;
+        }
 
         bool found = false;
 
@@ -335,56 +454,65 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
         if( !found )
             return;
 
-        aItem->SetVisited( false );
-
-        item_set.insert( aItem );
+        aItem->SetSearchIndex( items.size() );
+        items.push_back( aItem );
     };
 
     std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
 
-    while( !item_set.empty() )
+    // Union-find over the connections between the searched items.  The search indices of the
+    // items left out are stale, so membership is checked against the item list.  The root of
+    // each set is its first item, so the clusters come out in item list order.
+    std::vector<int> parent( items.size() );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    auto findRoot = [&parent]( int aIndex )
     {
-        CN_CLUSTER_PTR cluster ( new CN_CLUSTER() );
-        CN_ITEM*       root;
-        auto           it = item_set.begin();
+        while( parent[aIndex] != aIndex )
+        {
+            parent[aIndex] = parent[parent[aIndex]];
+            aIndex = parent[aIndex];
+        }
 
-        while( it != item_set.end() && (*it)->Visited() )
-            it = item_set.erase( item_set.begin() );
+        return aIndex;
+    };
 
-        if( it == item_set.end() )
-            break;
+    for( int i = 0; i < (int) items.size(); i++ )
+    {
+        for( CN_ITEM* n : items[i]->ConnectedItems() )
+        {
+            int j = n->SearchIndex();
 
-        root = *it;
-        root->SetVisited ( true );
+            if( j < 0 || j >= (int) items.size() || items[j] != n )
+                continue;
 
-        Q.clear();
-        Q.push_back( root );
+            if( withinAnyNet && n->Net() != items[i]->Net() )
+                continue;
 
-        while( Q.size() )
-        {
-            CN_ITEM* current = Q.front();
+            int rootA = findRoot( i );
+            int rootB = findRoot( j );
 
-            Q.pop_front();
-            cluster->Add( current );
+            if( rootA != rootB )
+                parent[ std::max( rootA, rootB ) ] = std::min( rootA, rootB );
+        }
+    }
 
-            for( auto n : current->ConnectedItems() )
-            {
-                if( withinAnyNet && n->Net() != root->Net() )
-                    continue;
+    std::vector<int> clusterIndex( items.size(), -1 );
 
-                if( !n->Visited() && n->Valid() )
-                {
-                    n->SetVisited( true );
-                    Q.push_back( n );
-                }
-            }
+    for( int i = 0; i < (int) items.size(); i++ )
+    {
+        int root = findRoot( i );
+
+        if( clusterIndex[root] < 0 )
+        {
+            clusterIndex[root] = clusters.size();
+            clusters.push_back( std::make_shared<CN_CLUSTER>() );
         }
 
-        clusters.push_back( cluster );
+        clusters[ clusterIndex[root] ]->Add( items[i] );
     }
 
-
-    std::sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+    std::stable_sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
         return a->OriginNet() < b->OriginNet();
     } );
 
@@ -501,6 +629,11 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit )
 
                         item->Parent()->SetNetCode( cluster->OriginNet() );
                         n_changed++;
+
+                        auto it = m_itemMap.find( item->Parent() );
+
+                        if( it != m_itemMap.end() )
+                            it->second.m_net = cluster->OriginNet();
                     }
                 }
             }
@@ -537,10 +670,10 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone,
 
     aIslands.clear();
 
-    Remove( aZone );
-    Add( aZone );
+    Update( aZone );
 
-    m_connClusters = SearchClusters( CSM_CONNECTIVITY_CHECK );
+    m_connClusters = SearchClusters( CSM_CONNECTIVITY_CHECK, s_clusterTypes,
+                                     aZone->GetNetCode() );
 
     for( const auto& cluster : m_connClusters )
     {
@@ -561,13 +694,24 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone,
 
 void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones )
 {
+    // Islands are clusters without pads, which never span nets in this mode, so only the
+    // nets of the zones need to be searched
+    std::vector<bool> zoneNets;
+
     for( auto& z : aZones )
     {
-        Remove( z.m_zone );
-        Add( z.m_zone );
+        Update( z.m_zone );
+
+        int net = z.m_zone->GetNetCode();
+
+        if( net >= (int) zoneNets.size() )
+            zoneNets.resize( net + 1, false );
+
+        if( net > 0 )
+            zoneNets[net] = true;
     }
 
-    m_connClusters = SearchClusters( CSM_CONNECTIVITY_CHECK );
+    m_connClusters = searchClusters( CSM_CONNECTIVITY_CHECK, s_clusterTypes, &zoneNets );
 
     for( auto& zone : aZones )
     {
@@ -597,7 +741,32 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLAT
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    // Clusters never span nets here, and all changes to the items of a net mark it as dirty
+    // (RN_NET relies on the same to keep the ratsnest of clean nets), so the clusters of the
+    // clean nets are still valid.
+    CLUSTERS dirtyClusters = searchClusters( CSM_RATSNEST, s_clusterTypes, &m_dirtyNets );
+    CLUSTERS clusters;
+
+    clusters.reserve( m_ratsnestClusters.size() + dirtyClusters.size() );
+
+    std::copy_if( m_ratsnestClusters.begin(), m_ratsnestClusters.end(),
+                  std::back_inserter( clusters ),
+                  [this]( const CN_CLUSTER_PTR& aCluster )
+                  {
+                      return !IsNetDirty( aCluster->OriginNet() );
+                  } );
+
+    size_t cleanCount = clusters.size();
+
+    clusters.insert( clusters.end(), dirtyClusters.begin(), dirtyClusters.end() );
+
+    std::inplace_merge( clusters.begin(), clusters.begin() + cleanCount, clusters.end(),
+                        []( const CN_CLUSTER_PTR& a, const CN_CLUSTER_PTR& b )
+                        {
+                            return a->OriginNet() < b->OriginNet();
+                        } );
+
+    m_ratsnestClusters = std::move( clusters );
     return m_ratsnestClusters;
 }
 
@@ -645,8 +814,7 @@ void CN_VISITOR::checkZoneItemConnection( CN_ZONE_LAYER* aZoneLayer, CN_ITEM* aI
     {
         if( aZoneLayer->ContainsPoint( aItem->GetAnchor( i ), accuracy ) )
         {
-            aZoneLayer->Connect( aItem );
-            aItem->Connect( aZoneLayer );
+            connect( aZoneLayer, aItem );
             return;
         }
     }
@@ -687,8 +855,7 @@ void CN_VISITOR::checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LA
 
         if( aZoneLayerB->ContainsPoint( outline.CPoint( i ), radiusA ) )
         {
-            aZoneLayerA->Connect( aZoneLayerB );
-            aZoneLayerB->Connect( aZoneLayerA );
+            connect( aZoneLayerA, aZoneLayerB );
             return;
         }
     }
@@ -703,8 +870,7 @@ void CN_VISITOR::checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LA
 
         if( aZoneLayerA->ContainsPoint( outline2.CPoint( i ), radiusB ) )
         {
-            aZoneLayerA->Connect( aZoneLayerB );
-            aZoneLayerB->Connect( aZoneLayerA );
+            connect( aZoneLayerA, aZoneLayerB );
             return;
         }
     }
@@ -770,8 +936,7 @@ bool CN_VISITOR::operator()( CN_ITEM* aCandidate )
     {
         if( parentB->HitTest( wxPoint( aCandidate->GetAnchor( i ) ), accuracyA ) )
         {
-            m_item->Connect( aCandidate );
-            aCandidate->Connect( m_item );
+            connect( m_item, aCandidate );
             return true;
         }
     }
@@ -780,8 +945,7 @@ bool CN_VISITOR::operator()( CN_ITEM* aCandidate )
     {
         if( parentA->HitTest( wxPoint( m_item->GetAnchor( i ) ), accuracyB ) )
         {
-            m_item->Connect( aCandidate );
-            aCandidate->Connect( m_item );
+            connect( m_item, aCandidate );
             return true;
         }
     }
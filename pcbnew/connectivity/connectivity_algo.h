@@ -152,6 +152,12 @@ public:
         }
 
         std::list<CN_ITEM*> m_items;
+
+        ///> for zones, the key of the fills (and net) the items were built from
+        size_t m_fillKey = 0;
+
+        ///> the net of the board item when it was added, which may have changed since
+        int m_net = -1;
     };
 
 private:
@@ -167,6 +173,13 @@ private:
 
     void    searchConnections();
 
+    /**
+     * Groups the valid items of the given types into clusters of connected items.
+     * @param aNets, if not null, selects the nets whose items are searched
+     */
+    const CLUSTERS searchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[],
+                                   const std::vector<bool>* aNets );
+
     void    propagateConnections( BOARD_COMMIT* aCommit = nullptr );
 
     template <class Container, class BItem>
@@ -175,8 +188,13 @@ private:
         auto item = c.Add( brditem );
 
         m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item );
+        m_itemMap[ brditem ].m_net = brditem->GetNetCode();
     }
 
+    /**
+     * Marks the net of \a aItem (or of its pads) as dirty, and the net it had when it was
+     * added, if it changed nets since: the clusters of both are out of date.
+     */
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
 
 public:
@@ -232,6 +250,12 @@ public:
     bool    Remove( BOARD_ITEM* aItem );
     bool    Add( BOARD_ITEM* aItem );
 
+    /**
+     * Rebuilds the connectivity items of aItem.  Zones whose fills and net did not change
+     * since their items were built keep them, along with their connections.
+     */
+    bool    Update( BOARD_ITEM* aItem );
+
     const CLUSTERS  SearchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[], int aSingleNet );
     const CLUSTERS  SearchClusters( CLUSTER_SEARCH_MODE aMode );
 
@@ -252,6 +276,11 @@ public:
      */
     void    FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones );
 
+    /**
+     * Returns the ratsnest clusters.  Only the clusters of dirty nets are searched again; the
+     * others are kept from the previous call, so the dirty flags must not be cleared between
+     * changing the items of a net and calling this.
+     */
     const CLUSTERS& GetClusters();
 
     const CN_LIST& ItemList() const
@@ -288,8 +317,12 @@ class CN_VISITOR {
 
 public:
 
-    CN_VISITOR( CN_ITEM* aItem ) :
-        m_item( aItem )
+    ///> pairs of connected items, each connection appearing in both directions
+    using CONNECTIONS = std::vector<std::pair<CN_ITEM*, CN_ITEM*>>;
+
+    CN_VISITOR( CN_ITEM* aItem, CONNECTIONS& aConnections ) :
+        m_item( aItem ),
+        m_connections( aConnections )
     {}
 
     bool operator()( CN_ITEM* aCandidate );
@@ -300,8 +333,17 @@ protected:
 
     void checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LAYER* aZoneLayerB );
 
+    void connect( CN_ITEM* aItemA, CN_ITEM* aItemB )
+    {
+        m_connections.emplace_back( aItemA, aItemB );
+        m_connections.emplace_back( aItemB, aItemA );
+    }
+
     ///> the item we are looking for connections to
     CN_ITEM* m_item;
+
+    ///> where the connections found are stored; the visitors of a thread share one
+    CONNECTIONS& m_connections;
 };
 
 #endif
@@ -76,8 +76,7 @@ bool CONNECTIVITY_DATA::Remove( BOARD_ITEM* aItem )
 
 bool CONNECTIVITY_DATA::Update( BOARD_ITEM* aItem )
 {
-    m_connAlgo->Remove( aItem );
-    m_connAlgo->Add( aItem );
+    m_connAlgo->Update( aItem );
     return true;
 }
 
@@ -180,7 +179,7 @@ void CONNECTIVITY_DATA::RecalculateRatsnest( BOARD_COMMIT* aCommit  )
             m_nets[i] = new RN_NET;
     }
 
-    auto clusters = m_connAlgo->GetClusters();
+    const auto& clusters = m_connAlgo->GetClusters();
 
     int dirtyNets = 0;
 
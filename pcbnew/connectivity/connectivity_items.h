@@ -180,8 +180,8 @@ private:
 
     CN_ANCHORS m_anchors;
 
-    ///> visited flag for the BFS scan
-    bool m_visited;
+    ///> index of the item in the last cluster search it took part in
+    int m_searchIndex;
 
     ///> can the net propagator modify the netcode?
     bool m_canChangeNet;
@@ -189,9 +189,6 @@ private:
     ///> valid flag, used to identify garbage items (we use lazy removal)
     bool m_valid;
 
-    ///> mutex protecting this item's connected_items set to allow parallel connection threads
-    std::mutex m_listLock;
-
 protected:
     ///> dirty flag, used to identify recently added item not yet scanned into the connectivity search
     bool m_dirty;
@@ -209,7 +206,7 @@ public:
     {
         m_parent = aParent;
         m_canChangeNet = aCanChangeNet;
-        m_visited = false;
+        m_searchIndex = -1;
         m_valid = true;
         m_dirty = true;
         m_anchors.reserve( std::max( 6, aAnchorCount ) );
@@ -314,14 +311,14 @@ public:
         m_connected.clear();
     }
 
-    void SetVisited( bool aVisited )
+    void SetSearchIndex( int aIndex )
     {
-        m_visited = aVisited;
+        m_searchIndex = aIndex;
     }
 
-    bool Visited() const
+    int SearchIndex() const
     {
-        return m_visited;
+        return m_searchIndex;
     }
 
     bool CanChangeNet() const
@@ -329,16 +326,19 @@ public:
         return m_canChangeNet;
     }
 
-    void Connect( CN_ITEM* b )
+    /**
+     * Adds items to the list of connected items.  Not thread-safe: the connection search
+     * collects the connections of all items first, and adds them in one go afterwards.
+     * @param aItems the new connected items, sorted and without duplicates
+     */
+    void Connect( const CONNECTED_ITEMS& aItems )
     {
-        std::lock_guard<std::mutex> lock( m_listLock );
-
-        auto i = std::lower_bound( m_connected.begin(), m_connected.end(), b );
-
-        if( i != m_connected.end() && *i == b )
-          return;
+        CONNECTED_ITEMS merged;
 
-        m_connected.insert( i, b );
+        merged.reserve( m_connected.size() + aItems.size() );
+        std::set_union( m_connected.begin(), m_connected.end(), aItems.begin(), aItems.end(),
+                        std::back_inserter( merged ) );
+        m_connected.swap( merged );
     }
 
     void RemoveInvalidRefs();
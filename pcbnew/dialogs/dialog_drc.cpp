@@ -234,7 +234,14 @@ void DIALOG_DRC::OnRunDRCClick( wxCommandEvent& aEvent )
     m_cancelled = false;
 
     m_brdEditor->RecordDRCExclusions();
-    deleteAllMarkers( true );
+
+    // An incremental run only replaces the markers of the items changed since the last run
+    if( !drcTool->CanRunIncrementally( testTracksAgainstZones, reportAllTrackErrors,
+                                       testFootprints ) )
+    {
+        deleteAllMarkers( true );
+    }
+
     m_unconnectedTreeModel->DeleteItems( false, true, true );
     m_footprintWarningsTreeModel->DeleteItems( false, true, true );
 
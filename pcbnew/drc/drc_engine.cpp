@@ -23,13 +23,22 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <chrono>
 #include <reporter.h>
 #include <widgets/progress_reporter.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <hash_eda.h>
 #include <drc/drc_engine.h>
 #include <drc/drc_rule_parser.h>
 #include <drc/drc_rule.h>
 #include <drc/drc_rule_condition.h>
 #include <drc/drc_test_provider.h>
+#include <drc/drc_rtree.h>
+
+thread_local std::vector<DRC_ENGINE::DEFERRED_REPORT>* DRC_ENGINE::s_deferredReports = nullptr;
+thread_local std::atomic<double>* DRC_ENGINE::s_providerProgress = nullptr;
+
 
 void drcPrintDebugMessage( int level, const wxString& msg, const char *function, int line )
 {
@@ -53,15 +62,23 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_worksheet( nullptr ),
     m_schematicNetlist( nullptr ),
     m_rulesValid( false ),
+    m_rulesFingerprint( 0 ),
+    m_itemDependentClearanceRules( false ),
     m_userUnits( EDA_UNITS::MILLIMETRES ),
+    m_errorLimits( DRCE_LAST + 1 ),
     m_testTracksAgainstZones( false ),
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
+    m_stopWorkers( false ),
+    m_pendingPhases( 0 ),
+    m_incremental( false ),
+    m_constraintCacheEnabled( false ),
+    m_constraintCacheHits( 0 ),
+    m_constraintCacheMisses( 0 ),
+    m_constraintCacheUncacheable( 0 ),
     m_reporter( nullptr ),
     m_progressReporter( nullptr )
 {
-    m_errorLimits.resize( DRCE_LAST + 1 );
-
     for( int ii = DRCE_FIRST; ii <= DRCE_LAST; ++ii )
         m_errorLimits[ ii ] = INT_MAX;
 }
@@ -69,6 +86,7 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
 
 DRC_ENGINE::~DRC_ENGINE()
 {
+    stopWorkers();
 }
 
 
@@ -498,6 +516,9 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     m_rules.clear();
     m_rulesValid = false;
 
+    // Cached entries point into the old rules
+    clearConstraintCache();
+
     try         // attempt to load full set of rules (implicit + user rules)
     {
         loadImplicitRules();
@@ -522,6 +543,33 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     for( int ii = DRCE_FIRST; ii < DRCE_LAST; ++ii )
         m_errorLimits[ ii ] = INT_MAX;
 
+    wxString fingerprint;
+
+    m_itemDependentClearanceRules = false;
+
+    for( DRC_RULE* rule : m_rules )
+    {
+        fingerprint << rule->m_Name << "|" << rule->m_LayerCondition.FmtHex() << "|";
+
+        if( rule->m_Condition )
+            fingerprint << rule->m_Condition->GetExpression();
+
+        for( const DRC_CONSTRAINT& constraint : rule->m_Constraints )
+        {
+            fingerprint << "|" << formatConstraint( constraint ) << constraint.m_DisallowFlags;
+
+            if( rule->m_Condition && rule->m_Condition->HasItemDependencies()
+                    && ( constraint.m_Type == DRC_CONSTRAINT_TYPE_CLEARANCE
+                         || constraint.m_Type == DRC_CONSTRAINT_TYPE_EDGE_CLEARANCE ) )
+            {
+                m_itemDependentClearanceRules = true;
+            }
+        }
+
+        fingerprint << "\n";
+    }
+
+    m_rulesFingerprint = std::hash<std::wstring>()( fingerprint.ToStdWstring() );
     m_rulesValid = true;
 }
 
@@ -536,6 +584,155 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aTestTracksAgainstZones,
     m_reportAllTrackErrors = aReportAllTrackErrors;
     m_testFootprints = aTestFootprints;
 
+    // A full run doesn't tell us what changed since the item index was built, so start afresh
+    // with the next incremental run.
+    m_itemTree.reset();
+
+    runProviders();
+}
+
+
+void DRC_ENGINE::RunIncrementalTests( EDA_UNITS aUnits,
+                                      const std::vector<BOARD_ITEM*>& aDirtyItems,
+                                      const std::set<KIID>& aRemovedItems )
+{
+    m_userUnits = aUnits;
+
+    // Footprint tests compare the whole board against the schematic
+    m_testFootprints = false;
+
+    DRC_CONSTRAINT worstConstraint;
+    int            worstClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( DRC_CONSTRAINT_TYPE_T type : { DRC_CONSTRAINT_TYPE_CLEARANCE,
+                                        DRC_CONSTRAINT_TYPE_HOLE_CLEARANCE,
+                                        DRC_CONSTRAINT_TYPE_EDGE_CLEARANCE,
+                                        DRC_CONSTRAINT_TYPE_SILK_CLEARANCE,
+                                        DRC_CONSTRAINT_TYPE_COURTYARD_CLEARANCE } )
+    {
+        if( QueryWorstConstraint( type, worstConstraint, DRCCQ_LARGEST_MINIMUM ) )
+            worstClearance = std::max( worstClearance, worstConstraint.GetValue().Min() );
+    }
+
+    // Footprints are indexed (and tested) through their children, whose entries are all
+    // recorded under the footprint so that they can be dropped together even when the children
+    // themselves have been swapped out (by undo, for instance).
+    auto forEachChild =
+            [&]( BOARD_ITEM* aItem, const std::function<void( BOARD_ITEM* )>& aFunc )
+            {
+                if( MODULE* footprint = dyn_cast<MODULE*>( aItem ) )
+                    footprint->RunOnChildren( aFunc );
+                else
+                    aFunc( aItem );
+            };
+
+    auto addToTree =
+            [&]( BOARD_ITEM* aItem )
+            {
+                forEachChild( aItem,
+                              [&]( BOARD_ITEM* child )
+                              {
+                                  // Groups and targets have no effective shape
+                                  if( child->Type() != PCB_GROUP_T
+                                          && child->Type() != PCB_TARGET_T )
+                                  {
+                                      m_itemTree->insert( child, aItem->m_Uuid );
+                                  }
+                              } );
+            };
+
+    // A footprint child is changed along with its footprint
+    std::set<BOARD_ITEM*> dirtyItems;
+
+    for( BOARD_ITEM* item : aDirtyItems )
+    {
+        if( item->GetParent() && item->GetParent()->Type() == PCB_MODULE_T )
+            dirtyItems.insert( static_cast<BOARD_ITEM*>( item->GetParent() ) );
+        else
+            dirtyItems.insert( item );
+    }
+
+    if( !m_itemTree )
+    {
+        // Built from the current board, so already up to date for the dirty items
+        m_itemTree = std::make_unique<DRC_RTREE>();
+
+        for( TRACK* track : m_board->Tracks() )
+            addToTree( track );
+
+        for( BOARD_ITEM* item : m_board->Drawings() )
+            addToTree( item );
+
+        for( ZONE_CONTAINER* zone : m_board->Zones() )
+            addToTree( zone );
+
+        for( MODULE* footprint : m_board->Modules() )
+            addToTree( footprint );
+    }
+    else
+    {
+        // Removed items may already have been deleted, and their addresses reused
+        for( const KIID& id : aRemovedItems )
+            m_itemTree->remove( id );
+
+        for( BOARD_ITEM* item : dirtyItems )
+        {
+            m_itemTree->remove( item->m_Uuid );
+            addToTree( item );
+        }
+    }
+
+    m_dirtyItemIds.clear();
+    m_invalidatedItems.clear();
+
+    for( BOARD_ITEM* item : dirtyItems )
+    {
+        forEachChild( item,
+                      [&]( BOARD_ITEM* child )
+                      {
+                          EDA_RECT bbox = child->GetBoundingBox();
+                          bbox.Inflate( worstClearance );
+
+                          m_dirtyItemIds.insert( child->m_Uuid );
+                          m_invalidatedItems.insert( child );
+
+                          for( PCB_LAYER_ID layer : LSET::AllLayersMask().Seq() )
+                          {
+                              for( DRC_RTREE::ITEM_WITH_SHAPE* entry :
+                                      m_itemTree->Overlapping( layer, bbox ) )
+                              {
+                                  m_invalidatedItems.insert( entry->parent );
+                              }
+                          }
+                      } );
+
+        // Footprint-level tests (courtyards, etc.) key off the footprint itself
+        m_dirtyItemIds.insert( item->m_Uuid );
+        m_invalidatedItems.insert( item );
+    }
+
+    ReportAux( wxString::Format( "Incremental run: %d dirty items, %d invalidated items",
+                                 (int) m_dirtyItemIds.size(),
+                                 (int) m_invalidatedItems.size() ) );
+
+    m_incremental = true;
+
+    runProviders();
+
+    m_incremental = false;
+    m_dirtyItemIds.clear();
+    m_invalidatedItems.clear();
+}
+
+
+bool DRC_ENGINE::IsItemInvalidated( const BOARD_ITEM* aItem ) const
+{
+    return !m_incremental || m_invalidatedItems.count( aItem ) > 0;
+}
+
+
+void DRC_ENGINE::runProviders()
+{
     if( m_progressReporter )
     {
         int phases = 0;
@@ -557,18 +754,263 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aTestTracksAgainstZones,
             m_errorLimits[ ii ] = INT_MAX;
     }
 
-    for( DRC_TEST_PROVIDER* provider : m_testProviders )
+    m_runThread = std::this_thread::get_id();
+
+    // Item properties don't change during a run, so constraints can be resolved once per
+    // (type, net, layer) combination.  Netclasses may have changed since the last run though.
+    clearConstraintCache();
+    m_constraintCacheEnabled = true;
+
+    // Update the shape caches in the pads to prevent multi-threaded rebuilds.
+    for( MODULE* module : m_board->Modules() )
     {
+        for( D_PAD* pad : module->Pads() )
+        {
+            if( pad->IsDirty() )
+                pad->BuildEffectiveShapes( UNDEFINED_LAYER );
+        }
+    }
+
+    std::vector<size_t>                       parallelProviders;
+    std::vector<std::vector<DEFERRED_REPORT>> reports( m_testProviders.size() );
+    std::vector<char>                         results( m_testProviders.size(), true );
+
+    // The serial providers can split their loops over the workers too
+    startWorkers();
+
+    // Providers which modify shared state (connectivity, courtyard caches, etc.) go first, on
+    // this thread, so that the parallel-safe ones see a stable board.
+    for( size_t ii = 0; ii < m_testProviders.size(); ++ii )
+    {
+        DRC_TEST_PROVIDER* provider = m_testProviders[ii];
+
         if( !provider->IsEnabled() )
             continue;
 
-        drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+        if( provider->IsParallelSafe() )
+        {
+            parallelProviders.push_back( ii );
+            continue;
+        }
 
-        ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
+        results[ii] = runProvider( provider, &reports[ii] );
 
-        if( !provider->Run() )
+        if( !results[ii] )
             break;
     }
+
+    // Note: parallelProviders only holds providers registered ahead of any serial provider
+    // which stopped the run.
+    if( !parallelProviders.empty() )
+    {
+        std::vector<std::atomic<double>> progress( parallelProviders.size() );
+        size_t                           finished = 0;
+        std::mutex                       finishedLock;
+        std::condition_variable          finishedCondition;
+
+        for( std::atomic<double>& providerProgress : progress )
+            providerProgress = 0.0;
+
+        m_pendingPhases = 0;
+
+        for( size_t i = 0; i < parallelProviders.size(); ++i )
+        {
+            queueTask(
+                    [&, i]()
+                    {
+                        size_t idx = parallelProviders[i];
+
+                        if( !m_progressReporter || !m_progressReporter->IsCancelled() )
+                        {
+                            s_providerProgress = &progress[i];
+                            results[idx] = runProvider( m_testProviders[idx], &reports[idx] );
+                            s_providerProgress = nullptr;
+                        }
+
+                        progress[i] = 0.0;
+
+                        std::lock_guard<std::mutex> lock( finishedLock );
+                        finished++;
+                        finishedCondition.notify_one();
+                    } );
+        }
+
+        // Providers report their progress and phases to us rather than to the reporter, so
+        // that their fractions add up instead of overwriting each other
+        auto updateProgress =
+                [&]()
+                {
+                    if( !m_progressReporter )
+                        return;
+
+                    for( int phases = m_pendingPhases.exchange( 0 ); phases > 0; --phases )
+                        m_progressReporter->AdvancePhase();
+
+                    double total = 0.0;
+
+                    for( const std::atomic<double>& providerProgress : progress )
+                        total += providerProgress;
+
+                    m_progressReporter->SetCurrentProgress( total );
+                    m_progressReporter->KeepRefreshing();
+                };
+
+        std::unique_lock<std::mutex> lock( finishedLock );
+
+        // Here we wait for the workers with a 100ms timeout to allow UI updating
+        auto allFinished =
+                [&]()
+                {
+                    return finished == parallelProviders.size();
+                };
+
+        while( !finishedCondition.wait_for( lock, std::chrono::milliseconds( 100 ), allFinished ) )
+        {
+            lock.unlock();
+            updateProgress();
+            lock.lock();
+        }
+
+        updateProgress();
+    }
+
+    stopWorkers();
+
+    // Deliver the results in registration order.  A provider returning false stops the run
+    // just as it would when running serially, so later providers' results are dropped.
+    for( size_t ii = 0; ii < m_testProviders.size(); ++ii )
+    {
+        for( const DEFERRED_REPORT& report : reports[ii] )
+        {
+            if( report.m_item )
+                flushViolation( report.m_item, report.m_pos );
+            else
+                ReportAux( report.m_auxMessage );
+        }
+
+        if( !results[ii] )
+            break;
+    }
+
+    m_constraintCacheEnabled = false;
+
+    ReportAux( wxString::Format( "Constraint cache: %d hits, %d misses, %d uncacheable",
+                                 (int) m_constraintCacheHits.load(),
+                                 (int) m_constraintCacheMisses.load(),
+                                 (int) m_constraintCacheUncacheable.load() ) );
+}
+
+
+size_t DRC_ENGINE::CONSTRAINT_CACHE_KEY_HASH::operator()( const CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    return hash_val( (int) aKey.m_type, (int) aKey.m_typeA, (int) aKey.m_typeB, aKey.m_netA,
+                     aKey.m_netB, (int) aKey.m_layer );
+}
+
+
+void DRC_ENGINE::clearConstraintCache()
+{
+    for( CONSTRAINT_CACHE_SHARD& shard : m_constraintCache )
+    {
+        std::lock_guard<std::mutex> lock( shard.m_lock );
+        shard.m_entries.clear();
+    }
+
+    m_constraintCacheHits = 0;
+    m_constraintCacheMisses = 0;
+    m_constraintCacheUncacheable = 0;
+}
+
+
+DRC_ENGINE::CONSTRAINT_CACHE_STATS DRC_ENGINE::GetConstraintCacheStats() const
+{
+    return { m_constraintCacheHits.load(), m_constraintCacheMisses.load(),
+             m_constraintCacheUncacheable.load() };
+}
+
+
+void DRC_ENGINE::startWorkers()
+{
+    stopWorkers();
+
+    size_t cores = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    m_stopWorkers = false;
+
+    for( size_t ii = 0; ii < cores; ++ii )
+        m_workers.emplace_back( &DRC_ENGINE::workerLoop, this );
+}
+
+
+void DRC_ENGINE::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_tasksLock );
+        m_stopWorkers = true;
+    }
+
+    m_tasksCondition.notify_all();
+
+    for( std::thread& worker : m_workers )
+        worker.join();
+
+    m_workers.clear();
+}
+
+
+void DRC_ENGINE::queueTask( std::function<void()> aTask )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_tasksLock );
+        m_tasks.push_back( std::move( aTask ) );
+    }
+
+    m_tasksCondition.notify_one();
+}
+
+
+void DRC_ENGINE::workerLoop()
+{
+    while( true )
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock( m_tasksLock );
+
+            m_tasksCondition.wait( lock,
+                                   [&]()
+                                   {
+                                       return m_stopWorkers || !m_tasks.empty();
+                                   } );
+
+            // Anything still queued when stopping is a helper of a finished RunChunked()
+            if( m_tasks.empty() )
+                return;
+
+            task = std::move( m_tasks.front() );
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+
+bool DRC_ENGINE::runProvider( DRC_TEST_PROVIDER* aProvider,
+                              std::vector<DEFERRED_REPORT>* aReports )
+{
+    s_deferredReports = aReports;
+
+    drc_dbg( 0, "Running test provider: '%s'\n", aProvider->GetName() );
+
+    ReportAux( wxString::Format( "Run DRC provider: '%s'", aProvider->GetName() ) );
+
+    bool ok = aProvider->Run();
+
+    s_deferredReports = nullptr;
+
+    return ok;
 }
 
 
@@ -596,10 +1038,19 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
         }
     }
 
-    const BOARD_CONNECTED_ITEM* connectedA = dynamic_cast<const BOARD_CONNECTED_ITEM*>( a );
-    const BOARD_CONNECTED_ITEM* connectedB = dynamic_cast<const BOARD_CONNECTED_ITEM*>( b );
+    const BOARD_CONNECTED_ITEM* connectedA = nullptr;
+    const BOARD_CONNECTED_ITEM* connectedB = nullptr;
     const DRC_CONSTRAINT*       constraintRef = nullptr;
     bool                        implicit = false;
+    bool                        itemDependent = false;
+    wxString                    msg;    // May be called from several providers at once
+
+    // IsConnected() is much cheaper than a dynamic_cast
+    if( a->IsConnected() )
+        connectedA = static_cast<const BOARD_CONNECTED_ITEM*>( a );
+
+    if( b && b->IsConnected() )
+        connectedB = static_cast<const BOARD_CONNECTED_ITEM*>( b );
 
     // Local overrides take precedence
     if( aConstraintId == DRC_CONSTRAINT_TYPE_CLEARANCE )
@@ -609,7 +1060,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( connectedA && connectedA->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideA = connectedA->GetLocalClearanceOverrides( &m_msg );
+            overrideA = connectedA->GetLocalClearanceOverrides( &msg );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -619,7 +1070,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( connectedB && connectedB->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideB = connectedB->GetLocalClearanceOverrides( &m_msg );
+            overrideB = connectedB->GetLocalClearanceOverrides( &msg );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -629,7 +1080,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( overrideA || overrideB )
         {
-            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, m_msg );
+            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, msg );
             constraint.m_Value.SetMin( std::max( overrideA, overrideB ) );
             return constraint;
         }
@@ -712,6 +1163,9 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                                   c->condition->GetExpression() ) )
                     }
 
+                    if( c->condition->HasItemDependencies() )
+                        itemDependent = true;
+
                     if( c->condition->EvaluateFor( a, b, aLayer, aReporter ) )
                     {
                         REPORT( implicit ? _( "Constraint applied." )
@@ -730,9 +1184,42 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                 }
             };
 
-    if( m_constraintMap.count( aConstraintId ) )
+    // The rule walk below only depends on the key unless an item-dependent condition is
+    // visited.  Reporting runs want to see the whole walk, so never use the cache for them.
+    bool                 useCache = m_constraintCacheEnabled && !aReporter;
+    bool                 cacheHit = false;
+    CONSTRAINT_CACHE_KEY key;
+    size_t               shardIdx = 0;
+
+    if( useCache )
     {
-        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = m_constraintMap[ aConstraintId ];
+        key.m_type  = aConstraintId;
+        key.m_typeA = a->Type();
+        key.m_typeB = b ? b->Type() : TYPE_NOT_INIT;
+        key.m_netA  = connectedA ? connectedA->GetNetCode() : -1;
+        key.m_netB  = connectedB ? connectedB->GetNetCode() : -1;
+        key.m_layer = aLayer;
+
+        shardIdx = CONSTRAINT_CACHE_KEY_HASH()( key ) % CONSTRAINT_CACHE_SHARDS;
+
+        CONSTRAINT_CACHE_SHARD&     shard = m_constraintCache[ shardIdx ];
+        std::lock_guard<std::mutex> lock( shard.m_lock );
+        auto                        it = shard.m_entries.find( key );
+
+        if( it != shard.m_entries.end() )
+        {
+            constraintRef = it->second.m_constraint;
+            implicit = it->second.m_implicit;
+            cacheHit = true;
+            m_constraintCacheHits++;
+        }
+    }
+
+    auto ruleIt = cacheHit ? m_constraintMap.end() : m_constraintMap.find( aConstraintId );
+
+    if( ruleIt != m_constraintMap.end() )
+    {
+        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = ruleIt->second;
 
         if( aReporter )
         {
@@ -753,6 +1240,22 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
         }
     }
 
+    if( useCache && !cacheHit )
+    {
+        if( itemDependent )
+        {
+            m_constraintCacheUncacheable++;
+        }
+        else
+        {
+            CONSTRAINT_CACHE_SHARD&     shard = m_constraintCache[ shardIdx ];
+            std::lock_guard<std::mutex> lock( shard.m_lock );
+
+            shard.m_entries[ key ] = { constraintRef, implicit };
+            m_constraintCacheMisses++;
+        }
+    }
+
     // Unfortunately implicit rules don't work for local clearances (such as zones) because
     // they have to be max'ed with netclass values (which are already implicit rules), and our
     // rule selection paradigm is "winner takes all".
@@ -771,7 +1274,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localA ) ) )
 
             if( localA > clearance )
-                clearance = connectedA->GetLocalClearance( &m_msg );
+                clearance = connectedA->GetLocalClearance( &msg );
         }
 
         if( localB > 0 )
@@ -782,12 +1285,12 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localB ) ) )
 
             if( localB > clearance )
-                clearance = connectedB->GetLocalClearance( &m_msg );
+                clearance = connectedB->GetLocalClearance( &msg );
         }
 
         if( localA > global || localB > global )
         {
-            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, m_msg );
+            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, msg );
             constraint.m_Value.SetMin( clearance );
             return constraint;
         }
@@ -795,7 +1298,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
     // fixme: return optional<drc_constraint>, let the particular test decide what to do if no matching constraint
     // is found
-    static DRC_CONSTRAINT nullConstraint( DRC_CONSTRAINT_TYPE_NULL );
+    DRC_CONSTRAINT nullConstraint( DRC_CONSTRAINT_TYPE_NULL );
     nullConstraint.m_DisallowFlags = 0;
 
     return constraintRef ? *constraintRef : nullConstraint;
@@ -805,6 +1308,127 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 }
 
 
+bool DRC_ENGINE::RunChunked( size_t aCount, size_t aChunkSize,
+                             const std::function<void( size_t aBegin, size_t aEnd )>& aFunc )
+{
+    size_t chunkCount = ( aCount + aChunkSize - 1 ) / aChunkSize;
+
+    if( chunkCount == 0 )
+        return true;
+
+    // Not worth handing over to the workers, or there are none to hand it to
+    if( chunkCount == 1 || m_workers.empty() )
+    {
+        for( size_t begin = 0; begin < aCount; begin += aChunkSize )
+        {
+            if( !ReportProgress( (double) begin / (double) aCount ) )
+                return false;
+
+            aFunc( begin, std::min( begin + aChunkSize, aCount ) );
+        }
+
+        return !m_progressReporter || !m_progressReporter->IsCancelled();
+    }
+
+    // Queued helpers can outlive this call (they find nothing left to do), so the state they
+    // share is reference counted
+    struct JOB
+    {
+        JOB( size_t aChunkCount ) :
+                m_reports( aChunkCount ),
+                m_nextChunk( 0 ),
+                m_finishedChunks( 0 ),
+                m_done( 0 )
+        {}
+
+        std::vector<std::vector<DEFERRED_REPORT>> m_reports;
+        std::atomic<size_t>                       m_nextChunk;
+        size_t                                    m_finishedChunks;
+        std::atomic<size_t>                       m_done;
+        std::mutex                                m_finishedLock;
+        std::condition_variable                   m_finishedCondition;
+    };
+
+    std::shared_ptr<JOB> job = std::make_shared<JOB>( chunkCount );
+    std::thread::id      caller = std::this_thread::get_id();
+
+    auto run_lambda =
+            [this, job, chunkCount, aCount, aChunkSize, caller, &aFunc]()
+            {
+                std::vector<DEFERRED_REPORT>* providerReports = s_deferredReports;
+
+                for( size_t i = job->m_nextChunk++; i < chunkCount; i = job->m_nextChunk++ )
+                {
+                    if( !m_progressReporter || !m_progressReporter->IsCancelled() )
+                    {
+                        size_t begin = i * aChunkSize;
+                        size_t end = std::min( begin + aChunkSize, aCount );
+
+                        s_deferredReports = &job->m_reports[i];
+                        aFunc( begin, end );
+                        s_deferredReports = providerReports;
+
+                        job->m_done += end - begin;
+
+                        if( std::this_thread::get_id() == caller )
+                            ReportProgress( (double) job->m_done / (double) aCount );
+                    }
+
+                    std::lock_guard<std::mutex> lock( job->m_finishedLock );
+
+                    if( ++job->m_finishedChunks == chunkCount )
+                        job->m_finishedCondition.notify_all();
+                }
+            };
+
+    // A worker running a provider works through the chunks itself, helped by any idle
+    // workers.  The run thread only hands the chunks out, as it has to keep the UI alive.
+    bool   callerHelps = caller != m_runThread;
+    size_t cores = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+    size_t helpers = std::min( cores, chunkCount ) - ( callerHelps ? 1 : 0 );
+
+    for( size_t ii = 0; ii < helpers; ++ii )
+        queueTask( run_lambda );
+
+    if( callerHelps )
+        run_lambda();
+
+    // Wait for the chunks still running on other workers, reporting progress every 100ms
+    {
+        std::unique_lock<std::mutex> lock( job->m_finishedLock );
+
+        while( !job->m_finishedCondition.wait_for( lock, std::chrono::milliseconds( 100 ),
+                                                   [&]()
+                                                   {
+                                                       return job->m_finishedChunks == chunkCount;
+                                                   } ) )
+        {
+            lock.unlock();
+            ReportProgress( (double) job->m_done / (double) aCount );
+            lock.lock();
+        }
+    }
+
+    ReportProgress( 1.0 );
+
+    // Hand the reports over in index order, to the provider's own buffer if it has one
+    for( std::vector<DEFERRED_REPORT>& chunkReports : job->m_reports )
+    {
+        for( DEFERRED_REPORT& report : chunkReports )
+        {
+            if( s_deferredReports )
+                s_deferredReports->push_back( std::move( report ) );
+            else if( report.m_item )
+                flushViolation( report.m_item, report.m_pos );
+            else
+                ReportAux( report.m_auxMessage );
+        }
+    }
+
+    return !m_progressReporter || !m_progressReporter->IsCancelled();
+}
+
+
 bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 {
     assert( error_code >= 0 && error_code <= DRCE_LAST );
@@ -814,8 +1438,26 @@ bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 
 void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
 {
+    // Violations between untouched items are still on the board from the previous run, unless
+    // they come from a provider which tests the whole board every time
+    if( m_incremental && aItem->GetViolatingTest()->SupportsIncremental()
+            && !m_dirtyItemIds.count( aItem->GetMainItemID() )
+            && !m_dirtyItemIds.count( aItem->GetAuxItemID() ) )
+    {
+        return;
+    }
+
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
 
+    if( s_deferredReports )
+        s_deferredReports->push_back( { aItem, aPos, wxEmptyString } );
+    else
+        flushViolation( aItem, aPos );
+}
+
+
+void DRC_ENGINE::flushViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+{
     if( m_violationHandler )
         m_violationHandler( aItem, aPos );
 
@@ -846,6 +1488,12 @@ void DRC_ENGINE::ReportAux ( const wxString& aStr )
     if( !m_reporter )
         return;
 
+    if( s_deferredReports )
+    {
+        s_deferredReports->push_back( { nullptr, wxPoint(), aStr } );
+        return;
+    }
+
     m_reporter->Report( aStr, RPT_SEVERITY_INFO );
 }
 
@@ -855,7 +1503,18 @@ bool DRC_ENGINE::ReportProgress( double aProgress )
     if( !m_progressReporter )
         return true;
 
+    // KeepRefreshing() may only be called from the main thread; RunTests() pumps it for us
+    // while the parallel providers are running, and reports the sum of their progress.
+    if( std::this_thread::get_id() != m_runThread )
+    {
+        if( s_providerProgress )
+            *s_providerProgress = aProgress;
+
+        return !m_progressReporter->IsCancelled();
+    }
+
     m_progressReporter->SetCurrentProgress( aProgress );
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -865,7 +1524,19 @@ bool DRC_ENGINE::ReportPhase( const wxString& aMessage )
     if( !m_progressReporter )
         return true;
 
+    if( std::this_thread::get_id() != m_runThread )
+    {
+        // The run thread advances the phase when it next reports the providers' progress
+        if( s_providerProgress )
+            *s_providerProgress = 0.0;
+
+        m_pendingPhases++;
+        m_progressReporter->Report( aMessage );
+        return !m_progressReporter->IsCancelled();
+    }
+
     m_progressReporter->AdvancePhase( aMessage );
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -24,15 +24,24 @@
 #ifndef DRC_ENGINE_H
 #define DRC_ENGINE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <drc/drc_rule.h>
 
 
 class BOARD_DESIGN_SETTINGS;
 class DRC_TEST_PROVIDER;
+class DRC_RTREE;
 class PCB_EDIT_FRAME;
 class BOARD_ITEM;
 class BOARD;
@@ -139,6 +148,15 @@ public:
 
     /**
      * Runs the DRC tests.
+     *
+     * Providers which modify shared board state are run first, in registration order, on the
+     * calling thread.  Providers which declare themselves parallel-safe are then run
+     * concurrently, and may also split their item loops into chunks (see RunChunked()).  The
+     * providers and their chunks share a single pool of one worker thread per core.
+     * Violations are buffered per provider and delivered to the violation
+     * handler in registration order once all providers have finished, so the report is the
+     * same regardless of thread scheduling.
+     *
      * @param aUnits
      * @param aTestTracksAgainstZones
      * @param aReportAllTrackErrors
@@ -148,6 +166,32 @@ public:
                    bool aReportAllTrackErrors = true, bool aTestFootprints = true );
 
 
+    /**
+     * Runs the tests again for the items touched since the last run only.
+     *
+     * The dirty items and everything within the worst clearance of them are handed to the
+     * providers which support incremental runs (see DRC_TEST_PROVIDER::SupportsIncremental()),
+     * and only their violations involving a dirty item are reported.  The other providers test
+     * the whole board and report all of their violations.  So the caller is expected to keep
+     * the markers from the previous run except those which refer to a dirty or removed item,
+     * or come from a provider without incremental support.
+     *
+     * The spatial index used to find neighbours is kept between incremental runs (and rebuilt
+     * after every full run).
+     *
+     * @param aUnits are the units used in violation messages.
+     * @param aDirtyItems are items added or modified since the last run.
+     * @param aRemovedItems are the ids of the items removed since the last run.
+     */
+    void RunIncrementalTests( EDA_UNITS aUnits, const std::vector<BOARD_ITEM*>& aDirtyItems,
+                              const std::set<KIID>& aRemovedItems );
+
+    /**
+     * @return false if an incremental run is in progress and aItem is neither dirty nor within
+     *         the worst clearance of a dirty item (and so need not be tested).
+     */
+    bool IsItemInvalidated( const BOARD_ITEM* aItem ) const;
+
     bool IsErrorLimitExceeded( int error_code );
 
     DRC_CONSTRAINT EvalRulesForItems( DRC_CONSTRAINT_TYPE_T ruleID, const BOARD_ITEM* a,
@@ -155,6 +199,30 @@ public:
                                       PCB_LAYER_ID aLayer = UNDEFINED_LAYER,
                                       REPORTER* aReporter = nullptr );
 
+    /**
+     * Hit/miss counts of the constraint resolution cache over the last run.  Lookups whose
+     * outcome depends on a rule condition looking at per-item data (see
+     * DRC_RULE_CONDITION::HasItemDependencies()) are counted as uncacheable.
+     */
+    struct CONSTRAINT_CACHE_STATS
+    {
+        size_t m_hits;
+        size_t m_misses;
+        size_t m_uncacheable;
+    };
+
+    CONSTRAINT_CACHE_STATS GetConstraintCacheStats() const;
+
+    /**
+     * Enable (and empty) the constraint resolution cache outside of the test runs, which
+     * always use it.  Used by the QA tests to compare cached and uncached resolutions.
+     */
+    void SetConstraintCacheEnabled( bool aEnable )
+    {
+        clearConstraintCache();
+        m_constraintCacheEnabled = aEnable;
+    }
+
     std::vector<DRC_CONSTRAINT> QueryConstraintsById( DRC_CONSTRAINT_TYPE_T ruleID );
 
     bool HasRulesForConstraintType( DRC_CONSTRAINT_TYPE_T constraintID );
@@ -166,6 +234,33 @@ public:
 
     bool RulesValid() { return m_rulesValid; }
 
+    /**
+     * @return a hash of the compiled rules (implicit and user), which changes whenever the
+     *         outcome of a test might.  Used to decide whether an incremental run is possible.
+     */
+    size_t GetRulesFingerprint() const { return m_rulesFingerprint; }
+
+    /**
+     * @return true if any clearance rule has a condition which depends on more than the
+     *         types, nets and netclasses of the items (see
+     *         DRC_RULE_CONDITION::HasItemDependencies()).
+     */
+    bool HasItemDependentClearanceRules() const { return m_itemDependentClearanceRules; }
+
+    /**
+     * Runs aFunc over the ranges [begin, end) of aChunkSize indexes covering [0, aCount), on
+     * the worker pool of the run.  A parallel provider's own thread works through its chunks
+     * too.  A single chunk, or a call made outside of a run, is run directly on the calling
+     * thread.  Violations and messages reported from aFunc are delivered in index order, as
+     * if the ranges had been run one after the other on the calling thread.
+     *
+     * aFunc must only read the board, and must not report progress (this does it instead).
+     *
+     * @return false if the run was cancelled.
+     */
+    bool RunChunked( size_t aCount, size_t aChunkSize,
+                     const std::function<void( size_t aBegin, size_t aEnd )>& aFunc );
+
     void ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
     bool ReportProgress( double aProgress );
     bool ReportPhase( const wxString& aMessage );
@@ -203,10 +298,81 @@ private:
         DRC_CONSTRAINT       constraint;
     };
 
+    /**
+     * Everything the rule walk in EvalRulesForItems() depends on, as long as no item-dependent
+     * condition is visited.  Netclasses follow from the nets.
+     */
+    struct CONSTRAINT_CACHE_KEY
+    {
+        DRC_CONSTRAINT_TYPE_T m_type;
+        KICAD_T               m_typeA;
+        KICAD_T               m_typeB;
+        int                   m_netA;      // -1 for unconnected items
+        int                   m_netB;
+        PCB_LAYER_ID          m_layer;
+
+        bool operator==( const CONSTRAINT_CACHE_KEY& aOther ) const
+        {
+            return m_type == aOther.m_type && m_typeA == aOther.m_typeA
+                    && m_typeB == aOther.m_typeB && m_netA == aOther.m_netA
+                    && m_netB == aOther.m_netB && m_layer == aOther.m_layer;
+        }
+    };
+
+    struct CONSTRAINT_CACHE_KEY_HASH
+    {
+        size_t operator()( const CONSTRAINT_CACHE_KEY& aKey ) const;
+    };
+
+    struct CONSTRAINT_CACHE_ENTRY
+    {
+        const DRC_CONSTRAINT* m_constraint;    // nullptr if no rule matched
+        bool                  m_implicit;
+    };
+
+    // Sharded so that provider threads rarely contend for the same lock
+    static constexpr size_t CONSTRAINT_CACHE_SHARDS = 16;
+
+    struct CONSTRAINT_CACHE_SHARD
+    {
+        std::mutex                                              m_lock;
+        std::unordered_map<CONSTRAINT_CACHE_KEY, CONSTRAINT_CACHE_ENTRY,
+                           CONSTRAINT_CACHE_KEY_HASH>           m_entries;
+    };
+
+    void clearConstraintCache();
+
     void loadImplicitRules();
     void loadTestProviders();
     DRC_RULE* createImplicitRule( const wxString& name );
 
+    /**
+     * A violation or log message produced by a provider, held back until all providers have
+     * finished so that the report order doesn't depend on thread scheduling.
+     */
+    struct DEFERRED_REPORT
+    {
+        std::shared_ptr<DRC_ITEM> m_item;     // nullptr for aux messages
+        wxPoint                   m_pos;
+        wxString                  m_auxMessage;
+    };
+
+    void runProviders();
+    bool runProvider( DRC_TEST_PROVIDER* aProvider, std::vector<DEFERRED_REPORT>* aReports );
+    void flushViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
+
+    void startWorkers();
+    void stopWorkers();
+    void queueTask( std::function<void()> aTask );
+    void workerLoop();
+
+    // Report buffer of the provider running on the current thread (if any)
+    static thread_local std::vector<DEFERRED_REPORT>* s_deferredReports;
+
+    // Progress through the current phase of the parallel provider running on the current
+    // thread (if any).  The run thread adds these up and reports the total.
+    static thread_local std::atomic<double>* s_providerProgress;
+
 protected:
     BOARD_DESIGN_SETTINGS*           m_designSettings;
     BOARD*                           m_board;
@@ -216,13 +382,38 @@ protected:
     std::vector<DRC_RULE_CONDITION*> m_ruleConditions;
     std::vector<DRC_RULE*>           m_rules;
     bool                             m_rulesValid;
+    size_t                           m_rulesFingerprint;
+    bool                             m_itemDependentClearanceRules;
     std::vector<DRC_TEST_PROVIDER*>  m_testProviders;
 
     EDA_UNITS                        m_userUnits;
-    std::vector<int>                 m_errorLimits;
+    std::vector<std::atomic<int>>    m_errorLimits;
     bool                             m_testTracksAgainstZones;
     bool                             m_reportAllTrackErrors;
     bool                             m_testFootprints;
+    std::thread::id                  m_runThread;
+
+    // Worker pool of a run, shared by the parallel providers and their chunks
+    std::vector<std::thread>               m_workers;
+    std::deque<std::function<void()>>      m_tasks;
+    std::mutex                             m_tasksLock;
+    std::condition_variable                m_tasksCondition;
+    bool                                   m_stopWorkers;
+    std::atomic<int>                       m_pendingPhases;
+
+    // Incremental run state
+    std::unique_ptr<DRC_RTREE>             m_itemTree;
+    bool                                   m_incremental;
+    std::set<KIID>                         m_dirtyItemIds;
+    std::unordered_set<const BOARD_ITEM*>  m_invalidatedItems;
+
+    // Constraint resolution cache; only used while tests are running as item properties
+    // (and so the keys) are stable then
+    bool                                   m_constraintCacheEnabled;
+    CONSTRAINT_CACHE_SHARD                 m_constraintCache[ CONSTRAINT_CACHE_SHARDS ];
+    std::atomic<size_t>                    m_constraintCacheHits;
+    std::atomic<size_t>                    m_constraintCacheMisses;
+    std::atomic<size_t>                    m_constraintCacheUncacheable;
 
     // constraint -> rule -> provider
     std::unordered_map< DRC_CONSTRAINT_TYPE_T,
@@ -232,7 +423,6 @@ protected:
     REPORTER*                        m_reporter;
     PROGRESS_REPORTER*               m_progressReporter;
 
-    wxString m_msg;  // Allocating strings gets expensive enough to want to avoid it
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
 };
 
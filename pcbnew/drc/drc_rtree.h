@@ -30,6 +30,7 @@
 #include <class_track.h>
 #include <class_zone.h>
 #include <unordered_set>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -82,6 +83,56 @@ public:
      * Inserts an item into the tree. Item's bounding box is taken via its GetBoundingBox() method.
      */
     void insert( BOARD_ITEM* aItem )
+    {
+        insert( aItem, nullptr );
+    }
+
+    /**
+     * Inserts an item into the tree and records its entries under aOwner (the item itself, or
+     * the footprint it belongs to), so that they can be removed with remove() once the item
+     * has been changed or deleted.
+     */
+    void insert( BOARD_ITEM* aItem, const KIID& aOwner )
+    {
+        insert( aItem, &m_ownedEntries[ aOwner ] );
+    }
+
+    /**
+     * Removes the entries recorded under aOwner by insert().  Neither the items nor their
+     * current bounding boxes are needed, so the items may have been moved or deleted since.
+     * @return true if any entries were removed.
+     */
+    bool remove( const KIID& aOwner )
+    {
+        auto it = m_ownedEntries.find( aOwner );
+
+        if( it == m_ownedEntries.end() )
+            return false;
+
+        for( const OWNED_ENTRY& owned : it->second )
+        {
+            const int mmin[2] = { owned.bbox.GetX(), owned.bbox.GetY() };
+            const int mmax[2] = { owned.bbox.GetRight(), owned.bbox.GetBottom() };
+
+            m_tree[owned.layer]->Remove( mmin, mmax, owned.entry );
+            delete owned.entry;
+            m_count--;
+        }
+
+        m_ownedEntries.erase( it );
+        return true;
+    }
+
+private:
+    /// An entry of the tree, with what is needed to remove it
+    struct OWNED_ENTRY
+    {
+        int              layer;
+        BOX2I            bbox;
+        ITEM_WITH_SHAPE* entry;
+    };
+
+    void insert( BOARD_ITEM* aItem, std::vector<OWNED_ENTRY>* aOwnedEntries )
     {
         std::vector<SHAPE*> subshapes;
 
@@ -104,12 +155,19 @@ public:
                 const int mmin[2] = { bbox.GetX(), bbox.GetY() };
                 const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
 
-                m_tree[layer]->Insert( mmin, mmax, new ITEM_WITH_SHAPE( aItem, subshape, itemShape ) );
+                ITEM_WITH_SHAPE* entry = new ITEM_WITH_SHAPE( aItem, subshape, itemShape );
+
+                m_tree[layer]->Insert( mmin, mmax, entry );
                 m_count++;
+
+                if( aOwnedEntries )
+                    aOwnedEntries->push_back( { layer, bbox, entry } );
             }
         }
     }
 
+public:
+
 #if 0
     /**
      * Function Remove()
@@ -177,6 +235,7 @@ public:
         for( auto tree : m_tree )
             tree->RemoveAll();
 
+        m_ownedEntries.clear();
         m_count = 0;
     }
 
@@ -528,6 +587,8 @@ public:
 private:
     drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
     size_t      m_count;
+
+    std::map<KIID, std::vector<OWNED_ENTRY>> m_ownedEntries;
 };
 
 
@@ -27,6 +27,9 @@
 #include <drc/drc_rule_condition.h>
 #include <pcb_expr_evaluator.h>
 
+#include <memory>
+#include <vector>
+
 
 DRC_RULE_CONDITION::DRC_RULE_CONDITION( const wxString& aExpression ) :
     m_expression( aExpression ),
@@ -54,9 +57,27 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
         return false;
     }
 
-    PCB_EXPR_CONTEXT ctx( aLayer );
+    // Reused so that evaluations in the DRC loops don't allocate (once warmed up).  One set per
+    // thread as providers may run concurrently, and one context per nesting level within it as
+    // evaluating a condition may evaluate others (through a property getter, for instance).
+    static thread_local std::vector<std::unique_ptr<PCB_EXPR_CONTEXT>> s_contexts;
+    static thread_local size_t                                         s_depth = 0;
+
+    struct DEPTH_GUARD
+    {
+        DEPTH_GUARD()  { s_depth++; }
+        ~DEPTH_GUARD() { s_depth--; }
+    };
+
+    if( s_depth == s_contexts.size() )
+        s_contexts.push_back( std::make_unique<PCB_EXPR_CONTEXT>() );
+
+    PCB_EXPR_CONTEXT& ctx = *s_contexts[ s_depth ];
+    DEPTH_GUARD       guard;
+
+    ctx.SetLayer( aLayer );
     ctx.SetErrorCallback(
-            [&]( const wxString& aMessage, int aOffset )
+            [aReporter]( const wxString& aMessage, int aOffset )
             {
                 if( aReporter )
                     aReporter->Report( _( "ERROR: " ) + aMessage );
@@ -83,6 +104,13 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
 }
 
 
+bool DRC_RULE_CONDITION::HasItemDependencies() const
+{
+    // Without ucode the result is always false, which is as cacheable as it gets
+    return m_ucode && m_ucode->HasItemDependencies();
+}
+
+
 bool DRC_RULE_CONDITION::Compile( REPORTER* aReporter, int aSourceLine, int aSourceOffset )
 {
     PCB_EXPR_COMPILER compiler;
@@ -47,6 +47,12 @@ public:
     void SetExpression( const wxString& aExpression ) { m_expression = aExpression; }
     wxString GetExpression() const { return m_expression; }
 
+    /**
+     * @return true if the condition depends on more than the types, nets and netclasses of
+     *         the items (and the layer), and so can't be cached on those.
+     */
+    bool HasItemDependencies() const;
+
 private:
     wxString                        m_expression;
     std::unique_ptr<PCB_EXPR_UCODE> m_ucode;
@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <mutex>
+
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
 #include <drc/drc_test_provider.h>
@@ -30,6 +32,9 @@
 #include <class_zone.h>
 #include <pcb_text.h>
 
+thread_local std::unordered_map<const DRC_RULE*, int>* DRC_TEST_PROVIDER::s_chunkStats = nullptr;
+
+
 DRC_TEST_PROVIDER::DRC_TEST_PROVIDER() :
     m_drcEngine( nullptr )
 {
@@ -77,6 +82,13 @@ void DRC_TEST_PROVIDER::reportAux( wxString fmt, ... )
 }
 
 
+bool DRC_TEST_PROVIDER::isInvalidated( const BOARD_ITEM* aItem ) const
+{
+    // Providers without incremental support test everything every time
+    return !SupportsIncremental() || m_drcEngine->IsItemInvalidated( aItem );
+}
+
+
 EDA_UNITS DRC_TEST_PROVIDER::userUnits() const
 {
     return m_drcEngine->UserUnits();
@@ -85,12 +97,13 @@ EDA_UNITS DRC_TEST_PROVIDER::userUnits() const
 
 void DRC_TEST_PROVIDER::accountCheck( const DRC_RULE* ruleToTest )
 {
-    auto it = m_stats.find( ruleToTest );
+    std::unordered_map<const DRC_RULE*, int>& stats = s_chunkStats ? *s_chunkStats : m_stats;
+    auto                                      it = stats.find( ruleToTest );
 
-    if( it == m_stats.end() )
-        m_stats[ ruleToTest ] = 1;
+    if( it == stats.end() )
+        stats[ ruleToTest ] = 1;
     else
-        m_stats[ ruleToTest ] += 1;
+        stats[ ruleToTest ] += 1;
 }
 
 
@@ -100,6 +113,28 @@ void DRC_TEST_PROVIDER::accountCheck( const DRC_CONSTRAINT& constraintToTest )
 }
 
 
+bool DRC_TEST_PROVIDER::runChunked( size_t aCount, size_t aChunkSize,
+                                    const std::function<void( size_t, size_t )>& aFunc )
+{
+    std::mutex statsLock;
+
+    return m_drcEngine->RunChunked( aCount, aChunkSize,
+            [&]( size_t aBegin, size_t aEnd )
+            {
+                std::unordered_map<const DRC_RULE*, int> stats;
+
+                s_chunkStats = &stats;
+                aFunc( aBegin, aEnd );
+                s_chunkStats = nullptr;
+
+                std::lock_guard<std::mutex> lock( statsLock );
+
+                for( const std::pair<const DRC_RULE* const, int>& stat : stats )
+                    m_stats[ stat.first ] += stat.second;
+            } );
+}
+
+
 void DRC_TEST_PROVIDER::reportRuleStatistics()
 {
     if( !m_isRuleDriven )
@@ -139,7 +174,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
     for( TRACK* item : brd->Tracks() )
     {
-        if( (item->GetLayerSet() & aLayers).any() )
+        if( (item->GetLayerSet() & aLayers).any() && isInvalidated( item ) )
         {
             if( typeMask[ PCB_TRACE_T ] && item->Type() == PCB_TRACE_T )
             {
@@ -161,7 +196,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
     for( BOARD_ITEM* item : brd->Drawings() )
     {
-        if( (item->GetLayerSet() & aLayers).any() )
+        if( (item->GetLayerSet() & aLayers).any() && isInvalidated( item ) )
         {
             if( typeMask[PCB_DIMENSION_T] && BaseType( item->Type() ) == PCB_DIMENSION_T )
             {
@@ -198,7 +233,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     {
         for( ZONE_CONTAINER* item : brd->Zones() )
         {
-            if( (item->GetLayerSet() & aLayers).any() )
+            if( (item->GetLayerSet() & aLayers).any() && isInvalidated( item ) )
             {
                 if( !aFunc( item ) )
                     return n;
@@ -212,7 +247,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     {
         if( typeMask[ PCB_FP_TEXT_T ] )
         {
-            if( (mod->Reference().GetLayerSet() & aLayers).any() )
+            if( (mod->Reference().GetLayerSet() & aLayers).any()
+                    && isInvalidated( &mod->Reference() ) )
             {
                 if( !aFunc( &mod->Reference() ) )
                     return n;
@@ -220,7 +256,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
                 n++;
             }
 
-            if( (mod->Value().GetLayerSet() & aLayers).any() )
+            if( (mod->Value().GetLayerSet() & aLayers).any()
+                    && isInvalidated( &mod->Value() ) )
             {
                 if( !aFunc( &mod->Value() ) )
                     return n;
@@ -233,7 +270,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             for( D_PAD* pad : mod->Pads() )
             {
-                if( ( pad->GetLayerSet() & aLayers ).any() )
+                if( ( pad->GetLayerSet() & aLayers ).any() && isInvalidated( pad ) )
                 {
                     if( !aFunc( pad ) )
                         return n;
@@ -245,7 +282,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
         for( BOARD_ITEM* dwg : mod->GraphicalItems() )
         {
-            if( (dwg->GetLayerSet() & aLayers).any() )
+            if( (dwg->GetLayerSet() & aLayers).any() && isInvalidated( dwg ) )
             {
                 if( typeMask[ PCB_FP_TEXT_T ] && dwg->Type() == PCB_FP_TEXT_T )
                 {
@@ -268,7 +305,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             for( ZONE_CONTAINER* zone : mod->Zones() )
             {
-                if( (zone->GetLayerSet() & aLayers).any() )
+                if( (zone->GetLayerSet() & aLayers).any() && isInvalidated( zone ) )
                 {
                     if( ! aFunc( zone ) )
                         return n;
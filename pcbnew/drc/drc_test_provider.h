@@ -97,6 +97,26 @@ public:
         return m_isRuleDriven;
     }
 
+    /**
+     * Returns true if the provider only reads shared board state (and keeps everything it
+     * writes in its own members), in which case the engine may run it concurrently with
+     * other parallel-safe providers.
+     */
+    virtual bool IsParallelSafe() const
+    {
+        return false;
+    }
+
+    /**
+     * Returns true if the provider only tests items (or pairs of items) which are close to each
+     * other, and skips items for which isInvalidated() returns false.  The other providers test
+     * the whole board in DRC_ENGINE::RunIncrementalTests() too.
+     */
+    virtual bool SupportsIncremental() const
+    {
+        return false;
+    }
+
     bool IsEnabled() const
     {
         return m_enabled;
@@ -120,8 +140,22 @@ protected:
     virtual void accountCheck( const DRC_RULE* ruleToTest );
     virtual void accountCheck( const DRC_CONSTRAINT& constraintToTest );
 
+    /**
+     * Runs aFunc over [0, aCount) in chunks on worker threads (see DRC_ENGINE::RunChunked()).
+     * Rule statistics are counted per chunk and merged afterwards; aFunc must not use m_msg.
+     *
+     * @return false if the run was cancelled.
+     */
+    bool runChunked( size_t aCount, size_t aChunkSize,
+                     const std::function<void( size_t aBegin, size_t aEnd )>& aFunc );
+
     bool isInvisibleText( const BOARD_ITEM* aItem ) const;
 
+    /**
+     * @return false if aItem is untouched by an incremental run and can be skipped.
+     */
+    bool isInvalidated( const BOARD_ITEM* aItem ) const;
+
     EDA_UNITS   userUnits() const;
     DRC_ENGINE* m_drcEngine;
     std::unordered_map<const DRC_RULE*, int> m_stats;
@@ -129,6 +163,10 @@ protected:
     bool m_enabled = true;
 
     wxString    m_msg;  // Allocating strings gets expensive enough to want to avoid it
+
+private:
+    // Rule statistics of the chunk running on the current thread (if any)
+    static thread_local std::unordered_map<const DRC_RULE*, int>* s_chunkStats;
 };
 
 #endif // DRC_TEST_PROVIDER__H
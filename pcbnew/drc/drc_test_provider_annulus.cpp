@@ -63,6 +63,10 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
 };
 
 
@@ -147,6 +151,9 @@ bool DRC_TEST_PROVIDER_ANNULUS::Run()
         if( !reportProgress( ii++, board->Tracks().size(), delta ) )
             break;
 
+        if( !isInvalidated( item ) )
+            continue;
+
         if( !checkAnnulus( item ) )
             break;
     }
@@ -78,6 +78,10 @@ public:
 
     int GetNumPhases() const override;
 
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
+
 private:
     void testPadClearances();
 
@@ -151,11 +155,12 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperTextAndGraphics()
 {
     // Test copper items for clearance violations with vias, tracks and pads
+    std::vector<BOARD_ITEM*> items;
 
     for( BOARD_ITEM* brdItem : m_board->Drawings() )
     {
         if( IsCopperLayer( brdItem->GetLayer() ) )
-            testCopperDrawItem( brdItem );
+            items.push_back( brdItem );
     }
 
     for( MODULE* module : m_board->Modules() )
@@ -164,10 +169,10 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperTextAndGraphics()
         FP_TEXT& val = module->Value();
 
         if( ref.IsVisible() && IsCopperLayer( ref.GetLayer() ) )
-            testCopperDrawItem( &ref );
+            items.push_back( &ref );
 
         if( val.IsVisible() && IsCopperLayer( val.GetLayer() ) )
-            testCopperDrawItem( &val );
+            items.push_back( &val );
 
         if( module->IsNetTie() )
             continue;
@@ -177,22 +182,33 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperTextAndGraphics()
             if( IsCopperLayer( item->GetLayer() ) )
             {
                 if( item->Type() == PCB_FP_TEXT_T && ( (FP_TEXT*) item )->IsVisible() )
-                    testCopperDrawItem( item );
+                    items.push_back( item );
                 else if( item->Type() == PCB_FP_SHAPE_T )
-                    testCopperDrawItem( item );
+                    items.push_back( item );
             }
         }
     }
+
+    runChunked( items.size(), 16,
+            [&]( size_t aBegin, size_t aEnd )
+            {
+                for( size_t ii = aBegin; ii < aEnd; ++ii )
+                    testCopperDrawItem( items[ii] );
+            } );
 }
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
 {
+    if( !isInvalidated( aItem ) )
+        return;
+
     EDA_RECT               bbox;
     std::shared_ptr<SHAPE> itemShape;
     EDA_TEXT*              textItem = dynamic_cast<EDA_TEXT*>( aItem );
     PCB_LAYER_ID           layer = aItem->GetLayer();
     BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    wxString               msg;
 
     if( textItem )
     {
@@ -234,12 +250,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
         {
             std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-            m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), minClearance ),
-                          MessageTextFromValue( userUnits(), std::max( 0, actual ) ) );
+            msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), minClearance ),
+                        MessageTextFromValue( userUnits(), std::max( 0, actual ) ) );
 
-            drcItem->SetErrorMessage( m_msg );
+            drcItem->SetErrorMessage( msg );
             drcItem->SetItems( track, aItem );
             drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -297,12 +313,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
 
         std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-        m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                      constraint.GetName(),
-                      MessageTextFromValue( userUnits(), minClearance ),
-                      MessageTextFromValue( userUnits(), actual ) );
+        msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                    constraint.GetName(),
+                    MessageTextFromValue( userUnits(), minClearance ),
+                    MessageTextFromValue( userUnits(), actual ) );
 
-        drcItem->SetErrorMessage( m_msg );
+        drcItem->SetErrorMessage( msg );
         drcItem->SetItems( pad, aItem );
         drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -313,25 +329,26 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
 {
-    // This is the number of tests between 2 calls to the progress bar
-    const int delta = 25;
-    int       count = m_board->Tracks().size();
+    // The number of tracks each thread tests at a time
+    const size_t chunkSize = 16;
+    TRACKS&      tracks = m_board->Tracks();
 
-    reportAux( "Testing %d tracks...", count );
+    reportAux( "Testing %d tracks...", (int) tracks.size() );
 
-    int ii = 0;
-
-    for( auto seg_it = m_board->Tracks().begin(); seg_it != m_board->Tracks().end(); seg_it++ )
-    {
-        if( !reportProgress( ii++, m_board->Tracks().size(), delta ) )
-            break;
+    runChunked( tracks.size(), chunkSize,
+            [&]( size_t aBegin, size_t aEnd )
+            {
+                for( auto seg_it = tracks.begin() + aBegin; seg_it != tracks.begin() + aEnd;
+                     seg_it++ )
+                {
+                    if( !isInvalidated( *seg_it ) )
+                        continue;
 
-        // Test segment against tracks and pads, optionally against copper zones
-        for( PCB_LAYER_ID layer : (*seg_it)->GetLayerSet().Seq() )
-        {
-            doTrackDrc( *seg_it, layer, seg_it + 1, m_board->Tracks().end() );
-        }
-    }
+                    // Test segment against tracks and pads, optionally against copper zones
+                    for( PCB_LAYER_ID layer : (*seg_it)->GetLayerSet().Seq() )
+                        doTrackDrc( *seg_it, layer, seg_it + 1, tracks.end() );
+                }
+            } );
 }
 
 
@@ -340,6 +357,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
                                                      TRACKS::iterator aEndIt )
 {
     BOARD_DESIGN_SETTINGS&  bds = m_board->GetDesignSettings();
+    wxString                msg;
 
     SHAPE_SEGMENT refSeg( aRefSeg->GetStart(), aRefSeg->GetEnd(), aRefSeg->GetWidth() );
     EDA_RECT      refSegInflatedBB = aRefSeg->GetBoundingBox();
@@ -406,12 +424,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
             {
                 std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), minClearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), minClearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drcItem->SetErrorMessage( m_msg );
+                drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( aRefSeg, pad );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -482,12 +500,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
         {
             std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-            m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), minClearance ),
-                          MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), minClearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-            drcItem->SetErrorMessage( m_msg );
+            drcItem->SetErrorMessage( msg );
             drcItem->SetItems( aRefSeg, track );
             drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -553,12 +571,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
                 actual = std::max( 0, actual - halfWidth );
                 std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), minClearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), minClearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drcItem->SetErrorMessage( m_msg );
+                drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( aRefSeg, zone );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -571,12 +589,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
 {
-    const int delta = 25;  // This is the number of tests between 2 calls to the progress bar
+    const size_t        chunkSize = 64;     // The number of pads each thread tests at a time
     std::vector<D_PAD*> sortedPads;
 
     m_board->GetSortedPadListByXthenYCoord( sortedPads );
 
-    reportAux( "Testing %d pads...", sortedPads.size());
+    reportAux( "Testing %d pads...", (int) sortedPads.size() );
 
     if( sortedPads.empty() )
         return;
@@ -598,17 +616,21 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
     max_size += m_largestClearance;
 
     // Test the pads
-    for( int idx = 0; idx < (int) sortedPads.size(); idx++ )
-    {
-        D_PAD* pad = sortedPads[idx];
+    runChunked( sortedPads.size(), chunkSize,
+            [&]( size_t aBegin, size_t aEnd )
+            {
+                for( int idx = (int) aBegin; idx < (int) aEnd; idx++ )
+                {
+                    D_PAD* pad = sortedPads[idx];
 
-        if( !reportProgress( idx, sortedPads.size(), delta ) )
-            break;
+                    if( !isInvalidated( pad ) )
+                        continue;
 
-        int x_limit = pad->GetPosition().x + pad->GetBoundingRadius() + max_size;
+                    int x_limit = pad->GetPosition().x + pad->GetBoundingRadius() + max_size;
 
-        doPadToPadsDrc( idx, sortedPads, x_limit );
-    }
+                    doPadToPadsDrc( idx, sortedPads, x_limit );
+                }
+            } );
 }
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doPadToPadsDrc( int aRefPadIdx,
@@ -617,6 +639,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doPadToPadsDrc( int aRefPadIdx,
 {
     const static LSET all_cu = LSET::AllCuMask();
     const BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    wxString                     msg;
 
     D_PAD*   refPad = aSortedPadsList[aRefPadIdx];
     LSET     layerMask = refPad->GetLayerSet() & all_cu;
@@ -657,10 +680,10 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doPadToPadsDrc( int aRefPadIdx,
             {
                 std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_SHORTING_ITEMS );
 
-                m_msg.Printf( drcItem->GetErrorText() + _( " (nets %s and %s)" ),
-                              pad->GetNetname(), refPad->GetNetname() );
+                msg.Printf( drcItem->GetErrorText() + _( " (nets %s and %s)" ),
+                            pad->GetNetname(), refPad->GetNetname() );
 
-                drcItem->SetErrorMessage( m_msg );
+                drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( pad, refPad );
 
                 reportViolation( drcItem, refPad->GetPosition());
@@ -737,12 +760,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doPadToPadsDrc( int aRefPadIdx,
             {
                 std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), minClearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( drcItem->GetErrorText() + _( " (%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), minClearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drcItem->SetErrorMessage( m_msg );
+                drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( refPad, pad );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -792,7 +815,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testZones()
 
             ZONE_CONTAINER* zoneRef = m_board->GetArea( ia );
 
-            if( !zoneRef->IsOnLayer( layer ) )
+            if( !zoneRef->IsOnLayer( layer ) || !isInvalidated( zoneRef ) )
                 continue;
 
             // If we are testing a single zone, then iterate through all other zones
@@ -59,6 +59,10 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
 };
 
 
@@ -70,6 +70,10 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
 };
 
 
@@ -119,7 +123,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                 else if( shape->GetShape() == S_POLYGON )
                 {
                     // Same for polygons
-                    SHAPE_LINE_CHAIN poly = shape->GetPolyShape().Outline( 0 );
+                    SHAPE_LINE_CHAIN poly = shape->GetPolyShape().COutline( 0 );
 
                     for( size_t ii = 0; ii < poly.GetSegmentCount(); ++ii )
                     {
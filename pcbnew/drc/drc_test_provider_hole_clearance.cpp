@@ -68,6 +68,10 @@ public:
 
     int GetNumPhases() const override;
 
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
+
 private:
     void addHole( const VECTOR2I& aLocation, int aRadius, BOARD_ITEM* aOwner );
 
@@ -209,6 +213,9 @@ void DRC_TEST_PROVIDER_HOLE_CLEARANCE::testPads2Holes()
         if( !reportProgress( idx, sortedPads.size(), delta ) )
             break;
 
+        if( !isInvalidated( pad ) )
+            continue;
+
         doPadToPadHoleDrc( idx, sortedPads, x_limit );
     }
 }
@@ -354,6 +361,10 @@ void DRC_TEST_PROVIDER_HOLE_CLEARANCE::testHoles2Holes()
             break;
 
         DRILLED_HOLE& refHole = m_drilledHoles[ ii ];
+
+        if( !isInvalidated( refHole.m_owner ) )
+            continue;
+
         int neighborhood = refHole.m_drillRadius + m_largestClearance + m_largestRadius;
 
         for( size_t jj = ii + 1; jj < m_drilledHoles.size(); ++jj )
@@ -66,6 +66,10 @@ public:
 
     int GetNumPhases() const override;
 
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
+
 private:
     void checkVia( VIA* via, bool aExceedMicro, bool aExceedStd );
     void checkPad( D_PAD* aPad );
@@ -91,7 +95,8 @@ bool DRC_TEST_PROVIDER_HOLE_SIZE::Run()
             if( m_drcEngine->IsErrorLimitExceeded( DRCE_TOO_SMALL_DRILL ) )
                 break;
 
-            checkPad( pad );
+            if( isInvalidated( pad ) )
+                checkPad( pad );
         }
     }
 
@@ -102,7 +107,7 @@ bool DRC_TEST_PROVIDER_HOLE_SIZE::Run()
 
     for( TRACK* track : m_board->Tracks() )
     {
-        if( track->Type() == PCB_VIA_T )
+        if( track->Type() == PCB_VIA_T && isInvalidated( track ) )
             vias.push_back( static_cast<VIA*>( track ) );
     }
 
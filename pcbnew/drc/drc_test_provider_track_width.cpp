@@ -61,6 +61,10 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
 };
 
 
@@ -146,6 +150,9 @@ bool DRC_TEST_PROVIDER_TRACK_WIDTH::Run()
         if( !reportProgress( ii++, m_drcEngine->GetBoard()->Tracks().size(), delta ) )
             break;
 
+        if( !isInvalidated( item ) )
+            continue;
+
         if( !checkTrackWidth( item ) )
             break;
     }
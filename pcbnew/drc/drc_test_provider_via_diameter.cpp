@@ -59,6 +59,10 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool IsParallelSafe() const override { return true; }
+
+    bool SupportsIncremental() const override { return true; }
 };
 
 
@@ -142,6 +146,9 @@ bool DRC_TEST_PROVIDER_VIA_DIAMETER::Run()
         if( !reportProgress( ii++, m_drcEngine->GetBoard()->Tracks().size(), delta ) )
             break;
 
+        if( !isInvalidated( item ) )
+            continue;
+
         if( !checkViaDiameter( item ) )
             break;
     }
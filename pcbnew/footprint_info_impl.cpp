@@ -24,6 +24,7 @@
 
 #include <class_module.h>
 #include <footprint_info.h>
+#include <footprint_lib_index.h>
 #include <fp_lib_table.h>
 #include <html_messagebox.h>
 #include <io_mgr.h>
@@ -173,6 +174,29 @@ bool FOOTPRINT_LIST_IMPL::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxStri
 }
 
 
+void FOOTPRINT_LIST_IMPL::queueLibrary( const wxString& aNickname )
+{
+    m_queue_in.push( aNickname );
+
+    // Only the KiCad s-expression parser reads numbers independently of the locale, the other
+    // footprint library formats still need LOCALE_IO.  KiCad libraries are directories of
+    // footprint files, which are read through their index.
+    try
+    {
+        const FP_LIB_TABLE_ROW* row = m_lib_table->FindRow( aNickname );
+
+        if( row->GetType() == IO_MGR::ShowType( IO_MGR::KICAD_SEXP ) )
+            m_indexed_libs[ aNickname ] = row->GetFullURI( true );
+        else
+            m_needs_locale_io = true;
+    }
+    catch( const IO_ERROR& )
+    {
+        // the loader reports it
+    }
+}
+
+
 void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aNickname,
         FOOTPRINT_ASYNC_LOADER* aLoader, unsigned aNThreads )
 {
@@ -186,13 +210,18 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_threads.clear();
     m_queue_in.clear();
     m_queue_out.clear();
+    m_needs_locale_io = false;
+    m_index_dir = FOOTPRINT_LIB_INDEX::DefaultIndexDir();
+    m_indexed_libs.clear();
 
     if( aNickname )
-        m_queue_in.push( *aNickname );
+    {
+        queueLibrary( *aNickname );
+    }
     else
     {
         for( auto const& nickname : aTable->GetLogicalLibs() )
-            m_queue_in.push( nickname );
+            queueLibrary( nickname );
     }
 
     m_loader->m_total_libs = m_queue_in.size();
@@ -238,14 +267,15 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
 
     size_t total_count = m_queue_out.size();
 
-    LOCALE_IO toggle_locale;
+    // Parse the footprints in parallel.  KiCad footprint libraries are read independently of
+    // the locale.  WARNING! The other formats require changing the locale, which is GLOBAL.
+    // It is only threadsafe to construct the LOCALE_IO before the threads are created,
+    // destroy it after they finish, and block the main (GUI) thread while they work. Any
+    // deviation from this will cause nasal demons.
+    std::unique_ptr<LOCALE_IO> toggle_locale;
 
-    // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
-    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the threads are created,
-    // destroy it after they finish, and block the main (GUI) thread while they work. Any deviation
-    // from this will cause nasal demons.
-    //
-    // TODO: blast LOCALE_IO into the sun
+    if( m_needs_locale_io )
+        toggle_locale = std::make_unique<LOCALE_IO>();
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
     std::vector<std::thread>                    threads;
@@ -257,6 +287,31 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
             {
+                auto indexedLib = m_indexed_libs.find( nickname );
+
+                // Only the footprint files changed since the library was last indexed are
+                // parsed, the rest comes from the index
+                if( indexedLib != m_indexed_libs.end() )
+                {
+                    FOOTPRINT_LIB_INDEX index( indexedLib->second, m_index_dir );
+
+                    CatchErrors( [&index, this]() { index.Update( &m_cancelled ); } );
+
+                    for( const FOOTPRINT_LIB_INDEX::ENTRY& entry : index.GetEntries() )
+                    {
+                        queue_parsed.move_push( std::make_unique<FOOTPRINT_INFO_IMPL>(
+                                nickname, entry.GetName(), entry.m_description,
+                                entry.m_keywords, 0, entry.m_padCount,
+                                entry.m_uniquePadCount ) );
+                    }
+
+                    if( m_progress_reporter )
+                        m_progress_reporter->AdvanceProgress();
+
+                    m_count_finished.fetch_add( 1 );
+                    continue;
+                }
+
                 wxArrayString fpnames;
 
                 try
@@ -327,7 +382,8 @@ FOOTPRINT_LIST_IMPL::FOOTPRINT_LIST_IMPL() :
     m_count_finished( 0 ),
     m_list_timestamp( 0 ),
     m_progress_reporter( nullptr ),
-    m_cancelled( false )
+    m_cancelled( false ),
+    m_needs_locale_io( false )
 {
 }
 
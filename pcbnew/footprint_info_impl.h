@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -92,6 +93,11 @@ class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
     PROGRESS_REPORTER*       m_progress_reporter;
     std::atomic_bool         m_cancelled;
     std::mutex               m_join;
+    bool                     m_needs_locale_io;    ///< a library format still reads numbers
+                                                   ///< in the current locale
+    wxString                 m_index_dir;          ///< see FOOTPRINT_LIB_INDEX
+    std::map<wxString, wxString> m_indexed_libs;   ///< path of the libraries read through
+                                                   ///< their index, per nickname
 
     /**
      * Call aFunc, pushing any IO_ERRORs and std::exceptions it throws onto m_errors.
@@ -100,6 +106,11 @@ class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
      */
     bool CatchErrors( const std::function<void()>& aFunc );
 
+    /**
+     * Queues the library \a aNickname for loading, and finds out how to read it.
+     */
+    void queueLibrary( const wxString& aNickname );
+
 protected:
     void StartWorkers( FP_LIB_TABLE* aTable, wxString const* aNickname,
                        FOOTPRINT_ASYNC_LOADER* aLoader, unsigned aNThreads ) override;
@@ -0,0 +1,396 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include <class_module.h>
+#include <common.h>
+#include <footprint_lib_index.h>
+#include <plugins/kicad/pcb_parser.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+
+
+///> Tells index files apart, and changes with their layout
+static const char indexMagic[8] = { 'K', 'I', 'F', 'P', 'I', 'D', 'X', '2' };
+
+
+wxString FOOTPRINT_LIB_INDEX::ENTRY::GetName() const
+{
+    return m_fileName.BeforeLast( '.' );
+}
+
+
+FOOTPRINT_LIB_INDEX::FOOTPRINT_LIB_INDEX( const wxString& aLibraryPath,
+                                          const wxString& aIndexDir ) :
+        m_libraryPath( aLibraryPath ),
+        m_indexDir( aIndexDir ),
+        m_indexTime( 0 ),
+        m_parsedCount( 0 )
+{
+}
+
+
+wxString FOOTPRINT_LIB_INDEX::DefaultIndexDir()
+{
+    // Like the 3D model cache, the indexes go to the user's cache directory:
+    // 1. OSX: ~/Library/Caches/kicad/fp-index/
+    // 2. Linux: ${XDG_CACHE_HOME}/kicad/fp-index ~/.cache/kicad/fp-index/
+    // 3. MSWin: AppData\Local\kicad\fp-index
+    wxString cacheDir;
+
+#if defined( _WIN32 )
+    wxStandardPaths::Get().UseAppInfo( wxStandardPaths::AppInfo_None );
+    cacheDir = wxStandardPaths::Get().GetUserLocalDataDir();
+    cacheDir.append( "\\kicad\\fp-index" );
+#elif defined( __WXMAC__ )
+    cacheDir = "${HOME}/Library/Caches/kicad/fp-index";
+#else   // assume Linux
+    cacheDir = ExpandEnvVarSubstitutions( "${XDG_CACHE_HOME}", nullptr );
+
+    if( cacheDir.empty() || cacheDir == "${XDG_CACHE_HOME}" )
+        cacheDir = "${HOME}/.cache";
+
+    cacheDir.append( "/kicad/fp-index" );
+#endif
+
+    return ExpandEnvVarSubstitutions( cacheDir, nullptr );
+}
+
+
+wxString FOOTPRINT_LIB_INDEX::GetIndexFileName() const
+{
+    // FNV-1a of the library path, which is also stored in the file to rule out collisions
+    wxScopedCharBuffer path = m_libraryPath.utf8_str();
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for( size_t ii = 0; ii < path.length(); ++ii )
+    {
+        hash ^= (unsigned char) path.data()[ii];
+        hash *= 1099511628211ULL;
+    }
+
+    return m_indexDir + wxFileName::GetPathSeparator()
+           + wxString::Format( "%016llx.fpidx", hash );
+}
+
+
+static void writeInt( std::string& aData, long long aValue )
+{
+    // Little endian, whatever the platform
+    for( int ii = 0; ii < 8; ++ii )
+        aData += (char) ( ( (unsigned long long) aValue >> ( 8 * ii ) ) & 0xFF );
+}
+
+
+static void writeString( std::string& aData, const wxString& aText )
+{
+    wxScopedCharBuffer utf8 = aText.utf8_str();
+
+    writeInt( aData, utf8.length() );
+    aData.append( utf8.data(), utf8.length() );
+}
+
+
+/**
+ * Reads the values written by writeInt() and writeString(), checking that they are all in
+ * the file.  After the first short read, IsOk() is false and all values are empty.
+ */
+class INDEX_READER
+{
+public:
+    INDEX_READER( const std::vector<char>& aData ) :
+            m_pos( aData.data() ),
+            m_end( aData.data() + aData.size() )
+    {
+    }
+
+    bool IsOk() const { return m_pos != nullptr; }
+
+    long long ReadInt()
+    {
+        if( !m_pos || m_end - m_pos < 8 )
+        {
+            m_pos = nullptr;
+            return 0;
+        }
+
+        unsigned long long value = 0;
+
+        for( int ii = 0; ii < 8; ++ii )
+            value |= (unsigned long long) (unsigned char) m_pos[ii] << ( 8 * ii );
+
+        m_pos += 8;
+        return (long long) value;
+    }
+
+    wxString ReadString()
+    {
+        long long length = ReadInt();
+
+        if( !m_pos || length < 0 || m_end - m_pos < length )
+        {
+            m_pos = nullptr;
+            return wxEmptyString;
+        }
+
+        wxString text = wxString::FromUTF8( m_pos, length );
+
+        m_pos += length;
+        return text;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+};
+
+
+void FOOTPRINT_LIB_INDEX::load()
+{
+    m_entries.clear();
+    m_indexTime = 0;
+
+    wxString indexFileName = GetIndexFileName();
+
+    if( !wxFileExists( indexFileName ) )
+        return;
+
+    wxFFile file( indexFileName, "rb" );
+
+    if( !file.IsOpened() )
+        return;
+
+    wxFileOffset length = file.Length();
+
+    if( length < (wxFileOffset) sizeof( indexMagic ) )
+        return;
+
+    std::vector<char> data( length );
+
+    if( file.Read( data.data(), data.size() ) != data.size()
+            || !std::equal( indexMagic, indexMagic + sizeof( indexMagic ), data.begin() ) )
+    {
+        return;
+    }
+
+    data.erase( data.begin(), data.begin() + sizeof( indexMagic ) );
+
+    INDEX_READER reader( data );
+
+    if( reader.ReadString() != m_libraryPath )
+        return;
+
+    m_indexTime = reader.ReadInt();
+
+    long long count = reader.ReadInt();
+
+    for( long long ii = 0; ii < count && reader.IsOk(); ++ii )
+    {
+        ENTRY entry;
+
+        entry.m_fileName = reader.ReadString();
+        entry.m_timestamp = reader.ReadInt();
+        entry.m_size = reader.ReadInt();
+        entry.m_description = reader.ReadString();
+        entry.m_keywords = reader.ReadString();
+        entry.m_padCount = (unsigned) reader.ReadInt();
+        entry.m_uniquePadCount = (unsigned) reader.ReadInt();
+
+        m_entries.push_back( entry );
+    }
+
+    // A truncated index is as good as none
+    if( !reader.IsOk() )
+        m_entries.clear();
+}
+
+
+void FOOTPRINT_LIB_INDEX::save() const
+{
+    std::string data( indexMagic, sizeof( indexMagic ) );
+
+    writeString( data, m_libraryPath );
+    writeInt( data, m_indexTime );
+    writeInt( data, m_entries.size() );
+
+    for( const ENTRY& entry : m_entries )
+    {
+        writeString( data, entry.m_fileName );
+        writeInt( data, entry.m_timestamp );
+        writeInt( data, entry.m_size );
+        writeString( data, entry.m_description );
+        writeString( data, entry.m_keywords );
+        writeInt( data, entry.m_padCount );
+        writeInt( data, entry.m_uniquePadCount );
+    }
+
+    if( !wxDirExists( m_indexDir ) && !wxFileName::Mkdir( m_indexDir, wxS_DIR_DEFAULT,
+                                                          wxPATH_MKDIR_FULL ) )
+    {
+        return;
+    }
+
+    // Written aside and renamed, so that another instance never reads half of an index.
+    // The index is only a cache, failing to write it is not an error.
+    wxString tempFileName = wxFileName::CreateTempFileName( m_indexDir
+                                                            + wxFileName::GetPathSeparator()
+                                                            + "fp" );
+
+    if( tempFileName.IsEmpty() )
+        return;
+
+    bool written;
+
+    {
+        wxFFile file( tempFileName, "wb" );
+
+        written = file.IsOpened() && file.Write( data.data(), data.size() ) == data.size()
+                  && file.Close();
+    }
+
+    if( !written || !wxRenameFile( tempFileName, GetIndexFileName(), true ) )
+        wxRemoveFile( tempFileName );
+}
+
+
+/**
+ * Parses the footprint file at \a aPath for what the index keeps of it.
+ */
+static void indexFootprint( const wxString& aPath, FOOTPRINT_LIB_INDEX::ENTRY& aEntry )
+{
+    MAPPED_FILE_LINE_READER     reader( aPath );
+    PCB_PARSER                  parser( &reader );
+    std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+    MODULE*                     footprint = dynamic_cast<MODULE*>( item.get() );
+
+    if( !footprint )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File '%s' does not contain a footprint." ),
+                                          aPath ) );
+    }
+
+    aEntry.m_description = footprint->GetDescription();
+    aEntry.m_keywords = footprint->GetKeywords();
+    aEntry.m_padCount = footprint->GetPadCount( DO_NOT_INCLUDE_NPTH );
+    aEntry.m_uniquePadCount = footprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH );
+}
+
+
+void FOOTPRINT_LIB_INDEX::Update( const std::atomic_bool* aCancelled )
+{
+    m_parsedCount = 0;
+
+    wxDir dir( m_libraryPath );
+
+    if( !dir.IsOpened() )
+    {
+        m_entries.clear();
+
+        THROW_IO_ERROR( wxString::Format( _( "Footprint library path '%s' does not exist "
+                                             "(or is not a directory)." ),
+                                          m_libraryPath ) );
+    }
+
+    // Before listing the files, so that a file changed while they are listed is racy
+    long long listingTime = wxDateTime::Now().GetTicks();
+
+    load();
+
+    auto byFileName = []( const ENTRY& aLhs, const ENTRY& aRhs )
+                      {
+                          return aLhs.m_fileName < aRhs.m_fileName;
+                      };
+
+    std::vector<ENTRY> entries;
+    wxString           fileName;
+    wxString           errors;
+    bool               changed = false;
+
+    for( bool ok = dir.GetFirst( &fileName, wxT( "*." ) + KiCadFootprintFileExtension,
+                                 wxDIR_FILES );
+         ok; ok = dir.GetNext( &fileName ) )
+    {
+        if( aCancelled && *aCancelled )
+            return;
+
+        wxString     path = m_libraryPath + wxFileName::GetPathSeparator() + fileName;
+        wxStructStat fileStat;
+
+        if( wxStat( path, &fileStat ) != 0 )
+            continue;
+
+        ENTRY entry;
+
+        entry.m_fileName = fileName;
+        entry.m_timestamp = fileStat.st_mtime;
+        entry.m_size = fileStat.st_size;
+
+        auto it = std::lower_bound( m_entries.begin(), m_entries.end(), entry, byFileName );
+
+        // Timestamps are in whole seconds, so a file modified within a second of the last
+        // listing may have changed again since, keeping its timestamp and maybe its size
+        bool racy = m_indexTime - entry.m_timestamp <= 1;
+
+        if( it != m_entries.end() && it->m_fileName == fileName && !racy
+                && it->m_timestamp == entry.m_timestamp && it->m_size == entry.m_size )
+        {
+            entries.push_back( *it );
+            continue;
+        }
+
+        changed = true;
+
+        try
+        {
+            indexFootprint( path, entry );
+            entries.push_back( entry );
+            m_parsedCount++;
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            // Left out of the index, so that it is parsed again next time
+            if( !errors.IsEmpty() )
+                errors += "\n\n";
+
+            errors += ioe.What();
+        }
+    }
+
+    // Footprints deleted since the last update
+    changed = changed || entries.size() != m_entries.size();
+
+    std::sort( entries.begin(), entries.end(), byFileName );
+    m_entries.swap( entries );
+    m_indexTime = listingTime;
+
+    if( changed )
+        save();
+
+    if( !errors.IsEmpty() )
+        THROW_IO_ERROR( errors );
+}
@@ -0,0 +1,101 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FOOTPRINT_LIB_INDEX_H
+#define FOOTPRINT_LIB_INDEX_H
+
+#include <atomic>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+ * A persistent index of a KiCad footprint library directory, holding what the footprint
+ * chooser shows of each footprint.
+ *
+ * The index of each library is a binary file in the user cache directory.  Its entries
+ * record the modification time and size of their footprint file, so that bringing the index
+ * up to date only parses the footprint files which were added or changed since.  Like
+ * FP_CACHE, it does not trust the files modified within a second of the last update, since
+ * they may have changed again within the same second.
+ */
+class FOOTPRINT_LIB_INDEX
+{
+public:
+    struct ENTRY
+    {
+        wxString  m_fileName;           ///< footprint file name, with its extension
+        long long m_timestamp;          ///< modification time of the file
+        long long m_size;               ///< size of the file in bytes
+        wxString  m_description;
+        wxString  m_keywords;
+        unsigned  m_padCount;
+        unsigned  m_uniquePadCount;
+
+        /// The footprint name, which is the file name without its extension
+        wxString GetName() const;
+    };
+
+    /**
+     * @param aLibraryPath is the path of the .pretty directory of the library.
+     * @param aIndexDir is the directory of the index files, see DefaultIndexDir().
+     */
+    FOOTPRINT_LIB_INDEX( const wxString& aLibraryPath, const wxString& aIndexDir );
+
+    /**
+     * Brings the index up to date with the library directory, and saves it if anything
+     * changed.
+     *
+     * @param aCancelled is polled between the footprint files to parse.  When it is set, the
+     *                   update stops without saving the index.
+     * @throw IO_ERROR if the library directory cannot be read, or if some footprint files do
+     *                 not parse.  The other files are indexed anyway.
+     */
+    void Update( const std::atomic_bool* aCancelled = nullptr );
+
+    const std::vector<ENTRY>& GetEntries() const { return m_entries; }
+
+    /// The number of footprint files parsed by the last Update()
+    int GetParsedCount() const { return m_parsedCount; }
+
+    /// The file holding the index of the library
+    wxString GetIndexFileName() const;
+
+    /**
+     * The directory of the footprint library indexes in the user cache directory.  It may
+     * change the application info of wxStandardPaths, so call it from the main thread.
+     */
+    static wxString DefaultIndexDir();
+
+private:
+    /// Reads the index file into m_entries, which it leaves empty if the file is not usable
+    void load();
+
+    void save() const;
+
+    wxString           m_libraryPath;
+    wxString           m_indexDir;
+    std::vector<ENTRY> m_entries;           ///< sorted by file name
+    long long          m_indexTime;         ///< when the files were listed for m_entries
+    int                m_parsedCount;
+};
+
+
+#endif // FOOTPRINT_LIB_INDEX_H
@@ -384,6 +384,7 @@ bool FOOTPRINT_EDIT_FRAME::SaveLibraryAs( const wxString& aLibraryPath )
 
     wxBusyCursor dummy;
     wxString msg;
+    wxArrayString skipped;
 
     IO_MGR::PCB_FILE_T  dstType = IO_MGR::GuessPluginTypeFromLibPath( dstLibPath );
     IO_MGR::PCB_FILE_T  curType = IO_MGR::GuessPluginTypeFromLibPath( curLibPath );
@@ -400,6 +401,14 @@ bool FOOTPRINT_EDIT_FRAME::SaveLibraryAs( const wxString& aLibraryPath )
         for( unsigned i = 0;  i < footprints.size();  ++i )
         {
             const MODULE* footprint = cur->GetEnumeratedFootprint( curLibPath, footprints[i] );
+
+            // Footprints which do not load are left out, and reported once all are saved
+            if( !footprint )
+            {
+                skipped.Add( footprints[i] );
+                continue;
+            }
+
             dst->FootprintSave( dstLibPath, footprint );
 
             msg = wxString::Format( _( "Footprint \"%s\" saved" ), footprints[i] );
@@ -416,7 +425,20 @@ bool FOOTPRINT_EDIT_FRAME::SaveLibraryAs( const wxString& aLibraryPath )
                             curLibPath,
                             dstLibPath );
 
-    DisplayInfoMessage( this, msg );
+    if( !skipped.IsEmpty() )
+    {
+        msg += wxT( "\n\n" );
+        msg += _( "The following footprints could not be loaded and were not saved:" );
+
+        for( const wxString& name : skipped )
+            msg += wxT( "\n" ) + name;
+
+        DisplayError( this, msg );
+    }
+    else
+    {
+        DisplayInfoMessage( this, msg );
+    }
 
     SetStatusText( wxEmptyString );
     return true;
@@ -403,6 +403,10 @@ PCB_EDIT_FRAME::~PCB_EDIT_FRAME()
 
     delete m_selectionFilterPanel;
     delete m_appearancePanel;
+
+    // The tools listening to the board must unregister before PCB_BASE_FRAME deletes it
+    delete m_toolManager;
+    m_toolManager = nullptr;
 }
 
 
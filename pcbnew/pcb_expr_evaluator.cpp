@@ -417,6 +417,17 @@ LIBEVAL::VALUE PCB_EXPR_VAR_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
     }
 
     BOARD_ITEM* item  = const_cast<BOARD_ITEM*>( GetObject( aCtx ) );
+
+    if( m_accessor != ACCESSOR::NONE && item->IsConnected() )
+    {
+        BOARD_CONNECTED_ITEM* connectedItem = static_cast<BOARD_CONNECTED_ITEM*>( item );
+
+        if( m_accessor == ACCESSOR::NET_CLASS )
+            return LIBEVAL::VALUE( connectedItem->GetNetClassName() );
+        else
+            return LIBEVAL::VALUE( connectedItem->GetNetname() );
+    }
+
     auto        it = m_matchingTypes.find( TYPE_HASH( *item ) );
 
     if( it == m_matchingTypes.end() )
@@ -455,6 +466,10 @@ LIBEVAL::FUNC_CALL_REF PCB_EXPR_UCODE::CreateFuncCall( const wxString& aName )
 {
     PCB_EXPR_BUILTIN_FUNCTIONS& registry = PCB_EXPR_BUILTIN_FUNCTIONS::Instance();
 
+    // isDiffPair() only looks at the net; everything else looks at the item itself
+    if( aName.Lower() != "isdiffpair" )
+        m_itemDependent = true;
+
     return registry.Get( aName.Lower() );
 }
 
@@ -490,6 +505,10 @@ std::unique_ptr<LIBEVAL::VAR_REF> PCB_EXPR_UCODE::CreateVarRef( const wxString&
     wxString field( aField );
     field.Replace( "_",  " " );
 
+    // Property names are case-insensitive
+    if( field.CmpNoCase( "Net" ) && field.CmpNoCase( "NetName" ) && field.CmpNoCase( "NetClass" ) )
+        m_itemDependent = true;
+
     for( const PROPERTY_MANAGER::CLASS_INFO& cls : propMgr.GetAllClasses() )
     {
         if( propMgr.IsOfType( cls.type, TYPE_HASH( BOARD_ITEM ) ) )
@@ -524,6 +543,13 @@ std::unique_ptr<LIBEVAL::VAR_REF> PCB_EXPR_UCODE::CreateVarRef( const wxString&
     if( vref->GetType() == LIBEVAL::VT_UNDEFINED )
         vref->SetType( LIBEVAL::VT_PARSE_ERROR );
 
+    // Netclass and net name conditions are by far the most common, and are evaluated for
+    // every item pair during DRC.  Read them directly rather than through the property system.
+    if( !field.CmpNoCase( "NetClass" ) )
+        vref->SetAccessor( PCB_EXPR_VAR_REF::ACCESSOR::NET_CLASS );
+    else if( !field.CmpNoCase( "NetName" ) )
+        vref->SetAccessor( PCB_EXPR_VAR_REF::ACCESSOR::NET_NAME );
+
     return std::move( vref );
 }
 
@@ -40,11 +40,24 @@ class PCB_EXPR_VAR_REF;
 class PCB_EXPR_UCODE final : public LIBEVAL::UCODE
 {
 public:
-    PCB_EXPR_UCODE() {};
+    PCB_EXPR_UCODE() :
+        m_itemDependent( false )
+    {};
+
     virtual ~PCB_EXPR_UCODE() {};
 
     virtual std::unique_ptr<LIBEVAL::VAR_REF> CreateVarRef( const wxString& aVar, const wxString& aField ) override;
     virtual LIBEVAL::FUNC_CALL_REF CreateFuncCall( const wxString& aName ) override;
+
+    /**
+     * @return true if the expression refers to anything other than the nets (or netclasses)
+     *         of the items, and so may give different results for items of the same type on
+     *         the same nets and layer.
+     */
+    bool HasItemDependencies() const { return m_itemDependent; }
+
+private:
+    bool m_itemDependent;
 };
 
 
@@ -69,6 +82,11 @@ public:
         return m_items[index];
     }
 
+    void SetLayer( PCB_LAYER_ID aLayer )
+    {
+        m_layer = aLayer;
+    }
+
     PCB_LAYER_ID GetLayer() const
     {
         return m_layer;
@@ -83,10 +101,21 @@ private:
 class PCB_EXPR_VAR_REF : public LIBEVAL::VAR_REF
 {
 public:
+    /**
+     * Properties read often enough to be worth bypassing PROPERTY_MANAGER for.
+     */
+    enum class ACCESSOR
+    {
+        NONE,
+        NET_NAME,
+        NET_CLASS
+    };
+
     PCB_EXPR_VAR_REF( int aItemIndex ) : 
         m_itemIndex( aItemIndex ),
         m_type( LIBEVAL::VT_UNDEFINED ),
-        m_isEnum( false )
+        m_isEnum( false ),
+        m_accessor( ACCESSOR::NONE )
     {
         //printf("*** CreateVarRef %p %d\n", this, aItemIndex );
     }
@@ -96,6 +125,8 @@ public:
     void SetIsEnum( bool s ) { m_isEnum = s; }
     bool IsEnum() const { return m_isEnum; }
 
+    void SetAccessor( ACCESSOR aAccessor ) { m_accessor = aAccessor; }
+
     void SetType( LIBEVAL::VAR_TYPE_T type ) { m_type = type; }
     LIBEVAL::VAR_TYPE_T GetType() override { return m_type; }
 
@@ -113,6 +144,7 @@ private:
     int                                         m_itemIndex;
     LIBEVAL::VAR_TYPE_T                         m_type;
     bool                                        m_isEnum;
+    ACCESSOR                                    m_accessor;
 };
 
 
@@ -484,6 +484,52 @@ bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 }
 
 
+void PCB_PAINTER::PrepareDraw( const VIEW_ITEM* aItem )
+{
+    const EDA_ITEM* item = dynamic_cast<const EDA_ITEM*>( aItem );
+
+    if( !item )
+        return;
+
+    switch( item->Type() )
+    {
+    case PCB_PAD_T:
+        // Builds all the effective shapes of the pad
+        static_cast<const D_PAD*>( item )->GetEffectiveHoleShape();
+        break;
+
+    case PCB_SHAPE_T:
+    case PCB_FP_SHAPE_T:
+    {
+        PCB_SHAPE* shape = const_cast<PCB_SHAPE*>( static_cast<const PCB_SHAPE*>( item ) );
+
+        // Only the OpenGL GAL draws the triangulation, see draw( const PCB_SHAPE* )
+        if( shape->GetShape() == S_POLYGON && m_gal->IsOpenGlEngine()
+                && shape->GetPolyShape().OutlineCount() > 0 )
+        {
+            shape->GetPolyShape().CacheTriangulation();
+        }
+
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    case PCB_FP_ZONE_AREA_T:
+        // As for shapes, only the OpenGL GAL draws the triangulation of the fill
+        if( m_gal->IsOpenGlEngine() )
+        {
+            const_cast<ZONE_CONTAINER*>( static_cast<const ZONE_CONTAINER*>( item ) )
+                    ->CacheTriangulation();
+        }
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+
 void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
 {
     VECTOR2D start( aTrack->GetStart() );
@@ -23,6 +23,7 @@
 
 #include <board_design_settings.h>
 #include <convert_to_biu.h>
+#include <kicad_string.h>
 #include <layers_id_colors_and_visibility.h>
 #include <macros.h>
 #include <math/util.h> // for KiROUND
@@ -601,7 +602,8 @@ double PCB_PLOT_PARAMS_PARSER::parseDouble()
     if( token != T_NUMBER )
         Expecting( T_NUMBER );
 
-    double val = strtod( CurText(), NULL );
+    double val;
+    DecimalToDouble( CurText(), val );
 
     return val;
 }
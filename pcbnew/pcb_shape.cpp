@@ -174,7 +174,7 @@ void PCB_SHAPE::Scale( double aScale )
     {
         std::vector<wxPoint> pts;
 
-        for( const VECTOR2I& pt : m_Poly.Outline( 0 ).CPoints() )
+        for( const VECTOR2I& pt : m_Poly.COutline( 0 ).CPoints() )
         {
             pts.emplace_back( pt );
             scalePt( pts.back() );
@@ -494,7 +494,7 @@ void PCB_SHAPE::GetMsgPanelInfo( EDA_DRAW_FRAME* aFrame, std::vector<MSG_PANEL_I
     case S_POLYGON:
         aList.emplace_back( shape, _( "Polygon" ), RED );
 
-        msg.Printf( "%d", GetPolyShape().Outline(0).PointCount() );
+        msg.Printf( "%d", GetPolyShape().COutline( 0 ).PointCount() );
         aList.emplace_back( _( "Points" ), msg, DARKGREEN );
         break;
 
@@ -530,7 +530,7 @@ void PCB_SHAPE::GetMsgPanelInfo( EDA_DRAW_FRAME* aFrame, std::vector<MSG_PANEL_I
 
     if( m_Shape == S_POLYGON )
     {
-        VECTOR2I point0 = GetPolyShape().Outline(0).CPoint(0);
+        VECTOR2I point0 = GetPolyShape().COutline( 0 ).CPoint( 0 );
         VECTOR2I coord0 = originTransforms.ToDisplayAbs( point0 );
         wxString origin = wxString::Format( "@(%s, %s)",
                                            MessageTextFromValue( units, coord0.x ),
@@ -1199,7 +1199,7 @@ bool PCB_SHAPE::IsPolyShapeValid() const
     if( GetPolyShape().OutlineCount() == 0 )
         return false;
 
-    const SHAPE_LINE_CHAIN& outline = ((SHAPE_POLY_SET&)GetPolyShape()).Outline( 0 );
+    const SHAPE_LINE_CHAIN& outline = GetPolyShape().COutline( 0 );
 
     return outline.PointCount() > 2;
 }
@@ -22,6 +22,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <future>
+#include <list>
+#include <set>
+#include <thread>
+
 #include <build_version.h>      // LEGACY_BOARD_FILE_VERSION
 #include <wildcards_and_files_ext.h>
 #include <advanced_config.h>
@@ -59,7 +65,17 @@ using namespace PCB_KEYS_T;
 class FP_CACHE_ITEM
 {
     WX_FILENAME             m_filename;
-    std::unique_ptr<MODULE> m_module;
+    std::unique_ptr<MODULE> m_module;       // NULL until the footprint file is parsed.
+    long long               m_timestamp;    // Of the file when m_module was read or written.
+    bool                    m_racy;         // m_timestamp is too recent to be trusted.
+
+    // Position in the FP_CACHE list of parsed footprints, valid when m_listed is set.
+    std::list<FP_CACHE_ITEM*>::iterator m_lruPos;
+    bool                                m_listed;
+
+    bool                    m_pinned;       // m_module was handed out by GetEnumeratedFootprint().
+
+    friend class FP_CACHE;
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
@@ -71,7 +87,11 @@ public:
 
 FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
     m_filename( aFileName ),
-    m_module( aModule )
+    m_module( aModule ),
+    m_timestamp( 0 ),
+    m_racy( false ),
+    m_listed( false ),
+    m_pinned( false )
 { }
 
 
@@ -89,8 +109,16 @@ class FP_CACHE
 
     bool            m_cache_dirty;      // Stored separately because it's expensive to check
                                         // m_cache_timestamp against all the files.
-    long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
-                                        // files.
+    long long       m_cache_timestamp;  // The timestamp of the library directory when its
+                                        // footprint files were listed.
+    bool            m_cache_racy;       // m_cache_timestamp is too recent to be trusted.
+
+    std::list<FP_CACHE_ITEM*> m_parsed; // The unpinned items holding a MODULE, most recently
+                                        // used first.
+    size_t          m_pinnedCount;      // The pinned items, which count against the cache size.
+
+    // Pinned footprints replaced since they were handed out, kept until Unpin().
+    std::vector<std::unique_ptr<MODULE>> m_retired;
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -98,7 +126,7 @@ public:
     wxString    GetPath() const { return m_lib_raw_path; }
     bool        IsWritable() const { return m_lib_path.IsOk() && m_lib_path.IsDirWritable(); }
     bool        Exists() const { return m_lib_path.IsOk() && m_lib_path.DirExists(); }
-    MODULE_MAP& GetModules() { return m_modules; }
+    const MODULE_MAP& GetModules() const { return m_modules; }
 
     // Most all functions in this class throw IO_ERROR exceptions.  There are no
     // error codes nor user interface calls from here, nor in any PLUGIN.
@@ -111,8 +139,41 @@ public:
      */
     void Save( MODULE* aModule = NULL );
 
+    /**
+     * List the footprint files of the library.  The footprints are only parsed when first
+     * asked for by GetFootprint().
+     *
+     * Listing the files again keeps the footprints already parsed, unless their file is gone.
+     */
     void Load();
 
+    /**
+     * Return the footprint \a aFootprintName, parsing its file if it was not yet or if it
+     * changed since.
+     *
+     * The footprint stays owned by the cache.  Unless it is pinned, it may be dropped by the
+     * next calls once more footprints are parsed than the cache size of the owner.
+     *
+     * @param aCheckModified tells to check the timestamp of the file of an already parsed
+     *                       footprint.
+     * @param aPin tells to keep the footprint in memory until Unpin(), even if it is replaced.
+     * @return the footprint or NULL if the library has no footprint \a aFootprintName.
+     */
+    const MODULE* GetFootprint( const wxString& aFootprintName, bool aCheckModified,
+                                bool aPin );
+
+    /**
+     * Free the pinned footprints which were replaced, and let the others be dropped again
+     * when the cache is full.
+     */
+    void Unpin();
+
+    /**
+     * Add \a aModule to the cache as \a aFootprintName, replacing any footprint of that name.
+     * The cache takes ownership of \a aModule, which is not written to disk.
+     */
+    void Add( const wxString& aFootprintName, MODULE* aModule, const WX_FILENAME& aFileName );
+
     void Remove( const wxString& aFootprintName );
 
     /**
@@ -123,7 +184,8 @@ public:
     static long long GetTimestamp( const wxString& aLibPath );
 
     /**
-     * Return true if the cache is not up-to-date.
+     * Return true if footprint files were added, removed or renamed since the cache was
+     * loaded.  Changes to the content of a file are found by GetFootprint().
      */
     bool IsModified();
 
@@ -139,6 +201,30 @@ public:
      * @return true if \a aPath is the same as the cache path.
      */
     bool IsPath( const wxString& aPath ) const;
+
+private:
+    long long getDirTimestamp() const;
+
+    /// Remember the timestamp of the library directory, to compare it in IsModified()
+    void updateTimestamp();
+
+    /// Remember the timestamp of the footprint file of \a aItem, taken before reading or
+    /// writing it
+    void setTimestamp( FP_CACHE_ITEM* aItem, long long aTimestamp );
+
+    /// Return true if \a aTimestamp is too recent to tell a later change in the same second
+    static bool isRacy( long long aTimestamp );
+
+    /// Parse the footprint file of \a aItem, dropping what it held
+    void parse( FP_CACHE_ITEM* aItem, const wxString& aFootprintName );
+
+    /// Make \a aItem the most recently used, and drop the least recently used footprints past
+    /// the cache size.  \a aItem must hold a MODULE.  Pinned items count against the cache
+    /// size, but are never dropped.
+    void touch( FP_CACHE_ITEM* aItem );
+
+    /// Drop the MODULE of \a aItem, if any.  The MODULE of a pinned item is retired instead.
+    void release( FP_CACHE_ITEM* aItem );
 };
 
 
@@ -149,13 +235,13 @@ FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
     m_lib_path.SetPath( aLibraryPath );
     m_cache_timestamp = 0;
     m_cache_dirty = true;
+    m_cache_racy = false;
+    m_pinnedCount = 0;
 }
 
 
 void FP_CACHE::Save( MODULE* aModule )
 {
-    m_cache_timestamp = 0;
-
     if( !m_lib_path.DirExists() && !m_lib_path.Mkdir() )
     {
         THROW_IO_ERROR( wxString::Format( _( "Cannot create footprint library path \"%s\"" ),
@@ -173,6 +259,10 @@ void FP_CACHE::Save( MODULE* aModule )
         if( aModule && aModule != it->second->GetModule() )
             continue;
 
+        // Footprints which were never parsed are on disk as they are
+        if( !it->second->GetModule() )
+            continue;
+
         WX_FILENAME fn = it->second->GetFileName();
 
         wxString tempFileName =
@@ -208,10 +298,10 @@ void FP_CACHE::Save( MODULE* aModule )
             THROW_IO_ERROR( msg );
         }
 #endif
-        m_cache_timestamp += fn.GetTimestamp();
+        setTimestamp( it->second, fn.GetTimestamp() );
     }
 
-    m_cache_timestamp += m_lib_path.GetModificationTime().GetValue().GetValue();
+    updateTimestamp();
 
     // If we've saved the full cache, we clear the dirty flag.
     if( !aModule )
@@ -222,7 +312,9 @@ void FP_CACHE::Save( MODULE* aModule )
 void FP_CACHE::Load()
 {
     m_cache_dirty = false;
-    m_cache_timestamp = 0;
+
+    // Taken before listing the files, so that a file added meanwhile is found next time.
+    updateTimestamp();
 
     wxDir dir( m_lib_raw_path );
 
@@ -239,49 +331,181 @@ void FP_CACHE::Load()
 
     // wxFileName construction is egregiously slow.  Construct it once and just swap out
     // the filename thereafter.
-    WX_FILENAME fn( m_lib_raw_path, wxT( "dummyName" ) );
+    WX_FILENAME           fn( m_lib_raw_path, wxT( "dummyName" ) );
+    std::set<wxString>    listed;
 
     if( dir.GetFirst( &fullName, fileSpec ) )
     {
-        wxString cacheError;
-
         do
         {
             fn.SetFullName( fullName );
 
-            // Queue I/O errors so only files that fail to parse don't get loaded.
-            try
-            {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+            wxString fpName = fn.GetName();
 
-                m_owner->m_parser->SetLineReader( &reader );
+            listed.insert( fpName );
 
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
+            if( m_modules.find( fpName ) == m_modules.end() )
+                m_modules.insert( fpName, new FP_CACHE_ITEM( nullptr, fn ) );
+        } while( dir.GetNext( &fullName ) );
+    }
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+    for( MODULE_ITER it = m_modules.begin(); it != m_modules.end(); )
+    {
+        if( listed.count( it->first ) )
+        {
+            ++it;
+        }
+        else
+        {
+            release( it->second );
+            it = m_modules.erase( it );
+        }
+    }
+}
 
-                m_cache_timestamp += fn.GetTimestamp();
-            }
-            catch( const IO_ERROR& ioe )
-            {
-                if( !cacheError.IsEmpty() )
-                    cacheError += "\n\n";
 
-                cacheError += ioe.What();
-            }
-        } while( dir.GetNext( &fullName ) );
+const MODULE* FP_CACHE::GetFootprint( const wxString& aFootprintName, bool aCheckModified,
+                                      bool aPin )
+{
+    MODULE_ITER it = m_modules.find( aFootprintName );
+
+    if( it == m_modules.end() )
+        return nullptr;
+
+    FP_CACHE_ITEM* item = it->second;
+
+    if( !item->GetModule()
+            || ( aCheckModified
+                    && ( item->m_racy || item->m_filename.GetTimestamp() != item->m_timestamp ) ) )
+    {
+        parse( item, aFootprintName );
+    }
+
+    if( aPin && !item->m_pinned )
+    {
+        if( item->m_listed )
+        {
+            m_parsed.erase( item->m_lruPos );
+            item->m_listed = false;
+        }
+
+        item->m_pinned = true;
+        m_pinnedCount++;
+    }
+
+    touch( item );
+
+    return item->GetModule();
+}
+
+
+void FP_CACHE::Unpin()
+{
+    m_retired.clear();
+    m_pinnedCount = 0;
+
+    for( MODULE_ITER it = m_modules.begin(); it != m_modules.end(); ++it )
+    {
+        if( it->second->m_pinned )
+        {
+            it->second->m_pinned = false;
+            touch( it->second );
+        }
+    }
+}
+
+
+void FP_CACHE::parse( FP_CACHE_ITEM* aItem, const wxString& aFootprintName )
+{
+    release( aItem );
+
+    // Taken before parsing, so that a change made meanwhile is found next time.
+    long long timestamp = aItem->m_filename.GetTimestamp();
+
+    MAPPED_FILE_LINE_READER reader( aItem->m_filename.GetFullPath() );
+
+    m_owner->m_parser->SetLineReader( &reader );
+
+    MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, aFootprintName ) );
+
+    aItem->m_module.reset( footprint );
+    setTimestamp( aItem, timestamp );
+}
+
+
+void FP_CACHE::touch( FP_CACHE_ITEM* aItem )
+{
+    if( !aItem->m_pinned )
+    {
+        if( aItem->m_listed )
+        {
+            m_parsed.splice( m_parsed.begin(), m_parsed, aItem->m_lruPos );
+        }
+        else
+        {
+            aItem->m_lruPos = m_parsed.insert( m_parsed.begin(), aItem );
+            aItem->m_listed = true;
+        }
+    }
+
+    size_t maxParsed = std::max( m_owner->m_footprintCacheSize, 0 );
 
-        if( !cacheError.IsEmpty() )
-            THROW_IO_ERROR( cacheError );
+    // The pinned footprints are held by the callers of GetEnumeratedFootprint(), so only the
+    // others can be dropped to make room.  aItem itself is kept, as it is being handed out.
+    while( maxParsed && !m_parsed.empty() && m_parsed.back() != aItem
+            && m_parsed.size() + m_pinnedCount > maxParsed )
+    {
+        release( m_parsed.back() );
+    }
+}
+
+
+void FP_CACHE::release( FP_CACHE_ITEM* aItem )
+{
+    if( aItem->m_listed )
+    {
+        m_parsed.erase( aItem->m_lruPos );
+        aItem->m_listed = false;
+    }
+
+    if( aItem->m_pinned )
+    {
+        // Whoever got it from GetEnumeratedFootprint() may still use it
+        if( aItem->m_module )
+            m_retired.push_back( std::move( aItem->m_module ) );
+
+        aItem->m_pinned = false;
+        m_pinnedCount--;
+    }
+
+    aItem->m_module.reset();
+}
+
+
+void FP_CACHE::Add( const wxString& aFootprintName, MODULE* aModule,
+                    const WX_FILENAME& aFileName )
+{
+    MODULE_ITER it = m_modules.find( aFootprintName );
+
+    if( it != m_modules.end() )
+    {
+        release( it->second );
+        m_modules.erase( it );
     }
+
+    FP_CACHE_ITEM* item = new FP_CACHE_ITEM( aModule, aFileName );
+    wxString       fpName = aFootprintName;
+
+    m_modules.insert( fpName, item );
+    touch( item );
 }
 
 
 void FP_CACHE::Remove( const wxString& aFootprintName )
 {
-    MODULE_CITER it = m_modules.find( aFootprintName );
+    MODULE_ITER it = m_modules.find( aFootprintName );
 
     if( it == m_modules.end() )
     {
@@ -293,7 +517,8 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
 
     // Remove the module from the cache and delete the module file from the library.
     wxString fullPath = it->second->GetFileName().GetFullPath();
-    m_modules.erase( aFootprintName );
+    release( it->second );
+    m_modules.erase( it );
     wxRemoveFile( fullPath );
 }
 
@@ -306,12 +531,49 @@ bool FP_CACHE::IsPath( const wxString& aPath ) const
 
 bool FP_CACHE::IsModified()
 {
-    m_cache_dirty = m_cache_dirty || GetTimestamp( m_lib_path.GetFullPath() ) != m_cache_timestamp;
+    // Adding, removing or renaming a file changes the timestamp of its directory, so this
+    // is a single stat() however large the library.
+    m_cache_dirty = m_cache_dirty || m_cache_racy || getDirTimestamp() != m_cache_timestamp;
 
     return m_cache_dirty;
 }
 
 
+void FP_CACHE::updateTimestamp()
+{
+    m_cache_timestamp = getDirTimestamp();
+
+    // Timestamps are in whole seconds on most file systems, so a file added within the same
+    // second as the last change of the directory would go unnoticed.  Until that second is
+    // over, the directory is listed again at each check.
+    m_cache_racy = isRacy( m_cache_timestamp );
+}
+
+
+void FP_CACHE::setTimestamp( FP_CACHE_ITEM* aItem, long long aTimestamp )
+{
+    aItem->m_timestamp = aTimestamp;
+
+    // As for the directory, a file changed again within the same second would keep its
+    // timestamp, so it is parsed again at each check until that second is over.
+    aItem->m_racy = isRacy( aTimestamp );
+}
+
+
+bool FP_CACHE::isRacy( long long aTimestamp )
+{
+    return wxDateTime::UNow().GetValue().GetValue() - aTimestamp < 2000;
+}
+
+
+long long FP_CACHE::getDirTimestamp() const
+{
+    wxDateTime modTime = m_lib_path.GetModificationTime();
+
+    return modTime.IsValid() ? modTime.GetValue().GetValue() : 0;
+}
+
+
 long long FP_CACHE::GetTimestamp( const wxString& aLibPath )
 {
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
@@ -631,11 +893,8 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     formatHeader( aBoard, aNestLevel );
 
     // Save the modules.
-    for( BOARD_ITEM* module : sorted_modules )
-    {
-        Format( module, aNestLevel );
-        m_out->Print( 0, "\n" );
-    }
+    formatItems( std::vector<BOARD_ITEM*>( sorted_modules.begin(), sorted_modules.end() ),
+                 aNestLevel, true );
 
     // Save the graphical items on the board (not owned by a module)
     for( BOARD_ITEM* item : sorted_drawings )
@@ -654,8 +913,8 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
         m_out->Print( 0, "\n" );
 
     // Save the polygon (which are the newer technology) zones.
-    for( auto zone : sorted_zones )
-        Format( zone, aNestLevel );
+    formatItems( std::vector<BOARD_ITEM*>( sorted_zones.begin(), sorted_zones.end() ),
+                 aNestLevel, false );
 
     // Save the groups
     for( BOARD_ITEM* group : sorted_groups )
@@ -663,6 +922,78 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
 }
 
 
+void PCB_IO::formatItems( const std::vector<BOARD_ITEM*>& aItems, int aNestLevel,
+                          bool aNewLine ) const
+{
+    // Footprints and filled zones are formatted by chunks of consecutive items, each chunk
+    // into its own string.  The strings are written in the order of the chunks afterwards,
+    // so the file is the same whichever threads formatted them.  A few chunks per thread
+    // even out the cost of the items, which varies a lot for zones.  Chunks have a minimum
+    // size, so that a few items are formatted right here rather than by starting threads.
+    const size_t minChunkSize = 16;
+
+    size_t threadCount = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+    size_t chunkSize = std::max( minChunkSize, aItems.size() / ( 4 * threadCount ) );
+    size_t chunkCount = ( aItems.size() + chunkSize - 1 ) / chunkSize;
+    size_t parallelThreadCount = std::min( threadCount, chunkCount );
+
+    if( parallelThreadCount <= 1 )
+    {
+        for( BOARD_ITEM* item : aItems )
+        {
+            Format( item, aNestLevel );
+
+            if( aNewLine )
+                m_out->Print( 0, "\n" );
+        }
+
+        return;
+    }
+
+    std::vector<std::string>         chunks( chunkCount );
+    std::atomic<size_t>              nextChunk( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto format_lambda = [&]() -> size_t
+    {
+        PCB_IO           worker( m_ctl );
+        STRING_FORMATTER formatter;
+
+        worker.m_board = m_board;
+        *worker.m_mapping = *m_mapping;
+        worker.m_out = &formatter;
+
+        for( size_t ii = nextChunk++; ii < chunkCount; ii = nextChunk++ )
+        {
+            size_t end = std::min( ( ii + 1 ) * chunkSize, aItems.size() );
+
+            for( size_t jj = ii * chunkSize; jj < end; ++jj )
+            {
+                worker.Format( aItems[jj], aNestLevel );
+
+                if( aNewLine )
+                    formatter.Print( 0, "\n" );
+            }
+
+            chunks[ii] = formatter.GetString();
+            formatter.Clear();
+        }
+
+        return 1;
+    };
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii] = std::async( std::launch::async, format_lambda );
+
+    // get() rethrows what a thread may have thrown
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii].get();
+
+    for( const std::string& chunk : chunks )
+        m_out->Write( chunk );
+}
+
+
 void PCB_IO::format( DIMENSION* aDimension, int aNestLevel ) const
 {
     ALIGNED_DIMENSION*    aligned = dynamic_cast<ALIGNED_DIMENSION*>( aDimension );
@@ -790,8 +1121,8 @@ void PCB_IO::format( PCB_SHAPE* aShape, int aNestLevel ) const
     case S_POLYGON: // Polygon
         if( aShape->IsPolyShapeValid() )
         {
-            SHAPE_POLY_SET& poly = aShape->GetPolyShape();
-            SHAPE_LINE_CHAIN& outline = poly.Outline( 0 );
+            const SHAPE_POLY_SET&   poly = aShape->GetPolyShape();
+            const SHAPE_LINE_CHAIN& outline = poly.COutline( 0 );
             int pointsCount = outline.PointCount();
 
             m_out->Print( aNestLevel, "(gr_poly (pts\n" );
@@ -876,8 +1207,8 @@ void PCB_IO::format( FP_SHAPE* aModuleDrawing, int aNestLevel ) const
     case S_POLYGON: // Polygonal segment
         if( aModuleDrawing->IsPolyShapeValid() )
         {
-            SHAPE_POLY_SET& poly = aModuleDrawing->GetPolyShape();
-            SHAPE_LINE_CHAIN& outline = poly.Outline( 0 );
+            const SHAPE_POLY_SET&   poly = aModuleDrawing->GetPolyShape();
+            const SHAPE_LINE_CHAIN& outline = poly.COutline( 0 );
             int pointsCount = outline.PointCount();
 
             m_out->Print( aNestLevel, "(fp_poly (pts" );
@@ -2033,6 +2364,7 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
 PCB_IO::PCB_IO( int aControlFlags ) :
     m_cache( 0 ),
+    m_footprintCacheSize( ADVANCED_CFG::GetCfg().m_FootprintCacheSize ),
     m_ctl( aControlFlags ),
     m_parser( new PCB_PARSER() ),
     m_mapping( new NETINFO_MAPPING() )
@@ -2052,7 +2384,7 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     BOARD* board = DoLoad( reader, aAppendToMe, aProperties );
 
@@ -2113,25 +2445,33 @@ void PCB_IO::init( const PROPERTIES* aProperties )
 
 void PCB_IO::validateCache( const wxString& aLibraryPath, bool checkModified )
 {
-    if( !m_cache || !m_cache->IsPath( aLibraryPath ) || ( checkModified && m_cache->IsModified() ) )
+    if( !m_cache || !m_cache->IsPath( aLibraryPath ) )
     {
         // a spectacular episode in memory management:
         delete m_cache;
         m_cache = new FP_CACHE( this, aLibraryPath );
         m_cache->Load();
     }
+    else if( checkModified && m_cache->IsModified() )
+    {
+        // Only lists the files again, the footprints are checked one by one when loaded
+        m_cache->Load();
+    }
 }
 
 
 void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibPath,
                                  bool aBestEfforts, const PROPERTIES* aProperties )
 {
-    LOCALE_IO toggle;     // toggles on, then off, the C locale.
     wxDir     dir( aLibPath );
     wxString  errorMsg;
 
     init( aProperties );
 
+    // A new enumeration begins, so the footprints handed out for the last one are released
+    if( m_cache )
+        m_cache->Unpin();
+
     try
     {
         validateCache( aLibPath );
@@ -2141,8 +2481,8 @@ void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
         errorMsg = ioe.What();
     }
 
-    // Some of the files may have been parsed correctly so we want to add the valid files to
-    // the library.
+    // The footprints are only parsed when loaded, so a file which does not parse is listed
+    // here and reported by FootprintLoad().
 
     for( MODULE_CITER it = m_cache->GetModules().begin(); it != m_cache->GetModules().end(); ++it )
         aFootprintNames.Add( it->first );
@@ -2155,10 +2495,8 @@ void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
 const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
                                     const wxString& aFootprintName,
                                     const PROPERTIES* aProperties,
-                                    bool checkModified )
+                                    bool checkModified, bool aPin )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     try
@@ -2170,14 +2508,8 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
-
-    MODULE_CITER it = mods.find( aFootprintName );
-
-    if( it == mods.end() )
-        return nullptr;
-
-    return it->second->GetModule();
+    // Throws if the footprint file does not parse
+    return m_cache->GetFootprint( aFootprintName, checkModified, aPin );
 }
 
 
@@ -2185,7 +2517,22 @@ const MODULE* PCB_IO::GetEnumeratedFootprint( const wxString& aLibraryPath,
                                               const wxString& aFootprintName,
                                               const PROPERTIES* aProperties )
 {
-    return getFootprint( aLibraryPath, aFootprintName, aProperties, false );
+    init( aProperties );
+
+    try
+    {
+        // The files were just listed by FootprintEnumerate(), so only the footprint file
+        // itself is checked for changes
+        validateCache( aLibraryPath, false );
+
+        // Pinned, as the caller may hold on to it until the next FootprintEnumerate()
+        return m_cache->GetFootprint( aFootprintName, true, true );
+    }
+    catch( const IO_ERROR& )
+    {
+        // As when the footprint list was built, broken footprints are left out
+        return nullptr;
+    }
 }
 
 
@@ -2208,7 +2555,8 @@ bool PCB_IO::FootprintExists( const wxString& aLibraryPath, const wxString& aFoo
 MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFootprintName,
                                const PROPERTIES* aProperties )
 {
-    const MODULE* footprint = getFootprint( aLibraryPath, aFootprintName, aProperties, true );
+    const MODULE* footprint = getFootprint( aLibraryPath, aFootprintName, aProperties, true,
+                                            false );
     return footprint ? (MODULE*) footprint->Duplicate() : nullptr;
 }
 
@@ -2249,7 +2597,7 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
 
     wxString footprintName = aFootprint->GetFPID().GetLibItemName();
 
-    MODULE_MAP& mods = m_cache->GetModules();
+    const MODULE_MAP& mods = m_cache->GetModules();
 
     // Quietly overwrite module and delete module file from path for any by same name.
     wxFileName fn( aLibraryPath, aFootprint->GetFPID().GetLibItemName(),
@@ -2290,7 +2638,6 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
     if( it != mods.end() )
     {
         wxLogTrace( traceKicadPcbPlugin, wxT( "Removing footprint file '%s'." ), fullPath );
-        mods.erase( footprintName );
         wxRemoveFile( fullPath );
     }
 
@@ -2312,7 +2659,7 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
     }
 
     wxLogTrace( traceKicadPcbPlugin, wxT( "Creating s-expr footprint file '%s'." ), fullPath );
-    mods.insert( footprintName, new FP_CACHE_ITEM( module, WX_FILENAME( fn.GetPath(), fullName ) ) );
+    m_cache->Add( footprintName, module, WX_FILENAME( fn.GetPath(), fullName ) );
     m_cache->Save( module );
 }
 
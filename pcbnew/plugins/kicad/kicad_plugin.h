@@ -207,6 +207,14 @@ public:
 
     void SetOutputFormatter( OUTPUTFORMATTER* aFormatter ) { m_out = aFormatter; }
 
+    /**
+     * Set the most footprints the library cache keeps parsed, 0 for no limit.  Footprints
+     * returned by GetEnumeratedFootprint() are kept past it until the next
+     * FootprintEnumerate().  The default comes from the FootprintCacheSize advanced config
+     * setting.
+     */
+    void SetFootprintCacheSize( int aSize ) { m_footprintCacheSize = aSize; }
+
     BOARD_ITEM* Parse( const wxString& aClipboardSourceInput );
 
 protected:
@@ -217,6 +225,7 @@ protected:
     const
     PROPERTIES*     m_props;        ///< passed via Save() or Load(), no ownership, may be NULL.
     FP_CACHE*       m_cache;        ///< Footprint library cache.
+    int             m_footprintCacheSize; ///< Most footprints kept parsed in m_cache.
 
     LINE_READER*    m_reader;       ///< no ownership here.
     wxString        m_filename;     ///< for saves only, name is in m_reader for loads
@@ -233,7 +242,7 @@ protected:
     void validateCache( const wxString& aLibraryPath, bool checkModified = true );
 
     const MODULE* getFootprint( const wxString& aLibraryPath, const wxString& aFootprintName,
-                  const PROPERTIES* aProperties, bool checkModified );
+                  const PROPERTIES* aProperties, bool checkModified, bool aPin );
 
     void init( const PROPERTIES* aProperties );
 
@@ -280,6 +289,14 @@ private:
 
     void format( ZONE_CONTAINER* aZone, int aNestLevel = 0 ) const;
 
+    /**
+     * Formats \a aItems in their order, on several threads when there are enough of them.
+     * A few items are formatted on the calling thread.
+     * @param aNewLine tells whether to add an empty line after each item.
+     */
+    void formatItems( const std::vector<BOARD_ITEM*>& aItems, int aNestLevel,
+                      bool aNewLine ) const;
+
     void formatLayer( const BOARD_ITEM* aItem ) const;
 
     void formatLayers( LSET aLayerMask, int aNestLevel = 0 ) const;
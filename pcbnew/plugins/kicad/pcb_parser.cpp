@@ -27,9 +27,15 @@
  * @brief Pcbnew s-expression file format parser implementation.
  */
 
-#include <cerrno>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+
 #include <common.h>
 #include <confirm.h>
+#include <kicad_string.h>
 #include <macros.h>
 #include <title_block.h>
 #include <trigo.h>
@@ -138,13 +144,10 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
-    char* tmp;
-
-    errno = 0;
+    double      fval;
+    const char* tmp = DecimalToDouble( CurText(), fval );
 
-    double fval = strtod( CurText(), &tmp );
-
-    if( errno )
+    if( !tmp )
     {
         wxString error;
         error.Printf( _( "Invalid floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -166,6 +169,32 @@ double PCB_PARSER::parseDouble()
 }
 
 
+int PCB_PARSER::parseBoardUnits()
+{
+    // Board units are nanometers, so the mm of the file convert to them by a power of ten.
+    static_assert( IU_PER_MM == 1e6, "PCB_PARSER expects nanometer board units" );
+
+    long long value;
+
+    if( DecimalToScaledInt( CurText(), 6, value ) == CurText() )
+    {
+        wxString error;
+        error.Printf( _( "Missing floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
+                      CurSource(), CurLineNumber(), CurOffset() );
+
+        THROW_IO_ERROR( error );
+    }
+
+    // N.B. we currently represent board units as integers.  Any values that are
+    // larger or smaller than those board units represent undefined behavior for
+    // the system.  We limit values to the largest that is visible on the screen
+    // This is the diagonal distance of the full screen ~1.5m (0.7071 = roughly 1/sqrt(2))
+    long long int_limit = std::numeric_limits<int>::max() * 0.7071;
+
+    return (int) Clamp<long long>( -int_limit, value, int_limit );
+}
+
+
 bool PCB_PARSER::parseBool()
 {
     T token = NextTok();
@@ -486,7 +515,6 @@ BOARD_ITEM* PCB_PARSER::Parse()
 {
     T               token;
     BOARD_ITEM*     item;
-    LOCALE_IO       toggle;
 
     // MODULEs can be prefixed with an initial block of single line comments and these
     // are kept for Format() so they round trip in s-expression form.  BOARDs might
@@ -543,19 +571,43 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
     std::map<wxString, wxString> properties;
+    std::vector<BOARD_SECTION>   sections;
 
     parseHeader();
 
+    // When the file is lexed in place, the footprints, tracks, vias and zones, which make up
+    // most of a board, are only delimited here, and parsed on several threads once the nets
+    // and layers they refer to are known.  Reading into an existing board renews the UUIDs
+    // of the items, which is left to a single thread.
+    bool deferSections = !m_resetKIIDs && std::thread::hardware_concurrency() > 1;
+
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
         if( token != T_LEFT )
             Expecting( T_LEFT );
 
+        const char* left = CurPtr();
+        int         leftLine = CurLineNumber();
+
         token = NextTok();
 
         if( token == T_page && m_requiredVersion <= 20200119 )
             token = T_paper;
 
+        if( left && deferSections
+                && ( token == T_module || token == T_segment || token == T_arc || token == T_via
+                     || token == T_zone ) )
+        {
+            BOARD_SECTION section;
+            int           endLine;
+
+            section.start = left;
+            section.end = SkipListInPlace( left, leftLine, endLine );
+            section.line = leftLine;
+            sections.push_back( section );
+            continue;
+        }
+
         switch( token )
         {
         case T_general:
@@ -643,6 +695,8 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    parseBoardSections( sections );
+
     m_board->SetProperties( properties );
 
     if( m_undefinedLayers.size() > 0 )
@@ -728,6 +782,155 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+void PCB_PARSER::initSectionWorker( const PCB_PARSER& aParser )
+{
+    m_board = aParser.m_board;
+    m_layerIndices = aParser.m_layerIndices;
+    m_layerMasks = aParser.m_layerMasks;
+    m_netCodes = aParser.m_netCodes;
+    m_tooRecent = aParser.m_tooRecent;
+    m_requiredVersion = aParser.m_requiredVersion;
+    m_sectionWorker = true;
+}
+
+
+void PCB_PARSER::parseBoardSections( const std::vector<BOARD_SECTION>& aSections )
+{
+    if( aSections.empty() )
+        return;
+
+    using ZONE_NET_FIXES = std::vector<std::pair<ZONE_CONTAINER*, wxString>>;
+
+    // Each section has its own slots, so that the workers never share anything they write
+    std::vector<std::unique_ptr<BOARD_ITEM>> items( aSections.size() );
+    std::vector<std::vector<GROUP_INFO>>     groupInfos( aSections.size() );
+    std::vector<ZONE_NET_FIXES>              zoneNetFixes( aSections.size() );
+    std::vector<std::vector<wxString>>       messages( aSections.size() );
+    std::vector<std::exception_ptr>          errors( aSections.size() );
+    std::mutex                               mergeLock;
+    bool                                     legacyZoneFill = false;
+
+    const MAPPED_FILE_LINE_READER& file = *mappedReader;
+
+    // Sections are small, so a thread only pays off for a good number of them
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   ( aSections.size() + 63 ) / 64 );
+
+    std::atomic<size_t> nextSection( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto parse_lambda = [&]() -> size_t
+    {
+        PCB_PARSER parser;
+
+        parser.initSectionWorker( *this );
+
+        for( size_t ii = nextSection++; ii < aSections.size(); ii = nextSection++ )
+        {
+            const BOARD_SECTION&    section = aSections[ii];
+            MAPPED_FILE_LINE_READER reader( file, section.start, section.end, section.line );
+
+            parser.SetLineReader( &reader );
+            parser.curTok = DSN_NONE;
+
+            try
+            {
+                parser.NeedLEFT();
+
+                switch( parser.NextTok() )
+                {
+                case T_module:
+                    items[ii].reset( parser.parseMODULE() );
+                    break;
+
+                case T_segment:
+                    items[ii].reset( parser.parseTRACK() );
+                    break;
+
+                case T_arc:
+                    items[ii].reset( parser.parseARC() );
+                    break;
+
+                case T_via:
+                    items[ii].reset( parser.parseVIA() );
+                    break;
+
+                case T_zone:
+                    items[ii].reset( parser.parseZONE_CONTAINER( m_board ) );
+                    break;
+
+                default:
+                    parser.Expecting( "module, segment, arc, via or zone" );
+                }
+            }
+            catch( ... )
+            {
+                errors[ii] = std::current_exception();
+            }
+
+            groupInfos[ii].swap( parser.m_groupInfos );
+            zoneNetFixes[ii].swap( parser.m_zoneNetFixes );
+            messages[ii].swap( parser.m_sectionErrors );
+        }
+
+        parser.PopReader();
+
+        std::lock_guard<std::mutex> lock( mergeLock );
+
+        m_undefinedLayers.insert( parser.m_undefinedLayers.begin(),
+                                  parser.m_undefinedLayers.end() );
+        legacyZoneFill |= parser.m_legacyZoneFill;
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        parse_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, parse_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    // Log the messages of the sections and report the error of the first broken one, in
+    // file order, as a serial parse would have
+    for( size_t ii = 0; ii < aSections.size(); ++ii )
+    {
+        for( const wxString& message : messages[ii] )
+            wxLogError( message );
+
+        if( errors[ii] )
+            std::rethrow_exception( errors[ii] );
+    }
+
+    if( legacyZoneFill )
+        confirmLegacyZoneFill();
+
+    for( size_t ii = 0; ii < aSections.size(); ++ii )
+    {
+        m_board->Add( items[ii].release(), ADD_MODE::APPEND );
+
+        for( const std::pair<ZONE_CONTAINER*, wxString>& fix : zoneNetFixes[ii] )
+            fixZoneNet( fix.first, fix.second );
+
+        for( GROUP_INFO& groupInfo : groupInfos[ii] )
+            m_groupInfos.push_back( std::move( groupInfo ) );
+    }
+}
+
+
+void PCB_PARSER::logError( const wxString& aMessage )
+{
+    if( m_sectionWorker )
+        m_sectionErrors.push_back( aMessage );
+    else
+        wxLogError( aMessage );
+}
+
+
 void PCB_PARSER::resolveGroups( BOARD_ITEM* aParent )
 {
     auto getItem = [&]( const KIID& aId )
@@ -3602,13 +3805,13 @@ D_PAD* PCB_PARSER::parseD_PAD( MODULE* aParent )
         case T_net:
             if( ! pad->SetNetCode( getNetCode( parseInt( "net number" ) ), /* aNoAssert */ true ) )
             {
-                wxLogError( wxString::Format( _( "Invalid net ID in\n"
-                                                 "file: '%s'\n"
-                                                 "line: %d\n"
-                                                 "offset: %d" ),
-                                              CurSource(),
-                                              CurLineNumber(),
-                                              CurOffset() ) );
+                logError( wxString::Format( _( "Invalid net ID in\n"
+                                               "file: '%s'\n"
+                                               "line: %d\n"
+                                               "offset: %d" ),
+                                            CurSource(),
+                                            CurLineNumber(),
+                                            CurOffset() ) );
             }
 
             NeedSYMBOLorNUMBER();
@@ -3618,13 +3821,13 @@ D_PAD* PCB_PARSER::parseD_PAD( MODULE* aParent )
                 FromUTF8() != m_board->FindNet( pad->GetNetCode() )->GetNetname() )
             {
                 pad->SetNetCode( NETINFO_LIST::ORPHANED, /* aNoAssert */ true );
-                wxLogError( wxString::Format( _( "Net name doesn't match net ID in\n"
-                                                 "file: '%s'\n"
-                                                 "line: %d\n"
-                                                 "offset: %d" ),
-                                              CurSource(),
-                                              CurLineNumber(),
-                                              CurOffset() ) );
+                logError( wxString::Format( _( "Net name doesn't match net ID in\n"
+                                               "file: '%s'\n"
+                                               "line: %d\n"
+                                               "offset: %d" ),
+                                            CurSource(),
+                                            CurLineNumber(),
+                                            CurOffset() ) );
             }
 
             NeedRIGHT();
@@ -4414,25 +4617,15 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 
                     if( token == T_segment )    // deprecated
                     {
-                        // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
-                        if( m_showLegacyZoneWarning )
-                        {
-                            KIDIALOG dlg( nullptr,
-                                          _( "The legacy segment fill mode is no longer supported.\n"
-                                             "Convert zones to polygon fills?"),
-                                          _( "Legacy Zone Warning" ),
-                                          wxYES_NO | wxICON_WARNING );
-
-                            dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
-
-                            if( dlg.ShowModal() == wxID_NO )
-                                THROW_IO_ERROR( wxT( "CANCEL" ) );
-
-                            m_showLegacyZoneWarning = false;
-                        }
+                        // SEGMENT fill mode no longer supported.  Make sure user is OK with
+                        // converting them.  Section workers leave the question to the main
+                        // parser, which asks it on the GUI thread.
+                        if( m_sectionWorker )
+                            m_legacyZoneFill = true;
+                        else
+                            confirmLegacyZoneFill();
 
                         zone->SetFillMode( ZONE_FILL_MODE::POLYGONS );
-                        m_board->SetModified();
                     }
                     else if( token == T_hatch )
                         zone->SetFillMode( ZONE_FILL_MODE::HATCH_PATTERN );
@@ -4783,21 +4976,10 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-        }
+        if( m_sectionWorker )
+            m_zoneNetFixes.emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     // Clear flags used in zone edition:
@@ -4807,6 +4989,48 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 }
 
 
+void PCB_PARSER::confirmLegacyZoneFill()
+{
+    if( m_showLegacyZoneWarning )
+    {
+        KIDIALOG dlg( nullptr,
+                      _( "The legacy segment fill mode is no longer supported.\n"
+                         "Convert zones to polygon fills?"),
+                      _( "Legacy Zone Warning" ),
+                      wxYES_NO | wxICON_WARNING );
+
+        dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
+
+        if( dlg.ShowModal() == wxID_NO )
+            THROW_IO_ERROR( wxT( "CANCEL" ) );
+
+        m_showLegacyZoneWarning = false;
+    }
+
+    m_board->SetModified();
+}
+
+
+void PCB_PARSER::fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetName )
+{
+    NETINFO_ITEM* net = m_board->FindNet( aNetName );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetName, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+    }
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
@@ -85,6 +85,25 @@ class PCB_PARSER : public PCB_LEXER
 
     bool                m_showLegacyZoneWarning;
 
+    bool                m_sectionWorker;    ///< parsing board sections for another parser
+    bool                m_legacyZoneFill;   ///< a section worker found a legacy zone fill mode
+
+    ///> Zones whose net code does not match their net name in the file.  Section workers
+    ///> leave them to the main parser, since fixing them may add nets to the board.
+    std::vector<std::pair<ZONE_CONTAINER*, wxString>> m_zoneNetFixes;
+
+    ///> Errors found by a section worker, which the main parser logs after the join, since
+    ///> wxLog is not meant to be used from the worker threads.
+    std::vector<wxString> m_sectionErrors;
+
+    ///> A top level section of a board file, left to the section workers
+    struct BOARD_SECTION
+    {
+        const char* start;      ///< the opening paren, in the mapped file
+        const char* end;        ///< just after the closing paren
+        int         line;       ///< the line number of start
+    };
+
     // Group membership info refers to other Uuids in the file.
     // We don't want to rely on group declarations being last in the file, so
     // we store info about the group declarations here during parsing and then resolve
@@ -190,6 +209,31 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function parseBoardSections
+     * parses the footprint, track, via and zone sections of a board on several threads, each
+     * with its own section worker parser, and adds their items to the board in file order.
+     */
+    void            parseBoardSections( const std::vector<BOARD_SECTION>& aSections );
+
+    /**
+     * Log a non fatal error, or keep it for the main parser in a section worker.
+     */
+    void            logError( const wxString& aMessage );
+
+    /**
+     * Function initSectionWorker
+     * copies the state of @a aParser needed to parse board sections after the header, layers
+     * and nets of the board were parsed by @a aParser.
+     */
+    void            initSectionWorker( const PCB_PARSER& aParser );
+
+    ///> Asks whether the legacy segment zone fill mode may be converted to polygons
+    void            confirmLegacyZoneFill();
+
+    ///> Gives aZone the net named aNetName, adding it to the board if needed
+    void            fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetName );
+
     /**
      * Function lookUpLayer
      * parses the current token for the layer definition of a #BOARD_ITEM object.
@@ -254,7 +298,8 @@ class PCB_PARSER : public PCB_LEXER
     /**
      * Function parseDouble
      * parses the current token as an ASCII numeric string with possible leading
-     * whitespace into a double precision floating point number.
+     * whitespace into a double precision floating point number, in the C locale whatever
+     * the current locale is.
      *
      * @throw IO_ERROR if an error occurs attempting to convert the current token.
      * @return The result of the parsed token.
@@ -272,37 +317,21 @@ class PCB_PARSER : public PCB_LEXER
         return parseDouble( GetTokenText( aToken ) );
     }
 
-    inline int parseBoardUnits()
-    {
-        // There should be no major rounding issues here, since the values in
-        // the file are in mm and get converted to nano-meters.
-        // See test program tools/test-nm-biu-to-ascii-mm-round-tripping.cpp
-        // to confirm or experiment.  Use a similar strategy in both places, here
-        // and in the test program. Make that program with:
-        // $ make test-nm-biu-to-ascii-mm-round-tripping
-        auto retval = parseDouble() * IU_PER_MM;
-
-        // N.B. we currently represent board units as integers.  Any values that are
-        // larger or smaller than those board units represent undefined behavior for
-        // the system.  We limit values to the largest that is visible on the screen
-        // This is the diagonal distance of the full screen ~1.5m
-        double int_limit = std::numeric_limits<int>::max() * 0.7071;    // 0.7071 = roughly 1/sqrt(2)
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
-    }
+    /**
+     * Function parseBoardUnits
+     * parses the current token, a length in mm, straight into board units.  The value is
+     * never converted to floating point, so it is rounded exactly, and the result does not
+     * depend on the locale.
+     *
+     * @throw IO_ERROR if the current token is not a number.
+     * @return The length in board units.
+     */
+    int parseBoardUnits();
 
     inline int parseBoardUnits( const char* aExpected )
     {
-        auto retval = parseDouble( aExpected ) * IU_PER_MM;
-
-        // N.B. we currently represent board units as integers.  Any values that are
-        // larger or smaller than those board units represent undefined behavior for
-        // the system.  We limit values to the largest that is visible on the screen
-        double int_limit = std::numeric_limits<int>::max() * 0.7071;
-
-        // Use here KiROUND, not KIROUND (see comments about them)
-        // when having a function as argument, because it will be called twice
-        // with KIROUND
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
+        NeedNUMBER( aExpected );
+        return parseBoardUnits();
     }
 
     inline int parseBoardUnits( PCB_KEYS_T::T aToken )
@@ -351,7 +380,9 @@ public:
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
         m_board( 0 ),
-        m_resetKIIDs( false )
+        m_resetKIIDs( false ),
+        m_sectionWorker( false ),
+        m_legacyZoneFill( false )
     {
         init();
     }
@@ -29,10 +29,14 @@
 #include <tools/zone_filler_tool.h>
 #include <tools/drc_tool.h>
 #include <kiface_i.h>
+#include <class_module.h>
+#include <advanced_config.h>
 #include <dialog_drc.h>
 #include <board_commit.h>
 #include <widgets/progress_reporter.h>
 #include <drc/drc_results_provider.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_test_provider.h>
 #include <netlist_reader/pcb_netlist.h>
 
 DRC_TOOL::DRC_TOOL() :
@@ -40,13 +44,19 @@ DRC_TOOL::DRC_TOOL() :
         m_editFrame( nullptr ),
         m_pcb( nullptr ),
         m_drcDialog( nullptr ),
-        m_drcRunning( false )
+        m_drcRunning( false ),
+        m_incrementalValid( false ),
+        m_lastRulesFingerprint( 0 ),
+        m_lastTestTracksAgainstZones( false ),
+        m_lastReportAllTrackErrors( false )
 {
 }
 
 
 DRC_TOOL::~DRC_TOOL()
 {
+    if( m_pcb )
+        m_pcb->RemoveListener( this );
 }
 
 
@@ -61,6 +71,13 @@ void DRC_TOOL::Reset( RESET_REASON aReason )
 
         m_pcb = m_editFrame->GetBoard();
         m_drcEngine = m_pcb->GetDesignSettings().m_DRCEngine;
+
+        // The previous board (if any) has already been deleted, so there's nothing to
+        // unregister from.
+        resetIncrementalState( true );
+
+        if( ADVANCED_CFG::GetCfg().m_IncrementalDRC )
+            m_pcb->AddListener( this );
     }
 
     if( aReason == MODEL_RELOAD && m_pcb->GetProject() )
@@ -78,6 +95,75 @@ void DRC_TOOL::Reset( RESET_REASON aReason )
 }
 
 
+void DRC_TOOL::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    if( aBoardItem->Type() != PCB_MARKER_T )
+        m_dirtyItems.insert( aBoardItem );
+}
+
+
+void DRC_TOOL::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    if( aBoardItem->Type() == PCB_MARKER_T )
+    {
+        // Markers deleted by the user won't be re-created by an incremental run
+        if( !m_drcRunning )
+            m_incrementalValid = false;
+
+        return;
+    }
+
+    auto forget =
+            [&]( BOARD_ITEM* aItem )
+            {
+                m_dirtyItems.erase( aItem );
+                m_staleIds.insert( aItem->m_Uuid );
+            };
+
+    // The children must be recorded now; they may be gone by the time of the next run
+    if( MODULE* footprint = dyn_cast<MODULE*>( aBoardItem ) )
+        footprint->RunOnChildren( forget );
+
+    forget( aBoardItem );
+}
+
+
+void DRC_TOOL::OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    if( aBoardItem->Type() != PCB_MARKER_T )
+        m_dirtyItems.insert( aBoardItem );
+}
+
+
+void DRC_TOOL::OnBoardNetSettingsChanged( BOARD& aBoard )
+{
+    // Netclass changes can affect the clearance of any item
+    m_incrementalValid = false;
+}
+
+
+void DRC_TOOL::resetIncrementalState( bool aInvalidate )
+{
+    m_dirtyItems.clear();
+    m_staleIds.clear();
+
+    if( aInvalidate )
+        m_incrementalValid = false;
+}
+
+
+bool DRC_TOOL::CanRunIncrementally( bool aTestTracksAgainstZones, bool aReportAllTrackErrors,
+                                    bool aTestFootprints ) const
+{
+    return ADVANCED_CFG::GetCfg().m_IncrementalDRC
+            && m_incrementalValid
+            && !aTestFootprints
+            && aTestTracksAgainstZones == m_lastTestTracksAgainstZones
+            && aReportAllTrackErrors == m_lastReportAllTrackErrors
+            && m_drcEngine->GetRulesFingerprint() == m_lastRulesFingerprint;
+}
+
+
 void DRC_TOOL::ShowDRCDialog( wxWindow* aParent )
 {
     bool show_dlg_modal = true;
@@ -153,6 +239,9 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aTestTracksA
     NETLIST           netlist;
     wxWindowDisabler  disabler( /* disable everything except: */ m_drcDialog );
 
+    bool incremental = CanRunIncrementally( aTestTracksAgainstZones, aReportAllTrackErrors,
+                                            aTestFootprints );
+
     m_drcRunning = true;
 
     if( aRefillZones )
@@ -203,8 +292,60 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aTestTracksA
                 }
             } );
 
-    m_drcEngine->RunTests( m_editFrame->GetUserUnits(), aTestTracksAgainstZones,
-                           aReportAllTrackErrors, aTestFootprints );
+    if( incremental )
+    {
+        // Zone refills above are included in the dirty items
+        std::vector<BOARD_ITEM*> dirtyItems( m_dirtyItems.begin(), m_dirtyItems.end() );
+        std::set<KIID>           staleIds = m_staleIds;
+
+        for( BOARD_ITEM* item : dirtyItems )
+        {
+            staleIds.insert( item->m_Uuid );
+
+            if( MODULE* footprint = dyn_cast<MODULE*>( item ) )
+            {
+                footprint->RunOnChildren(
+                        [&]( BOARD_ITEM* child )
+                        {
+                            staleIds.insert( child->m_Uuid );
+                        } );
+            }
+        }
+
+        // Markers for the touched items, and those of the tests which are run on the whole
+        // board anyway, are re-created by the run; the others are kept
+        for( MARKER_PCB* marker : m_pcb->Markers() )
+        {
+            std::shared_ptr<RC_ITEM> rcItem = marker->GetRCItem();
+            DRC_ITEM*                drcItem = dynamic_cast<DRC_ITEM*>( rcItem.get() );
+
+            if( !drcItem || !drcItem->GetViolatingTest()
+                    || !drcItem->GetViolatingTest()->SupportsIncremental()
+                    || staleIds.count( rcItem->GetMainItemID() )
+                    || staleIds.count( rcItem->GetAuxItemID() ) )
+            {
+                commit.Remove( marker );
+            }
+        }
+
+        m_drcEngine->RunIncrementalTests( m_editFrame->GetUserUnits(), dirtyItems, m_staleIds );
+    }
+    else
+    {
+        m_drcEngine->RunTests( m_editFrame->GetUserUnits(), aTestTracksAgainstZones,
+                               aReportAllTrackErrors, aTestFootprints );
+    }
+
+    // A cancelled run leaves an unknown set of markers behind, so the next one must be complete
+    resetIncrementalState( aProgressReporter->IsCancelled() );
+
+    if( !incremental && !aProgressReporter->IsCancelled() )
+    {
+        m_incrementalValid = true;
+        m_lastRulesFingerprint = m_drcEngine->GetRulesFingerprint();
+        m_lastTestTracksAgainstZones = aTestTracksAgainstZones;
+        m_lastReportAllTrackErrors = aReportAllTrackErrors;
+    }
 
     m_drcEngine->SetProgressReporter( nullptr );
     m_drcEngine->ClearViolationHandler();
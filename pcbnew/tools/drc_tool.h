@@ -31,6 +31,7 @@
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 #include <memory>
+#include <set>
 #include <vector>
 #include <tools/pcb_tool_base.h>
 
@@ -42,7 +43,7 @@ class WX_PROGRESS_REPORTER;
 class DRC_ENGINE;
 
 
-class DRC_TOOL : public PCB_TOOL_BASE
+class DRC_TOOL : public PCB_TOOL_BASE, public BOARD_LISTENER
 {
 public:
     DRC_TOOL();
@@ -51,6 +52,12 @@ public:
     /// @copydoc TOOL_INTERACTIVE::Reset()
     void Reset( RESET_REASON aReason ) override;
 
+    ///> Track the items touched since the last DRC run (for incremental runs).
+    void OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardNetSettingsChanged( BOARD& aBoard ) override;
+
 private:
     PCB_EDIT_FRAME*  m_editFrame;        // The pcb frame editor which owns the board
     BOARD*           m_pcb;
@@ -62,6 +69,15 @@ private:
     std::vector<std::shared_ptr<DRC_ITEM>> m_unconnected;      // list of unconnected pads
     std::vector<std::shared_ptr<DRC_ITEM>> m_footprints;       // list of footprint warnings
 
+    // Incremental DRC state.  Valid only after a complete run with the same options and rules
+    // and no change to the net settings since.
+    bool                                   m_incrementalValid;
+    size_t                                 m_lastRulesFingerprint;
+    bool                                   m_lastTestTracksAgainstZones;
+    bool                                   m_lastReportAllTrackErrors;
+    std::set<BOARD_ITEM*>                  m_dirtyItems;       // added or changed since last run
+    std::set<KIID>                         m_staleIds;         // ids of removed items
+
 private:
     ///> Sets up handlers for various events.
     void setTransitions() override;
@@ -73,6 +89,11 @@ private:
 
     EDA_UNITS userUnits() const { return m_editFrame->GetUserUnits(); }
 
+    /**
+     * Forget the items touched since the last run, and optionally the last run itself.
+     */
+    void resetIncrementalState( bool aInvalidate );
+
 public:
     /**
      * Open a dialog and prompts the user, then if a test run button is
@@ -112,6 +133,21 @@ public:
 
     std::shared_ptr<DRC_ENGINE> GetDRCEngine() { return m_drcEngine; }
 
+    /**
+     * Check whether the next call to RunTests() with the given options will only re-test
+     * the items changed since the last run (see ADVANCED_CFG::m_IncrementalDRC).  Footprint
+     * (schematic parity) tests always require a complete run.
+     *
+     * If an incremental run is possible the caller must keep the existing markers; those
+     * referring to changed items, or reported by tests which always cover the whole board, are
+     * replaced by RunTests() itself.  The unconnected items and footprint warnings are always
+     * reported again.
+     *
+     * Must be called after the engine has been (re)initialized.
+     */
+    bool CanRunIncrementally( bool aTestTracksAgainstZones, bool aReportAllTrackErrors,
+                              bool aTestFootprints ) const;
+
     /**
      * Run the DRC tests.
      */
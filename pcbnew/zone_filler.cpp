@@ -25,7 +25,10 @@
 
 #include <thread>
 #include <algorithm>
+#include <climits>
+#include <functional>
 #include <future>
+#include <set>
 
 #include <advanced_config.h>
 #include <class_board.h>
@@ -43,6 +46,8 @@
 #include <geometry/shape_poly_set.h>
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
+#include <drc/drc_engine.h>
+#include <hash_eda.h>
 #include <confirm.h>
 #include <convert_to_biu.h>
 #include <math/util.h>      // for KiROUND
@@ -51,12 +56,124 @@
 static const double s_RoundPadThermalSpokeAngle = 450;      // in deci-degrees
 
 
+static void hashPolySet( size_t& aSeed, const SHAPE_POLY_SET& aPoly )
+{
+    hash_combine( aSeed, aPoly.OutlineCount() );
+
+    for( int ii = 0; ii < aPoly.OutlineCount(); ++ii )
+    {
+        for( const SHAPE_LINE_CHAIN& chain : aPoly.CPolygon( ii ) )
+        {
+            hash_combine( aSeed, chain.PointCount() );
+
+            for( int jj = 0; jj < chain.PointCount(); ++jj )
+                hash_combine( aSeed, chain.CPoint( jj ).x, chain.CPoint( jj ).y );
+        }
+    }
+}
+
+
+/**
+ * Returns the index of cell ( aX, aY ) along a Z-order curve, which keeps the cells of each
+ * 2x2, 4x4, ... block together.
+ */
+static int zOrderIndex( int aX, int aY )
+{
+    int index = 0;
+
+    for( int bit = 0; bit < 8; ++bit )
+    {
+        index |= ( ( aX >> bit ) & 1 ) << ( 2 * bit );
+        index |= ( ( aY >> bit ) & 1 ) << ( 2 * bit + 1 );
+    }
+
+    return index;
+}
+
+
+void ZONE_FILLER::unionKnockouts( SHAPE_POLY_SET& aHoles, const BOX2I& aArea )
+{
+    // Below this a single union is faster than binning
+    const int minOutlinesToBin = 1000;
+    const int outlinesPerBin = 250;
+    const int maxSide = 64;
+
+    int count = aHoles.OutlineCount();
+
+    if( count < minOutlinesToBin )
+    {
+        aHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+        return;
+    }
+
+    // A power of two so that the merge tree pairs up neighbouring cells
+    int side = 1;
+
+    while( side * side * outlinesPerBin < count && side < maxSide )
+        side *= 2;
+
+    BOX2I area = aArea;
+    area.Normalize();
+
+    double cellWidth = std::max( 1.0, (double) area.GetWidth() / side );
+    double cellHeight = std::max( 1.0, (double) area.GetHeight() / side );
+
+    std::vector<SHAPE_POLY_SET> bins( side * side );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        BOX2I bbox = aHoles.COutline( ii ).BBox();
+
+        if( !bbox.Intersects( area ) )
+            continue;
+
+        VECTOR2I        centre = bbox.Centre();
+        int             col = Clamp( 0, int( ( centre.x - area.GetX() ) / cellWidth ), side - 1 );
+        int             row = Clamp( 0, int( ( centre.y - area.GetY() ) / cellHeight ), side - 1 );
+        SHAPE_POLY_SET& bin = bins[ zOrderIndex( col, row ) ];
+        int             outline = bin.AddOutline( aHoles.COutline( ii ) );
+
+        for( int jj = 0; jj < aHoles.HoleCount( ii ); ++jj )
+            bin.AddHole( aHoles.CHole( ii, jj ), outline );
+    }
+
+    runParallel( bins.size(),
+            [&]( size_t aBin )
+            {
+                bins[aBin].Simplify( SHAPE_POLY_SET::PM_FAST );
+            } );
+
+    for( size_t stride = 1; stride < bins.size(); stride *= 2 )
+    {
+        runParallel( bins.size() / ( 2 * stride ),
+                [&]( size_t aPair )
+                {
+                    SHAPE_POLY_SET& a = bins[ 2 * stride * aPair ];
+                    SHAPE_POLY_SET& b = bins[ 2 * stride * aPair + stride ];
+
+                    if( b.OutlineCount() == 0 )
+                        return;
+
+                    if( a.OutlineCount() == 0 )
+                        a = b;
+                    else
+                        a.BooleanAdd( b, SHAPE_POLY_SET::PM_FAST );
+
+                    b.RemoveAllContours();
+                } );
+    }
+
+    aHoles = bins[0];
+}
+
+
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
         m_board( aBoard ),
         m_brdOutlinesValid( false ),
         m_commit( aCommit ),
         m_progressReporter( nullptr ),
-        m_maxError( ARC_HIGH_DEF )
+        m_maxError( ARC_HIGH_DEF ),
+        m_spareThreads( 0 )
 {
     // To enable add "DebugZoneFiller=1" to kicad_advanced settings file.
     m_debugZoneFiller = ADVANCED_CFG::GetCfg().m_DebugZoneFiller;
@@ -68,6 +185,55 @@ ZONE_FILLER::~ZONE_FILLER()
 }
 
 
+void ZONE_FILLER::runParallel( size_t aCount, const std::function<void( size_t )>& aFunc )
+{
+    std::atomic<size_t> nextItem( 0 );
+
+    auto run_lambda =
+            [&]() -> size_t
+            {
+                size_t num = 0;
+
+                for( size_t i = nextItem++; i < aCount; i = nextItem++ )
+                {
+                    aFunc( i );
+                    num++;
+                }
+
+                return num;
+            };
+
+    // This thread does its share, and is helped by as many of the spare threads as it can
+    // use.  Nothing is left when the zones themselves are filled on every core.
+    int helpers = 0;
+    int spare = m_spareThreads;
+    int wanted = (int) std::min<size_t>( aCount, INT_MAX ) - 1;
+
+    while( spare > 0 && wanted > 0 )
+    {
+        int claimed = std::min( spare, wanted );
+
+        if( m_spareThreads.compare_exchange_weak( spare, spare - claimed ) )
+        {
+            helpers = claimed;
+            break;
+        }
+    }
+
+    std::vector<std::future<size_t>> returns( helpers );
+
+    for( int ii = 0; ii < helpers; ++ii )
+        returns[ii] = std::async( std::launch::async, run_lambda );
+
+    run_lambda();
+
+    for( int ii = 0; ii < helpers; ++ii )
+        returns[ii].wait();
+
+    m_spareThreads += helpers;
+}
+
+
 void ZONE_FILLER::InstallNewProgressReporter( wxWindow* aParent, const wxString& aTitle,
                                               int aNumPhases )
 {
@@ -119,7 +285,8 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
         }
     }
 
-    // Sort by priority to reduce deferrals waiting on higher priority zones.
+    // Sort by priority to reduce deferrals waiting on higher priority zones.  This also
+    // ensures higher priority zones are fingerprinted before the zones they knock out.
     std::sort( aZones.begin(), aZones.end(),
                []( const ZONE_CONTAINER* lhs, const ZONE_CONTAINER* rhs )
                {
@@ -127,9 +294,30 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
                } );
 
     for( ZONE_CONTAINER* zone : aZones )
-    {
         zone->CacheBoundingBox();
 
+    // A zone layer whose fill inputs have the same fingerprint as when it was last filled
+    // gets its previous raw fill back instead of being recomputed.  Clearance rules which look
+    // at more than the nets and netclasses of items (insideArea(), footprint references, etc.)
+    // could change the fill without changing any fingerprint, so they disable the cache.
+    std::set<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>> unchanged;
+    bool   useFingerprints = !m_debugZoneFiller && bds.m_DRCEngine
+                                && bds.m_DRCEngine->RulesValid()
+                                && !bds.m_DRCEngine->HasItemDependentClearanceRules();
+    size_t seed = hash_val( m_brdOutlinesValid, bds.m_MaxError, bds.m_ZoneFillVersion,
+                            bds.m_ZoneKeepExternalFillets, bds.GetHolePlatingThickness(),
+                            worstClearance, ADVANCED_CFG::GetCfg().m_ExtraClearance );
+
+    if( useFingerprints )
+    {
+        hash_combine( seed, bds.m_DRCEngine->GetRulesFingerprint() );
+        hashPolySet( seed, m_boardOutline );
+    }
+
+    m_fillFingerprints.clear();
+
+    for( ZONE_CONTAINER* zone : aZones )
+    {
         // Rule areas are not filled
         if( zone->GetIsRuleArea() )
             continue;
@@ -143,6 +331,16 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
         {
             zone->BuildHashValue( layer );
 
+            if( useFingerprints )
+            {
+                size_t fingerprint = computeFillFingerprint( zone, layer, seed );
+
+                m_fillFingerprints[ { zone, layer } ] = fingerprint;
+
+                if( zone->IsFilled() && zone->GetFillFingerprint( layer ) == fingerprint )
+                    unchanged.insert( { zone, layer } );
+            }
+
             // Add the zone to the list of zones to test or refill
             toFill.emplace_back( std::make_pair( zone, layer ) );
         }
@@ -156,7 +354,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
         zone->SetFillVersion( bds.m_ZoneFillVersion );
     }
 
-    size_t cores = std::thread::hardware_concurrency();
+    size_t cores = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
     std::atomic<size_t> nextItem;
 
     auto check_fill_dependency =
@@ -238,7 +436,23 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
 
                     // Now we're ready to fill.
                     SHAPE_POLY_SET rawPolys, finalPolys;
-                    fillSingleZone( zone, layer, rawPolys, finalPolys );
+
+                    if( unchanged.count( toFill[i] ) )
+                    {
+                        // UnFill() leaves the raw polygons alone; the final ones are derived
+                        // from them exactly as fillSingleZone() does.
+                        rawPolys = zone->RawPolysList( layer );
+                        finalPolys = rawPolys;
+
+                        if( !zone->IsOnCopperLayer() )
+                            finalPolys.Fracture( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+                        zone->SetNeedRefill( false );
+                    }
+                    else
+                    {
+                        fillSingleZone( zone, layer, rawPolys, finalPolys );
+                    }
 
                     std::unique_lock<std::mutex> zoneLock( zone->GetLock() );
 
@@ -246,12 +460,20 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
                     zone->SetFilledPolysList( layer, finalPolys );
                     zone->SetFillFlag( layer, true );
 
+                    auto fingerprint = m_fillFingerprints.find( toFill[i] );
+
+                    zone->SetFillFingerprint( layer, fingerprint != m_fillFingerprints.end()
+                                                            ? fingerprint->second : 0 );
+
                     if( m_progressReporter )
                         m_progressReporter->AdvanceProgress();
 
                     num++;
                 }
 
+                // Out of zones, so this thread can help with the knockouts of those still filling
+                m_spareThreads++;
+
                 return num;
             };
 
@@ -262,6 +484,9 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
 
         nextItem = 0;
 
+        // Each zone filling thread takes a core; runParallel() shares out the others
+        m_spareThreads = (int) ( cores - std::max<size_t>( parallelThreadCount, 1 ) );
+
         if( parallelThreadCount <= 1 )
             fill_lambda( m_progressReporter );
         else
@@ -344,7 +569,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
 
             for( int idx : islands )
             {
-                SHAPE_LINE_CHAIN& outline = poly.Outline( idx );
+                const SHAPE_LINE_CHAIN& outline = poly.COutline( idx );
 
                 if( mode == ISLAND_REMOVAL_MODE::ALWAYS )
                     poly.DeletePolygon( idx );
@@ -376,7 +601,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
 
             for( int ii = poly.OutlineCount() - 1; ii >= 0; ii-- )
             {
-                std::vector<SHAPE_LINE_CHAIN>& island = poly.Polygon( ii );
+                const std::vector<SHAPE_LINE_CHAIN>& island = poly.CPolygon( ii );
 
                 if( island.empty() || !m_boardOutline.Contains( island.front().CPoint( 0 ) ) )
                     poly.DeletePolygon( ii );
@@ -735,6 +960,10 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
     {
         for( D_PAD* pad : module->Pads() )
         {
+            // A pad or footprint clearance override can be larger than any netclass or rule
+            // clearance, so it widens the area the pad can knock out
+            int padClearance = pad->GetLocalClearanceOverrides( nullptr );
+
             if( !pad->FlashLayer( aLayer ) )
             {
                 if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
@@ -747,7 +976,10 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
             if( pad->GetNetCode() != aZone->GetNetCode() || pad->GetNetCode() <= 0
                     || aZone->GetPadConnection( pad ) == ZONE_CONNECTION::NONE )
             {
-                if( pad->GetBoundingBox().Intersects( zone_boundingbox ) )
+                EDA_RECT padBBox = pad->GetBoundingBox();
+                padBBox.Inflate( padClearance );
+
+                if( padBBox.Intersects( zone_boundingbox ) )
                 {
                     int gap;
 
@@ -920,7 +1152,8 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
         }
     }
 
-    aHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+    // Only the part of the holes inside the zone matters
+    unionKnockouts( aHoles, aZone->GetCachedBoundingBox() );
 }
 
 
@@ -1374,14 +1607,14 @@ void ZONE_FILLER::addHatchFillTypeOnZone( const ZONE_CONTAINER* aZone, PCB_LAYER
             case 1:
                 // Chamfer() uses the distance from a corner to create a end point
                 // for the chamfer.
-                hole_base = smooth_hole.Chamfer( smooth_value ).Outline( 0 );
+                hole_base = smooth_hole.Chamfer( smooth_value ).COutline( 0 );
                 break;
 
             default:
                 if( aZone->GetHatchSmoothingLevel() > 2 )
                     error_max /= 2;    // Force better smoothing
 
-                hole_base = smooth_hole.Fillet( smooth_value, error_max ).Outline( 0 );
+                hole_base = smooth_hole.Fillet( smooth_value, error_max ).COutline( 0 );
                 break;
 
             case 0:
@@ -1494,7 +1727,7 @@ void ZONE_FILLER::addHatchFillTypeOnZone( const ZONE_CONTAINER* aZone, PCB_LAYER
     // It happens for holes near the zone outline
     for( int ii = 0; ii < holes.OutlineCount(); )
     {
-        double area = holes.Outline( ii ).Area();
+        double area = holes.COutline( ii ).Area();
 
         if( area < minimal_hole_area ) // The current hole is too small: remove it
             holes.DeletePolygon( ii );
@@ -1506,3 +1739,207 @@ void ZONE_FILLER::addHatchFillTypeOnZone( const ZONE_CONTAINER* aZone, PCB_LAYER
     // generate strictly simple polygons needed by Gerber files and Fracture()
     aRawPolys.BooleanSubtract( aRawPolys, holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
 }
+
+
+size_t ZONE_FILLER::computeFillFingerprint( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                            size_t aSeed )
+{
+    size_t fingerprint = aSeed;
+
+    // The zone itself
+    hashPolySet( fingerprint, *aZone->Outline() );
+    hash_combine( fingerprint, (int) aLayer, aZone->IsOnCopperLayer(), aZone->GetPriority(),
+                  aZone->GetNetCode(), aZone->GetNetClassName().ToStdWstring(),
+                  aZone->GetLocalClearance(), aZone->GetMinThickness(),
+                  (int) aZone->GetPadConnection(), aZone->GetThermalReliefGap(),
+                  aZone->GetThermalReliefSpokeWidth(), aZone->GetCornerSmoothingType(),
+                  aZone->GetCornerRadius() );
+    hash_combine( fingerprint, (int) aZone->GetFillMode(), aZone->GetHatchThickness(),
+                  aZone->GetHatchGap(), aZone->GetHatchOrientation(),
+                  aZone->GetHatchSmoothingLevel(), aZone->GetHatchSmoothingValue(),
+                  aZone->GetHatchHoleMinArea(), aZone->GetHatchBorderAlgorithm() );
+
+    // Anything which can knock out, connect to or merge with the zone.  This is a superset
+    // of the items looked at by the filler.
+    EDA_RECT zone_boundingbox = aZone->GetCachedBoundingBox();
+    int      extra_margin = Millimeter2iu( ADVANCED_CFG::GetCfg().m_ExtraClearance );
+    int      biggest_clearance = std::max( { aZone->GetLocalClearance(),
+                                             aZone->GetThermalReliefGap(),
+                                             m_board->GetDesignSettings().GetBiggestClearanceValue() } );
+
+    zone_boundingbox.Inflate( biggest_clearance + extra_margin );
+
+    auto hashItem =
+            [&]( BOARD_ITEM* aItem )
+            {
+                hash_combine( fingerprint, (int) aItem->Type(),
+                              aItem->GetLayerSet().to_ullong() );
+
+                if( aItem->IsConnected() )
+                {
+                    BOARD_CONNECTED_ITEM* item = static_cast<BOARD_CONNECTED_ITEM*>( aItem );
+
+                    hash_combine( fingerprint, item->GetNetCode(),
+                                  item->GetNetClassName().ToStdWstring() );
+                }
+            };
+
+    auto hashText =
+            [&]( const EDA_TEXT* aText )
+            {
+                EDA_RECT textBox = aText->GetTextBox();
+
+                hash_combine( fingerprint, textBox.GetX(), textBox.GetY(), textBox.GetWidth(),
+                              textBox.GetHeight(), aText->GetTextPos().x, aText->GetTextPos().y,
+                              aText->GetDrawRotation(), aText->IsVisible() );
+            };
+
+    auto hashGraphicItem =
+            [&]( BOARD_ITEM* aItem )
+            {
+                if( !aItem->IsOnLayer( aLayer ) && !aItem->IsOnLayer( Edge_Cuts ) )
+                    return;
+
+                if( !aItem->GetBoundingBox().Intersects( zone_boundingbox ) )
+                    return;
+
+                hashItem( aItem );
+
+                switch( aItem->Type() )
+                {
+                case PCB_SHAPE_T:
+                case PCB_FP_SHAPE_T:
+                {
+                    PCB_SHAPE* shape = static_cast<PCB_SHAPE*>( aItem );
+
+                    hash_combine( fingerprint, (int) shape->GetShape(), shape->GetWidth(),
+                                  shape->GetStart().x, shape->GetStart().y, shape->GetEnd().x,
+                                  shape->GetEnd().y, shape->GetAngle(),
+                                  shape->GetBezControl1().x, shape->GetBezControl1().y,
+                                  shape->GetBezControl2().x, shape->GetBezControl2().y );
+                    hashPolySet( fingerprint, shape->GetPolyShape() );
+                    break;
+                }
+                case PCB_TEXT_T:
+                    hashText( static_cast<PCB_TEXT*>( aItem ) );
+                    break;
+
+                case PCB_FP_TEXT_T:
+                    hashText( static_cast<FP_TEXT*>( aItem ) );
+                    break;
+
+                default:
+                    break;
+                }
+            };
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            if( !pad->IsOnLayer( aLayer )
+                    && pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+            {
+                continue;
+            }
+
+            // The clearance the filler uses comes from the pad, or failing that from its
+            // footprint, and can reach further than the zone's own clearance
+            int      padClearance = pad->GetLocalClearanceOverrides( nullptr );
+            EDA_RECT padBBox = pad->GetBoundingBox();
+            padBBox.Inflate( std::max( aZone->GetThermalReliefGap( pad ), padClearance ) );
+
+            if( !padBBox.Intersects( zone_boundingbox ) )
+                continue;
+
+            hashItem( pad );
+            hashPolySet( fingerprint, *pad->GetEffectivePolygon() );
+            hash_combine( fingerprint, pad->GetPosition().x, pad->GetPosition().y,
+                          pad->GetOrientation(), pad->GetDrillSize().x, pad->GetDrillSize().y,
+                          (int) pad->GetDrillShape(), (int) pad->GetAttribute(),
+                          (int) pad->GetProperty(), pad->FlashLayer( aLayer ),
+                          pad->GetLocalClearance(), module->GetLocalClearance(), padClearance,
+                          (int) pad->GetCustomShapeInZoneOpt() );
+            hash_combine( fingerprint, (int) aZone->GetPadConnection( pad ),
+                          aZone->GetThermalReliefGap( pad ),
+                          aZone->GetThermalReliefSpokeWidth( pad ) );
+        }
+
+        hashGraphicItem( &module->Reference() );
+        hashGraphicItem( &module->Value() );
+
+        for( BOARD_ITEM* item : module->GraphicalItems() )
+            hashGraphicItem( item );
+    }
+
+    for( TRACK* track : m_board->Tracks() )
+    {
+        if( !track->IsOnLayer( aLayer ) && track->Type() != PCB_VIA_T )
+            continue;
+
+        if( !track->GetBoundingBox().Intersects( zone_boundingbox ) )
+            continue;
+
+        hashItem( track );
+        hash_combine( fingerprint, track->GetStart().x, track->GetStart().y,
+                      track->GetEnd().x, track->GetEnd().y, track->GetWidth() );
+
+        if( track->Type() == PCB_ARC_T )
+        {
+            ARC* arc = static_cast<ARC*>( track );
+            hash_combine( fingerprint, arc->GetMid().x, arc->GetMid().y );
+        }
+        else if( track->Type() == PCB_VIA_T )
+        {
+            VIA* via = static_cast<VIA*>( track );
+            hash_combine( fingerprint, (int) via->GetViaType(), via->GetDrillValue(),
+                          via->FlashLayer( aLayer ) );
+        }
+    }
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        hashGraphicItem( item );
+
+    auto hashZone =
+            [&]( ZONE_CONTAINER* aOther )
+            {
+                if( aOther == aZone || !aOther->GetLayerSet().test( aLayer ) )
+                    return;
+
+                EDA_RECT otherBBox = aOther->GetBoundingBox();
+                otherBBox.Inflate( aOther->GetLocalClearance() );
+
+                if( !otherBBox.Intersects( zone_boundingbox ) )
+                    return;
+
+                hashItem( aOther );
+                hashPolySet( fingerprint, *aOther->Outline() );
+                hash_combine( fingerprint, aOther->GetIsRuleArea(),
+                              aOther->GetDoNotAllowCopperPour(), aOther->GetPriority(),
+                              aOther->GetLocalClearance(), aOther->GetCornerSmoothingType(),
+                              aOther->GetCornerRadius() );
+
+                // Higher priority zones knock out their filled areas (rather than their
+                // outlines), so their fills are inputs too.
+                if( aOther->GetIsRuleArea() || aOther->GetPriority() <= aZone->GetPriority() )
+                    return;
+
+                auto other = m_fillFingerprints.find( { aOther, aLayer } );
+
+                if( other != m_fillFingerprints.end() )
+                    hash_combine( fingerprint, other->second );
+                else if( aOther->HasFilledPolysForLayer( aLayer ) )
+                    hashPolySet( fingerprint, aOther->GetFilledPolysList( aLayer ) );
+            };
+
+    for( ZONE_CONTAINER* otherZone : m_board->Zones() )
+        hashZone( otherZone );
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( ZONE_CONTAINER* otherZone : module->Zones() )
+            hashZone( otherZone );
+    }
+
+    return fingerprint;
+}
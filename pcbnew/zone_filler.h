@@ -26,6 +26,9 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <vector>
 #include <class_zone.h>
 
@@ -60,6 +63,23 @@ private:
     void buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
                                     SHAPE_POLY_SET& aHoles );
 
+    /**
+     * Unions a set of overlapping knockout polygons, like aHoles.Simplify( PM_FAST ) would, but
+     * without a single Clipper call having to process the whole set at once.
+     *
+     * Polygons whose bounding box misses aArea are dropped.  The others are binned into a grid
+     * of cells by the centre of their bounding box, the cells are unioned in parallel and the
+     * results are merged pairwise in a balanced tree, neighbouring cells first.
+     */
+    void unionKnockouts( SHAPE_POLY_SET& aHoles, const BOX2I& aArea );
+
+    /**
+     * Runs aFunc( 0 ) ... aFunc( aCount - 1 ) on the calling thread and the spare threads.
+     * Called from within the zone filling threads, so the threads are shared out through
+     * m_spareThreads to keep the total at one per core.
+     */
+    void runParallel( size_t aCount, const std::function<void( size_t )>& aFunc );
+
     /**
      * Function computeRawFilledArea
      * Add non copper areas polygons (pads and tracks with clearance)
@@ -109,6 +129,14 @@ private:
     void addHatchFillTypeOnZone( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
                                  SHAPE_POLY_SET& aRawPolys );
 
+    /**
+     * Compute a fingerprint of everything the fill of aZone on aLayer depends on: the zone's
+     * own outline and settings, the pads, tracks, graphic items and zones near enough to
+     * knock it out, and (through aSeed) the board outline and design rules.
+     * Higher-priority zones must have been fingerprinted first.
+     */
+    size_t computeFillFingerprint( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer, size_t aSeed );
+
     BOARD*                m_board;
     SHAPE_POLY_SET        m_boardOutline;       // the board outlines, if exists
     bool                  m_brdOutlinesValid;   // true if m_boardOutline is well-formed
@@ -119,7 +147,13 @@ private:
 
     int                   m_maxError;
 
+    /// Fill fingerprints of the zones being filled, in priority order
+    std::map<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>, size_t> m_fillFingerprints;
+
     bool                  m_debugZoneFiller;
+
+    /// Cores not running a zone filling thread (or a runParallel() helper) at the moment
+    std::atomic<int>      m_spareThreads;
 };
 
 #endif
@@ -0,0 +1,255 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the keyword lookup of DSNLEXER, and for lexing in place from a
+ * MAPPED_FILE_LINE_READER
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <dsnlexer.h>
+#include <richio.h>
+
+
+/**
+ * What a lexer reports about one of its tokens
+ */
+struct LEXED_TOKEN
+{
+    int         m_tok;
+    std::string m_text;
+    int         m_lineNumber;
+    std::string m_line;
+    int         m_offset;
+
+    bool operator==( const LEXED_TOKEN& aOther ) const
+    {
+        return m_tok == aOther.m_tok && m_text == aOther.m_text
+               && m_lineNumber == aOther.m_lineNumber && m_line == aOther.m_line
+               && m_offset == aOther.m_offset;
+    }
+};
+
+
+std::ostream& operator<<( std::ostream& aStream, const LEXED_TOKEN& aToken )
+{
+    return aStream << aToken.m_tok << " \"" << aToken.m_text << "\" at line "
+                   << aToken.m_lineNumber << ":" << aToken.m_offset;
+}
+
+
+/**
+ * Writes a text to a temporary file, and lexes it through a FILE_LINE_READER and through a
+ * MAPPED_FILE_LINE_READER.
+ */
+struct DSNLEXER_FILE_FIXTURE
+{
+    DSNLEXER_FILE_FIXTURE() :
+            m_fileName( wxFileName::CreateTempFileName( "dsnlexer" ) )
+    {
+    }
+
+    ~DSNLEXER_FILE_FIXTURE()
+    {
+        wxRemoveFile( m_fileName );
+    }
+
+    void write( const std::string& aText )
+    {
+        wxFFile file( m_fileName, "wb" );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+    }
+
+    ///> Returns the tokens of the file up to DSN_EOF or a parse error, and the error if any
+    static std::vector<LEXED_TOKEN> lex( LINE_READER& aReader, std::string& aError )
+    {
+        static const KEYWORD keywords[] = { { "abc", 0 } };
+
+        DSNLEXER                 lexer( keywords, 1, &aReader );
+        std::vector<LEXED_TOKEN> tokens;
+
+        aError.clear();
+
+        try
+        {
+            int tok;
+
+            while( ( tok = lexer.NextTok() ) != DSN_EOF )
+            {
+                tokens.push_back( { tok, lexer.CurText(), lexer.CurLineNumber(),
+                                    lexer.CurLine(), lexer.CurOffset() } );
+            }
+        }
+        catch( const PARSE_ERROR& error )
+        {
+            aError = error.inputLine + ":" + std::to_string( error.lineNumber ) + ":"
+                     + std::to_string( error.byteIndex );
+        }
+
+        return tokens;
+    }
+
+    ///> Checks that both readers lex aText alike, and returns the tokens
+    std::vector<LEXED_TOKEN> checkSameTokens( const std::string& aText )
+    {
+        write( aText );
+
+        std::string streamError;
+        std::string mappedError;
+
+        FILE_LINE_READER         streamReader( m_fileName );
+        std::vector<LEXED_TOKEN> expected = lex( streamReader, streamError );
+
+        MAPPED_FILE_LINE_READER  mappedReader( m_fileName );
+        std::vector<LEXED_TOKEN> actual = lex( mappedReader, mappedError );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                       expected.end() );
+        BOOST_CHECK_EQUAL( mappedError, streamError );
+
+        return actual;
+    }
+
+    wxString m_fileName;
+};
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexer )
+
+
+/**
+ * Check that every keyword of a large table is found, and that other symbols are not.
+ */
+BOOST_AUTO_TEST_CASE( KeywordLookup )
+{
+    const int count = 2000;
+
+    // The index of a keyword table is kept for the lexers to come, so the table stays
+    static std::vector<std::string> names;
+    static std::vector<KEYWORD>     keywords;
+    std::string                     text;
+
+    if( names.empty() )
+    {
+        for( int ii = 0; ii < count; ++ii )
+            names.push_back( "kw_" + std::to_string( ii ) );
+
+        for( int ii = 0; ii < count; ++ii )
+            keywords.push_back( { names[ii].c_str(), ii } );
+    }
+
+    for( int ii = 0; ii < count; ++ii )
+        text += names[ii] + " ";
+
+    // Symbols close to the keywords, which must not be taken for them
+    text += "kw_ kw_2000 kw_19999 KW_1 kw_1x";
+
+    DSNLEXER lexer( keywords.data(), keywords.size(), text, "keywords" );
+
+    for( int ii = 0; ii < count; ++ii )
+        BOOST_CHECK_EQUAL( lexer.NextTok(), ii );
+
+    for( int ii = 0; ii < 5; ++ii )
+        BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+}
+
+
+/**
+ * Check that a last line without a newline is lexed in place up to its end, and no further.
+ */
+BOOST_FIXTURE_TEST_CASE( MappedNoTrailingNewline, DSNLEXER_FILE_FIXTURE )
+{
+    std::vector<LEXED_TOKEN> tokens = checkSameTokens( "(abc 12\n  (d \"e f\"))" );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), 8u );
+    BOOST_CHECK_EQUAL( tokens[1].m_tok, 0 );
+    BOOST_CHECK_EQUAL( tokens[5].m_text, "e f" );
+    BOOST_CHECK_EQUAL( tokens[7].m_line, "  (d \"e f\"))" );
+
+    // A symbol or a number right at the end of the file
+    tokens = checkSameTokens( "(abc)\nlast" );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), 4u );
+    BOOST_CHECK_EQUAL( tokens[3].m_text, "last" );
+
+    tokens = checkSameTokens( "(abc)\r\n-1.5e3" );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), 4u );
+    BOOST_CHECK_EQUAL( tokens[3].m_tok, DSN_NUMBER );
+}
+
+
+/**
+ * Check quoted strings and escapes which end right at the end of a line or of the file.
+ */
+BOOST_FIXTURE_TEST_CASE( MappedStringsAtLineEnd, DSNLEXER_FILE_FIXTURE )
+{
+    std::vector<LEXED_TOKEN> tokens =
+            checkSameTokens( "(s \"a\\\\\"\n\"q\\\"\"\n\"\\x4\"\n\"\\101\")" );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), 7u );
+    BOOST_CHECK_EQUAL( tokens[2].m_text, "a\\" );
+    BOOST_CHECK_EQUAL( tokens[3].m_text, "q\"" );
+    BOOST_CHECK_EQUAL( tokens[4].m_text, "\x04" );
+    BOOST_CHECK_EQUAL( tokens[5].m_text, "A" );
+
+    // Unterminated at the end of a line, and at the end of the file after an escape
+    checkSameTokens( "(s \"abc\n\"def\")\n" );
+    checkSameTokens( "(s \"abc\\" );
+    checkSameTokens( "(s \"abc\\x" );
+    checkSameTokens( "(s \"abc" );
+}
+
+
+/**
+ * Check that CurLine() and CurOffset() are the same for lines read in place, including
+ * comments, blank lines and CR LF line ends.
+ */
+BOOST_FIXTURE_TEST_CASE( MappedSameAsStream, DSNLEXER_FILE_FIXTURE )
+{
+    std::vector<LEXED_TOKEN> tokens = checkSameTokens(
+            "# comment\n(abc (x 1) \"two\"\t3)\n\n   \r\n\t(y\r\n  ab)  \n" );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), 13u );
+    BOOST_CHECK_EQUAL( tokens[0].m_lineNumber, 2 );
+    BOOST_CHECK_EQUAL( tokens[5].m_offset, 10 );
+    BOOST_CHECK_EQUAL( tokens[9].m_lineNumber, 5 );
+    BOOST_CHECK_EQUAL( tokens[12].m_line, "  ab)  \n" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
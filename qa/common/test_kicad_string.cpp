@@ -28,6 +28,8 @@
 
 #include <unit_test_utils/unit_test_utils.h>
 
+#include <climits>
+
 // Code under test
 #include <kicad_string.h>
 
@@ -107,4 +109,77 @@ BOOST_AUTO_TEST_CASE( NaturalNumberCompare )
     }
 }
 
+/**
+ * Test the #DecimalToDouble method against strtod() in the C locale.
+ */
+BOOST_AUTO_TEST_CASE( DecimalDoubleMatchesStrtod )
+{
+    const std::vector<std::string> cases = {
+        "0", "-0", "1", "-1", "1.5", "-2.25", ".5", "5.", "+3", "  42", "1e3", "1.5E-3",
+        "123456.789012", "0.000001", "12345678901234567890123", "1e22", "1e23", "-7e-22",
+        "3.14159265358979323846264338327950288", "9007199254740993", "1.7976931348623157e308",
+        "4.9e-324", "1.5e", "1.5e+", "2mm"
+    };
+
+    for( const std::string& c : cases )
+    {
+        double      value;
+        char*       expectedEnd;
+        const char* end = DecimalToDouble( c.c_str(), value );
+        double      expected = strtod( c.c_str(), &expectedEnd );
+
+        BOOST_TEST_CONTEXT( c )
+        {
+            BOOST_CHECK_EQUAL( value, expected );
+            BOOST_CHECK_EQUAL( end - c.c_str(), expectedEnd - c.c_str() );
+        }
+    }
+
+    double value;
+
+    BOOST_CHECK( DecimalToDouble( "1e400", value ) == nullptr );
+
+    const char* text = "mm";
+    BOOST_CHECK( DecimalToDouble( text, value ) == text );
+}
+
+/**
+ * Test the #DecimalToScaledInt method.
+ */
+BOOST_AUTO_TEST_CASE( DecimalScaledInt )
+{
+    using CASE = std::pair<std::pair<std::string, int>, long long>;
+
+    const std::vector<CASE> cases = {
+        { { "0", 6 }, 0 },
+        { { "1", 6 }, 1000000 },
+        { { "-2.54", 6 }, -2540000 },
+        { { "0.1", 6 }, 100000 },                        // not exact in floating point
+        { { "1.0000005", 6 }, 1000001 },                 // halves round away from zero
+        { { "-1.0000005", 6 }, -1000001 },
+        { { "1.00000049999999999999999", 6 }, 1000000 }, // digits beyond the mantissa
+        { { "1.5e-3", 6 }, 1500 },
+        { { "12.7", 4 }, 127000 },
+        { { "1e30", 6 }, LLONG_MAX },                    // saturates
+        { { "-1e30", 6 }, LLONG_MIN },
+        { { "1e-30", 6 }, 0 },
+    };
+
+    for( const auto& c : cases )
+    {
+        long long value;
+
+        BOOST_TEST_CONTEXT( c.first.first )
+        {
+            DecimalToScaledInt( c.first.first.c_str(), c.first.second, value );
+            BOOST_CHECK_EQUAL( value, c.second );
+        }
+    }
+
+    long long   value;
+    const char* text = "-";
+
+    BOOST_CHECK( DecimalToScaledInt( text, 6, value ) == text );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,209 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the search of LIB_TREE_NODE_ROOT, which must score the items as matching
+ * each term against all of them does.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <map>
+
+#include <wx/tokenzr.h>
+
+// Code under test
+#include <eda_pattern_match.h>
+#include <lib_tree_model.h>
+
+
+class TEST_LIB_TREE_ITEM : public LIB_TREE_ITEM
+{
+public:
+    TEST_LIB_TREE_ITEM( const wxString& aLib, const wxString& aName, const wxString& aDesc ) :
+            m_libId( aLib, aName ),
+            m_desc( aDesc )
+    {
+    }
+
+    LIB_ID   GetLibId() const override { return m_libId; }
+    wxString GetName() const override { return m_libId.GetLibItemName(); }
+    wxString GetLibNickname() const override { return m_libId.GetLibNickname(); }
+    wxString GetDescription() override { return m_desc; }
+    wxString GetSearchText() override { return m_desc; }
+
+private:
+    LIB_ID   m_libId;
+    wxString m_desc;
+};
+
+
+struct LIB_TREE_SEARCH_FIXTURE
+{
+    LIB_TREE_SEARCH_FIXTURE()
+    {
+        populate( m_tree );
+        populate( m_reference );
+    }
+
+    static void populate( LIB_TREE_NODE_ROOT& aTree )
+    {
+        const std::vector<std::vector<wxString>> libs = {
+            { "Device", "R", "Resistor r=10k", "C", "Unpolarized capacitor c=100n",
+              "L", "Inductor", "R_Pack04", "4 resistor network" },
+            { "Resistor_SMD", "R_0402", "Resistor SMD 0402", "R_0603", "Resistor SMD 0603" },
+            { "Connector", "Conn_01x02", "Generic connector", "USB_C", "USB Type-C receptacle" }
+        };
+
+        for( const std::vector<wxString>& lib : libs )
+        {
+            LIB_TREE_NODE_LIB& libNode = aTree.AddLib( lib[0], wxEmptyString );
+
+            for( size_t ii = 1; ii + 1 < lib.size(); ii += 2 )
+            {
+                TEST_LIB_TREE_ITEM item( lib[0], lib[ii], lib[ii + 1] );
+                libNode.AddItem( &item );
+            }
+        }
+    }
+
+    ///> Returns the scores of the items of a tree, by library and item name
+    static std::map<wxString, int> getScores( const LIB_TREE_NODE_ROOT& aTree )
+    {
+        std::map<wxString, int> scores;
+
+        for( const std::unique_ptr<LIB_TREE_NODE>& lib : aTree.m_Children )
+        {
+            for( const std::unique_ptr<LIB_TREE_NODE>& item : lib->m_Children )
+                scores[lib->m_Name + "/" + item->m_Name] = item->m_Score;
+        }
+
+        return scores;
+    }
+
+    ///> Checks that the indexed search scores the items as the matchers alone do
+    void checkSearch( const wxString& aSearch )
+    {
+        BOOST_TEST_CONTEXT( "Search: " << aSearch )
+        {
+            m_tree.ResetScore();
+            m_tree.UpdateSearchScore( aSearch );
+
+            m_reference.ResetScore();
+            wxStringTokenizer tokenizer( aSearch );
+
+            while( tokenizer.HasMoreTokens() )
+            {
+                EDA_COMBINED_MATCHER matcher( tokenizer.GetNextToken().Lower() );
+                m_reference.UpdateScore( matcher );
+            }
+
+            std::map<wxString, int> scores = getScores( m_tree );
+            std::map<wxString, int> expected = getScores( m_reference );
+
+            BOOST_CHECK_EQUAL( scores.size(), expected.size() );
+
+            for( const std::pair<const wxString, int>& item : expected )
+            {
+                BOOST_TEST_CONTEXT( "Item: " << item.first )
+                {
+                    BOOST_REQUIRE( scores.count( item.first ) );
+                    BOOST_CHECK_EQUAL( scores.at( item.first ), item.second );
+                }
+            }
+
+            // As the chooser does after each search, so the next one sees another tree order
+            m_tree.SortNodes();
+        }
+    }
+
+    ///> Returns the library node named aName of a tree
+    static LIB_TREE_NODE_LIB* findLib( LIB_TREE_NODE_ROOT& aTree, const wxString& aName )
+    {
+        for( std::unique_ptr<LIB_TREE_NODE>& lib : aTree.m_Children )
+        {
+            if( lib->m_Name == aName )
+                return static_cast<LIB_TREE_NODE_LIB*>( lib.get() );
+        }
+
+        return nullptr;
+    }
+
+    LIB_TREE_NODE_ROOT m_tree;
+    LIB_TREE_NODE_ROOT m_reference;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( LibTreeSearch, LIB_TREE_SEARCH_FIXTURE )
+
+
+/**
+ * Typing a search string one character at a time narrows down the last matches.
+ */
+BOOST_AUTO_TEST_CASE( Typing )
+{
+    for( const wxString& search : { "r", "re", "res", "resi", "resistor", "resistor ",
+                                    "resistor 0", "resistor 060", "resistor 0603" } )
+    {
+        checkSearch( search );
+    }
+
+    // Going back is not narrowing
+    for( const wxString& search : { "resistor 06", "cap", "Conn", "conn 01x", "" } )
+        checkSearch( search );
+}
+
+
+/**
+ * Library names, which are not indexed, and operators, which cannot be looked up.
+ */
+BOOST_AUTO_TEST_CASE( LibrariesAndOperators )
+{
+    for( const wxString& search : { "smd", "resistor_smd", "device ind", "r_*", "r_0?0",
+                                    "usb.c", "r=", "r<20k", "c>10n", "c>10n cap", "[cl]$" } )
+    {
+        checkSearch( search );
+    }
+}
+
+
+/**
+ * Items added after a search are indexed by the next one.
+ */
+BOOST_AUTO_TEST_CASE( AddedItems )
+{
+    checkSearch( "diode" );
+
+    for( LIB_TREE_NODE_ROOT* tree : { &m_tree, &m_reference } )
+    {
+        TEST_LIB_TREE_ITEM item( "Device", "D", "Diode" );
+        findLib( *tree, "Device" )->AddItem( &item );
+    }
+
+    checkSearch( "diode" );
+    checkSearch( "diodes" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
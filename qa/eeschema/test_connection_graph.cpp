@@ -0,0 +1,415 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the conditional recalculations of CONNECTION_GRAPH, which reuse the item
+ * connectivity of the unchanged sheets and must find the nets of a full recalculation.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <sch_io_mgr.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet_path.h>
+#include <sch_text.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+// Code under test
+#include <connection_graph.h>
+
+
+class TEST_CONNECTION_GRAPH_FIXTURE
+{
+public:
+    /// The net code and the number of items of each net, by net name
+    typedef std::map<wxString, std::pair<int, size_t>> NETS;
+
+    TEST_CONNECTION_GRAPH_FIXTURE() :
+            m_schematic( nullptr )
+    {
+        m_pi = SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD );
+    }
+
+    virtual ~TEST_CONNECTION_GRAPH_FIXTURE()
+    {
+        delete m_pi;
+    }
+
+    void loadSchematic( const wxString& aBaseName );
+
+    NETS getNets()
+    {
+        NETS nets;
+
+        for( const auto& net : m_schematic.ConnectionGraph()->GetNetMap() )
+        {
+            std::pair<int, size_t>& entry = nets[ net.first.first ];
+
+            entry.first = net.first.second;
+
+            for( CONNECTION_SUBGRAPH* subgraph : net.second )
+                entry.second += subgraph->m_items.size();
+        }
+
+        return nets;
+    }
+
+    void checkNets( const NETS& aNets, const NETS& aExpected, bool aCheckCodes )
+    {
+        BOOST_CHECK_EQUAL( aNets.size(), aExpected.size() );
+
+        for( const auto& net : aExpected )
+        {
+            BOOST_TEST_CONTEXT( "Net: " << net.first )
+            {
+                BOOST_REQUIRE( aNets.count( net.first ) );
+                BOOST_CHECK_EQUAL( aNets.at( net.first ).second, net.second.second );
+
+                if( aCheckCodes )
+                    BOOST_CHECK_EQUAL( aNets.at( net.first ).first, net.second.first );
+            }
+        }
+    }
+
+    ///> Schematic to load
+    SCHEMATIC m_schematic;
+
+    SCH_PLUGIN* m_pi;
+
+    SETTINGS_MANAGER m_manager;
+};
+
+
+void TEST_CONNECTION_GRAPH_FIXTURE::loadSchematic( const wxString& aBaseName )
+{
+    wxFileName fn = KI_TEST::GetEeschemaTestDataDir();
+
+    fn.AppendDir( "netlists" );
+    fn.AppendDir( aBaseName );
+    fn.SetName( aBaseName );
+    fn.SetExt( KiCadSchematicFileExtension );
+
+    BOOST_TEST_MESSAGE( fn.GetFullPath() );
+
+    wxFileName pro( fn );
+    pro.SetExt( ProjectFileExtension );
+
+    m_manager.LoadProject( pro.GetFullPath() );
+
+    m_manager.Prj().SetElem( PROJECT::ELEM_SCH_PART_LIBS, nullptr );
+
+    m_schematic.Reset();
+    m_schematic.SetProject( &m_manager.Prj() );
+    m_schematic.SetRoot( m_pi->Load( fn.GetFullPath(), &m_schematic ) );
+
+    BOOST_REQUIRE_EQUAL( m_pi->GetError().IsEmpty(), true );
+
+    m_schematic.CurrentSheet().push_back( &m_schematic.Root() );
+
+    SCH_SCREENS screens( m_schematic.Root() );
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->UpdateLocalLibSymbolLinks();
+
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+
+    // Restore all of the loaded symbol instances from the root sheet screen.
+    sheets.UpdateSymbolInstances( m_schematic.RootScreen()->GetSymbolInstances() );
+
+    sheets.AnnotatePowerSymbols();
+
+    for( SCH_SHEET_PATH& sheet : sheets )
+        sheet.UpdateAllScreenReferences();
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectionGraph, TEST_CONNECTION_GRAPH_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( UnchangedSheetsReused )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    CONNECTION_GRAPH* graph = m_schematic.ConnectionGraph();
+    SCH_SHEET_LIST    sheets = m_schematic.GetSheets();
+
+    graph->Recalculate( sheets, true );
+
+    NETS full = getNets();
+
+    BOOST_REQUIRE( full.count( "/ampli_ht_horizontal/PIEZO_IN" ) );
+    BOOST_REQUIRE( full.count( "/ampli_ht_vertical/PIEZO_IN" ) );
+
+    // Nothing changed
+    graph->Recalculate( sheets );
+    checkNets( getNets(), full, true );
+
+    // Removing a label from the amplifier screen changes both of its sheets
+    SCH_SCREEN* screen = nullptr;
+    SCH_LABEL*  label = nullptr;
+
+    for( const SCH_SHEET_PATH& sheet : sheets )
+    {
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_LABEL_T ) )
+        {
+            if( static_cast<SCH_LABEL*>( item )->GetText() == "PIEZO_IN" )
+            {
+                screen = sheet.LastScreen();
+                label = static_cast<SCH_LABEL*>( item );
+            }
+        }
+    }
+
+    BOOST_REQUIRE( label );
+
+    screen->Remove( label );
+    graph->Recalculate( sheets );
+
+    NETS conditional = getNets();
+
+    BOOST_CHECK( !conditional.count( "/ampli_ht_horizontal/PIEZO_IN" ) );
+    BOOST_CHECK( !conditional.count( "/ampli_ht_vertical/PIEZO_IN" ) );
+
+    // The other nets keep their code
+    for( const auto& net : conditional )
+    {
+        if( full.count( net.first ) )
+            BOOST_CHECK_EQUAL( net.second.first, full.at( net.first ).first );
+    }
+
+    graph->Recalculate( sheets, true );
+    checkNets( conditional, getNets(), false );
+
+    // Putting it back gives the first nets, but for their codes after the full recalculation
+    NETS reference = getNets();
+
+    screen->Append( label );
+    graph->Recalculate( sheets );
+
+    NETS restored = getNets();
+
+    checkNets( restored, full, false );
+
+    for( const auto& net : reference )
+        BOOST_CHECK_EQUAL( restored.at( net.first ).first, net.second.first );
+}
+
+
+BOOST_AUTO_TEST_CASE( ChangedInPlace )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    CONNECTION_GRAPH*     graph = m_schematic.ConnectionGraph();
+    SCH_SHEET_LIST        sheets = m_schematic.GetSheets();
+    const SCH_SHEET_PATH& root = sheets[0];
+
+    graph->Recalculate( sheets, true );
+
+    NETS full = getNets();
+
+    // A wire of a net with a few more items, which leaves it when moved away
+    SCH_LINE* wire = nullptr;
+    wxString  netName;
+
+    for( SCH_ITEM* item : root.LastScreen()->Items().OfType( SCH_LINE_T ) )
+    {
+        SCH_LINE* line = static_cast<SCH_LINE*>( item );
+
+        if( line->IsWire() && line->Connection( &root ) )
+        {
+            netName = line->Connection( &root )->Name();
+
+            if( full.count( netName ) && full.at( netName ).second > 3 )
+            {
+                wire = line;
+                break;
+            }
+        }
+    }
+
+    BOOST_REQUIRE( wire );
+
+    // Undo swaps the data of a changed item with its copy, in place
+    SCH_LINE copy( *wire );
+
+    copy.Move( wxPoint( 0, Mils2iu( 20000 ) ) );
+    wire->SwapData( &copy );
+    graph->Recalculate( sheets );
+
+    NETS moved = getNets();
+
+    BOOST_CHECK( !moved.count( netName )
+                 || moved.at( netName ).second < full.at( netName ).second );
+
+    graph->Recalculate( sheets, true );
+    checkNets( moved, getNets(), false );
+
+    // Redo swaps it back, after a full recalculation found nothing dirty
+    wire->SwapData( &copy );
+    graph->Recalculate( sheets );
+
+    checkNets( getNets(), full, false );
+}
+
+
+BOOST_AUTO_TEST_CASE( LinkedSubgraphsRebuilt )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    CONNECTION_GRAPH*     graph = m_schematic.ConnectionGraph();
+    SCH_SHEET_LIST        sheets = m_schematic.GetSheets();
+    const SCH_SHEET_PATH& root = sheets[0];
+
+    graph->Recalculate( sheets, true );
+
+    NETS full = getNets();
+
+    BOOST_REQUIRE( full.count( "/12Vext" ) );
+
+    // On an amplifier sheet, a net named after a symbol pin and a ground net
+    SCH_ITEM* pinWire = nullptr;
+    SCH_ITEM* groundWire = nullptr;
+
+    for( SCH_ITEM* item : sheets[1].LastScreen()->Items().OfType( SCH_LINE_T ) )
+    {
+        CONNECTION_SUBGRAPH* subgraph = graph->GetSubgraphForItem( item );
+
+        if( !subgraph || !subgraph->m_driver || subgraph->m_driver->Type() != SCH_PIN_T )
+            continue;
+
+        SCH_PIN* pin = static_cast<SCH_PIN*>( subgraph->m_driver );
+
+        if( !pin->IsPowerConnection() && subgraph->m_hier_ports.empty() )
+            pinWire = item;
+        else if( pin->IsPowerConnection() && pin->GetName() == "GND" )
+            groundWire = item;
+    }
+
+    BOOST_REQUIRE( pinWire && groundWire );
+
+    long pinCode = graph->GetSubgraphForItem( pinWire )->m_code;
+    long groundCode = graph->GetSubgraphForItem( groundWire )->m_code;
+
+    SCH_ITEM* label = nullptr;
+
+    for( SCH_ITEM* item : root.LastScreen()->Items().OfType( SCH_LABEL_T ) )
+    {
+        if( static_cast<SCH_LABEL*>( item )->GetText() == "12Vext" )
+            label = item;
+    }
+
+    BOOST_REQUIRE( label );
+
+    root.LastScreen()->Remove( label );
+    graph->Recalculate( sheets );
+
+    NETS conditional = getNets();
+
+    // The ground net is also on the root sheet and is built again, the other one is kept
+    BOOST_CHECK_EQUAL( graph->GetSubgraphForItem( pinWire )->m_code, pinCode );
+    BOOST_CHECK_NE( graph->GetSubgraphForItem( groundWire )->m_code, groundCode );
+
+    BOOST_CHECK( !conditional.count( "/12Vext" ) );
+
+    // The code of a name without nets is dropped, so the restored net gets a new one
+    root.LastScreen()->Append( label );
+    graph->Recalculate( sheets );
+
+    NETS restored = getNets();
+
+    checkNets( restored, full, false );
+    BOOST_CHECK_NE( restored.at( "/12Vext" ).first, full.at( "/12Vext" ).first );
+
+    for( const auto& net : conditional )
+    {
+        if( restored.count( net.first ) )
+            BOOST_CHECK_EQUAL( restored.at( net.first ).first, net.second.first );
+    }
+
+    // Without the label, a full recalculation finds the same nets
+    root.LastScreen()->Remove( label );
+    graph->Recalculate( sheets, true );
+    checkNets( conditional, getNets(), false );
+
+    root.LastScreen()->Append( label );
+}
+
+
+BOOST_AUTO_TEST_CASE( WeakNetsRenamedAcrossSheets )
+{
+    loadSchematic( "weak_vector_bus_disambiguation" );
+
+    CONNECTION_GRAPH* graph = m_schematic.ConnectionGraph();
+    SCH_SHEET_LIST    sheets = m_schematic.GetSheets();
+
+    graph->Recalculate( sheets, true );
+
+    NETS full = getNets();
+
+    // The bus members of both subsheets are weakly driven by sheet pins of the same names
+    BOOST_REQUIRE( full.count( "/B1" ) );
+    BOOST_REQUIRE( full.count( "/B1_1" ) );
+
+    SCH_SCREEN* screen = nullptr;
+    SCH_ITEM*   label = nullptr;
+
+    for( const SCH_SHEET_PATH& sheet : sheets )
+    {
+        if( !sheet.LastScreen()->GetFileName().EndsWith( "sub2.kicad_sch" ) )
+            continue;
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_LABEL_T ) )
+        {
+            if( static_cast<SCH_LABEL*>( item )->GetText() == "B1" )
+            {
+                screen = sheet.LastScreen();
+                label = item;
+            }
+        }
+    }
+
+    BOOST_REQUIRE( label );
+
+    // Only the second subsheet changes, but the names of the first one depend on it
+    screen->Remove( label );
+    graph->Recalculate( sheets );
+
+    NETS conditional = getNets();
+
+    graph->Recalculate( sheets, true );
+    checkNets( conditional, getNets(), false );
+
+    screen->Append( label );
+    graph->Recalculate( sheets );
+
+    checkNets( getNets(), full, false );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
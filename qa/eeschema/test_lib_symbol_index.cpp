@@ -0,0 +1,192 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the symbol summaries read when an s-expression symbol library is opened,
+ * and the symbols parsed in full on demand.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <properties.h>
+#include <sch_plugins/kicad/sch_sexpr_plugin.h>
+#include <symbol_lib_table.h>
+
+
+static const char* libraryText =
+        "(kicad_symbol_lib (version 20200827) (generator kicad_symbol_editor)\n"
+        "  (symbol \"R_Pack\" (in_bom yes) (on_board yes)\n"
+        "    (property \"Reference\" \"RN\" (id 0) (at 0 0 0))\n"
+        "    (property \"Value\" \"R_Pack\" (id 1) (at 0 0 0))\n"
+        "    (property \"Footprint\" \"Resistor_SMD:R_Array\" (id 2) (at 0 0 0))\n"
+        "    (property \"ki_keywords\" \"R network\" (id 4) (at 0 0 0))\n"
+        "    (property \"ki_description\" \"Resistor pack\" (id 5) (at 0 0 0))\n"
+        "    (symbol \"R_Pack_1_1\"\n"
+        "      (pin passive line (at 0 3.81 270) (length 1.27) (name \"~\") (number \"1\"))\n"
+        "    )\n"
+        "    (symbol \"R_Pack_2_1\"\n"
+        "      (pin passive line (at 0 3.81 270) (length 1.27) (name \"~\") (number \"2\"))\n"
+        "    )\n"
+        "  )\n"
+        "  (symbol \"R_Pack_Alt\" (extends \"R_Pack\")\n"
+        "    (property \"Reference\" \"RN\" (id 0) (at 0 0 0))\n"
+        "    (property \"Value\" \"R_Pack_Alt\" (id 1) (at 0 0 0))\n"
+        "    (property \"ki_description\" \"Resistor pack (alternate)\" (id 5) (at 0 0 0))\n"
+        "  )\n"
+        "  (symbol \"GND\" (power) (pin_names (offset 0)) (in_bom yes) (on_board yes)\n"
+        "    (property \"Reference\" \"#PWR\" (id 0) (at 0 0 0))\n"
+        "    (property \"Value\" \"GND\" (id 1) (at 0 0 0))\n"
+        "    (symbol \"GND_1_1\"\n"
+        "      (pin power_in line (at 0 0 270) (length 0) hide (name \"GND\") (number \"1\"))\n"
+        "    )\n"
+        "  )\n"
+        ")\n";
+
+
+class TEST_LIB_SYMBOL_INDEX_FIXTURE
+{
+public:
+    TEST_LIB_SYMBOL_INDEX_FIXTURE()
+    {
+        m_fileName = wxFileName::CreateTempFileName( "lib_symbol_index" );
+
+        wxFFile file( m_fileName, "wb" );
+        BOOST_REQUIRE( file.IsOpened() && file.Write( wxString( libraryText ) ) );
+    }
+
+    ~TEST_LIB_SYMBOL_INDEX_FIXTURE()
+    {
+        wxRemoveFile( m_fileName );
+    }
+
+    ///> The symbols of the library by name, read as the symbol chooser does
+    std::map<wxString, LIB_PART*> loadSummaries()
+    {
+        std::vector<LIB_PART*>        symbols;
+        std::map<wxString, LIB_PART*> byName;
+        PROPERTIES                    props;
+
+        props[ SYMBOL_LIB_TABLE::PropSummariesOnly ] = "";
+        m_plugin.EnumerateSymbolLib( symbols, m_fileName, &props );
+
+        for( LIB_PART* symbol : symbols )
+            byName[ symbol->GetName() ] = symbol;
+
+        return byName;
+    }
+
+    static size_t pinCount( LIB_PART* aSymbol )
+    {
+        LIB_PINS pins;
+
+        aSymbol->GetPins( pins );
+        return pins.size();
+    }
+
+    wxString         m_fileName;
+    SCH_SEXPR_PLUGIN m_plugin;
+};
+
+
+/**
+ * Declare the test suite
+ */
+BOOST_FIXTURE_TEST_SUITE( LibSymbolIndex, TEST_LIB_SYMBOL_INDEX_FIXTURE )
+
+
+/**
+ * Check that the summaries have what the symbol chooser shows, and no graphic items
+ */
+BOOST_AUTO_TEST_CASE( Summaries )
+{
+    std::map<wxString, LIB_PART*> symbols = loadSummaries();
+
+    BOOST_REQUIRE_EQUAL( symbols.size(), 3u );
+
+    LIB_PART* pack = symbols[ "R_Pack" ];
+
+    BOOST_CHECK_EQUAL( pack->GetDescription(), "Resistor pack" );
+    BOOST_CHECK_EQUAL( pack->GetKeyWords(), "R network" );
+    BOOST_CHECK_EQUAL( pack->GetFootprintField().GetText(), "Resistor_SMD:R_Array" );
+    BOOST_CHECK_EQUAL( pack->GetUnitCount(), 2 );
+    BOOST_CHECK( pack->IsRoot() );
+    BOOST_CHECK_EQUAL( pinCount( pack ), 0u );
+
+    LIB_PART* alt = symbols[ "R_Pack_Alt" ];
+
+    BOOST_CHECK( alt->IsAlias() );
+    BOOST_CHECK_EQUAL( alt->GetDescription(), "Resistor pack (alternate)" );
+    BOOST_CHECK_EQUAL( alt->GetUnitCount(), 2 );
+
+    BOOST_CHECK( symbols[ "GND" ]->IsPower() );
+    BOOST_CHECK( !pack->IsPower() );
+}
+
+
+/**
+ * Check that loading a symbol parses it in place of its summary, with its parent
+ */
+BOOST_AUTO_TEST_CASE( ParsedOnLoad )
+{
+    std::map<wxString, LIB_PART*> symbols = loadSummaries();
+
+    LIB_PART* alt = m_plugin.LoadSymbol( m_fileName, "R_Pack_Alt" );
+
+    BOOST_CHECK_EQUAL( alt, symbols[ "R_Pack_Alt" ] );
+    BOOST_CHECK( alt->IsAlias() );
+    BOOST_CHECK_EQUAL( alt->GetValueField().GetText(), "R_Pack_Alt" );
+    BOOST_CHECK_EQUAL( pinCount( symbols[ "R_Pack" ] ), 2u );
+
+    // Not asked for yet
+    BOOST_CHECK_EQUAL( pinCount( symbols[ "GND" ] ), 0u );
+
+    BOOST_CHECK( m_plugin.LoadSymbol( m_fileName, "R_Missing" ) == nullptr );
+}
+
+
+/**
+ * Check that enumerating the symbols without asking for summaries parses them all
+ */
+BOOST_AUTO_TEST_CASE( FullEnumeration )
+{
+    std::vector<LIB_PART*> symbols;
+
+    m_plugin.EnumerateSymbolLib( symbols, m_fileName );
+
+    BOOST_REQUIRE_EQUAL( symbols.size(), 3u );
+
+    for( LIB_PART* symbol : symbols )
+    {
+        if( symbol->IsRoot() )
+            BOOST_CHECK_GT( pinCount( symbol ), 0u );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
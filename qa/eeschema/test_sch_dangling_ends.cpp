@@ -0,0 +1,350 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the dangling end tests of SCH_SCREEN
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <convert_to_biu.h>
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <sch_bus_entry.h>
+#include <sch_component.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+
+// Code under test
+#include <sch_screen.h>
+
+
+class TEST_SCH_DANGLING_ENDS_FIXTURE
+{
+public:
+    TEST_SCH_DANGLING_ENDS_FIXTURE()
+    {
+        // Two wires meeting in a corner, a label in the middle of the first one and one away
+        m_wire1 = addWire( { 0, 0 }, { 1000, 0 } );
+        m_wire2 = addWire( { 1000, 0 }, { 1000, 1000 } );
+
+        m_label1 = new SCH_LABEL( wxPoint( Mils2iu( 500 ), 0 ), "A" );
+        m_screen.Append( m_label1 );
+
+        m_label2 = new SCH_LABEL( wxPoint( Mils2iu( 5000 ), Mils2iu( 5000 ) ), "B" );
+        m_screen.Append( m_label2 );
+    }
+
+    SCH_LINE* addWire( const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        SCH_LINE* wire = new SCH_LINE( wxPoint( Mils2iu( aStart.x ), Mils2iu( aStart.y ) ),
+                                       LAYER_WIRE );
+
+        wire->SetEndPoint( wxPoint( Mils2iu( aEnd.x ), Mils2iu( aEnd.y ) ) );
+        m_screen.Append( wire );
+        return wire;
+    }
+
+    SCH_SCREEN m_screen;
+    SCH_LINE*  m_wire1;
+    SCH_LINE*  m_wire2;
+    SCH_LABEL* m_label1;
+    SCH_LABEL* m_label2;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchDanglingEnds, TEST_SCH_DANGLING_ENDS_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( Full )
+{
+    BOOST_CHECK( m_screen.TestDanglingEnds() );
+
+    BOOST_CHECK( m_wire1->IsStartDangling() );
+    BOOST_CHECK( !m_wire1->IsEndDangling() );
+    BOOST_CHECK( !m_wire2->IsStartDangling() );
+    BOOST_CHECK( m_wire2->IsEndDangling() );
+    BOOST_CHECK( !m_label1->IsDangling() );
+    BOOST_CHECK( m_label2->IsDangling() );
+
+    // Nothing changes the second time
+    BOOST_CHECK( !m_screen.TestDanglingEnds() );
+}
+
+
+BOOST_AUTO_TEST_CASE( Incremental )
+{
+    m_screen.TestDanglingEnds();
+
+    // Moving the first wire away disconnects the second one and the label on it
+    m_screen.Remove( m_wire1 );
+    m_wire1->Move( wxPoint( 0, Mils2iu( 2000 ) ) );
+    m_screen.Append( m_wire1 );
+
+    std::vector<SCH_ITEM*> changed;
+    std::function<void( SCH_ITEM* )> changeHandler =
+            [&]( SCH_ITEM* aItem )
+            {
+                changed.push_back( aItem );
+            };
+
+    BOOST_CHECK( m_screen.TestDanglingEnds( { m_wire1 }, &changeHandler ) );
+
+    BOOST_CHECK( m_wire1->IsEndDangling() );
+    BOOST_CHECK( m_wire2->IsStartDangling() );
+    BOOST_CHECK( m_label1->IsDangling() );
+    BOOST_CHECK_EQUAL( changed.size(), 3u );
+
+    // An added label is the only item tested
+    SCH_LABEL* label = new SCH_LABEL( wxPoint( Mils2iu( 3000 ), Mils2iu( 3000 ) ), "C" );
+    m_screen.Append( label );
+    changed.clear();
+
+    BOOST_CHECK( m_screen.TestDanglingEnds( { label }, &changeHandler ) );
+    BOOST_CHECK( label->IsDangling() );
+    BOOST_CHECK_EQUAL( changed.size(), 1u );
+
+    // Moved on the second wire, it is connected
+    m_screen.Remove( label );
+    label->SetPosition( wxPoint( Mils2iu( 1000 ), Mils2iu( 500 ) ) );
+    m_screen.Append( label );
+
+    BOOST_CHECK( m_screen.TestDanglingEnds( { label } ) );
+    BOOST_CHECK( !label->IsDangling() );
+
+    // Same states as testing everything
+    BOOST_CHECK( !m_screen.TestDanglingEnds() );
+
+    // A removed item is not dereferenced
+    m_screen.Remove( m_wire2 );
+    delete m_wire2;
+
+    BOOST_CHECK( m_screen.TestDanglingEnds( { m_wire2 } ) );
+    BOOST_CHECK( label->IsDangling() );
+    BOOST_CHECK( !m_screen.TestDanglingEnds() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+/**
+ * A symbol, a sheet and bus entries, connected through wires and buses.
+ */
+class TEST_SCH_DANGLING_CONNECTIONS_FIXTURE
+{
+public:
+    TEST_SCH_DANGLING_CONNECTIONS_FIXTURE() :
+            m_part( "R", nullptr )
+    {
+        // A symbol whose first pin is at the end of a wire, and the second one unconnected
+        for( int ii = 0; ii < 2; ++ii )
+        {
+            LIB_PIN* pin = new LIB_PIN( &m_part );
+
+            pin->SetNumber( wxString::Format( "%d", ii + 1 ) );
+            pin->SetType( ELECTRICAL_PINTYPE::PT_PASSIVE );
+            pin->SetPosition( wxPoint( Mils2iu( ii ? 300 : -300 ), 0 ) );
+            m_part.AddDrawItem( pin );
+        }
+
+        m_symbol = new SCH_COMPONENT( m_part, m_part.GetLibId(), nullptr, 0, 0,
+                                      wxPoint( Mils2iu( 2000 ), Mils2iu( 2000 ) ) );
+        add( m_symbol );
+        add( newLine( { 1000, 2000 }, { 1700, 2000 }, LAYER_WIRE ) );
+
+        // A sheet with a pin at the end of a wire
+        m_sheet = new SCH_SHEET( nullptr, wxPoint( Mils2iu( 4000 ), 0 ) );
+        m_sheet->SetSize( wxSize( Mils2iu( 1000 ), Mils2iu( 1000 ) ) );
+        m_sheet->AddPin( new SCH_SHEET_PIN( m_sheet, wxPoint( Mils2iu( 4000 ), Mils2iu( 500 ) ),
+                                            "IN" ) );
+        add( m_sheet );
+        add( newLine( { 3000, 500 }, { 4000, 500 }, LAYER_WIRE ) );
+
+        // A bus with a wire entry to a labelled wire, and a bus entry to a second bus
+        add( newLine( { 0, 4000 }, { 0, 6000 }, LAYER_BUS ) );
+
+        m_wireEntry = new SCH_BUS_WIRE_ENTRY( wxPoint( 0, Mils2iu( 5000 ) ) );
+        add( m_wireEntry );
+        add( newLine( { 100, 5100 }, { 1000, 5100 }, LAYER_WIRE ) );
+        add( new SCH_LABEL( wxPoint( Mils2iu( 1000 ), Mils2iu( 5100 ) ), "D0" ) );
+
+        m_busEntry = new SCH_BUS_BUS_ENTRY( wxPoint( 0, Mils2iu( 4200 ) ) );
+        add( m_busEntry );
+        add( newLine( { 100, 4300 }, { 1000, 4300 }, LAYER_BUS ) );
+    }
+
+    static SCH_LINE* newLine( const wxPoint& aStart, const wxPoint& aEnd, SCH_LAYER_ID aLayer )
+    {
+        SCH_LINE* line = new SCH_LINE( wxPoint( Mils2iu( aStart.x ), Mils2iu( aStart.y ) ),
+                                       aLayer );
+
+        line->SetEndPoint( wxPoint( Mils2iu( aEnd.x ), Mils2iu( aEnd.y ) ) );
+        return line;
+    }
+
+    void add( SCH_ITEM* aItem )
+    {
+        m_screen.Append( aItem );
+        m_items.push_back( aItem );
+    }
+
+    ///> Moves an item by the given offset (in mils) and tests it incrementally
+    void moveItem( SCH_ITEM* aItem, int aDx, int aDy )
+    {
+        m_screen.Remove( aItem );
+        aItem->Move( wxPoint( Mils2iu( aDx ), Mils2iu( aDy ) ) );
+        m_screen.Append( aItem );
+
+        m_screen.TestDanglingEnds( { aItem } );
+    }
+
+    ///> The dangling states of all the connection points of the items, in screen order
+    std::vector<bool> danglingStates()
+    {
+        std::vector<bool> states;
+
+        for( SCH_ITEM* item : m_screen.Items() )
+        {
+            switch( item->Type() )
+            {
+            case SCH_LINE_T:
+                states.push_back( static_cast<SCH_LINE*>( item )->IsStartDangling() );
+                states.push_back( static_cast<SCH_LINE*>( item )->IsEndDangling() );
+                break;
+
+            case SCH_BUS_WIRE_ENTRY_T:
+            case SCH_BUS_BUS_ENTRY_T:
+                states.push_back( static_cast<SCH_BUS_ENTRY_BASE*>( item )->IsDanglingStart() );
+                states.push_back( static_cast<SCH_BUS_ENTRY_BASE*>( item )->IsDanglingEnd() );
+                break;
+
+            case SCH_COMPONENT_T:
+                for( std::unique_ptr<SCH_PIN>& pin :
+                        static_cast<SCH_COMPONENT*>( item )->GetRawPins() )
+                    states.push_back( pin->IsDangling() );
+
+                break;
+
+            case SCH_SHEET_T:
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                    states.push_back( pin->IsDangling() );
+
+                break;
+
+            default:
+                states.push_back( static_cast<SCH_TEXT*>( item )->IsDangling() );
+                break;
+            }
+        }
+
+        return states;
+    }
+
+    /**
+     * Checks the current dangling states against the ones found by testing every item
+     * against the end points of all the items.
+     */
+    void checkAgainstAllPairs()
+    {
+        std::vector<bool>              tested = danglingStates();
+        std::vector<DANGLING_END_ITEM> endPoints;
+
+        for( SCH_ITEM* item : m_screen.Items() )
+            item->GetEndPoints( endPoints );
+
+        for( SCH_ITEM* item : m_screen.Items() )
+            item->UpdateDanglingState( endPoints );
+
+        BOOST_CHECK( danglingStates() == tested );
+    }
+
+    // The symbols of the screen are flattened copies of the part
+    LIB_PART               m_part;
+    SCH_SCREEN             m_screen;
+    std::vector<SCH_ITEM*> m_items;
+    SCH_COMPONENT*         m_symbol;
+    SCH_SHEET*             m_sheet;
+    SCH_BUS_WIRE_ENTRY*    m_wireEntry;
+    SCH_BUS_BUS_ENTRY*     m_busEntry;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchDanglingConnections, TEST_SCH_DANGLING_CONNECTIONS_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( GridMatchesAllPairs )
+{
+    m_screen.TestDanglingEnds();
+    checkAgainstAllPairs();
+
+    std::vector<std::unique_ptr<SCH_PIN>>& pins = m_symbol->GetRawPins();
+
+    BOOST_REQUIRE_EQUAL( pins.size(), 2u );
+    BOOST_CHECK( !pins[0]->IsDangling() );
+    BOOST_CHECK( pins[1]->IsDangling() );
+    BOOST_CHECK( !m_sheet->GetPins()[0]->IsDangling() );
+    BOOST_CHECK( !m_wireEntry->IsDangling() );
+    BOOST_CHECK( !m_busEntry->IsDangling() );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalMatchesAllPairs )
+{
+    m_screen.TestDanglingEnds();
+
+    // Every item moved away from its connections and back
+    for( SCH_ITEM* item : m_items )
+    {
+        BOOST_TEST_CONTEXT( item->GetSelectMenuText( EDA_UNITS::MILS ).ToStdString() )
+        {
+            moveItem( item, 300, 100 );
+            checkAgainstAllPairs();
+
+            moveItem( item, -300, -100 );
+            checkAgainstAllPairs();
+        }
+    }
+
+    BOOST_CHECK( !m_symbol->GetRawPins()[0]->IsDangling() );
+
+    // The moved symbol leaves its wire, and the sheet pin lands on the same wire end
+    moveItem( m_symbol, 0, 1000 );
+    checkAgainstAllPairs();
+    BOOST_CHECK( m_symbol->GetRawPins()[0]->IsDangling() );
+
+    moveItem( m_sheet, -2300, 1500 );
+    checkAgainstAllPairs();
+    BOOST_CHECK( !m_sheet->GetPins()[0]->IsDangling() );
+
+    // The wire entry moved off the bus
+    moveItem( m_wireEntry, 500, 0 );
+    checkAgainstAllPairs();
+    BOOST_CHECK( m_wireEntry->IsDanglingStart() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,330 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_cached_container.cpp
+ * Checks that the free chunks of a cached vertex container stay consistent, and that the
+ * vertices of its items survive being moved, through random allocations, frees and compactions.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gal/opengl/cached_container.h>
+#include <gal/opengl/vertex_item.h>
+#include <gal/opengl/vertex_manager.h>
+
+using namespace KIGFX;
+
+
+/**
+ * A cached container storing its vertices in RAM without an OpenGL buffer, which exposes
+ * its chunks to the tests.
+ */
+class TEST_CACHED_CONTAINER : public CACHED_CONTAINER
+{
+public:
+    TEST_CACHED_CONTAINER( unsigned int aSize ) :
+            CACHED_CONTAINER( aSize )
+    {
+        m_vertices = static_cast<VERTEX*>( malloc( aSize * VERTEX_SIZE ) );
+    }
+
+    ~TEST_CACHED_CONTAINER()
+    {
+        free( m_vertices );
+    }
+
+    unsigned int GetBufferHandle() const override { return 0; }
+
+    bool IsMapped() const override { return true; }
+
+    void Map() override {}
+
+    void Unmap() override {}
+
+    /**
+     * Checks that the free chunks are indexed the same by size and by offset, are merged with
+     * their neighbours, and that they cover with the items the whole container without any
+     * overlap.
+     */
+    void CheckChunks() const
+    {
+        BOOST_REQUIRE( m_item == nullptr );
+        BOOST_CHECK_EQUAL( m_freeChunks.size(), m_freeChunkOffsets.size() );
+
+        unsigned int freeSpace = 0;
+
+        for( const CHUNK& chunk : m_freeChunks )
+        {
+            auto byOffset = m_freeChunkOffsets.find( getChunkOffset( chunk ) );
+
+            BOOST_REQUIRE( byOffset != m_freeChunkOffsets.end() );
+            BOOST_CHECK_EQUAL( byOffset->second, (unsigned int) getChunkSize( chunk ) );
+            BOOST_CHECK_GT( getChunkSize( chunk ), 0 );
+
+            freeSpace += getChunkSize( chunk );
+        }
+
+        BOOST_CHECK_EQUAL( freeSpace, m_freeSpace );
+
+        // (offset, size, free) of every chunk, in the order of their offsets
+        std::vector<std::tuple<unsigned int, unsigned int, bool>> chunks;
+
+        for( const std::pair<const unsigned int, unsigned int>& chunk : m_freeChunkOffsets )
+            chunks.emplace_back( chunk.first, chunk.second, true );
+
+        for( const std::pair<const unsigned int, VERTEX_ITEM*>& item : m_items )
+        {
+            BOOST_CHECK_EQUAL( item.first, item.second->GetOffset() );
+            BOOST_CHECK_GT( item.second->GetSize(), 0u );
+            BOOST_CHECK_LE( item.first + item.second->GetSize(), m_maxIndex );
+
+            chunks.emplace_back( item.first, item.second->GetSize(), false );
+        }
+
+        std::sort( chunks.begin(), chunks.end() );
+
+        unsigned int end = 0;
+        bool         prevFree = false;
+
+        for( const std::tuple<unsigned int, unsigned int, bool>& chunk : chunks )
+        {
+            // No gap and no overlap with the previous chunk
+            BOOST_CHECK_EQUAL( std::get<0>( chunk ), end );
+
+            // Free chunks next to each other are merged
+            BOOST_CHECK( !( prevFree && std::get<2>( chunk ) ) );
+
+            end = std::get<0>( chunk ) + std::get<1>( chunk );
+            prevFree = std::get<2>( chunk );
+        }
+
+        BOOST_CHECK_EQUAL( end, m_currentSize );
+    }
+
+protected:
+    bool defragmentResize( unsigned int aNewSize ) override
+    {
+        if( usedSpace() > aNewSize )
+            return false;
+
+        VERTEX* newBufferMem = static_cast<VERTEX*>( malloc( aNewSize * VERTEX_SIZE ) );
+
+        defragment( newBufferMem );
+
+        free( m_vertices );
+        m_vertices = newBufferMem;
+
+        m_freeSpace += ( aNewSize - m_currentSize );
+        m_currentSize = aNewSize;
+
+        resetChunks();
+        m_dirty = true;
+
+        return true;
+    }
+};
+
+
+/**
+ * Items stored in a small test container, each vertex holding the id of its item and its
+ * index in the item.
+ */
+struct CACHED_CONTAINER_FIXTURE
+{
+    CACHED_CONTAINER_FIXTURE() :
+            m_manager( false ),
+            m_container( 64 )
+    {
+    }
+
+    ///> Adds vertices to an item, new or already stored
+    void grow( VERTEX_ITEM* aItem, unsigned int aSize )
+    {
+        unsigned int size = aItem->GetSize();
+
+        m_container.SetItem( aItem );
+
+        VERTEX* vertices = m_container.Allocate( aSize );
+
+        BOOST_REQUIRE( vertices );
+
+        for( unsigned int ii = 0; ii < aSize; ++ii )
+        {
+            vertices[ii].x = m_ids.at( aItem );
+            vertices[ii].y = size + ii;
+        }
+
+        m_container.FinishItem();
+    }
+
+    VERTEX_ITEM* addItem( unsigned int aSize )
+    {
+        m_items.push_back( std::make_unique<VERTEX_ITEM>( m_manager ) );
+        m_ids[ m_items.back().get() ] = m_nextId++;
+
+        grow( m_items.back().get(), aSize );
+
+        return m_items.back().get();
+    }
+
+    void deleteItem( size_t aIndex )
+    {
+        m_container.Delete( m_items[aIndex].get() );
+        m_ids.erase( m_items[aIndex].get() );
+        m_items.erase( m_items.begin() + aIndex );
+    }
+
+    ///> Checks the container chunks, and that every item still has its own vertices
+    void checkContainer()
+    {
+        m_container.CheckChunks();
+
+        for( const std::unique_ptr<VERTEX_ITEM>& item : m_items )
+        {
+            const VERTEX* vertices = m_container.GetVertices( item->GetOffset() );
+            bool          ok = true;
+
+            for( unsigned int ii = 0; ii < item->GetSize() && ok; ++ii )
+                ok = vertices[ii].x == m_ids.at( item.get() ) && vertices[ii].y == ii;
+
+            BOOST_CHECK_MESSAGE( ok, "Vertices of item " << m_ids.at( item.get() ) << " lost" );
+        }
+    }
+
+    // Only the items are allocated through the manager, it stores nothing itself
+    VERTEX_MANAGER                            m_manager;
+    TEST_CACHED_CONTAINER                     m_container;
+    std::vector<std::unique_ptr<VERTEX_ITEM>> m_items;
+    std::map<const VERTEX_ITEM*, int>         m_ids;
+    int                                       m_nextId = 1;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( CachedContainer, CACHED_CONTAINER_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( CompactFillsHoles )
+{
+    for( int ii = 0; ii < 4; ++ii )
+        addItem( 4 );
+
+    VERTEX_ITEM* last = m_items.back().get();
+
+    // The last item moves to the hole left by the second one
+    deleteItem( 1 );
+    checkContainer();
+    BOOST_CHECK_GT( m_container.GetFragmentation(), 0.0 );
+
+    BOOST_CHECK_EQUAL( m_container.Compact( 1000 ), 4u );
+    checkContainer();
+
+    BOOST_CHECK_EQUAL( last->GetOffset(), 4u );
+    BOOST_CHECK_EQUAL( m_container.GetFragmentation(), 0.0 );
+
+    // Nothing is left to move
+    BOOST_CHECK_EQUAL( m_container.Compact( 1000 ), 0u );
+}
+
+
+BOOST_AUTO_TEST_CASE( CompactSizeLimit )
+{
+    for( int ii = 0; ii < 6; ++ii )
+        addItem( 4 );
+
+    deleteItem( 0 );
+    deleteItem( 0 );
+
+    // The first item is moved even if it is bigger than the limit, but not the next one
+    BOOST_CHECK_EQUAL( m_container.Compact( 2 ), 4u );
+    checkContainer();
+
+    BOOST_CHECK_EQUAL( m_container.Compact( 8 ), 4u );
+    checkContainer();
+    BOOST_CHECK_EQUAL( m_container.GetFragmentation(), 0.0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( ExactFitUploaded )
+{
+    // The second item fills the rest of the container exactly, and must be uploaded too
+    addItem( 32 );
+    addItem( 32 );
+    checkContainer();
+}
+
+
+BOOST_AUTO_TEST_CASE( RandomOperations )
+{
+    std::mt19937                                 rng( 42 );
+    std::uniform_int_distribution<unsigned int> sizeDist( 1, 40 );
+    std::uniform_int_distribution<int>          opDist( 0, 9 );
+
+    for( int step = 0; step < 5000; ++step )
+    {
+        int op = opDist( rng );
+
+        if( op < 4 || m_items.empty() )
+        {
+            addItem( sizeDist( rng ) );
+        }
+        else if( op < 6 )
+        {
+            size_t index = rng() % m_items.size();
+            grow( m_items[index].get(), sizeDist( rng ) );
+        }
+        else if( op < 9 )
+        {
+            deleteItem( rng() % m_items.size() );
+        }
+        else
+        {
+            m_container.Compact( sizeDist( rng ) * 4 );
+        }
+
+        checkContainer();
+
+        if( step % 1000 == 999 )
+        {
+            BOOST_TEST_CONTEXT( "Step " << step )
+            {
+                // Compacting without a limit moves as many items as fit in the holes
+                m_container.Compact( m_container.GetSize() );
+                checkContainer();
+            }
+        }
+    }
+
+    BOOST_CHECK_GT( m_container.GetMovedBytes(), 0u );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
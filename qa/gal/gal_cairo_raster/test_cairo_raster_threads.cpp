@@ -0,0 +1,229 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_cairo_raster_threads.cpp
+ * Checks that the Cairo GAL draws the same pixels when its paths are rasterized in bands by
+ * several threads as when they are drawn at once (CairoRasterThreads = 1).
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include <gal/cairo/cairo_gal.h>
+#include <gal/color4d.h>
+#include <gal/gal_display_options.h>
+
+
+/**
+ * A Cairo GAL drawing into an image surface of a fixed size, with one world unit per pixel
+ * and the origin at the top left corner.
+ */
+class OFFSCREEN_CAIRO_GAL : public KIGFX::CAIRO_GAL_BASE
+{
+public:
+    OFFSCREEN_CAIRO_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aOptions, int aWidth, int aHeight ) :
+            CAIRO_GAL_BASE( aOptions )
+    {
+        surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, aWidth, aHeight );
+        context = cairo_create( surface );
+        currentContext = context;
+
+        ResizeScreen( aWidth, aHeight );
+
+        SetWorldUnitLength( 1.0 );
+        SetScreenDPI( 1.0 );
+        SetZoomFactor( 1.0 );
+        SetLookAtPoint( VECTOR2D( aWidth / 2.0, aHeight / 2.0 ) );
+    }
+
+    ///> Returns the pixels of the image, row after row
+    std::vector<uint32_t> GetPixels()
+    {
+        cairo_surface_flush( surface );
+
+        int            width = cairo_image_surface_get_width( surface );
+        int            height = cairo_image_surface_get_height( surface );
+        int            stride = cairo_image_surface_get_stride( surface );
+        unsigned char* data = cairo_image_surface_get_data( surface );
+
+        std::vector<uint32_t> pixels;
+
+        for( int y = 0; y < height; ++y )
+        {
+            const uint32_t* row = reinterpret_cast<const uint32_t*>( data + y * stride );
+            pixels.insert( pixels.end(), row, row + width );
+        }
+
+        return pixels;
+    }
+};
+
+
+static const int WIDTH = 320;
+static const int HEIGHT = 250;     // Not a multiple of the band count, so bands differ in size
+
+
+/**
+ * Draws a frame of shapes crossing the bands wherever their seams are: rows of thin and thick
+ * lines a few pixels apart (some on pixel edges, some on pixel centres), small circles and
+ * arcs, and shapes spanning the whole image.  Some colors are translucent, so the order in
+ * which overlapping paths are drawn shows.
+ */
+static std::vector<uint32_t> drawFrame( int aThreadCount )
+{
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+    OFFSCREEN_CAIRO_GAL        gal( options, WIDTH, HEIGHT );
+
+    gal.SetRasterThreadCount( aThreadCount );
+    gal.SetClearColor( KIGFX::COLOR4D::BLACK );
+
+    {
+        KIGFX::GAL_DRAWING_CONTEXT ctx( &gal );
+
+        gal.SetIsFill( false );
+        gal.SetIsStroke( true );
+
+        for( int y = 0; y < HEIGHT; y += 5 )
+        {
+            gal.SetStrokeColor( KIGFX::COLOR4D( 0.2, 0.8, 0.4, 0.7 ) );
+            gal.SetLineWidth( 1.0 );
+            gal.DrawLine( VECTOR2D( 3, y ), VECTOR2D( WIDTH - 3, y + 0.5 ) );
+
+            gal.SetStrokeColor( KIGFX::COLOR4D( 0.9, 0.3, 0.1, 0.5 ) );
+            gal.SetLineWidth( 3.0 );
+            gal.DrawLine( VECTOR2D( 20 + y % 40, y ), VECTOR2D( 60 + y % 40, y + 9 ) );
+        }
+
+        gal.SetIsFill( true );
+        gal.SetIsStroke( false );
+
+        for( int y = 2; y < HEIGHT; y += 7 )
+        {
+            gal.SetFillColor( KIGFX::COLOR4D( 0.3, 0.3, 1.0, 0.6 ) );
+            gal.DrawCircle( VECTOR2D( 150 + ( y * 13 ) % 120, y + 0.25 ), 2.5 + y % 4 );
+
+            gal.SetFillColor( KIGFX::COLOR4D( 1.0, 1.0, 0.2, 0.4 ) );
+            gal.DrawSegment( VECTOR2D( 100, y ), VECTOR2D( 130, y + 11.5 ), 2.0 );
+        }
+
+        // Shapes spanning all the bands
+        gal.SetFillColor( KIGFX::COLOR4D( 0.8, 0.1, 0.8, 0.3 ) );
+        gal.DrawCircle( VECTOR2D( WIDTH / 2.0, HEIGHT / 2.0 ), HEIGHT / 2.0 - 1 );
+
+        std::deque<VECTOR2D> star;
+
+        for( int ii = 0; ii < 14; ++ii )
+        {
+            double angle = ii * M_PI / 7;
+            double radius = ( ii % 2 ) ? 40.0 : 120.0;
+
+            star.emplace_back( 160 + radius * std::cos( angle ),
+                               125 + radius * std::sin( angle ) );
+        }
+
+        gal.SetFillColor( KIGFX::COLOR4D( 0.1, 0.9, 0.9, 0.5 ) );
+        gal.DrawPolygon( star );
+
+        gal.SetIsFill( false );
+        gal.SetIsStroke( true );
+        gal.SetStrokeColor( KIGFX::COLOR4D( 1.0, 1.0, 1.0, 0.8 ) );
+        gal.SetLineWidth( 7.0 );
+        gal.DrawLine( VECTOR2D( 5, 5 ), VECTOR2D( WIDTH - 5, HEIGHT - 5 ) );
+        gal.DrawArc( VECTOR2D( WIDTH / 2.0, HEIGHT / 2.0 ), 100, 0.3, 2.8 );
+        gal.DrawRectangle( VECTOR2D( 10.5, 10.5 ), VECTOR2D( WIDTH - 10.5, HEIGHT - 10.5 ) );
+    }
+
+    return gal.GetPixels();
+}
+
+
+/// The largest difference of a color channel between two pixels
+static int channelDifference( uint32_t aFirst, uint32_t aSecond )
+{
+    int difference = 0;
+
+    for( int shift = 0; shift < 32; shift += 8 )
+    {
+        int first = ( aFirst >> shift ) & 0xff;
+        int second = ( aSecond >> shift ) & 0xff;
+
+        difference = std::max( difference, std::abs( first - second ) );
+    }
+
+    return difference;
+}
+
+
+BOOST_AUTO_TEST_SUITE( CairoRasterThreads )
+
+
+BOOST_AUTO_TEST_CASE( BandsMatchSingleThread )
+{
+    std::vector<uint32_t> reference = drawFrame( 1 );
+
+    BOOST_REQUIRE_EQUAL( reference.size(), (size_t) WIDTH * HEIGHT );
+
+    // Make sure something was drawn over the cleared image
+    size_t drawn = 0;
+
+    for( uint32_t pixel : reference )
+        drawn += ( pixel != reference[0] );
+
+    BOOST_REQUIRE_GT( drawn, reference.size() / 4 );
+
+    for( int threads : { 2, 3, 4, 7 } )
+    {
+        BOOST_TEST_CONTEXT( threads << " threads" )
+        {
+            std::vector<uint32_t> banded = drawFrame( threads );
+
+            BOOST_REQUIRE_EQUAL( banded.size(), reference.size() );
+
+            // The bands start on whole rows, so only rounding may change the coverage of a
+            // pixel.  A path missing or clipped at a seam differs by much more.
+            int    maxDifference = 0;
+            size_t differing = 0;
+
+            for( size_t ii = 0; ii < reference.size(); ++ii )
+            {
+                int difference = channelDifference( reference[ii], banded[ii] );
+
+                maxDifference = std::max( maxDifference, difference );
+                differing += ( difference > 0 );
+            }
+
+            BOOST_TEST_MESSAGE( differing << " pixels differ, by up to " << maxDifference );
+            BOOST_CHECK_LE( maxDifference, 2 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
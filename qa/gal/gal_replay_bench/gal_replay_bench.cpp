@@ -0,0 +1,659 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Benchmark of the redraw path of the GAL canvases.
+ *
+ * A board is drawn by a VIEW and a PCB_PAINTER into an offscreen Cairo image, without any
+ * window, while a script of zoom and pan steps is replayed.  Each step draws a frame, and the
+ * percentiles of the frame costs collected in KIGFX::FRAME_STATS are reported at the end.
+ * The layers are not cached, as on the Cairo canvas, and the rasterization uses the number of
+ * threads given with -j.
+ *
+ * With --opengl, the board is drawn by the OpenGL GAL instead, in a window (so a display is
+ * needed) and with the layers cached as on the OpenGL canvas.  The items smaller on screen
+ * than --coarse-pixels are then drawn from their coarse variants, and --compare-coarse replays
+ * the script with them off and then on, to compare the vertices drawn and the frame times.
+ * Each report tells how many frames miss the 60 fps budget.
+ *
+ * The first frame prepares all the items (see KIGFX::PAINTER::PrepareDraw()) with the number
+ * of threads given with -P.  Comparing the first frames of runs with -P 1 and -P 0 gives the
+ * gain of the parallel preparation; most of it is in the triangulation of zones and polygons,
+ * which only the OpenGL GAL needs.
+ *
+ * A script has one step per line:
+ *   fit            shows the whole board
+ *   zoom F         zooms by the factor F around the center of the screen
+ *   pan DX DY      moves the view by DX screen widths and DY screen heights
+ * Empty lines and lines starting with '#' are ignored.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <wx/app.h>
+#include <wx/cmdline.h>
+#include <wx/frame.h>
+#include <wx/msgout.h>
+
+#include <advanced_config.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <common.h>
+#include <gal/cairo/cairo_gal.h>
+#include <gal/frame_stats.h>
+#include <gal/opengl/opengl_gal.h>
+#include <macros.h>
+#include <pcb_painter.h>
+#include <pcb_view.h>
+#include <profile.h>
+#include <settings/color_settings.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_program.h>
+
+
+/**
+ * A Cairo GAL drawing into an image surface of a fixed size, which needs no window.
+ */
+class OFFSCREEN_CAIRO_GAL : public KIGFX::CAIRO_GAL_BASE
+{
+public:
+    OFFSCREEN_CAIRO_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aOptions, int aWidth, int aHeight ) :
+            CAIRO_GAL_BASE( aOptions )
+    {
+        surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, aWidth, aHeight );
+        context = cairo_create( surface );
+        currentContext = context;
+
+        ResizeScreen( aWidth, aHeight );
+    }
+
+    bool WritePng( const std::string& aFileName )
+    {
+        cairo_surface_flush( surface );
+        return cairo_surface_write_to_png( surface, aFileName.c_str() ) == CAIRO_STATUS_SUCCESS;
+    }
+};
+
+
+/// The costs of a frame, timed as a whole and by the VIEW and the GAL
+struct FRAME
+{
+    double             m_time;
+    KIGFX::FRAME_STATS m_stats;
+};
+
+
+///> The time of a frame on a 60 fps canvas, in ms
+static const double frameBudget = 1000.0 / 60.0;
+
+
+///> Used when no script is given: panning and zooming across the whole board
+static const char* defaultScript[] = {
+    "fit",
+    "pan 0.1 0", "pan 0.1 0", "pan 0.1 0", "pan 0.1 0", "pan 0.1 0",
+    "pan -0.1 0", "pan -0.1 0", "pan -0.1 0", "pan -0.1 0", "pan -0.1 0",
+    "zoom 1.5", "zoom 1.5", "zoom 1.5", "zoom 1.5", "zoom 1.5",
+    "pan 0.25 0", "pan 0.25 0", "pan 0 0.25", "pan 0 0.25", "pan -0.25 0", "pan -0.25 0",
+    "pan 0 -0.25", "pan 0 -0.25",
+    "zoom 0.67", "zoom 0.67", "zoom 0.67", "zoom 0.67", "zoom 0.67",
+    "pan 0 0.1", "pan 0 0.1", "pan 0 -0.1", "pan 0 -0.1",
+};
+
+
+static std::vector<std::string> readScript( const wxString& aFileName )
+{
+    std::vector<std::string> steps;
+
+    if( aFileName.IsEmpty() )
+        return std::vector<std::string>( std::begin( defaultScript ), std::end( defaultScript ) );
+
+    std::ifstream file( aFileName.ToStdString() );
+    std::string   line;
+
+    while( std::getline( file, line ) )
+    {
+        line.erase( 0, line.find_first_not_of( " \t" ) );
+
+        if( !line.empty() && line[0] != '#' )
+            steps.push_back( line );
+    }
+
+    return steps;
+}
+
+
+/**
+ * Moves the view for a step of the script.
+ *
+ * @return false if the step is not understood.
+ */
+static bool applyStep( KIGFX::VIEW& aView, const BOARD& aBoard, const std::string& aStep )
+{
+    std::istringstream stream( aStep );
+    std::string        command;
+
+    stream >> command;
+
+    if( command == "fit" )
+    {
+        EDA_RECT bbox = aBoard.GetBoundingBox();
+
+        // Some margin around the board, as when zooming to fit in the editor
+        bbox.Inflate( bbox.GetWidth() / 10, bbox.GetHeight() / 10 );
+        aView.SetViewport( BOX2D( bbox.GetOrigin(), bbox.GetSize() ) );
+        return true;
+    }
+    else if( command == "zoom" )
+    {
+        double factor = 0.0;
+
+        if( !( stream >> factor ) || factor <= 0.0 )
+            return false;
+
+        aView.SetScale( aView.GetScale() * factor, aView.GetCenter() );
+        return true;
+    }
+    else if( command == "pan" )
+    {
+        double dx = 0.0;
+        double dy = 0.0;
+
+        if( !( stream >> dx >> dy ) )
+            return false;
+
+        VECTOR2D size = aView.GetViewport().GetSize();
+
+        aView.SetCenter( aView.GetCenter() + VECTOR2D( dx * size.x, dy * size.y ) );
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * Draws a frame as EDA_DRAW_PANEL_GAL::DoRePaint() does.
+ */
+static FRAME drawFrame( KIGFX::VIEW& aView, KIGFX::GAL& aGal )
+{
+    FRAME frame;
+
+    aGal.SetFrameStats( &frame.m_stats );
+
+    PROF_COUNTER timer;
+
+    aView.UpdateItems();
+
+    {
+        KIGFX::GAL_DRAWING_CONTEXT ctx( &aGal );
+
+        // As EDA_DRAW_PANEL_GAL::DoRePaint() does for OpenGL
+        if( aGal.IsOpenGlEngine() )
+            aGal.ClearScreen();
+
+        aView.ClearTargets();
+        aView.Redraw();
+    }
+
+    frame.m_time = timer.msecs();
+    aGal.SetFrameStats( nullptr );
+
+    return frame;
+}
+
+
+/**
+ * @return the nearest-rank percentile of the values.
+ */
+static double percentile( std::vector<double> aValues, double aFraction )
+{
+    if( aValues.empty() )
+        return 0.0;
+
+    std::sort( aValues.begin(), aValues.end() );
+
+    size_t rank = (size_t) std::ceil( aFraction * aValues.size() );
+
+    return aValues[ std::min( std::max<size_t>( rank, 1 ), aValues.size() ) - 1 ];
+}
+
+
+template <typename GETTER>
+static double mean( const std::vector<FRAME>& aFrames, GETTER aGetter )
+{
+    double sum = 0.0;
+
+    for( const FRAME& frame : aFrames )
+        sum += aGetter( frame );
+
+    return aFrames.empty() ? 0.0 : sum / aFrames.size();
+}
+
+
+static size_t lateFrameCount( const std::vector<FRAME>& aFrames )
+{
+    return std::count_if( aFrames.begin(), aFrames.end(),
+                          []( const FRAME& f ) { return f.m_time > frameBudget; } );
+}
+
+
+template <typename GETTER>
+static void printRow( const char* aName, const std::vector<FRAME>& aFrames, GETTER aGetter )
+{
+    std::vector<double> values;
+
+    for( const FRAME& frame : aFrames )
+        values.push_back( aGetter( frame ) );
+
+    printf( "  %-10s %9.2f %9.2f %9.2f %9.2f %9.2f\n", aName, mean( aFrames, aGetter ),
+            percentile( values, 0.5 ), percentile( values, 0.9 ), percentile( values, 0.99 ),
+            percentile( values, 1.0 ) );
+}
+
+
+static void printReport( const std::vector<FRAME>& aFrames )
+{
+    printf( "%zu frames, times in ms\n", aFrames.size() );
+    printf( "  %-10s %9s %9s %9s %9s %9s\n", "", "mean", "p50", "p90", "p99", "max" );
+
+    using KIGFX::FRAME_STATS;
+
+    printRow( "frame", aFrames, []( const FRAME& f ) { return f.m_time; } );
+    printRow( "update", aFrames, []( const FRAME& f ) { return f.m_stats.m_updateTime; } );
+    printRow( "upload", aFrames, []( const FRAME& f ) { return f.m_stats.m_uploadTime; } );
+    printRow( "query", aFrames, []( const FRAME& f ) { return f.m_stats.GetQueryTime(); } );
+    printRow( "draw", aFrames, []( const FRAME& f ) { return f.m_stats.GetDrawTime(); } );
+    printRow( "flush", aFrames, []( const FRAME& f ) { return f.m_stats.m_flushTime; } );
+    printRow( "composite", aFrames, []( const FRAME& f ) { return f.m_stats.m_compositeTime; } );
+    printRow( "present", aFrames, []( const FRAME& f ) { return f.m_stats.m_presentTime; } );
+    printRow( "items", aFrames,
+              []( const FRAME& f ) { return (double) f.m_stats.GetItemCount(); } );
+    printRow( "vertices", aFrames,
+              []( const FRAME& f ) { return (double) f.m_stats.m_vertexCount; } );
+
+    printf( "%zu frames over the 60 fps budget of %.2f ms\n", lateFrameCount( aFrames ),
+            frameBudget );
+
+    // The layers costing the most, over all the frames
+    std::map<int, double> layerTimes;
+
+    for( const FRAME& frame : aFrames )
+    {
+        for( const FRAME_STATS::LAYER& layer : frame.m_stats.m_layers )
+            layerTimes[layer.m_layer] += layer.m_queryTime + layer.m_drawTime;
+    }
+
+    std::vector<std::pair<double, int>> layers;
+
+    for( const std::pair<const int, double>& layerTime : layerTimes )
+        layers.emplace_back( layerTime.second, layerTime.first );
+
+    std::sort( layers.rbegin(), layers.rend() );
+
+    printf( "Most costly layers (query and draw, mean ms per frame):\n" );
+
+    for( size_t ii = 0; ii < layers.size() && ii < 8; ++ii )
+        printf( "  layer %3d %9.2f\n", layers[ii].second, layers[ii].first / aFrames.size() );
+}
+
+
+/**
+ * Compares the frames replayed with the coarse groups off and on.
+ */
+static void printCoarseComparison( const std::vector<FRAME>& aFull,
+                                   const std::vector<FRAME>& aCoarse, int aCoarsePixels )
+{
+    auto vertices = []( const FRAME& f ) { return (double) f.m_stats.m_vertexCount; };
+    auto time = []( const FRAME& f ) { return f.m_time; };
+
+    std::vector<double> fullTimes;
+    std::vector<double> coarseTimes;
+
+    for( const FRAME& frame : aFull )
+        fullTimes.push_back( frame.m_time );
+
+    for( const FRAME& frame : aCoarse )
+        coarseTimes.push_back( frame.m_time );
+
+    double fullVertices = mean( aFull, vertices );
+    double coarseVertices = mean( aCoarse, vertices );
+
+    printf( "Coarse groups below %d pixels, off -> on:\n", aCoarsePixels );
+    printf( "  vertices per frame  %12.0f -> %12.0f (%+.1f%%)\n", fullVertices, coarseVertices,
+            fullVertices > 0.0 ? 100.0 * ( coarseVertices / fullVertices - 1.0 ) : 0.0 );
+    printf( "  mean frame (ms)     %12.2f -> %12.2f\n", mean( aFull, time ),
+            mean( aCoarse, time ) );
+    printf( "  p90 frame (ms)      %12.2f -> %12.2f\n", percentile( fullTimes, 0.9 ),
+            percentile( coarseTimes, 0.9 ) );
+    printf( "  frames over budget  %12zu -> %12zu of %zu\n", lateFrameCount( aFull ),
+            lateFrameCount( aCoarse ), aCoarse.size() );
+    printf( "  60 fps target       %12s -> %12s\n",
+            lateFrameCount( aFull ) ? "missed" : "met",
+            lateFrameCount( aCoarse ) ? "missed" : "met" );
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "s", "script", _( "zoom and pan script to replay" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of times the script is replayed" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "W", "width", _( "viewport width in pixels" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "H", "height", _( "viewport height in pixels" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "p", "png", _( "file to write the last Cairo frame to" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "j", "threads",
+            _( "number of rasterizing threads, 0 for all the cores" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "P", "prepare-threads",
+            _( "number of threads preparing the items, 0 for all the cores" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_SWITCH, "g", "opengl",
+            _( "draw with the OpenGL GAL, in a window, instead of Cairo" ).mb_str() },
+    { wxCMD_LINE_OPTION, "c", "coarse-pixels",
+            _( "screen size below which cached items are drawn coarse, 0 to disable it" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_SWITCH, "C", "compare-coarse",
+            _( "replay with the coarse groups off, then on, and compare them" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "board file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum GAL_REPLAY_BENCH_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    BAD_SCRIPT,
+    NO_OPENGL,
+};
+
+
+/**
+ * Creates an OpenGL GAL in a window of the given client size.  The window is shown, as the
+ * GAL only draws when it is on screen.
+ *
+ * @return nullptr if OpenGL can't be used.
+ */
+static KIGFX::OPENGL_GAL* createOpenGlGal( KIGFX::GAL_DISPLAY_OPTIONS& aOptions, int aWidth,
+                                           int aHeight )
+{
+    wxString error = KIGFX::OPENGL_GAL::CheckFeatures( aOptions );
+
+    if( !error.IsEmpty() )
+    {
+        fprintf( stderr, "Could not use OpenGL: %s\n", TO_UTF8( error ) );
+        return nullptr;
+    }
+
+    wxFrame* frame = new wxFrame( nullptr, wxID_ANY, wxT( "gal_replay_bench" ) );
+
+    frame->SetClientSize( aWidth, aHeight );
+
+    KIGFX::OPENGL_GAL* gal = new KIGFX::OPENGL_GAL( aOptions, frame );
+
+    frame->Show();
+    wxYield();
+
+    gal->ResizeScreen( aWidth, aHeight );
+
+    return gal;
+}
+
+
+/**
+ * Replays the script from the whole board, which is drawn a first time and reported apart.
+ */
+static int replaySteps( KIGFX::VIEW& aView, KIGFX::GAL& aGal, const BOARD& aBoard,
+                        const std::vector<std::string>& aSteps, long aRepeat,
+                        std::vector<FRAME>& aFrames )
+{
+    applyStep( aView, aBoard, "fit" );
+    FRAME first = drawFrame( aView, aGal );
+
+    printf( "First frame: %.2f ms, update %.2f ms (%zu items, %.2f ms preparing them)\n",
+            first.m_time, first.m_stats.m_updateTime, first.m_stats.m_updatedItemCount,
+            first.m_stats.m_prepareTime );
+
+    for( long ii = 0; ii < std::max( aRepeat, 1L ); ++ii )
+    {
+        for( const std::string& step : aSteps )
+        {
+            if( !applyStep( aView, aBoard, step ) )
+            {
+                fprintf( stderr, "Invalid script step: %s\n", step.c_str() );
+                return BAD_SCRIPT;
+            }
+
+            aFrames.push_back( drawFrame( aView, aGal ) );
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+/**
+ * Replays the script over the board drawn with aGal, and prints the report.
+ *
+ * @param aCoarsePixels is the screen size below which cached items are drawn coarse.
+ * @param aCompareCoarse tells to replay the script with the coarse groups off, then on.
+ */
+static int replay( KIGFX::GAL& aGal, BOARD& aBoard, const std::vector<std::string>& aSteps,
+                   long aRepeat, long aPrepareThreads, int aCoarsePixels, bool aCompareCoarse )
+{
+    KIGFX::PCB_VIEW    view( true );
+    KIGFX::PCB_PAINTER painter( &aGal );
+    COLOR_SETTINGS     colors;
+
+    view.SetGAL( &aGal );
+    view.SetPainter( &painter );
+    view.SetPrepareThreadCount( std::max( aPrepareThreads, 0L ) );
+    painter.GetSettings()->LoadColors( &colors );
+
+    // Caching makes no sense for Cairo, see PCB_DRAW_PANEL_GAL::setDefaultLayerDeps()
+    if( !aGal.IsOpenGlEngine() )
+    {
+        for( int i = 0; i < KIGFX::VIEW::VIEW_MAX_LAYERS; i++ )
+            view.SetLayerTarget( i, KIGFX::TARGET_NONCACHED );
+    }
+
+    // Added as PCB_DRAW_PANEL_GAL::DisplayBoard() does
+    for( BOARD_ITEM* drawing : aBoard.Drawings() )
+        view.Add( drawing );
+
+    for( TRACK* track : aBoard.Tracks() )
+        view.Add( track );
+
+    for( MODULE* module : aBoard.Modules() )
+        view.Add( module );
+
+    for( ZONE_CONTAINER* zone : aBoard.Zones() )
+        view.Add( zone );
+
+    if( !aCompareCoarse )
+    {
+        std::vector<FRAME> frames;
+
+        view.SetCoarseItemPixels( aCoarsePixels );
+
+        int ret = replaySteps( view, aGal, aBoard, aSteps, aRepeat, frames );
+
+        if( ret == KI_TEST::RET_CODES::OK )
+            printReport( frames );
+
+        return ret;
+    }
+
+    std::vector<FRAME> fullFrames;
+    std::vector<FRAME> coarseFrames;
+
+    printf( "Coarse groups off\n" );
+    view.SetCoarseItemPixels( 0 );
+
+    int ret = replaySteps( view, aGal, aBoard, aSteps, aRepeat, fullFrames );
+
+    if( ret != KI_TEST::RET_CODES::OK )
+        return ret;
+
+    printReport( fullFrames );
+
+    // Cached again from scratch, so that both replays start from the same state
+    printf( "\nCoarse groups on\n" );
+    view.SetCoarseItemPixels( aCoarsePixels );
+    view.UpdateAllItems( KIGFX::ALL );
+
+    ret = replaySteps( view, aGal, aBoard, aSteps, aRepeat, coarseFrames );
+
+    if( ret != KI_TEST::RET_CODES::OK )
+        return ret;
+
+    printReport( coarseFrames );
+    printf( "\n" );
+    printCoarseComparison( fullFrames, coarseFrames, aCoarsePixels );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+int main( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program replays zoom and pan steps over a board drawn "
+                               "offscreen, and reports the percentiles of the frame costs. "
+                               "The board is read from stdin when no file is given." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     repeat = 3;
+    long     width = 1920;
+    long     height = 1080;
+    long     threads = 0;
+    long     prepareThreads = 0;
+    long     coarsePixels = ADVANCED_CFG::GetCfg().m_CoarseItemPixels;
+    wxString scriptFile;
+    wxString pngFile;
+
+    cl_parser.Found( "repeat", &repeat );
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+    cl_parser.Found( "script", &scriptFile );
+    cl_parser.Found( "png", &pngFile );
+    cl_parser.Found( "threads", &threads );
+    cl_parser.Found( "prepare-threads", &prepareThreads );
+    cl_parser.Found( "coarse-pixels", &coarsePixels );
+
+    bool compareCoarse = cl_parser.Found( "compare-coarse" );
+
+    // Only the OpenGL GAL caches the items, and so has coarse variants of them
+    if( compareCoarse && !cl_parser.Found( "opengl" ) )
+    {
+        fprintf( stderr, "--compare-coarse needs --opengl\n" );
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    if( compareCoarse && coarsePixels <= 0 )
+    {
+        fprintf( stderr, "--compare-coarse needs --coarse-pixels above 0\n" );
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    width = std::max( width, 1L );
+    height = std::max( height, 1L );
+
+    std::string filename;
+
+    if( cl_parser.GetParamCount() )
+        filename = cl_parser.GetParam( 0 ).ToStdString();
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !board )
+        return LOAD_FAILED;
+
+    std::vector<std::string> steps = readScript( scriptFile );
+
+    if( steps.empty() )
+        return BAD_SCRIPT;
+
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+
+    if( cl_parser.Found( "opengl" ) )
+    {
+        // The OpenGL GAL needs a window, and so the GUI
+        wxApp::SetInstance( new wxApp() );
+
+        if( !wxEntryStart( argc, argv ) )
+            return NO_OPENGL;
+
+        KIGFX::OPENGL_GAL* gal = createOpenGlGal( options, width, height );
+        int                ret = NO_OPENGL;
+
+        if( gal )
+        {
+            ret = replay( *gal, *board, steps, repeat, prepareThreads, (int) coarsePixels,
+                          compareCoarse );
+            gal->GetParent()->Destroy();
+        }
+
+        wxEntryCleanup();
+        return ret;
+    }
+
+    OFFSCREEN_CAIRO_GAL gal( options, width, height );
+
+    gal.SetRasterThreadCount( std::max( threads, 0L ) );
+
+    int ret = replay( gal, *board, steps, repeat, prepareThreads, (int) coarsePixels, false );
+
+    if( ret == KI_TEST::RET_CODES::OK && !pngFile.IsEmpty()
+            && !gal.WritePng( pngFile.ToStdString() ) )
+    {
+        fprintf( stderr, "Could not write %s\n", TO_UTF8( pngFile ) );
+    }
+
+    return ret;
+}
\ No newline at end of file
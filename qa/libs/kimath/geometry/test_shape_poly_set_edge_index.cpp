@@ -0,0 +1,305 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_edge_index.cpp
+ * Checks that the queries answered through the SHAPE_POLY_SET edge index give the same
+ * results as walking all of the edges.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <climits>
+#include <random>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+/**
+ * A plane with square and diamond shaped holes, and islands inside some of the holes, on a
+ * coarse grid so that many of the query points fall exactly on edges and vertices.
+ */
+struct EDGE_INDEX_FIXTURE
+{
+    EDGE_INDEX_FIXTURE() :
+            m_rng( 1234 )
+    {
+        m_threshold = SHAPE_POLY_SET::GetEdgeIndexThreshold();
+
+        SHAPE_POLY_SET holes;
+        SHAPE_POLY_SET islands;
+
+        m_polySet.AddOutline( rect( 0, 0, 2000, 1500 ) );
+
+        for( int x = 100; x < 1900; x += 150 )
+        {
+            for( int y = 100; y < 1400; y += 150 )
+            {
+                if( ( x + y ) % 300 )
+                {
+                    holes.AddOutline( rect( x, y, 100, 100 ) );
+                    islands.AddOutline( rect( x + 30, y + 30, 40, 40 ) );
+                }
+                else
+                {
+                    holes.AddOutline( diamond( x + 50, y + 50, 60 ) );
+                }
+            }
+        }
+
+        m_polySet.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+        m_polySet.BooleanAdd( islands, SHAPE_POLY_SET::PM_FAST );
+
+        for( int ii = 0; ii < 2000; ii++ )
+        {
+            m_points.push_back( randomPoint() );
+            m_segs.emplace_back( randomPoint(), randomPoint() );
+
+            // Short segments as well, mostly missing all edges
+            m_segs.emplace_back( m_points.back(), m_points.back() + VECTOR2I( 7, 3 ) );
+        }
+    }
+
+    ~EDGE_INDEX_FIXTURE()
+    {
+        SHAPE_POLY_SET::SetEdgeIndexThreshold( m_threshold );
+    }
+
+    static SHAPE_LINE_CHAIN rect( int aX, int aY, int aW, int aH )
+    {
+        SHAPE_LINE_CHAIN chain( { VECTOR2I( aX, aY ), VECTOR2I( aX + aW, aY ),
+                                  VECTOR2I( aX + aW, aY + aH ), VECTOR2I( aX, aY + aH ) } );
+        chain.SetClosed( true );
+        return chain;
+    }
+
+    static SHAPE_LINE_CHAIN diamond( int aX, int aY, int aR )
+    {
+        SHAPE_LINE_CHAIN chain( { VECTOR2I( aX - aR, aY ), VECTOR2I( aX, aY - aR ),
+                                  VECTOR2I( aX + aR, aY ), VECTOR2I( aX, aY + aR ) } );
+        chain.SetClosed( true );
+        return chain;
+    }
+
+    VECTOR2I randomPoint()
+    {
+        std::uniform_int_distribution<int> xDist( -10, 201 );
+        std::uniform_int_distribution<int> yDist( -10, 151 );
+
+        return VECTOR2I( xDist( m_rng ) * 10, yDist( m_rng ) * 10 );
+    }
+
+    /**
+     * Returns the answers of aPolySet to all of the queries.  Whether they go through the edge
+     * index depends on the threshold when the set reaches the query count to build it.
+     */
+    std::vector<SEG::ecoord> answers( const SHAPE_POLY_SET& aPolySet ) const
+    {
+        std::vector<SEG::ecoord> results;
+
+        for( const VECTOR2I& pt : m_points )
+        {
+            results.push_back( aPolySet.Contains( pt ) );
+            results.push_back( aPolySet.Contains( pt, -1, 15 ) );
+            results.push_back( aPolySet.SquaredDistance( pt ) );
+
+            for( int ii = 0; ii < aPolySet.OutlineCount(); ii += 7 )
+            {
+                results.push_back( aPolySet.Contains( pt, ii ) );
+                results.push_back( aPolySet.SquaredDistanceToPolygon( pt, ii, nullptr ) );
+            }
+        }
+
+        for( const SEG& seg : m_segs )
+        {
+            results.push_back( aPolySet.SquaredDistance( seg ) );
+            results.push_back( aPolySet.Collide( seg, 25 ) );
+        }
+
+        return results;
+    }
+
+    ///> Checks that an indexed copy of aPolySet answers like aPolySet walking its edges
+    void checkIndexedMatchesLinear( const SHAPE_POLY_SET& aPolySet )
+    {
+        SHAPE_POLY_SET::SetEdgeIndexThreshold( INT_MAX );
+
+        SHAPE_POLY_SET           linearSet = aPolySet;
+        std::vector<SEG::ecoord> expected = answers( linearSet );
+
+        SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+
+        SHAPE_POLY_SET           indexedSet = aPolySet;
+        std::vector<SEG::ecoord> actual = answers( indexedSet );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                       expected.end() );
+    }
+
+    SHAPE_POLY_SET        m_polySet;
+    std::vector<VECTOR2I> m_points;
+    std::vector<SEG>      m_segs;
+    std::mt19937          m_rng;
+    int                   m_threshold;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SPSEdgeIndex, EDGE_INDEX_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsLinear )
+{
+    BOOST_REQUIRE_GT( m_polySet.OutlineCount(), 1 );
+    BOOST_REQUIRE_GT( m_polySet.HoleCount( 0 ), 1 );
+
+    checkIndexedMatchesLinear( m_polySet );
+}
+
+
+BOOST_AUTO_TEST_CASE( Fractured )
+{
+    // Fracturing makes long bridge edges between the holes and the outline
+    SHAPE_POLY_SET fractured = m_polySet;
+    fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    checkIndexedMatchesLinear( fractured );
+}
+
+
+BOOST_AUTO_TEST_CASE( BBoxCaches )
+{
+    // Both paths must skip the outlines whose cached bounding box misses the point
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( INT_MAX );
+
+    SHAPE_POLY_SET linearSet = m_polySet;
+    linearSet.BuildBBoxCaches();
+
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+
+    SHAPE_POLY_SET indexedSet = m_polySet;
+    indexedSet.BuildBBoxCaches();
+    answers( indexedSet );
+
+    for( const VECTOR2I& pt : m_points )
+    {
+        BOOST_CHECK_EQUAL( indexedSet.Contains( pt, -1, 0, true ),
+                           linearSet.Contains( pt, -1, 0, true ) );
+        BOOST_CHECK_EQUAL( indexedSet.Contains( pt, -1, 15, true ),
+                           linearSet.Contains( pt, -1, 15, true ) );
+        BOOST_CHECK_EQUAL( indexedSet.Contains( pt, 0, 0, true ),
+                           linearSet.Contains( pt, 0, 0, true ) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( EditsInvalidate )
+{
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+
+    SHAPE_POLY_SET indexedSet = m_polySet;
+    answers( indexedSet );
+
+    // Copies share the index until one of them is edited
+    SHAPE_POLY_SET copy = indexedSet;
+
+    indexedSet.Move( VECTOR2I( 35, -20 ) );
+    copy.Outline( 0 ).SetPoint( 0, VECTOR2I( -50, -50 ) );
+
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( INT_MAX );
+
+    SHAPE_POLY_SET moved = m_polySet;
+    moved.Move( VECTOR2I( 35, -20 ) );
+
+    SHAPE_POLY_SET edited = m_polySet;
+    edited.Outline( 0 ).SetPoint( 0, VECTOR2I( -50, -50 ) );
+
+    std::vector<SEG::ecoord> expectedMoved = answers( moved );
+    std::vector<SEG::ecoord> expectedEdited = answers( edited );
+
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+
+    std::vector<SEG::ecoord> actualMoved = answers( indexedSet );
+    std::vector<SEG::ecoord> actualEdited = answers( copy );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( actualMoved.begin(), actualMoved.end(),
+                                   expectedMoved.begin(), expectedMoved.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( actualEdited.begin(), actualEdited.end(),
+                                   expectedEdited.begin(), expectedEdited.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( EditsThroughHeldReferences )
+{
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+
+    // References taken before the set is indexed, and only read until it is
+    SHAPE_POLY_SET           indexedSet = m_polySet;
+    SHAPE_LINE_CHAIN&        outline = indexedSet.Outline( 0 );
+    SHAPE_LINE_CHAIN&        hole = indexedSet.Hole( 0, 3 );
+    SHAPE_POLY_SET::POLYGON& island = indexedSet.Polygon( 1 );
+    VECTOR2I                 islandCentre = island.front().BBox().Centre();
+
+    BOOST_REQUIRE_EQUAL( island.size(), 1 );
+    answers( indexedSet );
+
+    // The same edits are made on a set walking its edges
+    SHAPE_POLY_SET linearSet = m_polySet;
+
+    auto checkSame =
+            [&]( const SHAPE_POLY_SET& aIndexedSet )
+            {
+                SHAPE_POLY_SET::SetEdgeIndexThreshold( INT_MAX );
+                std::vector<SEG::ecoord> expected = answers( linearSet );
+
+                SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+                std::vector<SEG::ecoord> actual = answers( aIndexedSet );
+
+                BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                               expected.end() );
+            };
+
+    outline.SetPoint( 0, VECTOR2I( -50, -50 ) );
+    linearSet.Outline( 0 ).SetPoint( 0, VECTOR2I( -50, -50 ) );
+    checkSame( indexedSet );
+
+    hole.Move( VECTOR2I( 20, 10 ) );
+    linearSet.Hole( 0, 3 ).Move( VECTOR2I( 20, 10 ) );
+    checkSame( indexedSet );
+
+    island.push_back( diamond( islandCentre.x, islandCentre.y, 10 ) );
+    linearSet.Polygon( 1 ).push_back( diamond( islandCentre.x, islandCentre.y, 10 ) );
+    checkSame( indexedSet );
+
+    // Copies don't take over an out of date index
+    SHAPE_POLY_SET copy = indexedSet;
+    checkSame( copy );
+
+    // Fetching a reference again drops the out of date index, and a new one gets built
+    indexedSet.Outline( 0 );
+    checkSame( indexedSet );
+    checkSame( indexedSet );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
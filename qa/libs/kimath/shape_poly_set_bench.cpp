@@ -0,0 +1,208 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Benchmark for the SHAPE_POLY_SET point and segment queries.
+ *
+ * Times Contains(), SquaredDistance() and Collide() on polygons of growing edge counts, once
+ * walking all of the edges and once through the edge index, to find the edge count from which
+ * the index pays off (see SHAPE_POLY_SET::SetEdgeIndexThreshold()).
+ *
+ * Usage: shape_poly_set_bench [queries per size]
+ */
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <geometry/shape_poly_set.h>
+
+#include <profile.h>
+
+
+/**
+ * A jagged disc with small octagonal holes, about aEdgeCount edges in all, like a zone fill
+ * cut around pads and vias.
+ */
+static SHAPE_POLY_SET buildPolySet( int aEdgeCount, std::mt19937& aRng )
+{
+    const int    radius = 50000000;       // 50mm
+    const int    holeEdges = aEdgeCount / 4;
+    const int    outlineEdges = std::max( 4, aEdgeCount - holeEdges );
+    SHAPE_POLY_SET polySet;
+
+    // Notches about as deep as the edges are long
+    double                                 edgeLength = 2.0 * M_PI * radius / outlineEdges;
+    std::uniform_real_distribution<double> depth( 0.0, edgeLength );
+
+    polySet.NewOutline();
+
+    for( int ii = 0; ii < outlineEdges; ii++ )
+    {
+        double angle = 2.0 * M_PI * ii / outlineEdges;
+        double r = radius - ( ii % 2 ? 0.0 : depth( aRng ) );
+
+        polySet.Append( KiROUND( r * cos( angle ) ), KiROUND( r * sin( angle ) ) );
+    }
+
+    int holeCount = holeEdges / 8;
+    int side = std::ceil( std::sqrt( holeCount ) );
+
+    for( int ii = 0; ii < holeCount; ii++ )
+    {
+        // Spread the holes over a square well inside the outline
+        int cx = ( 2 * ( ii % side ) + 1 - side ) * ( radius / 2 ) / side;
+        int cy = ( 2 * ( ii / side ) + 1 - side ) * ( radius / 2 ) / side;
+        int r = radius / side / 4;
+
+        polySet.NewHole();
+
+        for( int jj = 0; jj < 8; jj++ )
+        {
+            double angle = 2.0 * M_PI * jj / 8;
+            polySet.Append( cx + KiROUND( r * cos( angle ) ), cy + KiROUND( r * sin( angle ) ),
+                            -1, polySet.HoleCount( 0 ) - 1 );
+        }
+    }
+
+    return polySet;
+}
+
+
+struct TIMINGS
+{
+    double contains = 0.0;
+    double distance = 0.0;
+    double collide = 0.0;
+    long   hits = 0;            ///< checksum, so that the queries can't be optimized away
+};
+
+
+static TIMINGS runQueries( const SHAPE_POLY_SET& aPolySet, const std::vector<VECTOR2I>& aPoints,
+                           const std::vector<SEG>& aSegs )
+{
+    TIMINGS timings;
+    int     count = aPoints.size();
+
+    PROF_COUNTER containsTimer;
+
+    for( const VECTOR2I& pt : aPoints )
+        timings.hits += aPolySet.Contains( pt );
+
+    containsTimer.Stop();
+
+    PROF_COUNTER distanceTimer;
+
+    for( const VECTOR2I& pt : aPoints )
+        timings.hits += aPolySet.SquaredDistance( pt ) > 0;
+
+    distanceTimer.Stop();
+
+    PROF_COUNTER collideTimer;
+
+    for( const SEG& seg : aSegs )
+        timings.hits += aPolySet.Collide( seg, 200000 );
+
+    collideTimer.Stop();
+
+    timings.contains = containsTimer.msecs() * 1e6 / count;
+    timings.distance = distanceTimer.msecs() * 1e6 / count;
+    timings.collide = collideTimer.msecs() * 1e6 / aSegs.size();
+
+    return timings;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    int          queries = argc > 1 ? atoi( argv[1] ) : 20000;
+    std::mt19937 rng( 42 );
+    int          defaultThreshold = SHAPE_POLY_SET::GetEdgeIndexThreshold();
+    int          crossover = -1;
+
+    printf( "%8s %10s | %-26s | %-26s | %-26s\n", "edges", "build us",
+            "contains ns (lin / idx)", "distance ns (lin / idx)", "collide ns (lin / idx)" );
+
+    for( int edges = 8; edges <= 131072; edges *= 2 )
+    {
+        SHAPE_POLY_SET polySet = buildPolySet( edges, rng );
+        BOX2I          bbox = polySet.BBox();
+
+        std::uniform_int_distribution<int> xDist( bbox.GetX(), bbox.GetRight() );
+        std::uniform_int_distribution<int> yDist( bbox.GetY(), bbox.GetBottom() );
+        std::uniform_int_distribution<int> dDist( -500000, 500000 );
+
+        std::vector<VECTOR2I> points;
+        std::vector<SEG>      segs;
+
+        for( int ii = 0; ii < queries; ii++ )
+        {
+            points.emplace_back( xDist( rng ), yDist( rng ) );
+            segs.emplace_back( points.back(), points.back() + VECTOR2I( dDist( rng ),
+                                                                        dDist( rng ) ) );
+        }
+
+        // Never indexed
+        SHAPE_POLY_SET::SetEdgeIndexThreshold( INT_MAX );
+        SHAPE_POLY_SET linearSet = polySet;
+        TIMINGS        linear = runQueries( linearSet, points, segs );
+
+        // Indexed; a handful of queries trigger the build, which is timed on its own
+        SHAPE_POLY_SET::SetEdgeIndexThreshold( 0 );
+        SHAPE_POLY_SET indexedSet = polySet;
+        PROF_COUNTER   buildTimer;
+
+        for( int ii = 0; ii < 64; ii++ )
+            indexedSet.Contains( points[ii % points.size()] );
+
+        buildTimer.Stop();
+
+        TIMINGS indexed = runQueries( indexedSet, points, segs );
+
+        if( linear.hits != indexed.hits )
+            printf( "Mismatch: %ld linear hits, %ld indexed hits\n", linear.hits, indexed.hits );
+
+        printf( "%8d %10.1f | %11.1f / %11.1f | %11.1f / %11.1f | %11.1f / %11.1f\n",
+                polySet.TotalVertices(), buildTimer.msecs() * 1e3, linear.contains,
+                indexed.contains, linear.distance, indexed.distance, linear.collide,
+                indexed.collide );
+
+        bool faster = indexed.contains < linear.contains && indexed.distance < linear.distance
+                      && indexed.collide < linear.collide;
+
+        if( faster && crossover < 0 )
+            crossover = polySet.TotalVertices();
+        else if( !faster )
+            crossover = -1;
+    }
+
+    SHAPE_POLY_SET::SetEdgeIndexThreshold( defaultThreshold );
+
+    printf( "Index faster for all queries from %d edges (current threshold: %d)\n", crossover,
+            defaultThreshold );
+
+    return 0;
+}
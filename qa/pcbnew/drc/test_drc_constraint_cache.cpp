@@ -0,0 +1,208 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc_constraint_cache.cpp
+ * Checks that the constraints resolved through the DRC_ENGINE cache are the same as the
+ * uncached ones, with rules whose conditions look at more than the nets of the items.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <pcbnew_utils/board_construction_utils.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <netinfo.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_rule.h>
+
+
+/**
+ * Tracks and vias of two nets, some of them inside the courtyard of U1, and rules on the
+ * net, the courtyard and the type of the items.
+ */
+struct DRC_CONSTRAINT_CACHE_FIXTURE
+{
+    DRC_CONSTRAINT_CACHE_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        m_board.Add( new NETINFO_ITEM( &m_board, "SIG", 1 ) );
+        m_board.Add( new NETINFO_ITEM( &m_board, "HV", 2 ) );
+
+        MODULE* footprint = new MODULE( &m_board );
+
+        KI_TEST::DrawRect( *footprint, { 0, 0 },
+                           { Millimeter2iu( 10 ), Millimeter2iu( 10 ) }, 0,
+                           Millimeter2iu( 0.1 ), F_CrtYd );
+        footprint->SetReference( "U1" );
+        footprint->SetPosition( wxPoint( 0, 0 ) );
+        footprint->BuildPolyCourtyard();
+        m_board.Add( footprint );
+
+        // Inside and outside of the courtyard, on each net
+        for( int net = 1; net <= 2; ++net )
+        {
+            for( int x : { 0, 20 } )
+            {
+                wxPoint pos( Millimeter2iu( x ), Millimeter2iu( net ) );
+                TRACK*  track = new TRACK( &m_board );
+
+                track->SetLayer( F_Cu );
+                track->SetNetCode( net );
+                track->SetWidth( Millimeter2iu( 0.25 ) );
+                track->SetStart( pos );
+                track->SetEnd( pos + wxPoint( Millimeter2iu( 2 ), 0 ) );
+                m_board.Add( track );
+                m_items.push_back( track );
+
+                VIA* via = new VIA( &m_board );
+
+                via->SetNetCode( net );
+                via->SetPosition( pos - wxPoint( 0, Millimeter2iu( 3 ) ) );
+                via->SetWidth( Millimeter2iu( 0.6 ) );
+                via->SetDrill( Millimeter2iu( 0.3 ) );
+                via->SetLayerPair( F_Cu, B_Cu );
+                m_board.Add( via );
+                m_items.push_back( via );
+            }
+        }
+
+        // The last matching rule wins, so the net rule is checked first and the others are
+        // only reached for the SIG items
+        wxFileName rulesFile( wxFileName::CreateTempFileName( "drc_rules" ) );
+        wxFFile    file( rulesFile.GetFullPath(), "w" );
+
+        file.Write( "(version 1)\n"
+                    "(rule vias\n"
+                    "   (constraint clearance (min 0.3mm))\n"
+                    "   (condition \"A.Type == 'Via'\"))\n"
+                    "(rule neckdown\n"
+                    "   (constraint clearance (min 0.05mm))\n"
+                    "   (condition \"A.insideCourtyard('U1')\"))\n"
+                    "(rule HV\n"
+                    "   (constraint clearance (min 1.5mm))\n"
+                    "   (condition \"A.NetName == 'HV'\"))\n" );
+        file.Close();
+
+        m_engine.InitEngine( rulesFile );
+        wxRemoveFile( rulesFile.GetFullPath() );
+
+        BOOST_REQUIRE( m_engine.RulesValid() );
+    }
+
+    ///> The clearance and rule name resolved for every ordered pair of items
+    std::vector<std::pair<int, wxString>> resolveAll()
+    {
+        std::vector<std::pair<int, wxString>> result;
+
+        for( BOARD_ITEM* a : m_items )
+        {
+            for( BOARD_ITEM* b : m_items )
+            {
+                DRC_CONSTRAINT constraint = m_engine.EvalRulesForItems(
+                        DRC_CONSTRAINT_TYPE_CLEARANCE, a, b, F_Cu );
+
+                result.emplace_back( constraint.GetValue().Min(), constraint.GetName() );
+            }
+        }
+
+        return result;
+    }
+
+    BOARD                    m_board;
+    DRC_ENGINE               m_engine;
+    std::vector<BOARD_ITEM*> m_items;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCConstraintCache, DRC_CONSTRAINT_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( CachedMatchesUncached )
+{
+    std::vector<std::pair<int, wxString>> uncached = resolveAll();
+
+    m_engine.SetConstraintCacheEnabled( true );
+
+    // The second pass is served from the entries of the first one wherever it can
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        BOOST_TEST_CONTEXT( "Pass " << pass )
+        {
+            std::vector<std::pair<int, wxString>> cached = resolveAll();
+
+            BOOST_REQUIRE_EQUAL( cached.size(), uncached.size() );
+
+            for( size_t ii = 0; ii < cached.size(); ++ii )
+            {
+                BOOST_CHECK_EQUAL( cached[ii].first, uncached[ii].first );
+                BOOST_CHECK( cached[ii].second == uncached[ii].second );
+            }
+        }
+    }
+
+    DRC_ENGINE::CONSTRAINT_CACHE_STATS stats = m_engine.GetConstraintCacheStats();
+
+    // The HV items match their rule before any item-dependent condition is looked at
+    BOOST_CHECK_GT( stats.m_hits, 0u );
+    BOOST_CHECK_GT( stats.m_uncacheable, 0u );
+
+    m_engine.SetConstraintCacheEnabled( false );
+}
+
+
+BOOST_AUTO_TEST_CASE( ItemDependentRules )
+{
+    m_engine.SetConstraintCacheEnabled( true );
+
+    // Twice, so that a wrongly cached result would show up the second time
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        for( BOARD_ITEM* item : m_items )
+        {
+            DRC_CONSTRAINT constraint = m_engine.EvalRulesForItems(
+                    DRC_CONSTRAINT_TYPE_CLEARANCE, item, nullptr, F_Cu );
+            int            expected;
+
+            if( static_cast<BOARD_CONNECTED_ITEM*>( item )->GetNetname() == "HV" )
+                expected = Millimeter2iu( 1.5 );
+            else if( item->Type() == PCB_VIA_T )
+                expected = Millimeter2iu( 0.3 );
+            else if( item->GetPosition().x < Millimeter2iu( 5 ) )
+                expected = Millimeter2iu( 0.05 );
+            else
+                expected = m_board.GetDesignSettings().GetDefault()->GetClearance();
+
+            BOOST_CHECK_EQUAL( constraint.GetValue().Min(), expected );
+        }
+    }
+
+    m_engine.SetConstraintCacheEnabled( false );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
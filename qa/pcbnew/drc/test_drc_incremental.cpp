@@ -0,0 +1,235 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc_incremental.cpp
+ * Checks that the markers kept and replaced by incremental DRC runs, the way DRC_TOOL does
+ * it, are the same as the ones of a complete run.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <netinfo.h>
+#include <drc/drc_item.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_test_provider.h>
+
+
+/**
+ * A violation as recorded by a marker: its error code and the ids of its items, in order.
+ */
+using VIOLATION = std::tuple<int, KIID, KIID>;
+
+
+/**
+ * Two pairs of tracks, one of them too close together, and a via between them.
+ */
+struct DRC_INCREMENTAL_FIXTURE
+{
+    DRC_INCREMENTAL_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        for( int net = 1; net <= 5; ++net )
+            m_board.Add( new NETINFO_ITEM( &m_board, wxString::Format( "N%d", net ), net ) );
+
+        m_tracks.push_back( addTrack( 1, 0 ) );
+        m_tracks.push_back( addTrack( 2, 2 ) );
+        m_tracks.push_back( addTrack( 3, 20 ) );
+        m_tracks.push_back( addTrack( 4, 20.3 ) );
+
+        m_via = new VIA( &m_board );
+        m_via->SetViaType( VIATYPE::THROUGH );
+        m_via->SetLayerPair( F_Cu, B_Cu );
+        m_via->SetWidth( Millimeter2iu( 0.8 ) );
+        m_via->SetDrill( Millimeter2iu( 0.4 ) );
+        m_via->SetPosition( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 10 ) ) );
+        m_via->SetNetCode( 5 );
+        m_board.Add( m_via );
+
+        m_board.BuildConnectivity();
+
+        // The first run is a complete one, as in DRC_TOOL
+        m_engine.InitEngine( wxFileName() );
+        m_engine.SetViolationHandler(
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+                {
+                    m_markers.push_back( aItem );
+                } );
+        m_engine.RunTests();
+    }
+
+    ///> Adds a horizontal track, 20mm long, at the given height (in mm)
+    TRACK* addTrack( int aNet, double aY )
+    {
+        TRACK* track = new TRACK( &m_board );
+
+        track->SetLayer( F_Cu );
+        track->SetNetCode( aNet );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetStart( wxPoint( 0, Millimeter2iu( aY ) ) );
+        track->SetEnd( wxPoint( Millimeter2iu( 20 ), Millimeter2iu( aY ) ) );
+        m_board.Add( track );
+
+        return track;
+    }
+
+    ///> Moves an item by the given offset (in mm)
+    void moveItem( BOARD_ITEM* aItem, double aDx, double aDy )
+    {
+        aItem->Move( wxPoint( Millimeter2iu( aDx ), Millimeter2iu( aDy ) ) );
+        m_board.BuildConnectivity();
+    }
+
+    static VIOLATION violation( const std::shared_ptr<DRC_ITEM>& aItem )
+    {
+        KIID mainId = aItem->GetMainItemID();
+        KIID auxId = aItem->GetAuxItemID();
+
+        // An incremental run may find the pair from the other side
+        if( auxId < mainId )
+            std::swap( mainId, auxId );
+
+        return VIOLATION( aItem->GetErrorCode(), mainId, auxId );
+    }
+
+    ///> The violations of a complete run on a fresh engine
+    std::multiset<VIOLATION> completeRun()
+    {
+        std::multiset<VIOLATION> violations;
+        DRC_ENGINE               engine( &m_board, &m_board.GetDesignSettings() );
+
+        engine.InitEngine( wxFileName() );
+        engine.SetViolationHandler(
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+                {
+                    violations.insert( violation( aItem ) );
+                } );
+        engine.RunTests();
+
+        return violations;
+    }
+
+    /**
+     * Runs the tests again for the changed items, replacing the markers the way DRC_TOOL
+     * does, and checks the result against a complete run.
+     */
+    void checkIncrementalRun( const std::vector<BOARD_ITEM*>& aDirtyItems,
+                              const std::set<KIID>& aRemovedItems = {} )
+    {
+        std::set<KIID> staleIds = aRemovedItems;
+
+        for( BOARD_ITEM* item : aDirtyItems )
+            staleIds.insert( item->m_Uuid );
+
+        m_markers.erase( std::remove_if( m_markers.begin(), m_markers.end(),
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem )
+                {
+                    return !aItem->GetViolatingTest()
+                            || !aItem->GetViolatingTest()->SupportsIncremental()
+                            || staleIds.count( aItem->GetMainItemID() )
+                            || staleIds.count( aItem->GetAuxItemID() );
+                } ),
+                m_markers.end() );
+
+        // The providers are shared, and were last attached to the engine of a complete run
+        m_engine.InitEngine( wxFileName() );
+        m_engine.RunIncrementalTests( EDA_UNITS::MILLIMETRES, aDirtyItems, aRemovedItems );
+
+        std::multiset<VIOLATION> violations;
+
+        for( const std::shared_ptr<DRC_ITEM>& item : m_markers )
+            violations.insert( violation( item ) );
+
+        BOOST_CHECK( violations == completeRun() );
+    }
+
+    ///> The number of clearance violations between the given items in the markers
+    int clearanceCount( const BOARD_ITEM* aItem, const BOARD_ITEM* aOther ) const
+    {
+        return std::count_if( m_markers.begin(), m_markers.end(),
+                [&]( const std::shared_ptr<DRC_ITEM>& aMarker )
+                {
+                    KIID mainId = aMarker->GetMainItemID();
+                    KIID auxId = aMarker->GetAuxItemID();
+
+                    return aMarker->GetErrorCode() == DRCE_CLEARANCE
+                           && ( ( mainId == aItem->m_Uuid && auxId == aOther->m_Uuid )
+                                || ( mainId == aOther->m_Uuid && auxId == aItem->m_Uuid ) );
+                } );
+    }
+
+    BOARD                                  m_board;
+    DRC_ENGINE                             m_engine;
+    std::vector<TRACK*>                    m_tracks;
+    VIA*                                   m_via;
+    std::vector<std::shared_ptr<DRC_ITEM>> m_markers;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCIncremental, DRC_INCREMENTAL_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( EditedItems )
+{
+    BOOST_CHECK( m_markers.size() > 0 );
+    BOOST_CHECK_EQUAL( clearanceCount( m_tracks[2], m_tracks[3] ), 1 );
+
+    // Moving a track next to another adds a violation, and keeps the one of the other pair
+    moveItem( m_tracks[1], 0, -1.7 );
+    checkIncrementalRun( { m_tracks[1] } );
+
+    BOOST_CHECK_EQUAL( clearanceCount( m_tracks[0], m_tracks[1] ), 1 );
+    BOOST_CHECK_EQUAL( clearanceCount( m_tracks[2], m_tracks[3] ), 1 );
+
+    // The via moved close to a track of the other pair
+    moveItem( m_via, 0, 9.3 );
+    checkIncrementalRun( { m_via } );
+
+    BOOST_CHECK_EQUAL( clearanceCount( m_via, m_tracks[2] ), 1 );
+
+    // Removing a track drops its violations
+    TRACK* removed = m_tracks[3];
+
+    m_board.Remove( removed );
+    m_board.BuildConnectivity();
+    checkIncrementalRun( {}, { removed->m_Uuid } );
+
+    BOOST_CHECK_EQUAL( clearanceCount( m_tracks[2], removed ), 0 );
+    delete removed;
+
+    // Moving the first track back fixes its violation
+    moveItem( m_tracks[1], 0, 1.7 );
+    checkIncrementalRun( { m_tracks[1] } );
+
+    BOOST_CHECK_EQUAL( clearanceCount( m_tracks[0], m_tracks[1] ), 0 );
+    BOOST_CHECK_EQUAL( clearanceCount( m_via, m_tracks[2] ), 1 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
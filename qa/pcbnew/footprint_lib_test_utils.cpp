@@ -0,0 +1,91 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+ */
+
+#include "footprint_lib_test_utils.h"
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <boost/test/unit_test.hpp>
+
+
+namespace KI_TEST
+{
+
+TEMP_FOOTPRINT_LIB::TEMP_FOOTPRINT_LIB()
+{
+    m_rootDir = wxFileName::CreateTempFileName( "fp_lib" );
+    wxRemoveFile( m_rootDir );
+    wxFileName::Mkdir( m_rootDir );
+
+    m_libDir = m_rootDir + "/test.pretty";
+    wxFileName::Mkdir( m_libDir );
+}
+
+
+TEMP_FOOTPRINT_LIB::~TEMP_FOOTPRINT_LIB()
+{
+    wxFileName::Rmdir( m_rootDir, wxPATH_RMDIR_RECURSIVE );
+}
+
+
+wxString TEMP_FOOTPRINT_LIB::FileName( const wxString& aName ) const
+{
+    return m_libDir + "/" + aName + ".kicad_mod";
+}
+
+
+void TEMP_FOOTPRINT_LIB::WriteFile( const wxString& aName, const wxString& aText )
+{
+    wxFFile file( FileName( aName ), "wb" );
+    BOOST_REQUIRE( file.IsOpened() && file.Write( aText ) );
+}
+
+
+void TEMP_FOOTPRINT_LIB::WriteFootprint( const wxString& aName, const wxString& aDescription,
+                                         int aPadCount )
+{
+    wxString text = wxString::Format( "(module %s (layer F.Cu) (tedit 5F000000)\n"
+                                      "  (descr \"%s\")\n"
+                                      "  (tags \"resistor\")\n",
+                                      aName, aDescription );
+
+    for( int ii = 1; ii <= aPadCount; ++ii )
+    {
+        text += wxString::Format( "  (pad %d smd rect (at %d 0) (size 1 1) (layers F.Cu))\n",
+                                  ii, 2 * ii );
+    }
+
+    text += ")\n";
+
+    WriteFile( aName, text );
+}
+
+
+void TEMP_FOOTPRINT_LIB::SetFileTime( const wxString& aName, const wxDateTime& aTime )
+{
+    BOOST_REQUIRE( wxFileName( FileName( aName ) ).SetTimes( nullptr, &aTime, nullptr ) );
+}
+
+} // namespace KI_TEST
@@ -0,0 +1,78 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+ */
+
+/**
+ * @file footprint_lib_test_utils.h
+ * Utilities for tests working on footprint library files
+ */
+
+#ifndef QA_PCBNEW_FOOTPRINT_LIB_TEST_UTILS__H
+#define QA_PCBNEW_FOOTPRINT_LIB_TEST_UTILS__H
+
+#include <wx/datetime.h>
+#include <wx/string.h>
+
+
+namespace KI_TEST
+{
+/**
+ * A KiCad footprint library (a .pretty directory) in a new temporary directory, removed
+ * with everything in it when the object is destroyed.
+ *
+ * Other files related to the library, such as its index, can go in GetRootDir().
+ */
+class TEMP_FOOTPRINT_LIB
+{
+public:
+    TEMP_FOOTPRINT_LIB();
+    ~TEMP_FOOTPRINT_LIB();
+
+    ///> The temporary directory holding the library
+    const wxString& GetRootDir() const { return m_rootDir; }
+
+    ///> The path of the library itself
+    const wxString& GetPath() const { return m_libDir; }
+
+    ///> Returns the full path of the file of footprint aName
+    wxString FileName( const wxString& aName ) const;
+
+    ///> Writes aText to the file of footprint aName
+    void WriteFile( const wxString& aName, const wxString& aText );
+
+    ///> Writes a footprint with the given description, "resistor" as keyword and aPadCount
+    ///> SMD pads
+    void WriteFootprint( const wxString& aName, const wxString& aDescription,
+                         int aPadCount = 1 );
+
+    ///> Sets the modification time of the file of footprint aName
+    void SetFileTime( const wxString& aName, const wxDateTime& aTime );
+
+private:
+    wxString m_rootDir;
+    wxString m_libDir;
+};
+
+} // namespace KI_TEST
+
+#endif // QA_PCBNEW_FOOTPRINT_LIB_TEST_UTILS__H
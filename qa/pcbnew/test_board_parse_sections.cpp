@@ -0,0 +1,273 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_board_parse_sections.cpp
+ * Checks that a board file lexed in place, whose footprints, tracks and zones are parsed on
+ * several threads, reads the same as when it is parsed serially.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <richio.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <plugins/kicad/pcb_parser.h>
+
+
+/**
+ * A log target keeping the messages, without their time stamps.
+ */
+class TEST_LOG : public wxLog
+{
+public:
+    std::vector<wxString> m_messages;
+
+protected:
+    void DoLogRecord( wxLogLevel aLevel, const wxString& aMsg,
+                      const wxLogRecordInfo& aInfo ) override
+    {
+        m_messages.push_back( aMsg );
+    }
+};
+
+
+/**
+ * A board saved to a temporary file, with enough footprints, tracks, vias and zones for
+ * the parser to share them between several threads.
+ */
+struct BOARD_PARSE_SECTIONS_FIXTURE
+{
+    BOARD_PARSE_SECTIONS_FIXTURE() :
+            m_fileName( wxFileName::CreateTempFileName( "board_parse" ) )
+    {
+        BOARD board;
+
+        for( int net = 1; net <= 16; ++net )
+            board.Add( new NETINFO_ITEM( &board, wxString::Format( "N%02d", net ), net ) );
+
+        for( int ii = 0; ii < 400; ++ii )
+        {
+            int     net = ii % 16 + 1;
+            wxPoint pos( Millimeter2iu( 5 * ( ii % 20 ) ), Millimeter2iu( 5 * ( ii / 20 ) ) );
+
+            if( ii % 2 == 0 )
+            {
+                MODULE* footprint = new MODULE( &board );
+
+                footprint->SetReference( wxString::Format( "R%d", ii ) );
+
+                for( int padNum = 0; padNum < 2; ++padNum )
+                {
+                    D_PAD*  pad = new D_PAD( footprint );
+                    wxPoint padPos( Millimeter2iu( 2 * padNum ), 0 );
+
+                    pad->SetName( wxString::Format( "%d", padNum + 1 ) );
+                    pad->SetAttribute( PAD_ATTRIB_SMD );
+                    pad->SetLayerSet( D_PAD::SMDMask() );
+                    pad->SetShape( PAD_SHAPE_RECT );
+                    pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+                    pad->SetPos0( padPos );
+                    pad->SetPosition( padPos );
+                    pad->SetNetCode( padNum ? net : 16 - net + 1 );
+                    footprint->Add( pad );
+                }
+
+                footprint->SetPosition( pos );
+                board.Add( footprint );
+            }
+
+            TRACK* track = new TRACK( &board );
+
+            track->SetLayer( ii % 3 ? F_Cu : B_Cu );
+            track->SetNetCode( net );
+            track->SetWidth( Millimeter2iu( 0.25 ) );
+            track->SetStart( pos );
+            track->SetEnd( pos + wxPoint( Millimeter2iu( 3 ), Millimeter2iu( 1 ) ) );
+            board.Add( track );
+
+            VIA* via = new VIA( &board );
+
+            via->SetNetCode( net );
+            via->SetPosition( pos + wxPoint( 0, Millimeter2iu( 2 ) ) );
+            via->SetWidth( Millimeter2iu( 0.6 ) );
+            via->SetDrill( Millimeter2iu( 0.3 ) );
+            via->SetLayerPair( F_Cu, B_Cu );
+            board.Add( via );
+        }
+
+        // Not on N03, whose pad net names are broken by the tests
+        for( int ii = 0; ii < 4; ++ii )
+        {
+            ZONE_CONTAINER* zone = new ZONE_CONTAINER( &board );
+            int             x = 30 * ii;
+
+            zone->SetLayer( B_Cu );
+            zone->SetNetCode( ii + 4 );
+            zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+
+            zone->Outline()->NewOutline();
+            zone->Outline()->Append( Millimeter2iu( x ), 0 );
+            zone->Outline()->Append( Millimeter2iu( x + 20 ), 0 );
+            zone->Outline()->Append( Millimeter2iu( x + 20 ), Millimeter2iu( 20 ) );
+            zone->Outline()->Append( Millimeter2iu( x ), Millimeter2iu( 20 ) );
+            board.Add( zone );
+        }
+
+        PCB_IO io;
+
+        io.Save( m_fileName, &board );
+    }
+
+    ~BOARD_PARSE_SECTIONS_FIXTURE()
+    {
+        wxRemoveFile( m_fileName );
+    }
+
+    ///> Parses the file through the given reader, keeping the logged messages
+    std::unique_ptr<BOARD> parse( LINE_READER& aReader, std::vector<wxString>& aMessages )
+    {
+        TEST_LOG*  log = new TEST_LOG;
+        wxLog*     oldLog = wxLog::SetActiveTarget( log );
+        PCB_PARSER parser;
+
+        parser.SetLineReader( &aReader );
+
+        std::unique_ptr<BOARD> board( static_cast<BOARD*>( parser.Parse() ) );
+
+        aMessages = log->m_messages;
+        delete wxLog::SetActiveTarget( oldLog );
+
+        return board;
+    }
+
+    ///> Parses the file in place, with its footprints, tracks and zones on several threads
+    std::unique_ptr<BOARD> parseInPlace( std::vector<wxString>& aMessages )
+    {
+        MAPPED_FILE_LINE_READER reader( m_fileName );
+
+        return parse( reader, aMessages );
+    }
+
+    std::unique_ptr<BOARD> parseSerially( std::vector<wxString>& aMessages )
+    {
+        FILE_LINE_READER reader( m_fileName );
+
+        return parse( reader, aMessages );
+    }
+
+    ///> The board as saved again, which holds all of its content
+    static std::string format( BOARD* aBoard )
+    {
+        PCB_IO io;
+
+        io.Format( aBoard );
+        return io.GetStringOutput( true );
+    }
+
+    wxString m_fileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( BoardParseSections, BOARD_PARSE_SECTIONS_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsSerialParse )
+{
+    std::vector<wxString>  inPlaceMessages;
+    std::vector<wxString>  serialMessages;
+    std::unique_ptr<BOARD> inPlace = parseInPlace( inPlaceMessages );
+    std::unique_ptr<BOARD> serial = parseSerially( serialMessages );
+
+    BOOST_REQUIRE( inPlace );
+    BOOST_REQUIRE( serial );
+
+    BOOST_CHECK_EQUAL( inPlace->Modules().size(), 200u );
+    BOOST_CHECK_EQUAL( inPlace->Tracks().size(), 800u );
+    BOOST_CHECK_EQUAL( inPlace->Zones().size(), 4u );
+
+    BOOST_CHECK( format( inPlace.get() ) == format( serial.get() ) );
+    BOOST_CHECK( inPlaceMessages.empty() );
+    BOOST_CHECK( serialMessages.empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE( ErrorsLoggedInFileOrder )
+{
+    wxFFile  file( m_fileName, "r" );
+    wxString content;
+
+    BOOST_REQUIRE( file.ReadAll( &content ) );
+    file.Close();
+
+    // Break the net names of the N03 pads, leaving the net list of the header alone
+    std::string text( content.ToStdString() );
+    size_t      firstFootprint = text.find( "(module" );
+
+    BOOST_REQUIRE( firstFootprint != std::string::npos );
+
+    std::regex  padNet( "\\(net (\\d+) \"?N03\"?\\)" );
+    std::string broken = text.substr( 0, firstFootprint )
+                         + std::regex_replace( text.substr( firstFootprint ), padNet,
+                                               "(net $1 WRONG)" );
+
+    BOOST_REQUIRE( broken != text );
+
+    file.Open( m_fileName, "w" );
+    file.Write( broken.c_str(), broken.size() );
+    file.Close();
+
+    std::vector<wxString>  inPlaceMessages;
+    std::vector<wxString>  serialMessages;
+    std::unique_ptr<BOARD> inPlace = parseInPlace( inPlaceMessages );
+    std::unique_ptr<BOARD> serial = parseSerially( serialMessages );
+
+    BOOST_REQUIRE( inPlace );
+    BOOST_REQUIRE( serial );
+
+    // One message per broken pad, the same and in the same order as the serial parse
+    BOOST_CHECK_EQUAL( serialMessages.size(), 25u );
+    BOOST_REQUIRE_EQUAL( inPlaceMessages.size(), serialMessages.size() );
+
+    for( size_t ii = 0; ii < serialMessages.size(); ++ii )
+        BOOST_CHECK( inPlaceMessages[ii] == serialMessages[ii] );
+
+    BOOST_CHECK( format( inPlace.get() ) == format( serial.get() ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,243 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_connectivity_incremental.cpp
+ * Checks that the ratsnest clusters kept up to date through item changes are the same as
+ * the ones of a connectivity database built from scratch.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+
+
+using CLUSTER_CONTENTS = std::vector<std::vector<const BOARD_CONNECTED_ITEM*>>;
+
+
+/**
+ * A row of four pads for each of eight nets, with tracks joining some of them, and a zone
+ * on the first net covering the pads of its row.
+ */
+struct CONNECTIVITY_INCREMENTAL_FIXTURE
+{
+    CONNECTIVITY_INCREMENTAL_FIXTURE()
+    {
+        MODULE* module = new MODULE( &m_board );
+
+        for( int net = 1; net <= 8; ++net )
+        {
+            m_board.Add( new NETINFO_ITEM( &m_board, wxString::Format( "N%d", net ), net ) );
+
+            for( int ii = 0; ii < 4; ++ii )
+            {
+                D_PAD*  pad = new D_PAD( module );
+                wxPoint pos = padPos( net, ii );
+
+                pad->SetAttribute( PAD_ATTRIB_SMD );
+                pad->SetLayerSet( D_PAD::SMDMask() );
+                pad->SetShape( PAD_SHAPE_RECT );
+                pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+                pad->SetPos0( pos );
+                pad->SetPosition( pos );
+                pad->SetNetCode( net );
+                module->Add( pad );
+            }
+        }
+
+        m_board.Add( module );
+
+        for( int net = 2; net <= 8; ++net )
+        {
+            m_tracks.push_back( addTrack( net, padPos( net, 0 ), padPos( net, 1 ) ) );
+
+            if( net % 2 )
+                m_tracks.push_back( addTrack( net, padPos( net, 2 ), padPos( net, 3 ) ) );
+        }
+
+        m_zone = new ZONE_CONTAINER( &m_board );
+        m_zone->SetLayer( F_Cu );
+        m_zone->SetNetCode( 1 );
+        m_zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+        m_zone->Outline()->AddOutline( rect( -2, 8, 40, 4 ) );
+        m_board.Add( m_zone );
+
+        setZoneFill( rect( -2, 8, 40, 4 ) );
+
+        m_board.BuildConnectivity();
+    }
+
+    static wxPoint padPos( int aNet, int aIndex )
+    {
+        return wxPoint( Millimeter2iu( 10 * aIndex ), Millimeter2iu( 10 * aNet ) );
+    }
+
+    static SHAPE_LINE_CHAIN rect( int aX, int aY, int aW, int aH )
+    {
+        SHAPE_LINE_CHAIN chain( { VECTOR2I( Millimeter2iu( aX ), Millimeter2iu( aY ) ),
+                                  VECTOR2I( Millimeter2iu( aX + aW ), Millimeter2iu( aY ) ),
+                                  VECTOR2I( Millimeter2iu( aX + aW ), Millimeter2iu( aY + aH ) ),
+                                  VECTOR2I( Millimeter2iu( aX ), Millimeter2iu( aY + aH ) ) } );
+        chain.SetClosed( true );
+        return chain;
+    }
+
+    TRACK* addTrack( int aNet, const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        TRACK* track = new TRACK( &m_board );
+
+        track->SetLayer( F_Cu );
+        track->SetNetCode( aNet );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetStart( aStart );
+        track->SetEnd( aEnd );
+        m_board.Add( track );
+
+        return track;
+    }
+
+    void setZoneFill( const SHAPE_LINE_CHAIN& aOutline )
+    {
+        SHAPE_POLY_SET fill;
+
+        fill.AddOutline( aOutline );
+        m_zone->SetFilledPolysList( F_Cu, fill );
+        m_zone->SetIsFilled( true );
+    }
+
+    ///> The items of the ratsnest clusters of each net, in a comparable order
+    static std::map<int, CLUSTER_CONTENTS> clusterContents( CONNECTIVITY_DATA& aConnectivity )
+    {
+        std::map<int, CLUSTER_CONTENTS> contents;
+
+        for( const CN_CLUSTER_PTR& cluster : aConnectivity.GetConnectivityAlgo()->GetClusters() )
+        {
+            std::vector<const BOARD_CONNECTED_ITEM*> items;
+
+            for( CN_ITEM* item : *cluster )
+                items.push_back( item->Parent() );
+
+            std::sort( items.begin(), items.end() );
+            items.erase( std::unique( items.begin(), items.end() ), items.end() );
+            contents[cluster->OriginNet()].push_back( items );
+        }
+
+        for( auto& net : contents )
+            std::sort( net.second.begin(), net.second.end() );
+
+        return contents;
+    }
+
+    ///> Checks the board connectivity against a connectivity database built from scratch
+    void checkMatchesRebuild()
+    {
+        std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board.GetConnectivity();
+        CONNECTIVITY_DATA                  rebuilt;
+
+        connectivity->RecalculateRatsnest();
+        rebuilt.Build( &m_board );
+
+        BOOST_CHECK( clusterContents( *connectivity ) == clusterContents( rebuilt ) );
+        BOOST_CHECK_EQUAL( connectivity->GetUnconnectedCount(), rebuilt.GetUnconnectedCount() );
+    }
+
+    BOARD               m_board;
+    ZONE_CONTAINER*     m_zone;
+    std::vector<TRACK*> m_tracks;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivityIncremental, CONNECTIVITY_INCREMENTAL_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ItemChanges )
+{
+    checkMatchesRebuild();
+
+    // Moving a track away from a pad splits a cluster
+    m_tracks[0]->SetEnd( padPos( 2, 1 ) + wxPoint( 0, Millimeter2iu( 3 ) ) );
+    m_board.GetConnectivity()->Update( m_tracks[0] );
+    checkMatchesRebuild();
+
+    // Adding one merges two
+    addTrack( 4, padPos( 4, 1 ), padPos( 4, 2 ) );
+    checkMatchesRebuild();
+
+    // Removing one splits one again
+    m_board.Remove( m_tracks[1] );
+    checkMatchesRebuild();
+    delete m_tracks[1];
+
+    // Changing the net of a track moves it to the other net's clusters, and updating it is
+    // enough for both nets to be searched again
+    m_tracks[2]->SetNetCode( 5 );
+    m_board.GetConnectivity()->Update( m_tracks[2] );
+    checkMatchesRebuild();
+
+    // The same for a pad, and for a zone, whose items are otherwise kept on update
+    D_PAD* pad = m_board.Modules().front()->Pads()[ 9 ];
+
+    pad->SetNetCode( 6 );
+    m_board.GetConnectivity()->Update( pad );
+    checkMatchesRebuild();
+
+    m_zone->SetNetCode( 7 );
+    m_board.GetConnectivity()->Update( m_zone );
+    checkMatchesRebuild();
+}
+
+
+BOOST_AUTO_TEST_CASE( UnchangedZoneFill )
+{
+    std::shared_ptr<CN_CONNECTIVITY_ALGO> algo = m_board.GetConnectivity()->GetConnectivityAlgo();
+
+    m_board.GetConnectivity()->RecalculateRatsnest();
+
+    const std::list<CN_ITEM*> zoneItems = algo->ItemEntry( m_zone ).GetItems();
+
+    // Refilling with the same copper keeps the zone items and leaves the net clean
+    setZoneFill( rect( -2, 8, 40, 4 ) );
+    m_board.GetConnectivity()->Update( m_zone );
+
+    BOOST_CHECK( algo->ItemEntry( m_zone ).GetItems() == zoneItems );
+    BOOST_CHECK( !algo->IsNetDirty( 1 ) );
+    checkMatchesRebuild();
+
+    // A fill reaching fewer pads rebuilds them
+    setZoneFill( rect( -2, 8, 15, 4 ) );
+    m_board.GetConnectivity()->Update( m_zone );
+
+    BOOST_CHECK( algo->ItemEntry( m_zone ).GetItems() != zoneItems );
+    BOOST_CHECK( algo->IsNetDirty( 1 ) );
+    checkMatchesRebuild();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
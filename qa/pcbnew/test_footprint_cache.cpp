@@ -0,0 +1,241 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_footprint_cache.cpp
+ * Checks that the KiCad footprint library plugin only parses the footprints it is asked
+ * for, and parses them again when their file changes.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <memory>
+
+#include <wx/filename.h>
+
+#include <class_module.h>
+#include <ki_exception.h>
+#include <plugins/kicad/kicad_plugin.h>
+
+#include "footprint_lib_test_utils.h"
+
+
+/**
+ * A footprint library of two resistors in a temporary directory.
+ */
+struct FOOTPRINT_CACHE_FIXTURE
+{
+    FOOTPRINT_CACHE_FIXTURE() :
+            m_libDir( m_lib.GetPath() )
+    {
+        m_lib.WriteFootprint( "R1", "Resistor" );
+        m_lib.WriteFootprint( "R2", "Resistor array" );
+        backdate( "R1" );
+        backdate( "R2" );
+    }
+
+    ///> Makes the file of footprint aName an hour old, so that its timestamp is trusted
+    void backdate( const wxString& aName )
+    {
+        m_lib.SetFileTime( aName, wxDateTime::Now() - wxTimeSpan::Hour() );
+    }
+
+    ///> Loads a footprint and returns its description
+    wxString loadDescription( const wxString& aName )
+    {
+        std::unique_ptr<MODULE> footprint( m_io.FootprintLoad( m_libDir, aName ) );
+
+        BOOST_REQUIRE( footprint );
+        return footprint->GetDescription();
+    }
+
+    KI_TEST::TEMP_FOOTPRINT_LIB m_lib;
+    wxString                    m_libDir;
+    PCB_IO                      m_io;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintCache, FOOTPRINT_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ParsedOnFirstLoad )
+{
+    m_lib.WriteFile( "broken", "(module broken (layer" );
+
+    // Listing the library parses nothing, so the broken footprint is only found when loaded
+    wxArrayString names;
+
+    BOOST_CHECK_NO_THROW( m_io.FootprintEnumerate( names, m_libDir, false ) );
+    BOOST_CHECK_EQUAL( names.size(), 3u );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor" );
+    BOOST_CHECK_THROW( m_io.FootprintLoad( m_libDir, "broken" ), IO_ERROR );
+    BOOST_CHECK( m_io.GetEnumeratedFootprint( m_libDir, "broken" ) == nullptr );
+    BOOST_CHECK( m_io.FootprintLoad( m_libDir, "R9" ) == nullptr );
+
+    // R2 was not parsed yet: a new content with the same timestamp is what gets loaded
+    wxDateTime time = wxFileName( m_lib.FileName( "R2" ) ).GetModificationTime();
+
+    m_lib.WriteFootprint( "R2", "Resistor network" );
+    m_lib.SetFileTime( "R2", time );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor network" );
+}
+
+
+BOOST_AUTO_TEST_CASE( ChangedFileParsedAgain )
+{
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor" );
+
+    wxDateTime time = wxFileName( m_lib.FileName( "R1" ) ).GetModificationTime();
+
+    m_lib.WriteFootprint( "R1", "Resistor, changed" );
+    m_lib.SetFileTime( "R1", time + wxTimeSpan::Minutes( 1 ) );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor, changed" );
+
+    // Enumerated footprints are checked for changes too
+    m_lib.WriteFootprint( "R1", "Resistor, changed again" );
+    m_lib.SetFileTime( "R1", time + wxTimeSpan::Minutes( 2 ) );
+
+    BOOST_CHECK_EQUAL( m_io.GetEnumeratedFootprint( m_libDir, "R1" )->GetDescription(),
+                       "Resistor, changed again" );
+
+    // Added footprints are found
+    m_lib.WriteFootprint( "R3", "Resistor" );
+    m_lib.SetFileTime( "R3", time + wxTimeSpan::Minutes( 3 ) );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R3" ), "Resistor" );
+}
+
+
+BOOST_AUTO_TEST_CASE( RacyFileParsedAgain )
+{
+    // A file changed within the same second as it was parsed keeps its timestamp
+    wxDateTime time = wxDateTime::Now();
+
+    m_lib.SetFileTime( "R1", time );
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor" );
+
+    m_lib.WriteFootprint( "R1", "Resistor, changed" );
+    m_lib.SetFileTime( "R1", time );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor, changed" );
+}
+
+
+BOOST_AUTO_TEST_CASE( CacheSizeLimit )
+{
+    m_io.SetFootprintCacheSize( 1 );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor" );
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor array" );
+
+    // New contents with the same timestamps are only seen for a footprint which was dropped
+    wxDateTime time1 = wxFileName( m_lib.FileName( "R1" ) ).GetModificationTime();
+    wxDateTime time2 = wxFileName( m_lib.FileName( "R2" ) ).GetModificationTime();
+
+    m_lib.WriteFootprint( "R2", "Resistor array, changed" );
+    m_lib.SetFileTime( "R2", time2 );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor array" );
+
+    m_lib.WriteFootprint( "R1", "Resistor, changed" );
+    m_lib.SetFileTime( "R1", time1 );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor, changed" );
+}
+
+
+BOOST_AUTO_TEST_CASE( EnumeratedFootprintsKept )
+{
+    m_io.SetFootprintCacheSize( 1 );
+
+    m_lib.WriteFootprint( "R3", "Resistor pack" );
+
+    wxArrayString names;
+    m_io.FootprintEnumerate( names, m_libDir, false );
+
+    const MODULE* r1 = m_io.GetEnumeratedFootprint( m_libDir, "R1" );
+    const MODULE* r2 = m_io.GetEnumeratedFootprint( m_libDir, "R2" );
+
+    BOOST_REQUIRE( r1 && r2 );
+
+    // Past the cache size, and R1 even replaced, yet both stay valid until the next listing
+    BOOST_CHECK_EQUAL( loadDescription( "R3" ), "Resistor pack" );
+
+    wxDateTime time = wxFileName( m_lib.FileName( "R1" ) ).GetModificationTime();
+
+    m_lib.WriteFootprint( "R1", "Resistor, changed" );
+    m_lib.SetFileTime( "R1", time + wxTimeSpan::Minutes( 1 ) );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor, changed" );
+
+    BOOST_CHECK( m_io.GetEnumeratedFootprint( m_libDir, "R2" ) == r2 );
+    BOOST_CHECK_EQUAL( r1->GetDescription(), "Resistor" );
+    BOOST_CHECK_EQUAL( r2->GetDescription(), "Resistor array" );
+
+    // Changed again, R1 is parsed anew when enumerated, and the replaced ones stay valid
+    m_lib.WriteFootprint( "R1", "Resistor, changed again" );
+    m_lib.SetFileTime( "R1", time + wxTimeSpan::Minutes( 2 ) );
+
+    const MODULE* newR1 = m_io.GetEnumeratedFootprint( m_libDir, "R1" );
+
+    BOOST_REQUIRE( newR1 );
+    BOOST_CHECK_EQUAL( newR1->GetDescription(), "Resistor, changed again" );
+    BOOST_CHECK_EQUAL( r1->GetDescription(), "Resistor" );
+
+    // The next listing releases them, and the cache size applies again
+    m_io.FootprintEnumerate( names, m_libDir, false );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R1" ), "Resistor, changed again" );
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor array" );
+}
+
+
+BOOST_AUTO_TEST_CASE( PinnedFootprintsCounted )
+{
+    m_io.SetFootprintCacheSize( 2 );
+
+    m_lib.WriteFootprint( "R3", "Resistor pack" );
+    backdate( "R3" );
+
+    wxArrayString names;
+    m_io.FootprintEnumerate( names, m_libDir, false );
+
+    BOOST_REQUIRE( m_io.GetEnumeratedFootprint( m_libDir, "R1" ) );
+
+    // With R1 pinned, there is only room for one more footprint, so loading R3 drops R2
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor array" );
+    BOOST_CHECK_EQUAL( loadDescription( "R3" ), "Resistor pack" );
+
+    wxDateTime time = wxFileName( m_lib.FileName( "R2" ) ).GetModificationTime();
+
+    m_lib.WriteFootprint( "R2", "Resistor array, changed" );
+    m_lib.SetFileTime( "R2", time );
+
+    BOOST_CHECK_EQUAL( loadDescription( "R2" ), "Resistor array, changed" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
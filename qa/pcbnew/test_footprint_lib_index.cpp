@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_footprint_lib_index.cpp
+ * Checks that the footprint library index only parses the footprint files changed since it
+ * was written, and gives the same entries as parsing all of them.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+
+#include <footprint_lib_index.h>
+#include <ki_exception.h>
+
+#include "footprint_lib_test_utils.h"
+
+
+/**
+ * A footprint library of two resistors in a temporary directory, and a directory for its
+ * index next to it.
+ */
+struct FOOTPRINT_LIB_INDEX_FIXTURE
+{
+    FOOTPRINT_LIB_INDEX_FIXTURE() :
+            m_libDir( m_lib.GetPath() ),
+            m_indexDir( m_lib.GetRootDir() + "/index" )
+    {
+        m_lib.WriteFootprint( "R1", "Resistor", 2 );
+        m_lib.WriteFootprint( "R2", "Resistor array", 4 );
+
+        age( "R1", wxTimeSpan::Hours( 2 ) );
+        age( "R2", wxTimeSpan::Hours( 2 ) );
+    }
+
+    ///> Dates the file of footprint aName back by aAge, so that the index trusts it
+    void age( const wxString& aName, const wxTimeSpan& aAge )
+    {
+        m_lib.SetFileTime( aName, wxDateTime::Now() - aAge );
+    }
+
+    ///> Updates a new index of the library, as a new session would
+    FOOTPRINT_LIB_INDEX update()
+    {
+        FOOTPRINT_LIB_INDEX index( m_libDir, m_indexDir );
+
+        index.Update();
+        return index;
+    }
+
+    KI_TEST::TEMP_FOOTPRINT_LIB m_lib;
+    wxString                    m_libDir;
+    wxString                    m_indexDir;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintLibIndex, FOOTPRINT_LIB_INDEX_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( OnlyChangedFilesParsed )
+{
+    FOOTPRINT_LIB_INDEX first = update();
+
+    BOOST_CHECK_EQUAL( first.GetParsedCount(), 2 );
+    BOOST_REQUIRE_EQUAL( first.GetEntries().size(), 2u );
+    BOOST_CHECK( wxFileExists( first.GetIndexFileName() ) );
+
+    const FOOTPRINT_LIB_INDEX::ENTRY& r2 = first.GetEntries()[1];
+
+    BOOST_CHECK_EQUAL( r2.GetName(), "R2" );
+    BOOST_CHECK_EQUAL( r2.m_description, "Resistor array" );
+    BOOST_CHECK_EQUAL( r2.m_keywords, "resistor" );
+    BOOST_CHECK_EQUAL( r2.m_padCount, 4u );
+    BOOST_CHECK_EQUAL( r2.m_uniquePadCount, 4u );
+
+    // Nothing changed: everything comes from the index
+    FOOTPRINT_LIB_INDEX second = update();
+
+    BOOST_CHECK_EQUAL( second.GetParsedCount(), 0 );
+    BOOST_REQUIRE_EQUAL( second.GetEntries().size(), 2u );
+    BOOST_CHECK_EQUAL( second.GetEntries()[1].m_description, "Resistor array" );
+
+    // A changed and an added footprint are parsed, and only them
+    m_lib.WriteFootprint( "R2", "Resistor network", 8 );
+    m_lib.WriteFootprint( "R3", "Resistor", 2 );
+
+    age( "R2", wxTimeSpan::Hour() );
+    age( "R3", wxTimeSpan::Hour() );
+
+    FOOTPRINT_LIB_INDEX third = update();
+
+    BOOST_CHECK_EQUAL( third.GetParsedCount(), 2 );
+    BOOST_REQUIRE_EQUAL( third.GetEntries().size(), 3u );
+    BOOST_CHECK_EQUAL( third.GetEntries()[1].m_description, "Resistor network" );
+    BOOST_CHECK_EQUAL( third.GetEntries()[1].m_padCount, 8u );
+
+    // A deleted one is dropped
+    wxRemoveFile( m_lib.FileName( "R1" ) );
+
+    FOOTPRINT_LIB_INDEX fourth = update();
+
+    BOOST_CHECK_EQUAL( fourth.GetParsedCount(), 0 );
+    BOOST_REQUIRE_EQUAL( fourth.GetEntries().size(), 2u );
+    BOOST_CHECK_EQUAL( fourth.GetEntries()[0].GetName(), "R2" );
+}
+
+
+BOOST_AUTO_TEST_CASE( BrokenFootprint )
+{
+    m_lib.WriteFile( "broken", "(module broken (layer" );
+
+    FOOTPRINT_LIB_INDEX index( m_libDir, m_indexDir );
+
+    BOOST_CHECK_THROW( index.Update(), IO_ERROR );
+
+    // The other footprints are indexed anyway, the broken one is parsed again next time
+    BOOST_CHECK_EQUAL( index.GetEntries().size(), 2u );
+    BOOST_CHECK_THROW( index.Update(), IO_ERROR );
+    BOOST_CHECK_EQUAL( index.GetParsedCount(), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( CorruptIndex )
+{
+    FOOTPRINT_LIB_INDEX first = update();
+
+    // A truncated index is rebuilt
+    wxFFile file( first.GetIndexFileName(), "wb" );
+    BOOST_REQUIRE( file.IsOpened() && file.Write( wxString( "KIFPIDX2\x05" ) ) );
+    file.Close();
+
+    FOOTPRINT_LIB_INDEX second = update();
+
+    BOOST_CHECK_EQUAL( second.GetParsedCount(), 2 );
+    BOOST_CHECK_EQUAL( second.GetEntries().size(), 2u );
+}
+
+
+BOOST_AUTO_TEST_CASE( RacyEntriesParsedAgain )
+{
+    wxDateTime now = wxDateTime::Now();
+
+    m_lib.WriteFootprint( "R3", "Resistor A", 2 );
+    m_lib.SetFileTime( "R3", now );
+
+    FOOTPRINT_LIB_INDEX first = update();
+
+    BOOST_CHECK_EQUAL( first.GetParsedCount(), 3 );
+
+    // Changed again within the same second, keeping its size: only the time of the index
+    // tells that it may have changed
+    m_lib.WriteFootprint( "R3", "Resistor B", 2 );
+    m_lib.SetFileTime( "R3", now );
+
+    FOOTPRINT_LIB_INDEX second = update();
+
+    BOOST_CHECK_EQUAL( second.GetParsedCount(), 1 );
+    BOOST_REQUIRE_EQUAL( second.GetEntries().size(), 3u );
+    BOOST_CHECK_EQUAL( second.GetEntries()[2].m_description, "Resistor B" );
+
+    // Once it is older than the index, it is trusted again
+    age( "R3", wxTimeSpan::Hour() );
+
+    FOOTPRINT_LIB_INDEX third = update();
+
+    BOOST_CHECK_EQUAL( third.GetParsedCount(), 1 );
+
+    FOOTPRINT_LIB_INDEX fourth = update();
+
+    BOOST_CHECK_EQUAL( fourth.GetParsedCount(), 0 );
+    BOOST_CHECK_EQUAL( fourth.GetEntries()[2].m_description, "Resistor B" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
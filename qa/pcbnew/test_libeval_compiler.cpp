@@ -178,4 +178,30 @@ BOOST_AUTO_TEST_CASE( IntrospectedProperties )
     }
 }
 
+BOOST_AUTO_TEST_CASE( ReusedContext )
+{
+    BOARD brd;
+    TRACK track( &brd );
+
+    track.SetLayer( F_Cu );
+
+    PCB_EXPR_COMPILER badCompiler, goodCompiler;
+    PCB_EXPR_UCODE    badLayer, goodLayer;
+    PCB_EXPR_CONTEXT  context, preflightContext;
+
+    BOOST_REQUIRE( badCompiler.Compile( "A.existsOnLayer('No_Such_Layer')", &badLayer,
+                                        &preflightContext ) );
+    BOOST_REQUIRE( goodCompiler.Compile( "A.existsOnLayer('F.Cu')", &goodLayer,
+                                         &preflightContext ) );
+
+    context.SetItems( &track, &track );
+
+    BOOST_CHECK_EQUAL( badLayer.Run( &context )->AsDouble(), 0.0 );
+    BOOST_CHECK( context.IsErrorPending() );
+
+    // The error of the previous evaluation doesn't carry over
+    BOOST_CHECK_EQUAL( goodLayer.Run( &context )->AsDouble(), 1.0 );
+    BOOST_CHECK( !context.IsErrorPending() );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,269 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_fill_fingerprint.cpp
+ * Checks that a refill only recomputes the zones whose fill inputs changed, and that the
+ * fills restored for the others are the same as a fresh fill.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <drc/drc_engine.h>
+#include <zone_filler.h>
+
+
+/**
+ * A row of four 20mm x 20mm zones on F_Cu, alternately GND and PWR, each with a signal
+ * track and via across it.  A higher-priority SIG zone sits inside the second one.
+ */
+struct ZONE_FINGERPRINT_FIXTURE
+{
+    ZONE_FINGERPRINT_FIXTURE()
+    {
+        BOARD_DESIGN_SETTINGS& bds = m_board.GetDesignSettings();
+
+        bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( &m_board, &bds );
+        bds.m_DRCEngine->InitEngine( wxFileName() );
+
+        m_board.Add( new NETINFO_ITEM( &m_board, "GND", 1 ) );
+        m_board.Add( new NETINFO_ITEM( &m_board, "PWR", 2 ) );
+        m_board.Add( new NETINFO_ITEM( &m_board, "SIG", 3 ) );
+
+        for( int ii = 0; ii < 4; ++ii )
+        {
+            int x = 30 * ii;
+
+            m_zones.push_back( addZone( ii % 2 ? 2 : 1, x, 0, 20, 20 ) );
+
+            TRACK* track = new TRACK( &m_board );
+            track->SetLayer( F_Cu );
+            track->SetNetCode( 3 );
+            track->SetWidth( Millimeter2iu( 0.25 ) );
+            track->SetStart( wxPoint( Millimeter2iu( x + 2 ), Millimeter2iu( 5 ) ) );
+            track->SetEnd( wxPoint( Millimeter2iu( x + 18 ), Millimeter2iu( 6 ) ) );
+            m_board.Add( track );
+
+            VIA* via = new VIA( &m_board );
+            via->SetNetCode( 3 );
+            via->SetPosition( wxPoint( Millimeter2iu( x + 10 ), Millimeter2iu( 12 ) ) );
+            via->SetWidth( Millimeter2iu( 0.6 ) );
+            via->SetDrill( Millimeter2iu( 0.3 ) );
+            via->SetLayerPair( F_Cu, B_Cu );
+            m_board.Add( via );
+            m_vias.push_back( via );
+        }
+
+        m_sigZone = addZone( 3, 33, 14, 6, 4 );
+        m_sigZone->SetPriority( 1 );
+
+        m_board.BuildConnectivity();
+    }
+
+    ZONE_CONTAINER* addZone( int aNet, int aX, int aY, int aW, int aH )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &m_board );
+
+        zone->SetLayer( F_Cu );
+        zone->SetNetCode( aNet );
+        zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+        zone->SetLocalClearance( Millimeter2iu( 0.3 ) );
+
+        zone->Outline()->NewOutline();
+        zone->Outline()->Append( Millimeter2iu( aX ), Millimeter2iu( aY ) );
+        zone->Outline()->Append( Millimeter2iu( aX + aW ), Millimeter2iu( aY ) );
+        zone->Outline()->Append( Millimeter2iu( aX + aW ), Millimeter2iu( aY + aH ) );
+        zone->Outline()->Append( Millimeter2iu( aX ), Millimeter2iu( aY + aH ) );
+        m_board.Add( zone );
+
+        return zone;
+    }
+
+    ///> Adds a footprint with a single 1mm SIG pad centred on the given point
+    MODULE* addFootprint( double aX, double aY )
+    {
+        MODULE* module = new MODULE( &m_board );
+        D_PAD*  pad = new D_PAD( module );
+        wxPoint pos( Millimeter2iu( aX ), Millimeter2iu( aY ) );
+
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( D_PAD::SMDMask() );
+        pad->SetShape( PAD_SHAPE_RECT );
+        pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        pad->SetPos0( pos );
+        pad->SetPosition( pos );
+        pad->SetNetCode( 3 );
+        module->Add( pad );
+        m_board.Add( module );
+
+        return module;
+    }
+
+    void fill()
+    {
+        ZONE_FILLER                  filler( &m_board, nullptr );
+        std::vector<ZONE_CONTAINER*> zones( m_board.Zones().begin(), m_board.Zones().end() );
+
+        BOOST_REQUIRE( filler.Fill( zones ) );
+    }
+
+    ///> The fill fingerprints of the zones, in board order
+    std::vector<size_t> fingerprints() const
+    {
+        std::vector<size_t> result;
+
+        for( ZONE_CONTAINER* zone : m_board.Zones() )
+            result.push_back( zone->GetFillFingerprint( F_Cu ) );
+
+        return result;
+    }
+
+    ///> The hashes of the raw and final fills of the zones, in board order
+    std::vector<MD5_HASH> fillHashes() const
+    {
+        std::vector<MD5_HASH> result;
+
+        for( ZONE_CONTAINER* zone : m_board.Zones() )
+        {
+            result.push_back( zone->RawPolysList( F_Cu ).GetHash() );
+            result.push_back( zone->GetFilledPolysList( F_Cu ).GetHash() );
+        }
+
+        return result;
+    }
+
+    ///> Checks the current fills against fills computed from scratch
+    void checkMatchesFreshFill()
+    {
+        std::vector<MD5_HASH> restored = fillHashes();
+
+        for( ZONE_CONTAINER* zone : m_board.Zones() )
+            zone->SetFillFingerprint( F_Cu, 0 );
+
+        fill();
+
+        BOOST_CHECK( fillHashes() == restored );
+    }
+
+    BOARD                        m_board;
+    std::vector<ZONE_CONTAINER*> m_zones;
+    std::vector<VIA*>            m_vias;
+    ZONE_CONTAINER*              m_sigZone;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillFingerprint, ZONE_FINGERPRINT_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( FingerprintsTrackInputs )
+{
+    fill();
+
+    std::vector<size_t> before = fingerprints();
+
+    for( size_t fingerprint : before )
+        BOOST_CHECK_NE( fingerprint, 0u );
+
+    // Filling again with nothing changed keeps every fingerprint
+    fill();
+    BOOST_CHECK( fingerprints() == before );
+
+    // Moving a via only changes the fingerprint of the zone around it
+    m_vias[2]->Move( wxPoint( Millimeter2iu( 3 ), 0 ) );
+    m_board.BuildConnectivity();
+    fill();
+
+    BOOST_CHECK_NE( m_zones[2]->GetFillFingerprint( F_Cu ), before[2] );
+
+    for( int ii : { 0, 1, 3 } )
+        BOOST_CHECK_EQUAL( m_zones[ii]->GetFillFingerprint( F_Cu ), before[ii] );
+
+    BOOST_CHECK_EQUAL( m_sigZone->GetFillFingerprint( F_Cu ), before[4] );
+
+    // A change to a higher-priority zone reaches the zone it knocks out
+    before = fingerprints();
+
+    m_sigZone->Move( wxPoint( Millimeter2iu( 2 ), 0 ) );
+    fill();
+
+    BOOST_CHECK_NE( m_sigZone->GetFillFingerprint( F_Cu ), before[4] );
+    BOOST_CHECK_NE( m_zones[1]->GetFillFingerprint( F_Cu ), before[1] );
+
+    for( int ii : { 0, 2, 3 } )
+        BOOST_CHECK_EQUAL( m_zones[ii]->GetFillFingerprint( F_Cu ), before[ii] );
+}
+
+
+BOOST_AUTO_TEST_CASE( RestoredFillsMatchFreshFill )
+{
+    fill();
+
+    m_vias[0]->Move( wxPoint( 0, Millimeter2iu( 2 ) ) );
+    m_board.BuildConnectivity();
+    fill();
+
+    checkMatchesFreshFill();
+
+    m_sigZone->Move( wxPoint( 0, Millimeter2iu( -3 ) ) );
+    fill();
+
+    checkMatchesFreshFill();
+}
+
+
+BOOST_AUTO_TEST_CASE( FootprintClearanceReachesFingerprints )
+{
+    // One footprint inside the last zone, and one whose pad sits 1.5mm outside the first
+    MODULE* inside = addFootprint( 100, 15 );
+    MODULE* outside = addFootprint( 22, 10 );
+
+    m_board.BuildConnectivity();
+    fill();
+
+    std::vector<size_t> before = fingerprints();
+
+    // The pad has no clearance of its own, so the footprint's clearance applies to it
+    inside->SetLocalClearance( Millimeter2iu( 1 ) );
+    fill();
+
+    BOOST_CHECK_NE( m_zones[3]->GetFillFingerprint( F_Cu ), before[3] );
+    checkMatchesFreshFill();
+
+    // A clearance larger than any netclass clearance reaches a zone the pad lies outside of
+    before = fingerprints();
+
+    outside->SetLocalClearance( Millimeter2iu( 2.5 ) );
+    fill();
+
+    BOOST_CHECK_NE( m_zones[0]->GetFillFingerprint( F_Cu ), before[0] );
+    checkMatchesFreshFill();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Benchmark for DRC rule condition evaluation.
+ *
+ * Evaluates a set of typical custom rule conditions against item pairs of a board, the same
+ * way the DRC providers do.  The board is read from the file given on the command line, or
+ * synthesized (a few thousand tracks and vias over a few netclasses) if there is none.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <netinfo.h>
+
+#include <drc/drc_rule_condition.h>
+#include <pcb_expr_evaluator.h>
+#include <plugins/kicad/pcb_parser.h>
+#include <property_mgr.h>
+#include <richio.h>
+
+#include <profile.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+static const char* conditions[] =
+{
+    "A.NetClass == 'HV'",
+    "A.NetClass == 'HV' && B.NetClass != 'HV'",
+    "A.NetName == '/VCC*' || B.NetName == '/GND'",
+    "A.isDiffPair() && B.NetClass == 'DDR'",
+    "A.Via_Type == 'micro_via'",
+    "A.Width > 0.2mm + 0.05mm",
+    "A.insideCourtyard('U1')",
+};
+
+
+static std::unique_ptr<BOARD> loadBoard( const wxString& aFileName )
+{
+    FILE_LINE_READER reader( aFileName );
+    PCB_PARSER       parser;
+
+    parser.SetLineReader( &reader );
+
+    return std::unique_ptr<BOARD>( dynamic_cast<BOARD*>( parser.Parse() ) );
+}
+
+
+static std::unique_ptr<BOARD> synthesizeBoard()
+{
+    const int   netCount = 256;
+    const int   trackCount = 20000;
+    const char* classNames[] = { "Default", "HV", "DDR", "PWR" };
+
+    std::unique_ptr<BOARD> brd = std::make_unique<BOARD>();
+    NETCLASSES&            netclasses = brd->GetDesignSettings().GetNetClasses();
+
+    for( int ii = 1; ii < 4; ++ii )
+        netclasses.Add( std::make_shared<NETCLASS>( classNames[ii] ) );
+
+    for( int ii = 1; ii <= netCount; ++ii )
+    {
+        wxString      name = ii % 2 ? wxString::Format( "/VCC%d", ii )
+                                    : wxString::Format( "/SIG%d_P", ii );
+        NETINFO_ITEM* net = new NETINFO_ITEM( brd.get(), name, ii );
+
+        brd->Add( net );
+        net->SetClass( netclasses.Find( classNames[ ii % 4 ] ) );
+    }
+
+    for( int ii = 0; ii < trackCount; ++ii )
+    {
+        TRACK* track = ( ii % 10 ) ? new TRACK( brd.get() ) : new VIA( brd.get() );
+
+        track->SetNetCode( 1 + ii % netCount );
+        track->SetLayer( ( ii % 3 ) ? F_Cu : B_Cu );
+        track->SetWidth( Millimeter2iu( 0.1 + 0.05 * ( ii % 5 ) ) );
+        track->SetStart( wxPoint( Millimeter2iu( ii % 100 ), Millimeter2iu( ii / 100 ) ) );
+        track->SetEnd( track->GetStart() + wxPoint( Millimeter2iu( 0.5 ), 0 ) );
+
+        brd->Add( track );
+    }
+
+    return brd;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "p", "pairs", _( "number of pairs evaluated per item" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum LIBEVAL_BENCH_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC
+};
+
+
+int libeval_compiler_bench_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the evaluation of DRC rule conditions "
+                               "over the items of a board, or of a synthesized board." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long pairsPerItem = 50;
+    cl_parser.Found( "pairs", &pairsPerItem );
+    pairsPerItem = std::max( pairsPerItem, 1L );
+
+    PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
+    propMgr.Rebuild();
+
+    std::unique_ptr<BOARD> brd;
+
+    try
+    {
+        brd = cl_parser.GetParamCount() ? loadBoard( cl_parser.GetParam( 0 ) ) : synthesizeBoard();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        printf( "Error loading board: %s\n", (const char*) ioe.What().c_str() );
+        return LIBEVAL_BENCH_RET_CODES::LOAD_FAILED;
+    }
+
+    if( !brd )
+        return LIBEVAL_BENCH_RET_CODES::LOAD_FAILED;
+
+    std::vector<BOARD_ITEM*> items;
+
+    for( TRACK* track : brd->Tracks() )
+        items.push_back( track );
+
+    for( MODULE* module : brd->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+            items.push_back( pad );
+    }
+
+    printf( "%d items, %ld pairs per item\n", (int) items.size(), pairsPerItem );
+
+    double totalMs = 0.0;
+    long   totalEvals = 0;
+
+    for( const char* expr : conditions )
+    {
+        DRC_RULE_CONDITION condition( expr );
+
+        if( !condition.Compile( nullptr ) )
+        {
+            printf( "%-48s failed to compile\n", expr );
+            continue;
+        }
+
+        long          evals = 0;
+        long          matches = 0;
+        PROF_COUNTER  timer;
+
+        for( size_t ii = 0; ii < items.size(); ++ii )
+        {
+            for( long jj = 1; jj <= pairsPerItem; ++jj )
+            {
+                BOARD_ITEM* b = items[ ( ii + jj ) % items.size() ];
+
+                if( condition.EvaluateFor( items[ii], b, F_Cu ) )
+                    matches++;
+
+                evals++;
+            }
+        }
+
+        timer.Stop();
+
+        double ms = timer.msecs();
+
+        printf( "%-48s %10ld evals, %8ld matches, %9.2f ms, %7.1f ns/eval%s\n",
+                expr, evals, matches, ms, ms * 1e6 / std::max( evals, 1L ),
+                condition.HasItemDependencies() ? "" : " (cacheable)" );
+
+        totalMs += ms;
+        totalEvals += evals;
+    }
+
+    printf( "Total: %ld evals in %.2f ms\n", totalEvals, totalMs );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "libeval_compiler_bench",
+        "Measure the evaluation of DRC rule conditions",
+        libeval_compiler_bench_main_func } );
@@ -0,0 +1,173 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Benchmark for the throughput of the s-expression lexer and the PCB parser.
+ *
+ * Each file is lexed and then parsed, once through a FILE_LINE_READER and once through a
+ * MAPPED_FILE_LINE_READER, so that the gain of lexing in place can be measured on real
+ * boards.
+ */
+
+#include <cstdio>
+#include <memory>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <class_board_item.h>
+#include <plugins/kicad/pcb_parser.h>
+#include <pcb_lexer.h>
+#include <richio.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+struct BENCH_RESULT
+{
+    double lexMs = 0.0;
+    double parseMs = 0.0;
+    long   tokens = 0;
+};
+
+
+template <typename READER>
+static BENCH_RESULT runBench( const wxString& aFileName, int aRepeat )
+{
+    BENCH_RESULT result;
+
+    for( int ii = 0; ii < aRepeat; ++ii )
+    {
+        READER    reader( aFileName );
+        PCB_LEXER lexer( &reader );
+        long      tokens = 0;
+
+        PROF_COUNTER timer;
+
+        while( lexer.NextTok() != DSN_EOF )
+            ++tokens;
+
+        timer.Stop();
+
+        result.lexMs += timer.msecs();
+        result.tokens = tokens;
+    }
+
+    for( int ii = 0; ii < aRepeat; ++ii )
+    {
+        READER     reader( aFileName );
+        PCB_PARSER parser;
+
+        parser.SetLineReader( &reader );
+
+        PROF_COUNTER                timer;
+        std::unique_ptr<BOARD_ITEM> item( parser.Parse() );
+
+        timer.Stop();
+
+        result.parseMs += timer.msecs();
+    }
+
+    result.lexMs /= aRepeat;
+    result.parseMs /= aRepeat;
+
+    return result;
+}
+
+
+static void printResult( const char* aReader, const BENCH_RESULT& aResult, double aMegabytes )
+{
+    printf( "  %-8s lex %9.2f ms %8.1f MB/s %8.2f Mtok/s | parse %9.2f ms %8.1f MB/s\n",
+            aReader, aResult.lexMs, aMegabytes * 1e3 / aResult.lexMs,
+            aResult.tokens * 1e-3 / aResult.lexMs, aResult.parseMs,
+            aMegabytes * 1e3 / aResult.parseMs );
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of runs to average" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PARSER_BENCH_RET_CODES
+{
+    PARSE_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int pcb_parser_bench_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the lexing and parsing throughput of PCB "
+                               "and footprint files, read from a stream and mapped in memory." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long repeat = 5;
+    cl_parser.Found( "repeat", &repeat );
+    repeat = std::max( repeat, 1L );
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        wxString filename = cl_parser.GetParam( i );
+        double   megabytes = wxFileName( filename ).GetSize().ToDouble() / ( 1024.0 * 1024.0 );
+
+        printf( "%s (%.2f MB)\n", TO_UTF8( filename ), megabytes );
+
+        try
+        {
+            printResult( "stream", runBench<FILE_LINE_READER>( filename, repeat ), megabytes );
+            printResult( "mapped", runBench<MAPPED_FILE_LINE_READER>( filename, repeat ),
+                         megabytes );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            printf( "  %s\n", TO_UTF8( ioe.What() ) );
+            return PARSER_BENCH_RET_CODES::PARSE_FAILED;
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pcb_parser_bench",
+        "Measure the lexing and parsing throughput of KiCad PCB files",
+        pcb_parser_bench_main_func } );
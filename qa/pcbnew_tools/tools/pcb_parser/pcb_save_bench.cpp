@@ -0,0 +1,172 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Round trip benchmark for saving boards.
+ *
+ * Each board is loaded, then saved several times to a temporary file to measure the save
+ * throughput.  The saved file is loaded and saved once more, and both saves must give the
+ * same bytes.
+ */
+
+#include <cstdio>
+#include <memory>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <richio.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+static bool readFile( const wxString& aFileName, wxString& aContent )
+{
+    wxFFile file( aFileName, "rb" );
+
+    return file.IsOpened() && file.ReadAll( &aContent, wxConvLatin1 );
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of saves to average" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum SAVE_BENCH_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    SAVE_FAILED,
+    ROUND_TRIP_MISMATCH
+};
+
+
+int pcb_save_bench_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the save throughput of PCB files, and "
+                               "checks that saving a saved board gives the same file." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long repeat = 5;
+    cl_parser.Found( "repeat", &repeat );
+    repeat = std::max( repeat, 1L );
+
+    wxString firstSave = wxFileName::CreateTempFileName( "pcb_save_bench" );
+    wxString secondSave = wxFileName::CreateTempFileName( "pcb_save_bench" );
+    int      ret = KI_TEST::RET_CODES::OK;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount() && ret == KI_TEST::RET_CODES::OK; i++ )
+    {
+        wxString               filename = cl_parser.GetParam( i );
+        PCB_IO                 io;
+        std::unique_ptr<BOARD> board;
+
+        printf( "%s\n", TO_UTF8( filename ) );
+
+        try
+        {
+            board.reset( io.Load( filename, nullptr ) );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            printf( "  %s\n", TO_UTF8( ioe.What() ) );
+            ret = SAVE_BENCH_RET_CODES::LOAD_FAILED;
+            break;
+        }
+
+        try
+        {
+            PROF_COUNTER timer;
+
+            for( int ii = 0; ii < repeat; ++ii )
+                io.Save( firstSave, board.get() );
+
+            timer.Stop();
+
+            double msecs = timer.msecs() / repeat;
+            double megabytes = wxFileName( firstSave ).GetSize().ToDouble() / ( 1024.0 * 1024.0 );
+
+            printf( "  save %9.2f ms %8.1f MB/s (%.2f MB)\n", msecs, megabytes * 1e3 / msecs,
+                    megabytes );
+
+            std::unique_ptr<BOARD> reloaded( io.Load( firstSave, nullptr ) );
+            io.Save( secondSave, reloaded.get() );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            printf( "  %s\n", TO_UTF8( ioe.What() ) );
+            ret = SAVE_BENCH_RET_CODES::SAVE_FAILED;
+            break;
+        }
+
+        wxString first;
+        wxString second;
+
+        if( !readFile( firstSave, first ) || !readFile( secondSave, second ) || first != second )
+        {
+            printf( "  round trip mismatch: %s %s\n", TO_UTF8( firstSave ),
+                    TO_UTF8( secondSave ) );
+            ret = SAVE_BENCH_RET_CODES::ROUND_TRIP_MISMATCH;
+        }
+        else
+        {
+            printf( "  round trip ok\n" );
+        }
+    }
+
+    // Leave mismatching files behind for inspection
+    if( ret != SAVE_BENCH_RET_CODES::ROUND_TRIP_MISMATCH )
+    {
+        wxRemoveFile( firstSave );
+        wxRemoveFile( secondSave );
+    }
+
+    return ret;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pcb_save_bench",
+        "Measure the save throughput of KiCad PCB files and check their round trip",
+        pcb_save_bench_main_func } );